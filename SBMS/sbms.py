@@ -424,6 +424,43 @@ def Add_pthread(env):
 				env.AppendUnique(LIBS=['pthread'])
 			
 
+##################################
+# rt (POSIX shared memory)
+##################################
+def Add_rt(env):
+	# Older versions of glibc keep shm_open in librt
+	includes = ['sys/mman.h', 'fcntl.h']
+	content = 'shm_open("", 0, 0);'
+	if(TestCompile(env, 'rt', includes, content, ['']) == None):
+		if(TestCompile(env, 'rt', includes, content, ['-lrt']) != None):
+			env.AppendUnique(LIBS=['rt'])
+
+
+##################################
+# io_uring (used by JAsyncReader)
+##################################
+def Add_io_uring(env):
+	# Only the kernel header is needed since the system calls are
+	# made directly (no liburing). If the header is missing, JAsyncReader
+	# falls back to using threads.
+	includes = ['linux/io_uring.h', 'sys/syscall.h', 'unistd.h']
+	content = 'struct io_uring_params p; syscall(__NR_io_uring_setup, 1, &p);'
+	if(TestCompile(env, 'io_uring', includes, content, ['']) != None):
+		env.AppendUnique(CXXFLAGS = ['-DHAVE_IO_URING'])
+
+
+##################################
+# zlib (used by JDecompressStream)
+##################################
+def Add_zlib(env):
+	# Without zlib, compressed input files can not be read but
+	# everything else still works.
+	includes = ['zlib.h']
+	content = 'z_stream zs; inflateInit2(&zs, 31);'
+	if(TestCompile(env, 'zlib', includes, content, ['-lz']) != None):
+		env.AppendUnique(CXXFLAGS = ['-DHAVE_ZLIB'])
+		env.AppendUnique(LIBS=['z'])
+
 
 ##################################
 # JANA
@@ -216,6 +216,16 @@ def mk_jana_config_script(env):
 		CCDB_LDFLAGS = "-L%s/lib" % (ccdb_home)
 		CCDB_LIBS = "-lccdb"
 
+	# System libraries libJANA.a needs that were found by the Add_pthread,
+	# Add_rt and Add_zlib tests in sbms.py. Since libJANA.a is a static
+	# library, programs linked against it must link these too.
+	SYS_LIBS = ''
+	if 'LIBS' in env:
+		libs = env.Split(env['LIBS'])
+		for lib in ['pthread', 'rt', 'z']:
+			if lib in libs: SYS_LIBS += ' -l%s' % lib
+	SYS_LIBS = SYS_LIBS.strip()
+
 	# Read in entire jana-congfig.in file as a single string
 	ifname = env.File("#/SBMS/jana-config.in").abspath
 	with open (ifname, "r") as myfile:
@@ -255,6 +265,8 @@ def mk_jana_config_script(env):
 		str = str.replace("@CCDB_LDFLAGS@", '%s' % CCDB_LDFLAGS)
 		str = str.replace("@CCDB_LIBS@", '%s' % CCDB_LIBS)
 
+		str = str.replace("@SYS_LIBS@", '%s' % SYS_LIBS)
+
 		str = str.replace("@JANA_INSTALL_DIR@", '%s' % JANA_INSTALL_DIR)
 
 		# Make sure output directory eists
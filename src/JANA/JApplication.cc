@@ -8,7 +8,9 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <fstream>
 #include <algorithm>
+#include <set>
 using namespace std;
 
 #ifdef __linux__
@@ -27,8 +29,16 @@ using namespace std;
 #include "JEventLoop.h"
 #include "JApplication.h"
 #include "JEventProcessor.h"
+#include "JEventSink.h"
 #include "JEventSource.h"
+#include "JEventIndex.h"
 #include "JEvent.h"
+#include "JOrderedOutput.h"
+#include "JPipeline.h"
+#include "JThreadTuner.h"
+#include "JProcessPool.h"
+#include "JCheckpoint.h"
+#include "JFactoryCache.h"
 #include "JGeometryXML.h"
 #include "JGeometryMYSQL.h"
 #include "JParameterManager.h"
@@ -37,6 +47,7 @@ using namespace std;
 #include "JEventSourceGenerator_NULL.h"
 #include "JVersion.h"
 #include "JStreamLog.h"
+#include "JDecompressStream.h"
 using namespace jana;
 
 #ifndef ansi_escape
@@ -236,10 +247,37 @@ JApplication::JApplication(int narg, char* argv[])
 	
 	print_factory_report = false;
 	print_resource_report = false;
+	stats_segment = NULL;
+	factory_cache = NULL;
+	max_events_in_buffer = 0;
+	control_server = NULL;
+	ordered_output = NULL;
+	last_sequence = 0;
+	pipeline = NULL;
+	thread_tuner = NULL;
+	process_pool = NULL;
+	worker_chunk_first = 0;
+	worker_chunk_end = 0;
+	checkpoint = NULL;
+	checkpoint_interval = 60.0;
+	last_checkpoint_ticks = 0;
+	resume_point = NULL;
+	Nsources_resumed = 0;
+	resume_skip = 0;
 
 	
 	// Loop over arguments
 	current_source = NULL;
+	current_source_Nevents = 0;
+	Nbytes_read_done = 0;
+	eventlist_mode = false;
+	Neventlist = 0;
+	Neventlist_selected = 0;
+	Neventlist_skipped = 0;
+	eventlist_source_serial = 0;
+	eventlist_next = 0;
+	nextevent_wait_ticks = 0;
+	print_source_io_stats = true;
 	if(narg>0)this->args.push_back(string(argv[0]));
 	for(int i=1; i<narg; i++){
 	
@@ -251,6 +289,11 @@ JApplication::JApplication(int narg, char* argv[])
 			NTHREADS_COMMAND_LINE = atoi(&argv[i][strlen(arg)]);
 			continue;
 		}
+		arg="--eventlist=";
+		if(!strncmp(arg, argv[i],strlen(arg))){
+			jparms->SetParameter("JANA:EVENTLIST", &argv[i][strlen(arg)]);
+			continue;
+		}
 		arg="--plugin=";
 		if(!strncmp(arg, argv[i],strlen(arg))){
 			const char* pluginname = &argv[i][strlen(arg)];
@@ -426,6 +469,7 @@ void JApplication::Usage(void)
 	
 	cout<<"  --janaversion            Print JANA verson information"<<endl;
 	cout<<"  --nthreads=X             Launch X processing threads"<<endl;
+	cout<<"  --eventlist=filename     Only process the events (\"run event\" lines) in filename"<<endl;
 	cout<<"  --plugin=plugin_name     Attach the plug-in named \"plugin_name\""<<endl;
 	cout<<"  --so=shared_obj          Attach a plug-in with filename \"shared_obj\""<<endl;
 	cout<<"  --sodir=shared_dir       Add the directory \"shared_dir\" to search list"<<endl;
@@ -470,6 +514,24 @@ JApplication::~JApplication()
 	rw_locks.clear();
 	for(auto p : HUP_locks            ) delete p;
 	HUP_locks.clear();
+	if(control_server) delete control_server;
+	control_server = NULL;
+	if(ordered_output) delete ordered_output;
+	ordered_output = NULL;
+	if(pipeline) delete pipeline;
+	pipeline = NULL;
+	if(thread_tuner) delete thread_tuner;
+	thread_tuner = NULL;
+	if(process_pool) delete process_pool;
+	process_pool = NULL;
+	if(checkpoint) delete checkpoint;
+	checkpoint = NULL;
+	if(resume_point) delete resume_point;
+	resume_point = NULL;
+	if(stats_segment) delete stats_segment;
+	stats_segment = NULL;
+	if(factory_cache) delete factory_cache;
+	factory_cache = NULL;
 	
 	// Delete JParameterManager
 	if(jparms)delete jparms;
@@ -546,6 +608,8 @@ jerror_t JApplication::NextEvent(uint64_t event_number, JEvent &event)
 	// Remove all events in buffer up to the event of interest
 	// (if it exists, otherwise remove all events)
 	for(auto myit=event_buffer.begin(); myit!=it; myit++){
+		if(ordered_output) ordered_output->Skip((*myit)->GetSequence());
+		if(pipeline) pipeline->Skip((*myit)->GetSequence());
 		(*myit)->FreeEvent();
 		delete (*myit);		
 	}
@@ -558,8 +622,10 @@ jerror_t JApplication::NextEvent(uint64_t event_number, JEvent &event)
 	jerror_t err = NOERROR;
 	if( event_buffer.empty() ){
 
-		// Event must be read from source. Call base class so it can record event ID
+		// Event must be read from source. Call base class so it can record event ID.
+		// It is not in the sequence of events read through the buffer.
 		err = current_source->JEventSource::GetEvent(event_number, event);
+		event.SetSequence(0);
 
 		pthread_mutex_unlock(&event_buffer_mutex);
 		pthread_mutex_unlock(&sources_mutex);
@@ -595,6 +661,7 @@ jerror_t JApplication::NextEvent(JEvent &event)
 	/// C. the JEventLoop's quit flag is set
 	
 	JEvent *myevent = NULL;
+	uint64_t wait_start_ticks = 0;
 	do{
 		// Lock mutex and grab next event from buffer (if there's one)
 		pthread_mutex_lock(&event_buffer_mutex);
@@ -611,6 +678,7 @@ jerror_t JApplication::NextEvent(JEvent &event)
 		if((myevent==NULL) && event_buffer_filling){
 			// no event in buffer so sleep for a bit so CPU
 			// is not completely eaten up
+			if(wait_start_ticks==0) wait_start_ticks = JEventLoop::GetTicks();
 			usleep(100);
 		}
 	}while((myevent==NULL) && event_buffer_filling);
@@ -628,6 +696,15 @@ jerror_t JApplication::NextEvent(JEvent &event)
 		pthread_mutex_unlock(&event_buffer_mutex);
 	}
 	
+	// Record time spent waiting for an event. This is charged to the
+	// source of the event we eventually got (if any) as well as kept
+	// in a total for all sources.
+	if(wait_start_ticks!=0){
+		uint64_t wait_ticks = JEventLoop::GetTicks() - wait_start_ticks;
+		__sync_fetch_and_add(&nextevent_wait_ticks, wait_ticks);
+		if(myevent && myevent->GetJEventSource()) myevent->GetJEventSource()->AddWorkerWaitTicks(wait_ticks);
+	}
+
 	// If we managed to get an event, copy it to the given
 	// reference and delete the JEvent object
 	if(myevent){
@@ -644,6 +721,7 @@ jerror_t JApplication::NextEvent(JEvent &event)
 		event.SetEventNumber(myevent->GetEventNumber());
 		event.SetRef(myevent->GetRef());
 		event.SetID(myevent->GetID());
+		event.SetSequence(myevent->GetSequence());
 		event.SetStatus(myevent->GetStatus());
 		event.SetSequential(myevent->GetSequential());
 		NEvents++;
@@ -681,13 +759,19 @@ void JApplication::EventBufferThread(void)
 	uint64_t EVENTS_TO_SKIP=0;
 	uint64_t EVENTS_TO_KEEP=0;
 	uint64_t SKIP_TO_EVENT = 0;
-	uint32_t MAX_EVENTS_IN_BUFFER = 10;
 	jparms->SetDefaultParameter("EVENTS_TO_SKIP", EVENTS_TO_SKIP, "Number of events that will be read in WITHOUT calling event processor(s)");
 	jparms->SetDefaultParameter("EVENTS_TO_KEEP", EVENTS_TO_KEEP, "Maximum number of events for which event processors are called before ending the program");
 	jparms->SetDefaultParameter("SKIP_TO_EVENT", SKIP_TO_EVENT, "Skip to event with this event number before starting event processing.");
-	jparms->SetDefaultParameter("MAX_EVENTS_IN_BUFFER", MAX_EVENTS_IN_BUFFER, "Maximum number of events to keep in event buffer (set this to 1 or greater)");
 	
-	jerror_t err;
+	// With an event list, EVENTS_TO_KEEP counts listed events found
+	// and EVENTS_TO_SKIP and SKIP_TO_EVENT are not used.
+	if(eventlist_mode && (EVENTS_TO_SKIP!=0 || SKIP_TO_EVENT!=0)){
+		jout<<"EVENTS_TO_SKIP and SKIP_TO_EVENT are ignored when processing an event list"<<endl;
+		EVENTS_TO_SKIP = 0;
+		SKIP_TO_EVENT = 0;
+	}
+
+	jerror_t err = NOERROR;
 	JEvent *event = NULL;
 	do{
 		// Lock mutex
@@ -715,6 +799,7 @@ void JApplication::EventBufferThread(void)
 				// Put this event in the buffer so it can be pulled by a 
 				// thread and processed.
 				pthread_mutex_lock(&event_buffer_mutex);
+				event->SetSequence(++last_sequence);
 				event_buffer.push_front(event);
 				sequential_event_complete = false;
 				pthread_mutex_unlock(&event_buffer_mutex);
@@ -730,6 +815,7 @@ void JApplication::EventBufferThread(void)
 			}else{
 
 				// normal event processing
+				event->SetSequence(++last_sequence);
 				event_buffer.push_front(event);
 
 			}
@@ -738,15 +824,30 @@ void JApplication::EventBufferThread(void)
 		
 		// Wait until either a slot is open to read an event into,
 		// or we're told to stop.
-		while(event_buffer.size()>=MAX_EVENTS_IN_BUFFER){
-			pthread_cond_wait(&event_buffer_cond, &event_buffer_mutex);
-			if(stop_event_buffer)break;
+		if(event_buffer.size()>=max_events_in_buffer){
+			uint64_t wait_start_ticks = JEventLoop::GetTicks();
+			while(event_buffer.size()>=max_events_in_buffer){
+				pthread_cond_wait(&event_buffer_cond, &event_buffer_mutex);
+				if(stop_event_buffer)break;
+			}
+			if(current_source) current_source->AddBufferFullTicks(JEventLoop::GetTicks() - wait_start_ticks);
 		}
 		
 		// Unlock mutex
 		pthread_mutex_unlock(&event_buffer_mutex);
 		if(stop_event_buffer)break;
 
+		// If events are to be skipped, let the source pass over them
+		// without reading them in if it can.
+		if(NEvents_read<EVENTS_TO_SKIP || SKIP_TO_EVENT!=0) SkipInSource(EVENTS_TO_SKIP, SKIP_TO_EVENT);
+		if(eventlist_mode){
+			if(eventlist.empty()) break; // found them all
+			SkipToListedEvent();
+		}
+		if(process_pool && process_pool->IsWorker()){
+			if(!SkipToWorkerChunk()) break; // no more for this worker
+		}
+
 		// The only way to get to here is if there is room in the event
 		// buffer for another event. Read one in and add it to the buffer
 		event = new JEvent;
@@ -755,9 +856,17 @@ void JApplication::EventBufferThread(void)
 			delete event;
 			event = NULL;
 		}else{
+			// Events already completed by the run being resumed from
+			// (JANA:RESUME) that the source couldn't skip
+			if(current_source_Nevents <= resume_skip){
+				event->FreeEvent();
+				delete event;
+				event = NULL;
+			}
+
 			// If the user specified that some events should be skipped,
 			// then do that here, making sure to free the event first!
-			if(NEvents_read<=(uint64_t)EVENTS_TO_SKIP){
+			else if(NEvents_read<=(uint64_t)EVENTS_TO_SKIP){
 				event->FreeEvent();
 				delete event;
 				event = NULL;
@@ -765,7 +874,7 @@ void JApplication::EventBufferThread(void)
 			
 			// If user specified a specific event to skip to, then
 			// check if this is that event.
-			if(SKIP_TO_EVENT!=0){
+			else if(SKIP_TO_EVENT!=0){
 				if(event->GetEventNumber()==SKIP_TO_EVENT){
 					// This is the event they're looking for!
 					// Allow the event to be processed and set 
@@ -778,24 +887,56 @@ void JApplication::EventBufferThread(void)
 					event = NULL;
 				}
 			}
+
+			// If only listed events are processed, check if this is one.
+			// Sources without an event index get here for every event so
+			// only their headers are read for unlisted events.
+			else if(eventlist_mode){
+				auto it = eventlist.find(make_pair(event->GetRunNumber(), event->GetEventNumber()));
+				if(it != eventlist.end()){
+					eventlist.erase(it);
+					Neventlist_selected++;
+				}else{
+					event->FreeEvent();
+					delete event;
+					event = NULL;
+				}
+			}
+
+			// In a JANA:NPROCESSES worker, skip events given to other
+			// workers if the source couldn't skip them itself.
+			else if(process_pool && process_pool->IsWorker() && NEvents_read<=worker_chunk_first){
+				event->FreeEvent();
+				delete event;
+				event = NULL;
+			}
 		}
 		
 		// If the user specified a fixed number of events to keep, then 
 		// check that here and end the loop once we've read them all
 		// in.
-		if(EVENTS_TO_KEEP>0)
-			if(NEvents_read >= (uint64_t)(EVENTS_TO_SKIP+EVENTS_TO_KEEP))break;
+		if(EVENTS_TO_KEEP>0){
+			if(eventlist_mode){
+				if(Neventlist_selected >= EVENTS_TO_KEEP) break;
+			}else{
+				if(NEvents_read >= (uint64_t)(EVENTS_TO_SKIP+EVENTS_TO_KEEP))break;
+			}
+		}
 		
 	}while(err!=NO_MORE_EVENT_SOURCES);
 
 	// Check if we have a last event that was read in but not added to the 
 	// event buffer and add it now.
-	if(event!=NULL)
-	pthread_mutex_lock(&event_buffer_mutex);
-	event_buffer.push_front(event);
-	pthread_mutex_unlock(&event_buffer_mutex);
+	if(event!=NULL){
+		pthread_mutex_lock(&event_buffer_mutex);
+		event->SetSequence(++last_sequence);
+		event_buffer.push_front(event);
+		pthread_mutex_unlock(&event_buffer_mutex);
+	}
 	event=NULL;
 
+	if(eventlist_mode) PrintEventListSummary();
+
 	event_buffer_filling=false;
 }
 
@@ -828,7 +969,7 @@ jerror_t JApplication::ReadEvent(JEvent &event)
 	}
 	switch(err){
 		case NO_MORE_EVENTS_IN_SOURCE:
-			current_source = NULL;
+			SourceDone(current_source);
 			return ReadEvent(event);
 			break;
 		default:
@@ -837,10 +978,255 @@ jerror_t JApplication::ReadEvent(JEvent &event)
 
 	// Event counter
 	NEvents_read++;
+	current_source_Nevents++;
 
 	return NOERROR;
 }
 
+//---------------------------------
+// SkipInSource
+//---------------------------------
+void JApplication::SkipInSource(uint64_t events_to_skip, uint64_t skip_to_event)
+{
+	/// Skip events for the EVENTS_TO_SKIP and SKIP_TO_EVENT parameters
+	/// using the sources' SkipEvents and SeekToEvent methods. This
+	/// returns once the next event read should be processed, or as soon
+	/// as the current source can't skip. In that case, EventBufferThread
+	/// reads the events in and discards them as usual. A source that
+	/// seeks to skip_to_event successfully is left so that the next event
+	/// read is that event. EventBufferThread still checks it.
+	///
+	/// Skipped events are counted in NEvents_read just as if they had been
+	/// read so EVENTS_TO_KEEP works the same either way.
+
+	// Like ReadEvent, this is only called from the event buffer thread
+	while(NEvents_read<events_to_skip || skip_to_event!=0){
+
+		if(!current_source){
+			if(OpenNext() != NOERROR) return;
+			continue;
+		}
+
+		JEventSource *source = current_source;
+		bool seeking = NEvents_read>=events_to_skip;
+		uint64_t Nskipped = 0;
+		jerror_t err;
+		try{
+			if(!seeking){
+				err = source->SkipEvents(events_to_skip-NEvents_read, Nskipped);
+			}else{
+				err = source->SeekToEvent(skip_to_event, Nskipped);
+			}
+		}catch(...){
+			err = NO_MORE_EVENTS_IN_SOURCE;
+		}
+		if(err == RESOURCE_UNAVAILABLE) return;
+
+		NEvents_read += Nskipped;
+		current_source_Nevents += Nskipped;
+		source->SkippedEvents(Nskipped);
+		if(Nskipped>0) jout<<"Skipped "<<Nskipped<<" events in source \""<<source->GetSourceName()<<"\""<<endl;
+
+		switch(err){
+			case NOERROR:
+				if(seeking || skip_to_event==0) return;
+				break; // go on to seek to skip_to_event
+			case NO_MORE_EVENTS_IN_SOURCE:
+				SourceDone(source);
+				break;
+			default:
+				return;
+		}
+	}
+}
+
+//---------------------------------
+// SkipToWorkerChunk
+//---------------------------------
+bool JApplication::SkipToWorkerChunk(void)
+{
+	/// In a JANA:NPROCESSES worker, get another chunk of events from the
+	/// parent once done with the current one and have the source(s) pass
+	/// over the events before it (other workers process those). Returns
+	/// false if there are no more events for this worker. If the source
+	/// can't skip, EventBufferThread reads the events in and discards them.
+	if(NEvents_read >= worker_chunk_end){
+		if(!process_pool->NextChunk(NEvents, worker_chunk_first, worker_chunk_end)) return false;
+	}
+
+	// Like ReadEvent, this is only called from the event buffer thread
+	while(NEvents_read < worker_chunk_first){
+
+		if(!current_source){
+			if(OpenNext() != NOERROR) return true;
+			continue;
+		}
+
+		JEventSource *source = current_source;
+		uint64_t Nskipped = 0;
+		jerror_t err;
+		try{
+			err = source->SkipEvents(worker_chunk_first-NEvents_read, Nskipped);
+		}catch(...){
+			err = NO_MORE_EVENTS_IN_SOURCE;
+		}
+		NEvents_read += Nskipped;
+		current_source_Nevents += Nskipped;
+		source->SkippedEvents(Nskipped);
+
+		if(err == NO_MORE_EVENTS_IN_SOURCE){
+			SourceDone(source);
+			continue;
+		}
+		if(err != NOERROR) break; // source can't skip
+	}
+
+	return true;
+}
+
+//---------------------------------
+// SourceDone
+//---------------------------------
+void JApplication::SourceDone(JEventSource *source)
+{
+	/// Called from the event buffer thread when the current source has
+	/// no more events.
+	if(source->io_done_ticks==0) source->io_done_ticks = JEventLoop::GetTicks();
+	Nbytes_read_done += source->io_Nbytes;
+	if(source == current_source) current_source = NULL;
+}
+
+//---------------------------------
+// ReadEventList
+//---------------------------------
+jerror_t JApplication::ReadEventList(string filename)
+{
+	/// Read the list of events to process. Each line has a run number
+	/// and an event number separated by white space. Blank lines and
+	/// lines starting with "#" are ignored. The list does not need to be
+	/// sorted and may cover any number of sources. Only events in the
+	/// list are processed (each one once).
+	///
+	/// For sources with an event index (see JEventIndex), the positions
+	/// of the listed events in the source are looked up and the source
+	/// skips straight to each one. Other sources have each event read
+	/// in, but since GetObjects is never called for unlisted events,
+	/// normally only their headers are looked at.
+	eventlist_mode = true;
+	eventlist.clear();
+
+	ifstream ifs(filename.c_str());
+	if(!ifs.is_open()){
+		jerr<<"Unable to open event list \""<<filename<<"\"!"<<endl;
+		return RESOURCE_UNAVAILABLE;
+	}
+
+	string line;
+	unsigned int Nbad = 0;
+	while(getline(ifs, line)){
+		stringstream ss(line);
+		string first;
+		if(!(ss>>first) || first[0]=='#') continue;
+		int32_t run;
+		uint64_t event;
+		stringstream ss2(line);
+		if(ss2>>run>>event){
+			eventlist.insert(make_pair(run, event));
+		}else if(Nbad++ < 5){
+			jerr<<"Bad line in event list \""<<filename<<"\": "<<line<<endl;
+		}
+	}
+	Neventlist = eventlist.size();
+
+	jout<<"Processing "<<Neventlist<<" events listed in \""<<filename<<"\""<<endl;
+
+	return NOERROR;
+}
+
+//---------------------------------
+// SkipToListedEvent
+//---------------------------------
+void JApplication::SkipToListedEvent(void)
+{
+	/// If the current source has an event index, have it skip to the
+	/// next listed event in it. If there are none left in it, the rest
+	/// of it is skipped and the next source is tried. This returns
+	/// as soon as the current source either is at a listed event or has
+	/// no index. EventBufferThread checks each event read either way.
+
+	// Like ReadEvent, this is only called from the event buffer thread
+	while(true){
+		if(!current_source){
+			if(OpenNext() != NOERROR) return;
+			continue;
+		}
+
+		JEventSource *source = current_source;
+		const JEventIndex *index = source->GetEventIndex();
+		if(!index) return;
+
+		// Find where the listed events are in this source. The source's
+		// serial number is used rather than its address since a new
+		// source may be allocated where a deleted one was.
+		if(eventlist_source_serial != source->GetSerial()){
+			eventlist_source_serial = source->GetSerial();
+			eventlist_ordinals.clear();
+			eventlist_next = 0;
+			for(auto it=eventlist.begin(); it!=eventlist.end(); it++){
+				const JEventIndex::Entry *e = index->Find(it->first, it->second);
+				if(e) eventlist_ordinals.push_back(e->ordinal);
+			}
+			sort(eventlist_ordinals.begin(), eventlist_ordinals.end());
+		}
+
+		while(eventlist_next<eventlist_ordinals.size() && eventlist_ordinals[eventlist_next]<current_source_Nevents) eventlist_next++;
+		uint64_t Nevents = ~(uint64_t)0; // skip whole rest of source if no listed events left in it
+		if(eventlist_next<eventlist_ordinals.size()) Nevents = eventlist_ordinals[eventlist_next] - current_source_Nevents;
+		if(Nevents==0) return;
+
+		uint64_t Nskipped = 0;
+		jerror_t err;
+		try{
+			err = source->SkipEvents(Nevents, Nskipped);
+		}catch(...){
+			err = NO_MORE_EVENTS_IN_SOURCE;
+		}
+		current_source_Nevents += Nskipped;
+		source->SkippedEvents(Nskipped);
+		Neventlist_skipped += Nskipped;
+
+		if(err == NO_MORE_EVENTS_IN_SOURCE){
+			SourceDone(source);
+			continue;
+		}
+		return;
+	}
+}
+
+//---------------------------------
+// PrintEventListSummary
+//---------------------------------
+void JApplication::PrintEventListSummary(void)
+{
+	/// Print how many of the listed events were found and how much had
+	/// to be read to get them (the read amplification).
+	uint64_t Nbytes = Nbytes_read_done;
+	if(current_source) Nbytes += current_source->io_Nbytes;
+	double Nsel = Neventlist_selected>0 ? (double)Neventlist_selected:1.0;
+
+	jout<<"Event list: found "<<Neventlist_selected<<" of "<<Neventlist<<" listed events"<<endl;
+	jout<<"     events read: "<<NEvents_read<<" ("<<Neventlist_skipped<<" more skipped using event index)"<<endl;
+	jout<<"      bytes read: "<<Nbytes<<endl;
+	jout<<"read amplification: "<<fixed<<setprecision(1)<<(double)NEvents_read/Nsel<<" events, "<<Val2StringWithPrefix((double)Nbytes/Nsel)<<"B read per selected event"<<endl;
+	if(!eventlist.empty()){
+		jout<<"   not processed: "<<eventlist.size()<<" (run/event";
+		unsigned int n = 0;
+		for(auto it=eventlist.begin(); it!=eventlist.end() && n<5; it++, n++) jout<<" "<<it->first<<"/"<<it->second;
+		if(eventlist.size()>5) jout<<" ...";
+		jout<<")"<<endl;
+	}
+}
+
 //---------------------------------
 // GetEventBufferSize
 //---------------------------------
@@ -868,8 +1254,19 @@ jerror_t JApplication::AddProcessor(JEventProcessor *processor, bool delete_me)
 	/// The JEventProcessor object will be used by the system, but it will not
 	/// delete it. It is up to the caller to delete it after event processing has
 	/// stopped (i.e. Run() has returned).
+	///
+	/// JEventSink objects are always kept after all other processors so
+	/// that they see everything the processors did with the event (e.g.
+	/// set status bits to mark it for skimming) regardless of the order
+	/// in which plugins were attached.
 	processor->SetJApplication(this);
-	processors.push_back(processor);
+	vector<JEventProcessor*>::iterator pos = processors.end();
+	if(dynamic_cast<JEventSink*>(processor) == NULL){
+		for(pos=processors.begin(); pos!=processors.end(); pos++){
+			if(dynamic_cast<JEventSink*>(*pos) != NULL) break;
+		}
+	}
+	processors.insert(pos, processor);
 	processor->SetDeleteMe(delete_me);
 	
 	pthread_rwlock_t *lock = new pthread_rwlock_t;
@@ -907,16 +1304,21 @@ jerror_t JApplication::RemoveProcessor(JEventProcessor *processor)
 //---------------------------------
 // AddJEventLoop
 //---------------------------------
-jerror_t JApplication::AddJEventLoop(JEventLoop *loop)
+jerror_t JApplication::AddJEventLoop(JEventLoop *loop, bool add_thread)
 {
 	/// Add a JEventLoop object and generate a complete set of factories
 	/// for it by calling the GenerateFactories method for each of the
 	/// JFactoryGenerator objects registered via AddFactoryGenerator().
 	/// This is typically not called directly but rather, called by
 	/// the JEventLoop constructor.
+	///
+	/// If add_thread is false, no JThread is made for the JEventLoop so
+	/// it is not monitored or counted as a processing thread. This is
+	/// for JEventLoops that processing threads borrow to process events
+	/// in (see JOrderedOutput).
 
 	// Create a new JThread object to represent this JEventLoop
-	JThread *jthread = new JThread(loop);
+	JThread *jthread = add_thread ? new JThread(loop):NULL;
 
 	// Copy pointer to the jthread object into the JEventLoop
 	// so it can update the heartbeat
@@ -924,7 +1326,7 @@ jerror_t JApplication::AddJEventLoop(JEventLoop *loop)
 
 	// Lock application-level mutex so we can use/modify it's members
 	WriteLock("app");
-	threads.push_back(jthread);
+	if(jthread) threads.push_back(jthread);
 
 	// Loop over all factory generators, creating the factories
 	// for this JEventLoop.
@@ -949,6 +1351,9 @@ jerror_t JApplication::RemoveJEventLoop(JEventLoop *loop)
 
 	WriteLock("app");
 
+	// JEventLoops without a thread of their own are not in the list
+	if(print_factory_report && !loop->has_thread) RecordFactoryCalls(loop);
+
 	for(unsigned int i=0; i<threads.size(); i++){
 		JThread *jthread = threads[i];
 		if(jthread->loop == loop){
@@ -1131,6 +1536,28 @@ void JApplication::GetActiveEventSourceNames(vector<string> &classNames, vector<
 	pthread_mutex_unlock(&sources_mutex);
 }
 
+//---------------------------------
+// GetSourceIOStats
+//---------------------------------
+void JApplication::GetSourceIOStats(vector<JEventSourceIOStats> &stats)
+{
+	/// Get a snapshot of the I/O accounting of all active sources (ones
+	/// that have not yet been deleted). Like GetActiveEventSourceNames,
+	/// the most recently opened source is first. This may be called
+	/// at any time during event processing. 
+	pthread_mutex_lock(&sources_mutex);
+
+	for(unsigned int i=0; i<sources.size(); i++){
+		JEventSource *source = sources[sources.size()-i-1];
+		if(source==NULL)continue;
+
+		stats.push_back(JEventSourceIOStats());
+		source->GetIOStats(stats.back());
+	}
+
+	pthread_mutex_unlock(&sources_mutex);
+}
+
 //---------------------------------
 // GetJGeometry
 //---------------------------------
@@ -1503,6 +1930,21 @@ jerror_t JApplication::Init(void)
 	// the lists for all event loops
 	for(unsigned int i=0; i<threads.size(); i++)threads[i]->loop->RefreshProcessorListFromJApplication();
 
+	// Read the event list if only listed events are to be processed
+	string EVENTLIST = "";
+	jparms->SetDefaultParameter("JANA:EVENTLIST", EVENTLIST, "File with the run and event numbers of the events to process (one \"run event\" per line). Other events are skipped. (Same as --eventlist)");
+	if(EVENTLIST != ""){
+		if(ReadEventList(EVENTLIST) != NOERROR) Quit(EX_NOINPUT);
+	}
+
+	// Size of the event buffer. If SetMaxEventsInBuffer() was already
+	// called (e.g. from a plugin) the config. parameter is not used.
+	uint32_t MAX_EVENTS_IN_BUFFER = 10;
+	jparms->SetDefaultParameter("MAX_EVENTS_IN_BUFFER", MAX_EVENTS_IN_BUFFER, "Maximum number of events to keep in event buffer (set this to 1 or greater)");
+	pthread_mutex_lock(&event_buffer_mutex);
+	if(max_events_in_buffer == 0) max_events_in_buffer = MAX_EVENTS_IN_BUFFER>0 ? MAX_EVENTS_IN_BUFFER:1;
+	pthread_mutex_unlock(&event_buffer_mutex);
+
 	// Launch event buffer thread
 	if(create_event_buffer_thread)
 		pthread_create(&ebthr, NULL, LaunchEventBufferThread, this);
@@ -1540,6 +1982,46 @@ jerror_t JApplication::Run(JEventProcessor *proc, int Nthreads)
 		source_names.push_back("dummy_source");
 	}
 
+	// If events are to be processed by forked worker processes, the
+	// event buffer thread must not be started until after the fork
+	int NPROCESSES = 1;
+	jparms->SetDefaultParameter("JANA:NPROCESSES", NPROCESSES, "Number of worker processes to fork after initialization. Each runs NTHREADS processing threads on its share of the events. See JProcessPool for details.");
+	if(NPROCESSES>1){
+		if(init_called){
+			jerr<<"JANA:NPROCESSES can't be used when Init() was called before Run(). Running a single process."<<endl;
+			NPROCESSES = 1;
+		}else{
+			create_event_buffer_thread = false;
+		}
+	}
+
+	// Periodically record how far processing has gotten and/or start
+	// where an earlier run of the job left off (see JCheckpoint)
+	string CHECKPOINT = "";
+	string RESUME = "";
+	jparms->SetDefaultParameter("JANA:CHECKPOINT", CHECKPOINT, "File to periodically write the progress of each source to so the job can be resumed with JANA:RESUME if it dies. See JCheckpoint for details.");
+	jparms->SetDefaultParameter("JANA:CHECKPOINT_INTERVAL", checkpoint_interval, "Time (in seconds) between writes of the JANA:CHECKPOINT file.");
+	jparms->SetDefaultParameter("JANA:RESUME", RESUME, "Checkpoint file (see JANA:CHECKPOINT) written by an earlier run of this job. Sources and events it completed are skipped.");
+	if(NPROCESSES>1 && (!CHECKPOINT.empty() || !RESUME.empty())){
+		jerr<<"JANA:CHECKPOINT and JANA:RESUME are not supported with JANA:NPROCESSES. Ignoring them."<<endl;
+		CHECKPOINT = RESUME = "";
+	}
+	if(!RESUME.empty()){
+		resume_point = new JCheckpoint();
+		if(!resume_point->Read(RESUME)){
+			jerr<<"Unable to resume from checkpoint: "<<resume_point->GetError()<<endl;
+			SetExitCode(EX_NOINPUT);
+			return RESOURCE_UNAVAILABLE;
+		}
+		jout<<"Resuming from checkpoint \""<<RESUME<<"\": "<<resume_point->GetNfinished()<<" source(s) finished, "<<resume_point->GetNcompleted()<<" events completed"<<endl;
+	}
+	if(!CHECKPOINT.empty()){
+		checkpoint = new JCheckpoint();
+		checkpoint_file = CHECKPOINT;
+		last_checkpoint_ticks = JEventLoop::GetTicks();
+		jout<<"Writing checkpoint to \""<<CHECKPOINT<<"\" every "<<checkpoint_interval<<" s"<<endl;
+	}
+
 	// Call init() for JEventProcessors (factories don't exist yet)
 	Init();
 		
@@ -1555,9 +2037,21 @@ jerror_t JApplication::Run(JEventProcessor *proc, int Nthreads)
 	stringstream ss;
 	ss<<Nthreads;
 	string nthreads_str = ss.str();
-	jparms->SetDefaultParameter("NTHREADS", nthreads_str, "Number of event processing threads. If set to 'Ncores' then one thread will be launched for each core the system claims to have.");
+	jparms->SetDefaultParameter("NTHREADS", nthreads_str, "Number of event processing threads. If set to 'Ncores' then one thread will be launched for each core the system claims to have. If set to 'auto' then the number is chosen by measuring the rate as threads are added (see JANA:NTHREADS_AUTO_...).");
+	bool NTHREADS_AUTO_BUFFER = true;
 	if(nthreads_str=="Ncores"){
 		Nthreads = Ncores;
+	}else if(nthreads_str=="auto"){
+		unsigned int NTHREADS_AUTO_MAX = Ncores;
+		double NTHREADS_AUTO_INTERVAL = 10.0;
+		double NTHREADS_AUTO_EFFICIENCY = 0.5;
+		jparms->SetDefaultParameter("JANA:NTHREADS_AUTO_MAX", NTHREADS_AUTO_MAX, "Max. number of threads to try when NTHREADS=auto.");
+		jparms->SetDefaultParameter("JANA:NTHREADS_AUTO_INTERVAL", NTHREADS_AUTO_INTERVAL, "Time (in seconds) to measure the rate for each number of threads tried when NTHREADS=auto.");
+		jparms->SetDefaultParameter("JANA:NTHREADS_AUTO_EFFICIENCY", NTHREADS_AUTO_EFFICIENCY, "When NTHREADS=auto, threads are added only while each added thread gives at least this fraction of the rate per thread already being achieved (1.0 means perfect scaling).");
+		jparms->SetDefaultParameter("JANA:NTHREADS_AUTO_BUFFER", NTHREADS_AUTO_BUFFER, "When NTHREADS=auto, keep MAX_EVENTS_IN_BUFFER at least twice the number of threads being tried. Set to 0 to leave it alone.");
+		thread_tuner = new JThreadTuner(NTHREADS_AUTO_MAX, NTHREADS_AUTO_INTERVAL, NTHREADS_AUTO_EFFICIENCY);
+		Nthreads = thread_tuner->GetNthreads();
+		jout<<"NTHREADS=auto: will try up to "<<NTHREADS_AUTO_MAX<<" threads measuring the rate for "<<NTHREADS_AUTO_INTERVAL<<" s each"<<endl;
 	}else{
 		Nthreads = atoi(nthreads_str.c_str());
 	}
@@ -1567,6 +2061,93 @@ jerror_t JApplication::Run(JEventProcessor *proc, int Nthreads)
 	}
 	if(NTHREADS_COMMAND_LINE>0){
 		Nthreads = NTHREADS_COMMAND_LINE;
+		if(thread_tuner) delete thread_tuner;
+		thread_tuner = NULL;
+	}
+
+	// Fork worker processes (if requested). The parent only hands out
+	// events to them and merges their results. The workers carry on
+	// below as if they were a normal job.
+	if(NPROCESSES>1 && ForkWorkers(NPROCESSES)) return RunProcessPool();
+
+	// Cache of factory outputs. This must exist before the event loops
+	// are made since they get it when created.
+	string FACTORY_CACHE = "";
+	string FACTORY_CACHE_MODE = "rw";
+	jparms->SetDefaultParameter("JANA:FACTORY_CACHE", FACTORY_CACHE, "Directory to keep the outputs of factories flagged CACHEABLE in so later jobs with the same configuration can read them instead of remaking them. Empty to disable.");
+	jparms->SetDefaultParameter("JANA:FACTORY_CACHE_MODE", FACTORY_CACHE_MODE, "How JANA:FACTORY_CACHE is used: \"rw\" reads what is there and stores what is not, \"read\" never stores, \"write\" never reads (remakes and stores everything).");
+	if(FACTORY_CACHE!="" && !factory_cache){
+		JFactoryCache::mode_t mode;
+		if(JFactoryCache::ParseMode(FACTORY_CACHE_MODE, mode)){
+			factory_cache = new JFactoryCache(FACTORY_CACHE, mode);
+		}else{
+			jerr<<"Bad value for JANA:FACTORY_CACHE_MODE: \""<<FACTORY_CACHE_MODE<<"\" (should be rw, read or write). Factory cache disabled."<<endl;
+		}
+	}
+
+	// Create shared memory segment that statistics are published to
+	// so that programs like janatop can monitor us.
+	jparms->SetDefaultParameter("JANA:SOURCE_IO_STATS", print_source_io_stats, "Print a summary of the I/O accounting (time in GetEvent/GetObjects, bytes read, reader utilization, time workers waited for events) for each event source once it is finished.");
+
+	bool STATS_SHM = true;
+	jparms->SetDefaultParameter("JANA:STATS_SHM", STATS_SHM, "Publish processing statistics in POSIX shared memory (/dev/shm/jana_stats.<pid>) so they can be viewed with janatop. Set to 0 to disable.");
+	if(STATS_SHM && !stats_segment){
+		stats_segment = new JStatsSegment();
+		if(stats_segment->Create()){
+			jstats_t *stats = stats_segment->Get();
+			string command;
+			for(unsigned int i=0; i<args.size(); i++) command += (i==0 ? "":" ") + args[i];
+			stats_segment->SetString(stats->command, command, sizeof(stats->command));
+		}else{
+			jerr<<"Unable to create shared memory statistics segment: "<<stats_segment->GetError()<<endl;
+			delete stats_segment;
+			stats_segment = NULL;
+		}
+	}
+
+	// Start server for control socket used by janactl
+	string CONTROL_SOCKET = "auto";
+	jparms->SetDefaultParameter("JANA:CONTROL_SOCKET", CONTROL_SOCKET, "Path of Unix domain socket janactl can use to monitor and control this process. Set to \"auto\" to use /tmp/jana_ctl.<pid> or \"none\" to disable.");
+	if(CONTROL_SOCKET!="none" && CONTROL_SOCKET!="" && !control_server){
+		if(CONTROL_SOCKET == "auto") CONTROL_SOCKET = JControlServer::GetDefaultPath();
+		control_server = new JControlServer(this);
+		if(!control_server->Start(CONTROL_SOCKET)){
+			jerr<<"Unable to start control server: "<<control_server->GetError()<<endl;
+			delete control_server;
+			control_server = NULL;
+		}
+	}
+
+	// Process events in a pipeline of stages with their own threads
+	// instead of identical threads (if requested)
+	string PIPELINE;
+	jparms->SetDefaultParameter("JANA:PIPELINE", PIPELINE, "Comma separated list of name:Nthreads for the stages of a processing pipeline (e.g. decode:2,reconstruct:8,write:1). If set, NTHREADS is not used. See JPipeline for the related JANA:PIPELINE:... parameters.");
+	if(PIPELINE != "") return RunPipeline(PIPELINE);
+
+	// Call sinks in the order events were read (if requested)
+	bool ORDERED_OUTPUT = false;
+	uint64_t ORDERED_OUTPUT_WINDOW = 100;
+	double ORDERED_OUTPUT_STALL_WARN = 5.0;
+	jparms->SetDefaultParameter("JANA:ORDERED_OUTPUT", ORDERED_OUTPUT, "Set to 1 to have JEventSinks see events in the order they were read. The sinks are called from a dedicated thread once the processing thread has handed the event to it.");
+	if(ORDERED_OUTPUT){
+		jparms->SetDefaultParameter("JANA:ORDERED_OUTPUT_WINDOW", ORDERED_OUTPUT_WINDOW, "Max. number of events that may be processed ahead of the oldest one not yet written when JANA:ORDERED_OUTPUT is set. Processing threads wait only for this. Should be larger than NTHREADS.");
+		jparms->SetDefaultParameter("JANA:ORDERED_OUTPUT_STALL_WARN", ORDERED_OUTPUT_STALL_WARN, "Print a warning when ordered output has waited this many seconds for one event while later ones are ready (0 to disable).");
+		bool have_sink = false;
+		for(unsigned int i=0; i<processors.size(); i++) if(dynamic_cast<JEventSink*>(processors[i]) != NULL) have_sink = true;
+		if(!have_sink){
+			jout<<"JANA:ORDERED_OUTPUT is set but there are no JEventSinks. Ignoring."<<endl;
+		}else if(!ordered_output){
+			ordered_output = new JOrderedOutput(this, ORDERED_OUTPUT_WINDOW, ORDERED_OUTPUT_STALL_WARN);
+			if(!ordered_output->Start()){
+				jerr<<"Unable to start ordered output: "<<ordered_output->GetError()<<endl;
+				delete ordered_output;
+				ordered_output = NULL;
+				return RESOURCE_UNAVAILABLE;
+			}
+			if(ORDERED_OUTPUT_WINDOW < (uint64_t)Nthreads){
+				jout<<"JANA:ORDERED_OUTPUT_WINDOW ("<<ORDERED_OUTPUT_WINDOW<<") is smaller than NTHREADS ("<<Nthreads<<"). Not all threads can be kept busy."<<endl;
+			}
+		}
 	}
 
 	// Launch all threads
@@ -1707,6 +2288,20 @@ jerror_t JApplication::Run(JEventProcessor *proc, int Nthreads)
 				Nlost_events++; // keep track of events we lost.
 			}
 		}
+
+		// Update shared memory statistics while we still have the read lock
+		PublishStats();
+		
+		// If NTHREADS=auto, let the tuner pick the number of threads
+		if(thread_tuner && !thread_tuner->IsDone() && !SIGINT_RECEIVED && !quitting){
+			int N = thread_tuner->Update(NEvents, (double)JEventLoop::GetTicks()/1.0E9);
+			if(NTHREADS_AUTO_BUFFER && max_events_in_buffer < (uint32_t)(2*N)) SetMaxEventsInBuffer(2*N);
+			if(thread_tuner->IsDone()){
+				jout<<"NTHREADS=auto: measured "<<thread_tuner->GetSummary()<<endl;
+				jout<<"NTHREADS=auto: using "<<N<<" threads (MAX_EVENTS_IN_BUFFER="<<max_events_in_buffer<<")"<<endl;
+			}
+			if(N != this->Nthreads) SetNthreads(N);
+		}
 		
 		// If there are less threads running than specified and we are not trying to
 		// quit, then launch new threads to get us up to the specified amount.
@@ -1789,11 +2384,14 @@ jerror_t JApplication::Run(JEventProcessor *proc, int Nthreads)
 		// quit, then kill enough threads to get us down to the specified amount.
 		for(int i=this->Nthreads; i<(int)threads.size(); i++){
 			
-			// Make sure we're not trying to quit
-			if( !SIGINT_RECEIVED && !quitting){
+			// Make sure we're not trying to quit. The thread is told to
+			// quit after its current event so that event is not lost.
+			// (It stays in the list until it exits so only tell it once.)
+			JEventLoop *loop = threads[i]->loop;
+			if( !SIGINT_RECEIVED && !quitting && loop && !loop->GetQuit()){
 						
 				jerr<<" Removing thread (to reduce number of threads) ..."<<endl;
-				pthread_kill(threads[i]->thread_id, SIGHUP);
+				loop->Quit();
 			}
 		}
 
@@ -1817,17 +2415,8 @@ jerror_t JApplication::Run(JEventProcessor *proc, int Nthreads)
 		// Check for event sources that have finished so we can delete the JEventSource
 		// object. These can allocate lots of memory and if the user passes a lot
 		// of files on the command line, then the memory usage keeps piling up.
-		pthread_mutex_lock(&sources_mutex);
-		for(unsigned int i=0; i<sources.size(); i++){
-			if(sources[i]==NULL) continue;
-			if(sources[i]==current_source) continue;
-			if(sources[i]->IsFinished()){
-				delete sources[i];
-				sources[i] = NULL;
-				Nsources_deleted++;
-			}
-		}
-		pthread_mutex_unlock(&sources_mutex);
+		DeleteFinishedSources();
+		UpdateCheckpoint(false);
 
 		// When a JEventLoop runs out of events, it removes itself from
 		// the list before returning from the thread.
@@ -1874,11 +2463,380 @@ jerror_t JApplication::Run(JEventProcessor *proc, int Nthreads)
 	jout<<"Average rate: "<<Val2StringWithPrefix(rate_average)<<"Hz"<<endl;
 	if(Nrelaunch_threads > 0) jout<<" "<<Nrelaunch_threads<<" thread relaunches were required"<<endl;
 
+	// Stop accepting control commands
+	if(control_server){
+		delete control_server;
+		control_server = NULL;
+	}
+
+	// Publish final numbers and let monitors know we're done. If threads
+	// may still be running, the segment is only unlinked, not unmapped.
+	if(stats_segment){
+		if(SIGINT_RECEIVED<3){
+			PublishStats();
+			delete stats_segment;
+			stats_segment = NULL;
+		}else{
+			stats_segment->Remove();
+		}
+	}
+
+	// Workers don't return to the rest of the program
+	if(process_pool && process_pool->IsWorker()) process_pool->Exit(NEvents-Nlost_events, exit_code);
+
+	if(SIGINT_RECEIVED>=3)exit(-1);
+
+	return NOERROR;
+}
+
+//---------------------------------
+// RunPipeline
+//---------------------------------
+jerror_t JApplication::RunPipeline(const string &spec)
+{
+	/// Process events with a JPipeline instead of the usual identical
+	/// processing threads. This is called from Run() when the
+	/// JANA:PIPELINE config. parameter is set and does the rest of what
+	/// Run() would. Stalled threads are not detected or relaunched in
+	/// this mode. JANA:ORDERED_OUTPUT is handled by the JPipeline.
+
+	pipeline = new JPipeline(this);
+	bool ok = pipeline->Configure(spec);
+	if(ok){
+		jout<<"Launching pipeline ..."<<endl;
+		ok = pipeline->Start();
+	}
+	if(!ok){
+		jerr<<"Unable to run pipeline: "<<pipeline->GetError()<<endl;
+		delete pipeline; // waits for any threads that were started
+		pipeline = NULL;
+		SetExitCode(EX_CONFIG);
+		return RESOURCE_UNAVAILABLE;
+	}
+
+	// Do a sleepy loop while the pipeline does its work
+	struct timespec req, rem;
+	req.tv_nsec = (int)0.5E9; // set to 1/2 second
+	req.tv_sec = 0;
+	double sleep_time = (double)req.tv_sec + (1.0E-9)*(double)req.tv_nsec;
+	while(pipeline->IsRunning()){
+		rem.tv_sec = rem.tv_nsec = 0;
+		nanosleep(&req, &rem);
+		if(rem.tv_sec == 0 && rem.tv_nsec == 0){
+			int delta_NEvents = NEvents - last_NEvents;
+			avg_NEvents += delta_NEvents>0 ? delta_NEvents:0;
+			avg_time += sleep_time;
+			rate_instantaneous = (double)delta_NEvents/sleep_time;
+			rate_average = (double)avg_NEvents/avg_time;
+		}
+		last_NEvents = NEvents;
+
+		if(show_ticker && (!batch_mode))PrintRate();
+
+		if(SIGINT_RECEIVED)Quit();
+		if(SIGINT_RECEIVED>=3)break;
+
+		pthread_rwlock_rdlock(app_rw_lock);
+		PublishStats();
+		pthread_rwlock_unlock(app_rw_lock);
+
+		DeleteFinishedSources();
+		UpdateCheckpoint(false);
+	}
+
+	// Only be nice about exiting if the user wasn't insistent
+	if(SIGINT_RECEIVED<3){
+		// This deletes the pipeline's JEventLoops. It joins its own
+		// threads so there is nothing to join for them here.
+		pipeline->Stop();
+		for(unsigned int i=0; i<threads_to_be_joined.size(); i++) delete threads_to_be_joined[i];
+		threads_to_be_joined.clear();
+
+		// Call erun() and fini() methods and delete event sources
+		Fini();
+
+		// Event buffer thread
+		jout<<"Merging event reader thread ..."<<endl; jout.flush();
+		pthread_join(ebthr, NULL);
+	}else{
+		jout<<"Exiting hard due to catching 3 or more SIGINTs ..."<<endl;
+	}
+
+	jout<<" "<<NEvents<<" events processed ";
+	jout<<" ("<<NEvents_read<<" events read) ";
+	jout<<"Average rate: "<<Val2StringWithPrefix(rate_average)<<"Hz"<<endl;
+	pipeline->PrintStats();
+
+	// Stop accepting control commands
+	if(control_server){
+		delete control_server;
+		control_server = NULL;
+	}
+
+	// Publish final numbers and let monitors know we're done
+	if(stats_segment){
+		if(SIGINT_RECEIVED<3){
+			PublishStats();
+			delete stats_segment;
+			stats_segment = NULL;
+		}else{
+			stats_segment->Remove();
+		}
+	}
+
+	// Workers don't return to the rest of the program
+	if(process_pool && process_pool->IsWorker()) process_pool->Exit(NEvents-Nlost_events, exit_code);
+
 	if(SIGINT_RECEIVED>=3)exit(-1);
 
 	return NOERROR;
 }
 
+//---------------------------------
+// ForkWorkers
+//---------------------------------
+bool JApplication::ForkWorkers(int Nprocesses)
+{
+	/// Fork the JANA:NPROCESSES worker processes. This is called from
+	/// Run() after Init() but before any threads are started. The first
+	/// event to be processed is read here and used to warm up (see
+	/// JEventLoop::WarmUp) so what that loads is shared by the workers.
+	/// The sources are then closed again so each worker opens its own.
+	/// (A file opened before forking shares its offset with all of the
+	/// processes.) The warm-up event is read again and processed by the
+	/// worker that gets the first chunk.
+	///
+	/// Returns true in the parent. In the workers, or if the workers
+	/// could not be started, the event buffer thread is started and false
+	/// is returned so Run() carries on as usual.
+	bool ok = true;
+
+	// These need to see the whole event stream
+	uint64_t EVENTS_TO_SKIP=0;
+	uint64_t EVENTS_TO_KEEP=0;
+	uint64_t SKIP_TO_EVENT=0;
+	if(jparms->Exists("EVENTS_TO_SKIP")) jparms->GetParameter("EVENTS_TO_SKIP", EVENTS_TO_SKIP);
+	if(jparms->Exists("EVENTS_TO_KEEP")) jparms->GetParameter("EVENTS_TO_KEEP", EVENTS_TO_KEEP);
+	if(jparms->Exists("SKIP_TO_EVENT")) jparms->GetParameter("SKIP_TO_EVENT", SKIP_TO_EVENT);
+	if(SKIP_TO_EVENT!=0 || eventlist_mode){
+		jerr<<"SKIP_TO_EVENT and event lists are not supported with JANA:NPROCESSES. Running a single process."<<endl;
+		ok = false;
+	}
+
+	uint64_t NPROCESSES_CHUNK = 100;
+	string NPROCESSES_WARMUP = "all";
+	jparms->SetDefaultParameter("JANA:NPROCESSES_CHUNK", NPROCESSES_CHUNK, "Number of consecutive events given to a JANA:NPROCESSES worker at a time.");
+	jparms->SetDefaultParameter("JANA:NPROCESSES_WARMUP", NPROCESSES_WARMUP, "Factories to activate for the warm-up event before forking JANA:NPROCESSES workers: 'all' or 'autoactivate' (only the AUTOACTIVATE ones).");
+
+	// Read the first event to be processed
+	JEvent *warmup_event = NULL;
+	if(ok){
+		SkipInSource(EVENTS_TO_SKIP, 0);
+		while(NEvents_read < EVENTS_TO_SKIP){
+			JEvent event;
+			if(ReadEvent(event) != NOERROR) break;
+			event.FreeEvent();
+		}
+		warmup_event = new JEvent;
+		if(NEvents_read<EVENTS_TO_SKIP || ReadEvent(*warmup_event)!=NOERROR){
+			jerr<<"No events to process!"<<endl;
+			delete warmup_event;
+			warmup_event = NULL;
+			ok = false;
+		}
+	}
+
+	// Warm up using an event loop in this thread. It is gone before we
+	// fork so the thread does not need to be joined.
+	if(ok){
+		jout<<"Warming up with event "<<warmup_event->GetEventNumber()<<" (run "<<warmup_event->GetRunNumber()<<") before forking "<<Nprocesses<<" worker processes ..."<<endl;
+		JEventLoop *loop = new JEventLoop(this);
+		try{
+			loop->WarmUp(*warmup_event, NPROCESSES_WARMUP=="all");
+		}catch(exception &e){
+			jerr<<"Exception during warm-up: "<<e.what()<<endl;
+		}
+		delete loop;
+		WriteLock("app");
+		for(unsigned int i=0; i<threads_to_be_joined.size(); i++) delete threads_to_be_joined[i];
+		threads_to_be_joined.clear();
+		Unlock("app");
+
+		warmup_event->FreeEvent();
+		delete warmup_event;
+		warmup_event = NULL;
+		CloseSources();
+
+		process_pool = new JProcessPool(this, Nprocesses, NPROCESSES_CHUNK);
+		if(!process_pool->Fork()){
+			jerr<<"Unable to start worker processes: "<<process_pool->GetError()<<". Running a single process."<<endl;
+			delete process_pool;
+			process_pool = NULL;
+			ok = false;
+		}
+	}
+
+	// Parent. It processes no events so the runs the warm-up began for
+	// the processors are ended by the workers.
+	if(ok && !process_pool->IsWorker()){
+		for(unsigned int i=0; i<processors.size(); i++){
+			if(processors[i]->brun_was_called()) processors[i]->Set_erun_called();
+		}
+		uint64_t end = EVENTS_TO_KEEP>0 ? EVENTS_TO_SKIP+EVENTS_TO_KEEP:~(uint64_t)0;
+		process_pool->SetRange(EVENTS_TO_SKIP, end);
+		return true;
+	}
+
+	// Worker (or single process if the warm-up event could not be read)
+	if(process_pool){
+		int id = process_pool->GetWorkerID();
+		stringstream tag;
+		tag<<"JANA["<<id<<"] >>";
+		jout.SetTag(tag.str());
+		tag.str("");
+		tag<<"JANA["<<id<<"] ERROR>>";
+		jerr.SetTag(tag.str());
+		show_ticker = 0; // the parent shows the total rate
+		setpgid(0, 0);   // SIGINT from the terminal goes to the parent only. It passes it on.
+		worker_chunk_first = worker_chunk_end = NEvents_read;
+	}
+	if(warmup_event){
+		pthread_mutex_lock(&event_buffer_mutex);
+		warmup_event->SetSequence(++last_sequence);
+		event_buffer.push_front(warmup_event);
+		pthread_mutex_unlock(&event_buffer_mutex);
+	}
+
+	create_event_buffer_thread = true;
+	pthread_create(&ebthr, NULL, LaunchEventBufferThread, this);
+
+	return false;
+}
+
+//---------------------------------
+// RunProcessPool
+//---------------------------------
+jerror_t JApplication::RunProcessPool(void)
+{
+	/// Do the parent's part when events are processed by forked worker
+	/// processes (JANA:NPROCESSES): hand out events to the workers until
+	/// they have all exited, then call Fini() which merges their results.
+	/// SIGINTs are passed on to the workers.
+	jout<<"Worker processes started"<<endl;
+
+	uint64_t start_ticks = JEventLoop::GetTicks();
+	uint64_t last_ticks = start_ticks;
+	int Nsigint_sent = 0;
+	while(!process_pool->IsDone()){
+		process_pool->Serve(0.5);
+
+		// The workers report how many events they've processed each
+		// time they ask for more. Events read here means the same.
+		NEvents = NEvents_read = process_pool->GetNevents();
+		uint64_t now = JEventLoop::GetTicks();
+		if(now - last_ticks >= 500000000){
+			double dt = (double)(now - last_ticks)/1.0E9;
+			rate_instantaneous = (double)(NEvents - last_NEvents)/dt;
+			rate_average = (double)NEvents/((double)(now - start_ticks)/1.0E9);
+			last_NEvents = NEvents;
+			last_ticks = now;
+			if(show_ticker && (!batch_mode))PrintRate();
+		}
+
+		for(; Nsigint_sent<SIGINT_RECEIVED; Nsigint_sent++) process_pool->Signal(SIGINT);
+	}
+	NEvents = NEvents_read = process_pool->GetNevents();
+
+	// Call erun() and fini() methods (results from the workers have
+	// been merged by now) and delete event sources
+	Fini();
+
+	jout<<" "<<NEvents<<" events processed by worker processes ";
+	jout<<"Average rate: "<<Val2StringWithPrefix(rate_average)<<"Hz"<<endl;
+	process_pool->PrintStats();
+
+	int worker_exit_code = process_pool->GetExitCode();
+	if(worker_exit_code!=0 && exit_code==0) SetExitCode(worker_exit_code);
+
+	return NOERROR;
+}
+
+//---------------------------------
+// DeleteFinishedSources
+//---------------------------------
+void JApplication::DeleteFinishedSources(void)
+{
+	/// Delete event sources the event buffer thread is done with
+	pthread_mutex_lock(&sources_mutex);
+	for(unsigned int i=0; i<sources.size(); i++){
+		if(sources[i]==NULL) continue;
+		if(sources[i]==current_source) continue;
+		if(sources[i]->IsFinished()){
+			if(print_source_io_stats) sources[i]->PrintIOStats();
+			if(checkpoint){
+				uint64_t Ncompleted;
+				bool finished;
+				sources[i]->GetProgress(Ncompleted, finished);
+				checkpoint->Set(i, sources[i]->GetSourceName(), Ncompleted, finished);
+			}
+			delete sources[i];
+			sources[i] = NULL;
+			Nsources_deleted++;
+		}
+	}
+	pthread_mutex_unlock(&sources_mutex);
+}
+
+//---------------------------------
+// CloseSources
+//---------------------------------
+void JApplication::CloseSources(void)
+{
+	/// Delete all sources opened so far and start over so the next
+	/// event read is the first event of the first source again. This is
+	/// only used before any threads are started (see ForkWorkers).
+	/// Any events read from the sources must already have been freed.
+	pthread_mutex_lock(&sources_mutex);
+	for(unsigned int i=0; i<sources.size(); i++){
+		if(sources[i]) delete sources[i];
+	}
+	sources.clear();
+	current_source = NULL;
+	current_source_Nevents = 0;
+	resume_skip = 0;
+	Nsources_resumed = 0;
+	Nbytes_read_done = 0;
+	NEvents_read = 0;
+	pthread_mutex_unlock(&sources_mutex);
+}
+
+//---------------------------------
+// UpdateCheckpoint
+//---------------------------------
+void JApplication::UpdateCheckpoint(bool force)
+{
+	/// Record the progress of each source opened so far and write the
+	/// JANA:CHECKPOINT file if JANA:CHECKPOINT_INTERVAL has passed since
+	/// it was last written (or if force is true). Sources already deleted
+	/// were recorded when they were (see DeleteFinishedSources).
+	if(!checkpoint) return;
+	uint64_t now = JEventLoop::GetTicks();
+	if(!force && (double)(now - last_checkpoint_ticks)/1.0E9 < checkpoint_interval) return;
+	last_checkpoint_ticks = now;
+
+	pthread_mutex_lock(&sources_mutex);
+	for(unsigned int i=0; i<sources.size(); i++){
+		if(sources[i]==NULL) continue;
+		uint64_t Ncompleted;
+		bool finished;
+		sources[i]->GetProgress(Ncompleted, finished);
+		checkpoint->Set(i, sources[i]->GetSourceName(), Ncompleted, finished);
+	}
+	pthread_mutex_unlock(&sources_mutex);
+
+	if(!checkpoint->Write(checkpoint_file)) jerr<<"Unable to write checkpoint: "<<checkpoint->GetError()<<endl;
+}
+
 //---------------------------------
 // Fini
 //---------------------------------
@@ -1901,6 +2859,16 @@ jerror_t JApplication::Fini(bool check_fini_called_flag)
 
 	// Print final resource report
 	if(print_resource_report)PrintResourceReport();
+
+	// All processing threads are done so this writes what is left in
+	// the reorder buffer and then stops the writer
+	if(ordered_output){
+		ordered_output->Stop();
+		ordered_output->PrintStats();
+	}
+
+	// Hit rates of factory cache
+	if(factory_cache) factory_cache->PrintStats();
 	
 	// Make sure erun is called
 	for(unsigned int i=0;i<processors.size();i++){
@@ -1916,9 +2884,27 @@ jerror_t JApplication::Fini(bool check_fini_called_flag)
 		}
 	}
 
-	// Call fini Processors
+	// Call fini Processors. In JANA:NPROCESSES worker processes, results
+	// are sent to the parent instead where they are merged before fini is
+	// called (for processors that support it).
 	try{
-		for(unsigned int i=0;i<processors.size();i++)processors[i]->fini();
+		for(unsigned int i=0;i<processors.size();i++){
+			if(process_pool && process_pool->IsWorker()){
+				string results;
+				jerror_t err = processors[i]->worker_fini(results);
+				if(err == NOERROR){
+					process_pool->SendResults(i, results);
+					continue;
+				}
+				if(err != RESOURCE_UNAVAILABLE){
+					jerr<<"worker_fini for "<<processors[i]->className()<<" returned error "<<err<<endl;
+					continue;
+				}
+			}else if(process_pool){
+				if(!process_pool->GotResults(i)) continue; // fini was called in the workers
+			}
+			processors[i]->fini();
+		}
 	}catch(exception &e){
 		jerr<<endl;
 		_DBG_<<e.what()<<endl;
@@ -1948,15 +2934,23 @@ jerror_t JApplication::Fini(bool check_fini_called_flag)
 	factories_to_delete.clear();
 	pthread_mutex_unlock(&factories_to_delete_mutex);
 	
+	// Record final progress while the sources still exist
+	if(checkpoint){
+		UpdateCheckpoint(true);
+		jout<<"Wrote checkpoint \""<<checkpoint_file<<"\" ("<<checkpoint->GetNcompleted()<<" events completed)"<<endl;
+	}
+
 	// Delete all sources allowing them to close cleanly
 	pthread_mutex_lock(&sources_mutex);
 	for(unsigned int i=0;i<sources.size();i++){
 		if(sources[i]!=NULL){
+			if(print_source_io_stats) sources[i]->PrintIOStats();
 			delete sources[i];
 			Nsources_deleted++;
 		}
 	}
 	sources.clear();
+	current_source = NULL;
 	pthread_mutex_unlock(&sources_mutex);
 	
 	// Tell event buffer thread to quit (if he hasn't already)
@@ -2110,6 +3104,27 @@ jerror_t JApplication::OpenNext(void)
 	// search for that source and use it. Otherwise, throw an exception.
 	JEventSourceGenerator* gen = NULL;
 	const char *sname = source_names[sources.size()].c_str();
+
+	// If resuming from a checkpoint, sources it says are finished are
+	// not opened again. Their events still count toward EVENTS_TO_SKIP
+	// and EVENTS_TO_KEEP.
+	unsigned int isource = sources.size();
+	resume_skip = 0;
+	if(resume_point){
+		const JCheckpoint::Entry *e = resume_point->Find(isource, sname);
+		if(e && e->finished){
+			jout<<"Skipping source \""<<sname<<"\" (finished according to checkpoint)"<<endl;
+			if(checkpoint) checkpoint->Set(isource, sname, e->Ncompleted, true);
+			NEvents_read += e->Ncompleted;
+			current_source = NULL;
+			current_source_Nevents = 0;
+			sources.push_back(NULL);
+			Nsources_resumed++;
+			pthread_mutex_unlock(&sources_mutex);
+			return NOERROR;
+		}
+		if(e) resume_skip = e->Ncompleted;
+	}
 	if(gPARMS->Exists("EVENT_SOURCE_TYPE")){
 		string EVENT_SOURCE_TYPE="";
 		gPARMS->GetParameter("EVENT_SOURCE_TYPE", EVENT_SOURCE_TYPE);
@@ -2154,7 +3169,16 @@ jerror_t JApplication::OpenNext(void)
 		}
 	}
 	
+	// Let the user know if the source is compressed. Sources that read
+	// through JEventSource::OpenInputStream() will get a stream that
+	// decompresses it on separate threads.
+	JDecompressStreamBuf::format_t compression = JDecompressStreamBuf::GetFormat(sname);
+	if(compression != JDecompressStreamBuf::kNone){
+		jout<<"Source \""<<sname<<"\" is "<<JDecompressStreamBuf::GetFormatName(compression)<<" compressed"<<endl;
+	}
+
 	current_source = NULL;
+	current_source_Nevents = 0;
 	if(gen != NULL){
 		jout<<"Opening source \""<<sname<<"\" of type: "<<gen->Description()<<endl;
 		current_source = gen->MakeJEventSource(sname);
@@ -2169,7 +3193,7 @@ jerror_t JApplication::OpenNext(void)
 			for(unsigned int i=0; i<sources.size(); i++){
 				if(sources[i] == NULL)Nnull_sources++;
 			}
-			if( (Nnull_sources==sources.size()) && (Nsources_deleted==0) ){
+			if( (Nnull_sources==sources.size()) && (Nsources_deleted==0) && (Nsources_resumed==0) ){
 				jerr<<"   xxxxxxxxxxxx  NO VALID EVENT SOURCES GIVEN !!!   xxxxxxxxxxxx  "<<endl;
 				jerr<<endl;
 				Quit(EX_NOINPUT);
@@ -2179,6 +3203,24 @@ jerror_t JApplication::OpenNext(void)
 		}
 	}
 	
+	// Pass over the events a checkpoint says were completed. If the
+	// source can't skip them, EventBufferThread reads them in and
+	// discards them.
+	if(current_source && resume_skip>0){
+		uint64_t Nskipped = 0;
+		try{
+			current_source->SkipEvents(resume_skip, Nskipped);
+		}catch(...){
+			Nskipped = 0;
+		}
+		NEvents_read += Nskipped;
+		current_source_Nevents += Nskipped;
+		current_source->SkippedEvents(Nskipped);
+		jout<<"Resuming source \""<<sname<<"\" after "<<resume_skip<<" completed events";
+		if(Nskipped < resume_skip) jout<<" ("<<resume_skip-Nskipped<<" must be read to get there)";
+		jout<<endl;
+	}
+
 	// Add source to list (even if it's NULL!)
 	sources.push_back(current_source);
 	
@@ -2443,6 +3485,46 @@ jerror_t JApplication::AttachPlugins(void)
 	return RESOURCE_UNAVAILABLE;
 }
 
+//---------------------------------
+// PublishStats
+//---------------------------------
+void JApplication::PublishStats(void)
+{
+	/// Copy the global statistics into the shared memory segment. Per-thread
+	/// statistics are written by the threads themselves (see JEventLoop::PublishStats)
+	/// except for the heartbeat which is maintained here. This is called
+	/// periodically from Run() with the app read lock held.
+	if(!stats_segment) return;
+	jstats_t *stats = stats_segment->Get();
+	if(!stats) return;
+
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+
+	stats->NEvents = NEvents;
+	stats->NEvents_read = NEvents_read;
+	stats->Nlost_events = Nlost_events;
+	stats->rate_instantaneous = rate_instantaneous;
+	stats->rate_average = rate_average;
+	stats->Nthreads = Nthreads;
+	stats->Nthreads_running = threads.size();
+	stats->event_buffer_size = GetEventBufferSize();
+	stats->event_buffer_max = max_events_in_buffer;
+
+	for(unsigned int i=0; i<threads.size(); i++){
+		if(!threads[i]->loop) continue;
+		jstats_thread_t *slot = threads[i]->loop->GetStatsSlot();
+		if(slot) slot->heartbeat = threads[i]->heartbeat;
+	}
+
+	pthread_mutex_lock(&sources_mutex);
+	string source_name = current_source ? current_source->GetSourceName():"";
+	pthread_mutex_unlock(&sources_mutex);
+	stats_segment->SetString(stats->source_name, source_name, sizeof(stats->source_name));
+
+	stats->update_time = (double)tv.tv_sec + 1.0E-6*(double)tv.tv_usec;
+}
+
 //---------------------------------
 // RecordFactoryCalls
 //---------------------------------
@@ -2450,9 +3532,15 @@ jerror_t JApplication::RecordFactoryCalls(JEventLoop *loop)
 {
 	/// Record the number of calls to each of the factories owned by the
 	/// given JEventLoop. This is called (eventually) when the JEventLoop
-	/// is deleted so that it contains the final statistics.
-	map<string, unsigned int> calls;
-	map<string, unsigned int> gencalls;
+	/// is deleted so that it contains the final statistics. The counts
+	/// are added to those already recorded for the calling thread since
+	/// JEventLoops without a thread of their own (see JPipeline and
+	/// JOrderedOutput) are all deleted by the same thread.
+	///
+	/// This should only be called when the app mutex is already locked
+	/// so we don't need to do it here.
+	map<string, unsigned int> &calls = Nfactory_calls[pthread_self()];
+	map<string, unsigned int> &gencalls = Nfactory_gencalls[pthread_self()];
 	vector<JFactory_base*> factories = loop->GetFactories();
 	for(unsigned int i=0; i<factories.size(); i++){
 		JFactory_base *fac = factories[i];
@@ -2460,14 +3548,14 @@ jerror_t JApplication::RecordFactoryCalls(JEventLoop *loop)
 		string tag = fac->Tag();
 		string nametag = name;
 		if(tag != "")nametag += ":" + tag;
-		calls[nametag] = fac->GetNcalls();
-		gencalls[nametag] = fac->GetNgencalls();
+		calls[nametag] += fac->GetNcalls();
+		gencalls[nametag] += fac->GetNgencalls();
+
+		const map<string, uint64_t> &counts = fac->GetPerfCounts();
+		if(counts.empty()) continue;
+		map<string, uint64_t> &perf_counts = Nfactory_perf_counts[pthread_self()][nametag];
+		for(map<string, uint64_t>::const_iterator it=counts.begin(); it!=counts.end(); it++) perf_counts[it->first] += it->second;
 	}
-	
-	// This should only be called when the app mutex is already locked
-	// so we don't need to do it here.
-	Nfactory_calls[pthread_self()] = calls;
-	Nfactory_gencalls[pthread_self()] = gencalls;
 
 	return NOERROR;
 }
@@ -2567,6 +3655,74 @@ jerror_t JApplication::PrintFactoryReport(void)
 		cout<<line<<endl;
 	}
 	cout<<endl;
+	
+	if(!Nfactory_perf_counts.empty()) PrintFactoryPerfReport();
+
+	return NOERROR;
+}
+
+//---------------------------------
+// PrintFactoryPerfReport
+//---------------------------------
+jerror_t JApplication::PrintFactoryPerfReport(void)
+{
+	/// Print the performance counters recorded for each factory
+	/// (summed over all threads). These are only available if
+	/// something (e.g. the janapfm plugin) installed a JFactoryMonitor
+	/// to fill them. If both "cycles" and "instructions" were
+	/// recorded then the instructions per cycle is also printed.
+
+	// Sum over threads
+	map<string, map<string, uint64_t> > totals;
+	set<string> counter_names;
+	map<pthread_t, map<string, map<string, uint64_t> > >::iterator iter;
+	for(iter=Nfactory_perf_counts.begin(); iter!=Nfactory_perf_counts.end(); iter++){
+		map<string, map<string, uint64_t> >::iterator fiter;
+		for(fiter=iter->second.begin(); fiter!=iter->second.end(); fiter++){
+			map<string, uint64_t>::iterator citer;
+			for(citer=fiter->second.begin(); citer!=fiter->second.end(); citer++){
+				totals[fiter->first][citer->first] += citer->second;
+				counter_names.insert(citer->first);
+			}
+		}
+	}
+	bool print_ipc = counter_names.count("cycles") && counter_names.count("instructions");
+
+	cout<<ansi_bold;
+	cout<<"Factory Performance Counters:"<<endl;
+	cout<<"============================="<<endl;
+	cout<<ansi_normal;
+	cout<<"Counts accumulated during calls to each factory's evnt method"<<endl;
+	cout<<"(excluding time spent in other factories it called) summed over"<<endl;
+	cout<<"all threads."<<endl;
+	cout<<endl;
+
+	unsigned int colwidth = 16;
+	unsigned int namewidth = 10;
+	map<string, map<string, uint64_t> >::iterator fiter;
+	for(fiter=totals.begin(); fiter!=totals.end(); fiter++){
+		if(fiter->first.size()+3 > namewidth) namewidth = fiter->first.size()+3;
+	}
+
+	cout<<setw(namewidth)<<left<<"Factory:"<<right;
+	set<string>::iterator niter;
+	for(niter=counter_names.begin(); niter!=counter_names.end(); niter++) cout<<setw(colwidth)<<*niter;
+	if(print_ipc) cout<<setw(8)<<"IPC";
+	cout<<endl;
+	cout<<string(namewidth + colwidth*counter_names.size() + (print_ipc ? 8:0), '-')<<endl;
+
+	for(fiter=totals.begin(); fiter!=totals.end(); fiter++){
+		map<string, uint64_t> &counts = fiter->second;
+		cout<<setw(namewidth)<<left<<fiter->first<<right;
+		for(niter=counter_names.begin(); niter!=counter_names.end(); niter++) cout<<setw(colwidth)<<counts[*niter];
+		if(print_ipc){
+			double cycles = (double)counts["cycles"];
+			double ipc = cycles>0.0 ? (double)counts["instructions"]/cycles:0.0;
+			cout<<setw(8)<<fixed<<setprecision(2)<<ipc;
+		}
+		cout<<endl;
+	}
+	cout<<endl;
 
 	return NOERROR;
 }
@@ -2744,6 +3900,23 @@ void JApplication::SetNthreads(int new_Nthreads)
 	jout<<"Setting number of processing threads to: "<<this->Nthreads<<endl;
 }
 
+//---------------------------------
+// SetMaxEventsInBuffer
+//---------------------------------
+void JApplication::SetMaxEventsInBuffer(uint32_t new_max)
+{
+	/// Set the maximum number of events the event buffer thread will
+	/// read ahead of the processing threads. This overrides the
+	/// MAX_EVENTS_IN_BUFFER config. parameter and takes effect
+	/// immediately.
+	if(new_max < 1) new_max = 1;
+
+	pthread_mutex_lock(&event_buffer_mutex);
+	max_events_in_buffer = new_max;
+	pthread_cond_signal(&event_buffer_cond); // in case it was waiting for room
+	pthread_mutex_unlock(&event_buffer_mutex);
+}
+
 //---------------------------------
 // RegisterHUPMutex
 //---------------------------------
@@ -12,6 +12,7 @@
 #include <vector>
 #include <string>
 #include <list>
+#include <set>
 #include <utility>
 #include <sstream>
 #include <stdint.h>
@@ -28,6 +29,8 @@ using std::stringstream;
 #include <JANA/JCalibrationGenerator.h>
 #include <JANA/JEventLoop.h>
 #include <JANA/JResourceManager.h>
+#include <JANA/JStatsSegment.h>
+#include <JANA/JControlServer.h>
 
 // The following is here just so we can use ROOT's THtml class to generate documentation.
 #include "cint.h"
@@ -41,6 +44,7 @@ namespace jana{
 
 class JEventProcessor;
 class JEventSource;
+class JEventSourceIOStats;
 class JEvent;
 class JGeometry;
 class JParameterManager;
@@ -51,6 +55,12 @@ class JFactoryGenerator;
 class JCalibrationGenerator;
 class JEventLoop;
 class JFactory_base;
+class JOrderedOutput;
+class JPipeline;
+class JThreadTuner;
+class JProcessPool;
+class JCheckpoint;
+class JFactoryCache;
 
 typedef void CallBack_t(void *arg);
 
@@ -69,9 +79,13 @@ class JApplication{
 		              virtual jerror_t NextEvent(JEvent &event); ///< Get the next event from the event buffer
 		              virtual jerror_t NextEvent(uint64_t event_number, JEvent &event); ///< Get the specified event number from the current event source
 		              virtual jerror_t ReadEvent(JEvent &event); ///< Get the next event from the source.
+		                          void SkipInSource(uint64_t events_to_skip, uint64_t skip_to_event); ///< Have the source(s) pass over unwanted events
+		                      jerror_t ReadEventList(string filename); ///< Read list of (run, event) to process (--eventlist)
+		                          void SkipToListedEvent(void); ///< Have the source skip to the next event in the event list
+		                          bool SkipToWorkerChunk(void); ///< Have the source skip to the next event given to this worker process (JANA:NPROCESSES)
 		                      jerror_t AddProcessor(JEventProcessor *processor, bool delete_me=false); ///< Add a JEventProcessor.
 		                      jerror_t RemoveProcessor(JEventProcessor *processor); ///< Remove a JEventProcessor
-		                      jerror_t AddJEventLoop(JEventLoop *loop); ///< Add a JEventLoop
+		                      jerror_t AddJEventLoop(JEventLoop *loop, bool add_thread=true); ///< Add a JEventLoop
 		                      jerror_t RemoveJEventLoop(JEventLoop *loop); ///< Remove a JEventLoop
 		                      jerror_t AddEventSource(string src_name, bool add_to_front=false); ///< Add an event source (e.g. filename) to list to be processed
 		                      jerror_t AddEventSourceGenerator(JEventSourceGenerator*); ///< Add a JEventSourceGenerator
@@ -86,6 +100,7 @@ class JApplication{
                  vector<JEventSource*> GetJEventSources(void); ///< Get pointers to all JEventSource objects.
                   template<class T> T* GetFirstJEventSource(void); ///< Return pointer to first source of specified type or NULL if none exist. Call like this: ptr = GetFirstJEventSource<JEventSourceMyType>();
 		                          void GetActiveEventSourceNames(vector<string> &classNames, vector<string> &sourceNames);
+		                          void GetSourceIOStats(vector<JEventSourceIOStats> &stats); ///< Get I/O accounting for all active (not yet deleted) sources
 		                 JEventSource* GetCurrentEventSource(void){return current_source;}
 		    vector<JFactoryGenerator*> GetFactoryGenerators(void){return factoryGenerators;} ///< Get the current list of JFactoryGenerators
 		vector<JCalibrationGenerator*> GetCalibrationGenerators(void){return calibrationGenerators;} ///< Get the current list of JCalibrationGenerators
@@ -109,7 +124,9 @@ class JApplication{
 		                          bool GetQuittingStatus(void){return quitting;} ///< return true if Quit has already been called
 		                           int GetNcores(void){return Ncores;}
 					   inline uint64_t GetNEvents(void){return NEvents;} ///< Returns the number of events processed so far.
+					   inline uint64_t GetNEventsRead(void){return NEvents_read;} ///< Returns the number of events read from the source(s) so far.
 				       inline uint64_t GetNLostEvents(void){return Nlost_events;} ///< Returns the number of events processed so far.
+		                 inline double GetNextEventWaitTime(void){return 1.0E-9*(double)nextevent_wait_ticks;} ///< Total time (s) processing threads have waited in NextEvent for an event (all sources, all threads)
 		                  inline float GetRate(void){return rate_instantaneous;} ///< Get the average event processing rate
 		                  inline float GetIntegratedRate(void){return rate_average;} ///< Get the current event processing rate
 		                          void GetInstantaneousThreadRates(map<pthread_t,double> &rates_by_thread);
@@ -121,10 +138,18 @@ class JApplication{
 		                          void AddAutoActivatedFactory(string name, string tag){auto_activated_factories.push_back(pair<string,string>(name,tag));}
 		                  virtual void PrintRate(); ///< Print the current rate to stdout
 		                          void SetShowTicker(int what){show_ticker = what;} ///< Turn auto-printing of rate to screen on or off.
+		                          void SetPrintFactoryReport(bool what){print_factory_report = what;} ///< Turn printing of factory report at end of job on or off (same as --factoryreport)
+		                 JStatsSegment* GetStatsSegment(void){return stats_segment;} ///< Get shared memory statistics segment (NULL if not enabled or not running)
+		                 JFactoryCache* GetFactoryCache(void){return factory_cache;} ///< Get cache of factory outputs (NULL if JANA:FACTORY_CACHE not set)
+		                JControlServer* GetControlServer(void){return control_server;} ///< Get control socket server (NULL if not enabled or not running)
+		                JOrderedOutput* GetOrderedOutput(void){return ordered_output;} ///< Get object calling sinks in order events were read (NULL if not enabled)
+		                     JPipeline* GetPipeline(void){return pipeline;} ///< Get pipeline of processing stages (NULL if not running in JANA:PIPELINE mode)
+		                  JProcessPool* GetProcessPool(void){return process_pool;} ///< Get worker processes (NULL if JANA:NPROCESSES not used). Use GetProcessPool()->GetWorkerID() to tell which worker this is.
 		                          void SignalThreads(int signo); ///< Send a system signal to all processing threads.
 		                          bool KillThread(pthread_t thr, bool verbose=true); ///< Kill a specific thread. Returns true if thread is found and kill signal sent, false otherwise.
 		                  unsigned int GetNthreads(void){return threads.size();} ///< Get the current number of processing threads
 		                          void SetNthreads(int new_Nthreads); ///< Set the number of processing threads to use (can be called during event processing)
+		                          void SetMaxEventsInBuffer(uint32_t new_max); ///< Set the maximum number of events in the event buffer (can be called during event processing)
 		                   inline void Lock(void){WriteLock("app");} ///< Deprecated. Use ReadLock("app") or WriteLock("app") instead. (This just calls WriteLock("app").)
 		                   inline void SetSequentialEventComplete(void){sequential_event_complete=true;} ///< Used by JEventLoop::Loop to signal the completion of a barrier event
 		      inline pthread_rwlock_t* CreateLock(const string &name, bool throw_exception_if_exists=true);
@@ -163,7 +188,9 @@ class JApplication{
                            jerror_t AttachPlugins(void);
                            jerror_t RecordFactoryCalls(JEventLoop *loop);
                            jerror_t PrintFactoryReport(void);
+                           jerror_t PrintFactoryPerfReport(void);
                            jerror_t PrintResourceReport(void);
+                               void PublishStats(void);
 
 		bool init_called;
 		bool fini_called;
@@ -178,6 +205,7 @@ class JApplication{
 		pthread_mutex_t factories_to_delete_mutex;
 		map<pthread_t, map<string, unsigned int> > Nfactory_calls;
 		map<pthread_t, map<string, unsigned int> > Nfactory_gencalls;
+		map<pthread_t, map<string, map<string, uint64_t> > > Nfactory_perf_counts; // key1=thread key2=factory key3=counter
 		vector<pair<string,string> > auto_activated_factories;
 		
 		JParameterManager *jparms;
@@ -215,6 +243,24 @@ class JApplication{
 		uint64_t NEvents_read;		///< Number of events read from source
 		uint64_t NEvents;			///< Number of events processed
 		uint64_t Nlost_events;		///< Number of events lost (e.g. due to stalled threads)
+		uint64_t nextevent_wait_ticks;	///< Total time (ns) processing threads waited in NextEvent
+		bool print_source_io_stats;	///< Print I/O summary as each source is finished (JANA:SOURCE_IO_STATS)
+		uint64_t current_source_Nevents;	///< Number of events read or skipped from current_source
+		uint64_t Nbytes_read_done;	///< Bytes read from sources the event buffer thread is done with
+
+		// Event list processing (--eventlist)
+		bool eventlist_mode;
+		std::set<pair<int32_t,uint64_t> > eventlist;	///< (run, event) of listed events not yet found
+		uint64_t Neventlist;			///< Number of events in the list
+		uint64_t Neventlist_selected;	///< Number of listed events read so far
+		uint64_t Neventlist_skipped;	///< Number of events skipped using source's event index
+		uint64_t eventlist_source_serial;	///< JEventSource::GetSerial() of source eventlist_ordinals was made for (0 for none)
+		vector<uint64_t> eventlist_ordinals;	///< Positions of listed events in that source (from its index)
+		unsigned int eventlist_next;
+
+		void SourceDone(JEventSource *source);
+		void PrintEventListSummary(void);
+
 		uint64_t last_NEvents;		///< Number of events processed the last time we calculated rates
 		uint64_t avg_NEvents;
 		double avg_time;
@@ -235,6 +281,31 @@ class JApplication{
 		bool override_runnumber;
 		int  user_supplied_runnumber;
 		bool sequential_event_complete;  ///< Used to flag that processing of a barrier event is complete
+		JStatsSegment *stats_segment;    ///< Shared memory block statistics are published to for janatop
+		JFactoryCache *factory_cache;    ///< On-disk cache of outputs of CACHEABLE factories (see JFactoryCache)
+		uint32_t max_events_in_buffer;
+		JControlServer *control_server;  ///< Unix domain socket server used by janactl
+		JOrderedOutput *ordered_output;  ///< Calls sinks in the order events were read (JANA:ORDERED_OUTPUT)
+		uint64_t last_sequence;          ///< Sequence number given to last event put in event buffer
+		JPipeline *pipeline;             ///< Stages events are processed in (JANA:PIPELINE)
+		JThreadTuner *thread_tuner;      ///< Chooses number of threads when NTHREADS=auto
+		JProcessPool *process_pool;      ///< Worker processes events are processed in (JANA:NPROCESSES)
+		uint64_t worker_chunk_first;     ///< First event (counting from start of input) of chunk given to this worker
+		uint64_t worker_chunk_end;       ///< One past last event of chunk given to this worker
+		JCheckpoint *checkpoint;         ///< Progress of sources written to JANA:CHECKPOINT
+		string checkpoint_file;
+		double checkpoint_interval;
+		uint64_t last_checkpoint_ticks;
+		JCheckpoint *resume_point;       ///< Progress of an earlier run read from JANA:RESUME
+		unsigned int Nsources_resumed;   ///< Sources not opened since resume_point says they are finished
+		uint64_t resume_skip;            ///< Events at start of current_source completed according to resume_point
+
+		jerror_t RunPipeline(const string &spec);
+		bool ForkWorkers(int Nprocesses);
+		jerror_t RunProcessPool(void);
+		void DeleteFinishedSources(void);
+		void CloseSources(void);
+		void UpdateCheckpoint(bool force);
 
 		int exit_code;
 
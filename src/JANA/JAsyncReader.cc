@@ -0,0 +1,514 @@
+// $Id$
+//
+//    File: JAsyncReader.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+#endif
+
+#include <iostream>
+using namespace std;
+
+#include "JAsyncReader.h"
+#include "JStreamLog.h"
+using namespace jana;
+
+// Thread entry point for kThreads method
+static void* JAsyncReader_WorkerThread(void *arg)
+{
+	((JAsyncReader*)arg)->WorkerLoop();
+	return NULL;
+}
+
+//---------------------------------
+// JAsyncReader    (Constructor)
+//---------------------------------
+JAsyncReader::JAsyncReader(const string &filename, uint32_t block_size, uint32_t queue_depth, method_t method)
+{
+	this->filename = filename;
+	this->block_size = block_size>0 ? block_size:1048576;
+	this->queue_depth = queue_depth;
+	this->method = kSync;
+	file_size = 0;
+	next_offset = 0;
+	stop_threads = false;
+	ring_fd = -1;
+	sq_ptr = cq_ptr = sqes = cqes = NULL;
+	sq_ring_size = cq_ring_size = sqes_size = 0;
+	pthread_mutex_init(&blocks_mutex, NULL);
+	pthread_mutex_init(&queue_mutex, NULL);
+	pthread_cond_init(&queue_cond, NULL);
+	pthread_cond_init(&ready_cond, NULL);
+
+	fd = open(filename.c_str(), O_RDONLY);
+	if(fd<0){
+		error = strerror(errno);
+		return;
+	}
+	struct stat st;
+	if(fstat(fd, &st)!=0){
+		error = strerror(errno);
+		close(fd);
+		fd = -1;
+		return;
+	}
+	file_size = st.st_size;
+
+	// We read strictly sequentially so let the kernel know that
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	// Pick the method. If the one asked for is not available, fall
+	// back to the next one down the list.
+	if(queue_depth==0) method = kSync;
+	if(method==kAuto || method==kIOUring){
+		if(SetupIOUring()){
+			this->method = kIOUring;
+			return;
+		}
+		if(method==kIOUring) jout<<"JAsyncReader: io_uring not available ("<<error<<"). Using threads instead."<<endl;
+		error = "";
+		method = kThreads;
+	}
+	if(method==kThreads){
+		if(StartThreads()){
+			this->method = kThreads;
+			return;
+		}
+		jout<<"JAsyncReader: unable to start reader threads. Reading synchronously."<<endl;
+	}
+	this->method = kSync;
+}
+
+//---------------------------------
+// ~JAsyncReader    (Destructor)
+//---------------------------------
+JAsyncReader::~JAsyncReader()
+{
+	// Reads still in flight must complete before their buffers are freed
+	for(unsigned int i=0; i<in_flight.size(); i++) Wait(in_flight[i]);
+	in_flight.clear();
+
+	StopThreads();
+	CloseIOUring();
+
+	for(unsigned int i=0; i<all_blocks.size(); i++){
+		free(all_blocks[i]->data);
+		delete all_blocks[i];
+	}
+	if(fd>=0) close(fd);
+
+	pthread_mutex_destroy(&blocks_mutex);
+	pthread_mutex_destroy(&queue_mutex);
+	pthread_cond_destroy(&queue_cond);
+	pthread_cond_destroy(&ready_cond);
+}
+
+//---------------------------------
+// Next
+//---------------------------------
+JAsyncReader::Block* JAsyncReader::Next(void)
+{
+	/// Return the next block of the file, waiting for its read to
+	/// complete if needed. Returns NULL once the end of the file has
+	/// been reached or if a read failed (in which case GetError()
+	/// returns a non-empty string). The caller must pass the block
+	/// to Release() once it is done with it.
+	if(fd<0) return NULL;
+
+	FillQueue(queue_depth>0 ? queue_depth:1);
+	if(in_flight.empty()) return NULL;
+
+	Block *block = in_flight.front();
+	in_flight.pop_front();
+	Wait(block);
+
+	// Top up the queue again now that there is room so the kernel/threads
+	// have something to do while the caller works on this block.
+	FillQueue(queue_depth);
+
+	if(block->err!=0 || block->size==0){
+		if(block->err!=0) error = strerror(block->err);
+		Release(block);
+		return NULL;
+	}
+
+	return block;
+}
+
+//---------------------------------
+// FillQueue
+//---------------------------------
+void JAsyncReader::FillQueue(uint32_t Nmax)
+{
+	/// Submit reads of the next blocks in the file until Nmax are in flight
+	while(in_flight.size()<Nmax && next_offset<file_size){
+		Block *block = GetFreeBlock();
+		block->offset = next_offset;
+		block->size = (file_size-next_offset)<block_size ? (uint32_t)(file_size-next_offset):block_size;
+		next_offset += block->size;
+		Submit(block);
+		in_flight.push_back(block);
+	}
+}
+
+//---------------------------------
+// Release
+//---------------------------------
+void JAsyncReader::Release(Block *block)
+{
+	/// Return a block obtained from Next() so its buffer can be
+	/// reused. This may be called from any thread.
+	if(!block) return;
+	pthread_mutex_lock(&blocks_mutex);
+	free_blocks.push_back(block);
+	pthread_mutex_unlock(&blocks_mutex);
+}
+
+//---------------------------------
+// GetMethodName
+//---------------------------------
+const char* JAsyncReader::GetMethodName(method_t method)
+{
+	switch(method){
+		case kAuto:    return "auto";
+		case kIOUring: return "io_uring";
+		case kThreads: return "threads";
+		case kSync:    return "sync";
+	}
+	return "unknown";
+}
+
+//---------------------------------
+// GetMethodByName
+//---------------------------------
+JAsyncReader::method_t JAsyncReader::GetMethodByName(const string &name)
+{
+	if(name=="io_uring") return kIOUring;
+	if(name=="threads") return kThreads;
+	if(name=="sync") return kSync;
+	return kAuto;
+}
+
+//---------------------------------
+// GetFreeBlock
+//---------------------------------
+JAsyncReader::Block* JAsyncReader::GetFreeBlock(void)
+{
+	/// Get a block from the free pool, allocating a new one if the
+	/// pool is empty. The number of blocks is therefore the queue
+	/// depth plus however many the caller holds on to at once.
+	Block *block = NULL;
+	pthread_mutex_lock(&blocks_mutex);
+	if(!free_blocks.empty()){
+		block = free_blocks.back();
+		free_blocks.pop_back();
+	}
+	pthread_mutex_unlock(&blocks_mutex);
+
+	if(!block){
+		block = new Block;
+		// Page align the buffer so it could be used with O_DIRECT
+		void *ptr = NULL;
+		if(posix_memalign(&ptr, 4096, block_size)!=0) ptr = malloc(block_size);
+		block->data = (char*)ptr;
+		all_blocks.push_back(block);
+	}
+
+	block->offset = 0;
+	block->size = 0;
+	block->err = 0;
+	block->ready = false;
+
+	return block;
+}
+
+//---------------------------------
+// Submit
+//---------------------------------
+void JAsyncReader::Submit(Block *block)
+{
+	switch(method){
+		case kIOUring:
+			SubmitIOUring(block);
+			break;
+		case kThreads:
+			pthread_mutex_lock(&queue_mutex);
+			pending.push_back(block);
+			pthread_cond_signal(&queue_cond);
+			pthread_mutex_unlock(&queue_mutex);
+			break;
+		default:
+			ReadSync(block);
+			block->ready = true;
+	}
+}
+
+//---------------------------------
+// Wait
+//---------------------------------
+void JAsyncReader::Wait(Block *block)
+{
+	/// Wait for the read of the given block to complete
+	switch(method){
+		case kIOUring:
+			while(!block->ready) ReapIOUring(true);
+			break;
+		case kThreads:
+			pthread_mutex_lock(&queue_mutex);
+			while(!block->ready) pthread_cond_wait(&ready_cond, &queue_mutex);
+			pthread_mutex_unlock(&queue_mutex);
+			break;
+		default:
+			break;
+	}
+}
+
+//---------------------------------
+// ReadSync
+//---------------------------------
+void JAsyncReader::ReadSync(Block *block, uint32_t Nalready)
+{
+	/// Read block->size bytes into the block using pread, starting
+	/// Nalready bytes into it. On return, block->size is the number
+	/// of bytes actually in the block (it is only less than asked for
+	/// if the file was truncated).
+	uint32_t Nread = Nalready;
+	while(Nread < block->size){
+		ssize_t n = pread(fd, &block->data[Nread], block->size-Nread, block->offset+Nread);
+		if(n<0){
+			if(errno==EINTR) continue;
+			block->err = errno;
+			break;
+		}
+		if(n==0) break;
+		Nread += n;
+	}
+	block->size = Nread;
+}
+
+//---------------------------------
+// StartThreads
+//---------------------------------
+bool JAsyncReader::StartThreads(void)
+{
+	for(uint32_t i=0; i<queue_depth; i++){
+		pthread_t thr;
+		if(pthread_create(&thr, NULL, JAsyncReader_WorkerThread, this)!=0) break;
+		threads.push_back(thr);
+	}
+	return !threads.empty();
+}
+
+//---------------------------------
+// StopThreads
+//---------------------------------
+void JAsyncReader::StopThreads(void)
+{
+	if(threads.empty()) return;
+	pthread_mutex_lock(&queue_mutex);
+	stop_threads = true;
+	pthread_cond_broadcast(&queue_cond);
+	pthread_mutex_unlock(&queue_mutex);
+	for(unsigned int i=0; i<threads.size(); i++) pthread_join(threads[i], NULL);
+	threads.clear();
+}
+
+//---------------------------------
+// WorkerLoop
+//---------------------------------
+void JAsyncReader::WorkerLoop(void)
+{
+	/// Loop run by each thread of the kThreads method. Blocks are
+	/// taken from the pending queue, read with pread, and marked ready.
+	pthread_mutex_lock(&queue_mutex);
+	while(true){
+		while(pending.empty() && !stop_threads) pthread_cond_wait(&queue_cond, &queue_mutex);
+		if(stop_threads) break;
+		Block *block = pending.front();
+		pending.pop_front();
+		pthread_mutex_unlock(&queue_mutex);
+
+		ReadSync(block);
+
+		pthread_mutex_lock(&queue_mutex);
+		block->ready = true;
+		pthread_cond_broadcast(&ready_cond);
+	}
+	pthread_mutex_unlock(&queue_mutex);
+}
+
+#ifdef HAVE_IO_URING
+
+//---------------------------------
+// SetupIOUring
+//---------------------------------
+bool JAsyncReader::SetupIOUring(void)
+{
+	/// Create an io_uring with room for queue_depth reads and map its
+	/// submission and completion rings. This is done with the raw
+	/// system calls so that liburing is not needed. Returns false
+	/// (with the reason in "error") if the kernel does not support it
+	/// or it has been disabled.
+	struct io_uring_params p;
+	memset(&p, 0, sizeof(p));
+	ring_fd = syscall(__NR_io_uring_setup, queue_depth, &p);
+	if(ring_fd<0){
+		error = strerror(errno);
+		ring_fd = -1;
+		return false;
+	}
+
+	sq_ring_size = p.sq_off.array + p.sq_entries*sizeof(unsigned);
+	cq_ring_size = p.cq_off.cqes + p.cq_entries*sizeof(struct io_uring_cqe);
+	bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP)!=0;
+	if(single_mmap){
+		if(cq_ring_size > sq_ring_size) sq_ring_size = cq_ring_size;
+		cq_ring_size = sq_ring_size;
+	}
+
+	sq_ptr = mmap(NULL, sq_ring_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+	if(sq_ptr==MAP_FAILED){
+		error = strerror(errno);
+		sq_ptr = NULL;
+		CloseIOUring();
+		return false;
+	}
+	if(single_mmap){
+		cq_ptr = sq_ptr;
+	}else{
+		cq_ptr = mmap(NULL, cq_ring_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+		if(cq_ptr==MAP_FAILED){
+			error = strerror(errno);
+			cq_ptr = NULL;
+			CloseIOUring();
+			return false;
+		}
+	}
+
+	sqes_size = p.sq_entries*sizeof(struct io_uring_sqe);
+	sqes = mmap(NULL, sqes_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+	if(sqes==MAP_FAILED){
+		error = strerror(errno);
+		sqes = NULL;
+		CloseIOUring();
+		return false;
+	}
+
+	char *sq = (char*)sq_ptr;
+	sq_head  = (unsigned*)(sq + p.sq_off.head);
+	sq_tail  = (unsigned*)(sq + p.sq_off.tail);
+	sq_mask  = (unsigned*)(sq + p.sq_off.ring_mask);
+	sq_array = (unsigned*)(sq + p.sq_off.array);
+
+	char *cq = (char*)cq_ptr;
+	cq_head  = (unsigned*)(cq + p.cq_off.head);
+	cq_tail  = (unsigned*)(cq + p.cq_off.tail);
+	cq_mask  = (unsigned*)(cq + p.cq_off.ring_mask);
+	cqes     = (void*)(cq + p.cq_off.cqes);
+
+	return true;
+}
+
+//---------------------------------
+// CloseIOUring
+//---------------------------------
+void JAsyncReader::CloseIOUring(void)
+{
+	if(sqes) munmap(sqes, sqes_size);
+	if(cq_ptr && cq_ptr!=sq_ptr) munmap(cq_ptr, cq_ring_size);
+	if(sq_ptr) munmap(sq_ptr, sq_ring_size);
+	sqes = cq_ptr = sq_ptr = NULL;
+	if(ring_fd>=0) close(ring_fd);
+	ring_fd = -1;
+}
+
+//---------------------------------
+// SubmitIOUring
+//---------------------------------
+void JAsyncReader::SubmitIOUring(Block *block)
+{
+	/// Queue a read of the block and tell the kernel about it. The
+	/// number of reads in flight never exceeds queue_depth so there is
+	/// always room in the submission ring.
+	block->iov.iov_base = block->data;
+	block->iov.iov_len = block->size;
+
+	unsigned tail = *sq_tail;
+	unsigned index = tail & *sq_mask;
+	struct io_uring_sqe *sqe = &((struct io_uring_sqe*)sqes)[index];
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IORING_OP_READV;
+	sqe->fd = fd;
+	sqe->addr = (unsigned long)&block->iov;
+	sqe->len = 1;
+	sqe->off = block->offset;
+	sqe->user_data = (unsigned long)block;
+	sq_array[index] = index;
+	__atomic_store_n(sq_tail, tail+1, __ATOMIC_RELEASE);
+
+	while(syscall(__NR_io_uring_enter, ring_fd, 1, 0, 0, NULL, 0)<0){
+		if(errno==EINTR || errno==EAGAIN || errno==EBUSY){
+			// Completion ring is full or we were interrupted. Make room and retry.
+			ReapIOUring(false);
+			continue;
+		}
+		// Could not submit. Do the read here instead.
+		__atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+		ReadSync(block);
+		block->ready = true;
+		break;
+	}
+}
+
+//---------------------------------
+// ReapIOUring
+//---------------------------------
+void JAsyncReader::ReapIOUring(bool wait)
+{
+	/// Mark every block whose read has completed as ready. If "wait"
+	/// is true, block until at least one completion is available.
+	if(wait){
+		unsigned head = __atomic_load_n(cq_head, __ATOMIC_ACQUIRE);
+		if(head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)){
+			syscall(__NR_io_uring_enter, ring_fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+		}
+	}
+
+	unsigned head = *cq_head;
+	while(head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)){
+		struct io_uring_cqe *cqe = &((struct io_uring_cqe*)cqes)[head & *cq_mask];
+		Block *block = (Block*)cqe->user_data;
+		if(cqe->res<0){
+			block->err = -cqe->res;
+			block->size = 0;
+		}else if((uint32_t)cqe->res < block->size){
+			// Short read. Get the rest synchronously.
+			ReadSync(block, cqe->res);
+		}
+		block->ready = true;
+		head++;
+	}
+	__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+}
+
+#else // HAVE_IO_URING
+
+bool JAsyncReader::SetupIOUring(void){ error = "not compiled with io_uring support"; return false; }
+void JAsyncReader::CloseIOUring(void){}
+void JAsyncReader::SubmitIOUring(Block *block){ ReadSync(block); block->ready = true; }
+void JAsyncReader::ReapIOUring(bool wait){}
+
+#endif // HAVE_IO_URING
+
@@ -0,0 +1,150 @@
+// $Id$
+//
+//    File: JAsyncReader.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JAsyncReader_
+#define _JAsyncReader_
+
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/uio.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+using std::string;
+using std::vector;
+using std::deque;
+
+// Place everything in JANA namespace
+namespace jana{
+
+/// JAsyncReader reads a file sequentially in fixed size blocks while
+/// keeping up to "queue_depth" reads in flight ahead of the consumer.
+/// It is meant to be used by JEventSource implementations so that a
+/// slow read does not stall the event buffer thread: by the time the
+/// source asks for the next block it has usually already arrived.
+///
+/// Three methods are available:
+///
+/// <ul>
+/// <li> kIOUring: Linux io_uring. Reads are submitted to the kernel and
+///      no extra threads are used. This requires the kernel headers at
+///      build time (HAVE_IO_URING) and a kernel that allows it at run
+///      time.
+/// <li> kThreads: a pool of queue_depth threads doing pread.
+/// <li> kSync: plain pread in the caller's thread (no read-ahead). This
+///      is what is used if queue_depth is 0.
+/// </ul>
+///
+/// kAuto tries them in that order.
+///
+/// Next() returns blocks in file order. A block stays valid until it is
+/// passed to Release(), which may be done from any thread (e.g. from
+/// the source's FreeEvent). Next() itself must always be called from
+/// the same thread.
+
+class JAsyncReader{
+	public:
+
+		enum method_t{
+			kAuto = 0,
+			kIOUring,
+			kThreads,
+			kSync
+		};
+
+		class Block{
+			public:
+				char *data;
+				uint64_t offset;    ///< offset of data[0] in file
+				uint32_t size;      ///< bytes actually read (less than the block size only for the last block)
+				int err;            ///< errno if read failed
+				volatile bool ready;
+
+			private:
+				friend class JAsyncReader;
+				struct iovec iov;
+		};
+
+		JAsyncReader(const string &filename, uint32_t block_size=1048576, uint32_t queue_depth=8, method_t method=kAuto);
+		virtual ~JAsyncReader();
+
+		bool IsOpen(void) const {return fd>=0;}
+		const string& GetError(void) const {return error;}
+		method_t GetMethod(void) const {return method;}
+		const char* GetMethodName(void) const {return GetMethodName(method);}
+		uint64_t GetFileSize(void) const {return file_size;}
+		uint32_t GetBlockSize(void) const {return block_size;}
+		uint32_t GetQueueDepth(void) const {return queue_depth;}
+
+		Block* Next(void);
+		void Release(Block *block);
+
+		static const char* GetMethodName(method_t method);
+		static method_t GetMethodByName(const string &name);
+
+		void WorkerLoop(void); ///< Used internally by threads of kThreads method
+
+	protected:
+		string filename;
+		string error;
+		int fd;
+		uint64_t file_size;
+		uint64_t next_offset;
+		uint32_t block_size;
+		uint32_t queue_depth;
+		method_t method;
+
+		deque<Block*> in_flight;   // in file order
+		vector<Block*> free_blocks;
+		vector<Block*> all_blocks;
+		pthread_mutex_t blocks_mutex;
+
+		// kThreads
+		vector<pthread_t> threads;
+		deque<Block*> pending;
+		pthread_mutex_t queue_mutex;
+		pthread_cond_t queue_cond;
+		pthread_cond_t ready_cond;
+		bool stop_threads;
+
+		// kIOUring
+		int ring_fd;
+		void *sq_ptr;
+		void *cq_ptr;
+		void *sqes;
+		size_t sq_ring_size;
+		size_t cq_ring_size;
+		size_t sqes_size;
+		unsigned *sq_head;
+		unsigned *sq_tail;
+		unsigned *sq_mask;
+		unsigned *sq_array;
+		unsigned *cq_head;
+		unsigned *cq_tail;
+		unsigned *cq_mask;
+		void *cqes;
+
+		Block* GetFreeBlock(void);
+		void FillQueue(uint32_t Nmax);
+		void Submit(Block *block);
+		void Wait(Block *block);
+		void ReadSync(Block *block, uint32_t Nalready=0);
+
+		bool SetupIOUring(void);
+		void CloseIOUring(void);
+		void SubmitIOUring(Block *block);
+		void ReapIOUring(bool wait);
+
+		bool StartThreads(void);
+		void StopThreads(void);
+};
+
+} // Close JANA namespace
+
+#endif // _JAsyncReader_
+
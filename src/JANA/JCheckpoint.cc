@@ -0,0 +1,162 @@
+// $Id$
+//
+//    File: JCheckpoint.cc
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+using namespace std;
+
+#include "JCheckpoint.h"
+using namespace jana;
+
+//---------------------------------
+// Set
+//---------------------------------
+void JCheckpoint::Set(unsigned int isource, const string &source_name, uint64_t Ncompleted, bool finished)
+{
+	/// Record the progress for the source with the given index in the
+	/// list of sources.
+	if(isource >= entries.size()){
+		Entry empty;
+		empty.Ncompleted = 0;
+		empty.finished = false;
+		empty.valid = false;
+		entries.resize(isource+1, empty);
+	}
+	Entry &e = entries[isource];
+	e.source_name = source_name;
+	e.Ncompleted = Ncompleted;
+	e.finished = finished;
+	e.valid = true;
+}
+
+//---------------------------------
+// Find
+//---------------------------------
+const JCheckpoint::Entry* JCheckpoint::Find(unsigned int isource, const string &source_name) const
+{
+	/// Return the entry for the source with the given index or NULL if
+	/// there is none. If the entry is for a source with a different name,
+	/// NULL is also returned since the list of sources has changed.
+	if(isource >= entries.size()) return NULL;
+	const Entry &e = entries[isource];
+	if(!e.valid || e.source_name!=source_name) return NULL;
+	return &e;
+}
+
+//---------------------------------
+// GetNcompleted
+//---------------------------------
+uint64_t JCheckpoint::GetNcompleted(void) const
+{
+	/// Total events completed over all sources
+	uint64_t N = 0;
+	for(unsigned int i=0; i<entries.size(); i++) N += entries[i].Ncompleted;
+	return N;
+}
+
+//---------------------------------
+// GetNfinished
+//---------------------------------
+unsigned int JCheckpoint::GetNfinished(void) const
+{
+	/// Number of sources that are finished
+	unsigned int N = 0;
+	for(unsigned int i=0; i<entries.size(); i++) if(entries[i].valid && entries[i].finished) N++;
+	return N;
+}
+
+//---------------------------------
+// Write
+//---------------------------------
+bool JCheckpoint::Write(const string &filename)
+{
+	/// Write the checkpoint to the given file. It is written to a
+	/// temporary file first which then replaces the old one so there is
+	/// always a complete checkpoint on disk. Returns false and sets the
+	/// error string on failure.
+	string tmpname = filename + ".tmp";
+	FILE *f = fopen(tmpname.c_str(), "w");
+	if(!f){
+		error = string("fopen(") + tmpname + "): " + strerror(errno);
+		return false;
+	}
+
+	time_t now = time(NULL);
+	char tstr[64];
+	strftime(tstr, sizeof(tstr), "%Y-%m-%d %H:%M:%S", localtime(&now));
+	fprintf(f, "# JANA checkpoint written %s by pid %d\n", tstr, (int)getpid());
+	fprintf(f, "# %llu events completed, %u source(s) finished\n", (unsigned long long)GetNcompleted(), GetNfinished());
+	fprintf(f, "# Resume with -PJANA:RESUME=%s\n", filename.c_str());
+	fprintf(f, "# index  Ncompleted  finished  name\n");
+	for(unsigned int i=0; i<entries.size(); i++){
+		const Entry &e = entries[i];
+		if(!e.valid) continue;
+		fprintf(f, "%u %llu %d %s\n", i, (unsigned long long)e.Ncompleted, e.finished ? 1:0, e.source_name.c_str());
+	}
+
+	bool ok = fflush(f)==0 && fsync(fileno(f))==0;
+	ok = (fclose(f)==0) && ok;
+	if(!ok){
+		error = string("write(") + tmpname + "): " + strerror(errno);
+		unlink(tmpname.c_str());
+		return false;
+	}
+	if(rename(tmpname.c_str(), filename.c_str()) != 0){
+		error = string("rename(") + tmpname + "): " + strerror(errno);
+		unlink(tmpname.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+//---------------------------------
+// Read
+//---------------------------------
+bool JCheckpoint::Read(const string &filename)
+{
+	/// Read a checkpoint written by Write(). Returns false and sets the
+	/// error string if the file can't be read or is malformed.
+	entries.clear();
+	ifstream ifs(filename.c_str());
+	if(!ifs.is_open()){
+		error = string("unable to open \"") + filename + "\": " + strerror(errno);
+		return false;
+	}
+
+	string line;
+	unsigned int lineno = 0;
+	while(getline(ifs, line)){
+		lineno++;
+		size_t pos = line.find_first_not_of(" \t");
+		if(pos==string::npos || line[pos]=='#') continue;
+
+		stringstream ss(line);
+		unsigned int isource;
+		uint64_t Ncompleted;
+		int finished;
+		ss >> isource >> Ncompleted >> finished;
+		string name;
+		getline(ss >> ws, name);
+		if(ss.fail() && name.empty()){
+			stringstream err;
+			err<<filename<<":"<<lineno<<": expected \"index Ncompleted finished name\"";
+			error = err.str();
+			entries.clear();
+			return false;
+		}
+		Set(isource, name, Ncompleted, finished!=0);
+	}
+
+	return true;
+}
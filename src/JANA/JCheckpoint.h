@@ -0,0 +1,86 @@
+// $Id$
+//
+//    File: JCheckpoint.h
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#ifndef _JCheckpoint_
+#define _JCheckpoint_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+// Place everything in JANA namespace
+namespace jana{
+
+/// JCheckpoint records how far processing of each event source has
+/// gotten so that a job that dies can be restarted where it left off
+/// rather than from the beginning.
+///
+/// When the JANA:CHECKPOINT config. parameter is set to a file name,
+/// JApplication writes the checkpoint there every
+/// JANA:CHECKPOINT_INTERVAL seconds and once more at the end. For each
+/// source opened so far it holds the number of events from the start of
+/// the source that have all been completed (see
+/// JEventSource::GetProgress) and whether the source is finished. An
+/// event counts as completed only once it has been freed so events that
+/// were read but were still being processed are not included. Events
+/// whose thread was killed for stalling are never freed so the
+/// checkpoint stays before them.
+///
+/// Running the job again with -PJANA:RESUME=<file> skips finished
+/// sources without opening them and skips the completed events of the
+/// others. This uses the sources' SkipEvents() when they implement it
+/// and otherwise reads the events in and discards them. At most about
+/// one checkpoint interval of processing is repeated.
+///
+/// Only what is processed is recorded. Processors that write results
+/// as they go (e.g. skims) should make sure what they have written for
+/// the completed events is on disk. Results kept until fini() (e.g.
+/// histograms) are those of the resumed job only and need to be added
+/// to those of the earlier one(s) if it got as far as writing them.
+///
+/// The file is plain text with one line per source:
+///
+///    index  Ncompleted  finished  name
+///
+/// It is written to a temporary file which is then renamed so it is
+/// always complete even if the job dies while writing it.
+
+class JCheckpoint{
+	public:
+
+		class Entry{
+			public:
+				string source_name;
+				uint64_t Ncompleted;
+				bool finished;
+				bool valid;      ///< false for sources not opened (yet)
+		};
+
+		JCheckpoint(){}
+		virtual ~JCheckpoint(){}
+
+		void Set(unsigned int isource, const string &source_name, uint64_t Ncompleted, bool finished);
+		const Entry* Find(unsigned int isource, const string &source_name) const;
+		uint64_t GetNcompleted(void) const;
+		unsigned int GetNfinished(void) const;
+
+		bool Write(const string &filename);
+		bool Read(const string &filename);
+		const string& GetError(void) const {return error;}
+
+	protected:
+		vector<Entry> entries;
+		string error;
+};
+
+} // Close JANA namespace
+
+#endif // _JCheckpoint_
+
@@ -0,0 +1,755 @@
+// $Id$
+//
+//    File: JControlServer.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <execinfo.h>
+#include <cxxabi.h>
+#endif // __linux__
+
+#include <iostream>
+#include <iomanip>
+using namespace std;
+
+#include "JControlServer.h"
+#include "JApplication.h"
+#include "JEventLoop.h"
+#include "JParameterManager.h"
+#include "JEventSource.h"
+using namespace jana;
+
+void* LaunchControlServerThread(void *arg);
+
+#ifdef __linux__
+// Stack samples are taken by sending a signal to each processing thread
+// and having it record its own backtrace into the slot set aside for it.
+// The symbols are resolved later by the server thread since that is not
+// safe to do from a signal handler.
+#define JCONTROL_MAX_FRAMES 64
+typedef struct{
+	pthread_t thread_id;
+	void *frames[JCONTROL_MAX_FRAMES];
+	volatile int Nframes;
+	volatile int done;
+}stack_sample_t;
+
+static stack_sample_t *stack_samples = NULL;
+static volatile unsigned int Nstack_samples = 0;
+static pthread_mutex_t stack_samples_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//-----------------------------------------------------------------
+// StackSampleHandler
+//-----------------------------------------------------------------
+static void StackSampleHandler(int x)
+{
+	pthread_t me = pthread_self();
+	for(unsigned int i=0; i<Nstack_samples; i++){
+		stack_sample_t &s = stack_samples[i];
+		if(!pthread_equal(s.thread_id, me)) continue;
+		s.Nframes = backtrace(s.frames, JCONTROL_MAX_FRAMES);
+		__sync_synchronize();
+		s.done = 1;
+		break;
+	}
+}
+
+//-----------------------------------------------------------------
+// Demangle
+//-----------------------------------------------------------------
+static string Demangle(const char *symbol)
+{
+	// backtrace_symbols gives lines of the form:  lib.so(_ZN4jana3FooEv+0x12) [0x7f...]
+	string s(symbol);
+	size_t pos_open = s.find('(');
+	size_t pos_plus = s.find('+', pos_open);
+	if(pos_open==string::npos || pos_plus==string::npos || pos_plus==pos_open+1) return s;
+
+	string mangled = s.substr(pos_open+1, pos_plus-pos_open-1);
+	int status = 0;
+	char *demangled = abi::__cxa_demangle(mangled.c_str(), NULL, NULL, &status);
+	if(status!=0 || !demangled) return s;
+	string ret = s.substr(0, pos_open+1) + demangled + s.substr(pos_plus);
+	free(demangled);
+
+	return ret;
+}
+#endif // __linux__
+
+
+//---------------------------------
+// JControlServer    (Constructor)
+//---------------------------------
+JControlServer::JControlServer(JApplication *app)
+{
+	this->app = app;
+	listen_fd = -1;
+	running = false;
+	stop = false;
+	pthread_mutex_init(&commands_mutex, NULL);
+}
+
+//---------------------------------
+// ~JControlServer    (Destructor)
+//---------------------------------
+JControlServer::~JControlServer()
+{
+	Stop();
+	pthread_mutex_destroy(&commands_mutex);
+}
+
+//---------------------------------
+// GetDefaultPath
+//---------------------------------
+string JControlServer::GetDefaultPath(pid_t pid)
+{
+	/// Return the socket path used by the process with the given
+	/// PID if JANA:CONTROL_SOCKET is not set explicitly.
+	stringstream ss;
+	ss << "/tmp/jana_ctl." << pid;
+	return ss.str();
+}
+
+//---------------------------------
+// Start
+//---------------------------------
+bool JControlServer::Start(const string &path)
+{
+	/// Create the socket at the given path and launch the thread that
+	/// services it. Any existing file at that path is removed first.
+	/// Returns false and sets the error string on failure.
+	if(running) return true;
+
+	struct sockaddr_un addr;
+	if(path.size() >= sizeof(addr.sun_path)){
+		error = "socket path too long: " + path;
+		return false;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path)-1);
+
+	listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(listen_fd < 0){
+		error = string("socket: ") + strerror(errno);
+		return false;
+	}
+	unlink(path.c_str());
+	if(bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0){
+		error = string("bind(") + path + "): " + strerror(errno);
+		close(listen_fd);
+		listen_fd = -1;
+		return false;
+	}
+	// Only our user may pause, quit, ... us
+	if(chmod(path.c_str(), 0600) != 0){
+		error = string("chmod(") + path + "): " + strerror(errno);
+		close(listen_fd);
+		listen_fd = -1;
+		unlink(path.c_str());
+		return false;
+	}
+	if(listen(listen_fd, 8) != 0){
+		error = string("listen(") + path + "): " + strerror(errno);
+		close(listen_fd);
+		listen_fd = -1;
+		unlink(path.c_str());
+		return false;
+	}
+	fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL) | O_NONBLOCK);
+	this->path = path;
+
+#ifdef __linux__
+	// Install handler used to sample stacks of processing threads. Call
+	// backtrace once here since it may allocate memory the first time
+	// it is called which is not something we want in a signal handler.
+	void *dummy[2];
+	backtrace(dummy, 2);
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = StackSampleHandler;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = SA_RESTART;
+	sigaction(SIGRTMIN+4, &sa, NULL);
+#endif // __linux__
+
+	stop = false;
+	if(pthread_create(&thr, NULL, LaunchControlServerThread, this) != 0){
+		error = "unable to create control server thread";
+		close(listen_fd);
+		listen_fd = -1;
+		unlink(path.c_str());
+		return false;
+	}
+	running = true;
+
+	return true;
+}
+
+//---------------------------------
+// Stop
+//---------------------------------
+void JControlServer::Stop(void)
+{
+	/// Stop the server thread, close all connections and remove the socket.
+	if(!running) return;
+
+	stop = true;
+	pthread_join(thr, NULL);
+	running = false;
+
+	for(unsigned int i=0; i<clients.size(); i++) close(clients[i].fd);
+	clients.clear();
+	if(listen_fd >= 0) close(listen_fd);
+	listen_fd = -1;
+	unlink(path.c_str());
+}
+
+//---------------------------------
+// LaunchControlServerThread
+//---------------------------------
+void* LaunchControlServerThread(void *arg)
+{
+	// Processing threads get the signals meant for the process
+	// as a whole (e.g. SIGINT) so block them all here.
+	sigset_t set;
+	sigfillset(&set);
+	pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+	((JControlServer*)arg)->ServiceLoop();
+
+	return NULL;
+}
+
+//---------------------------------
+// ServiceLoop
+//---------------------------------
+void JControlServer::ServiceLoop(void)
+{
+	/// Wait for activity on the listening socket or any client
+	/// connection and handle it. This only returns once Stop()
+	/// is called.
+	while(!stop){
+		vector<struct pollfd> fds(1+clients.size());
+		fds[0].fd = listen_fd;
+		fds[0].events = POLLIN;
+		fds[0].revents = 0;
+		for(unsigned int i=0; i<clients.size(); i++){
+			fds[i+1].fd = clients[i].fd;
+			fds[i+1].events = POLLIN | (clients[i].out.empty() ? 0:POLLOUT);
+			fds[i+1].revents = 0;
+		}
+
+		// Wake up periodically to check the stop flag
+		int n = poll(&fds[0], fds.size(), 250);
+		if(n <= 0) continue;
+
+		// Service existing clients first since accepting new
+		// connections will change the clients vector.
+		vector<client_t> keep;
+		for(unsigned int i=0; i<clients.size(); i++){
+			client_t &client = clients[i];
+			bool ok = true;
+			if(fds[i+1].revents & (POLLIN | POLLHUP | POLLERR)) ok = ReadClient(client);
+			if(ok && !client.out.empty()) ok = WriteClient(client);
+			if(ok && client.close_when_sent && client.out.empty()) ok = false;
+			if(ok){
+				keep.push_back(client);
+			}else{
+				close(client.fd);
+			}
+		}
+		clients.swap(keep);
+
+		if(fds[0].revents & POLLIN){
+			while(true){
+				int fd = accept(listen_fd, NULL, NULL);
+				if(fd < 0) break;
+				fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+				client_t client;
+				client.fd = fd;
+				client.close_when_sent = false;
+				clients.push_back(client);
+			}
+		}
+	}
+}
+
+//---------------------------------
+// ReadClient
+//---------------------------------
+bool JControlServer::ReadClient(client_t &client)
+{
+	/// Read whatever is available from the client and execute any
+	/// complete lines. Returns false if the connection should be closed.
+	char buff[1024];
+	while(true){
+		ssize_t n = read(client.fd, buff, sizeof(buff));
+		if(n == 0) return false; // client closed connection
+		if(n < 0){
+			if(errno==EAGAIN || errno==EWOULDBLOCK) break;
+			if(errno == EINTR) continue;
+			return false;
+		}
+		client.in.append(buff, n);
+
+		// Don't let a client that never sends a newline use up all our memory
+		if(client.in.size() > 65536) return false;
+	}
+
+	size_t pos;
+	while((pos=client.in.find('\n')) != string::npos){
+		string line = client.in.substr(0, pos);
+		client.in.erase(0, pos+1);
+		if(!line.empty() && line[line.size()-1]=='\r') line.erase(line.size()-1);
+		if(line.empty()) continue;
+		if(line=="exit" || line=="bye"){
+			client.close_when_sent = true;
+			break;
+		}
+
+		stringstream out;
+		bool ok = Execute(line, out);
+		client.out += FormatResponse(ok, out.str());
+	}
+
+	return true;
+}
+
+//---------------------------------
+// WriteClient
+//---------------------------------
+bool JControlServer::WriteClient(client_t &client)
+{
+	/// Write as much pending output to the client as it will take.
+	/// Returns false if the connection should be closed.
+	while(!client.out.empty()){
+		ssize_t n = write(client.fd, client.out.data(), client.out.size());
+		if(n < 0){
+			if(errno==EAGAIN || errno==EWOULDBLOCK) break;
+			if(errno == EINTR) continue;
+			return false;
+		}
+		client.out.erase(0, n);
+	}
+
+	return true;
+}
+
+//---------------------------------
+// FormatResponse
+//---------------------------------
+string JControlServer::FormatResponse(bool ok, const string &text)
+{
+	/// Wrap the output of a command in the status line and terminator
+	/// described in the class documentation.
+	string response;
+	stringstream ss(text);
+	string line;
+	bool first = true;
+	while(getline(ss, line)){
+		if(first && !ok){
+			response = "ERROR " + line + "\n";
+			first = false;
+			continue;
+		}
+		if(first) response = "OK\n";
+		first = false;
+		if(!line.empty() && line[0]=='.') line = "." + line;
+		response += line + "\n";
+	}
+	if(first) response = ok ? "OK\n":"ERROR\n";
+	response += ".\n";
+
+	return response;
+}
+
+//---------------------------------
+// AddCommand
+//---------------------------------
+void JControlServer::AddCommand(const string &name, CommandHandler_t *handler, void *arg, const string &help)
+{
+	/// Add a command to the server. If a command with the same name
+	/// already exists, it is replaced. Built in commands cannot be
+	/// replaced.
+	command_t cmd;
+	cmd.handler = handler;
+	cmd.arg = arg;
+	cmd.help = help;
+
+	pthread_mutex_lock(&commands_mutex);
+	commands[name] = cmd;
+	pthread_mutex_unlock(&commands_mutex);
+}
+
+//---------------------------------
+// Execute
+//---------------------------------
+bool JControlServer::Execute(const string &line, stringstream &out)
+{
+	/// Execute a single command line, writing any output to "out".
+	/// This is normally called from the server thread, but may be
+	/// called from anywhere.
+	vector<string> args;
+	stringstream ss(line);
+	string word;
+	while(ss >> word) args.push_back(word);
+	if(args.empty()) return true;
+
+	string cmd = args[0];
+	try{
+		if(cmd=="help")       return CmdHelp(args, out);
+		if(cmd=="pause")      {app->ReadLock("app"); app->Pause(); app->Unlock("app"); return true;}
+		if(cmd=="resume")     {app->ReadLock("app"); app->Resume(); app->Unlock("app"); return true;}
+		if(cmd=="quit")       {jout<<"Quit requested via control socket"<<endl; app->Quit(); return true;}
+		if(cmd=="kill")       {jerr<<"Kill requested via control socket"<<endl; exit(-1);}
+		if(cmd=="nthreads")   return CmdNthreads(args, out);
+		if(cmd=="killthread") return CmdKillThread(args, out);
+		if(cmd=="get")        return CmdGet(args, out);
+		if(cmd=="set")        return CmdSet(args, out);
+		if(cmd=="params")     return CmdParams(args, out);
+		if(cmd=="stats")      return CmdStats(args, out);
+		if(cmd=="threads")    return CmdThreads(args, out);
+		if(cmd=="sources")    return CmdSources(args, out);
+		if(cmd=="iostats")    return CmdIOStats(args, out);
+		if(cmd=="stacks")     return CmdStacks(args, out);
+		if(cmd=="command"){
+			const vector<string> &cargs = app->GetArgs();
+			for(unsigned int i=0; i<cargs.size(); i++) out << (i==0 ? "":" ") << cargs[i];
+			out << endl;
+			return true;
+		}
+
+		// Commands added by plugins
+		pthread_mutex_lock(&commands_mutex);
+		map<string, command_t>::iterator iter = commands.find(cmd);
+		bool found = iter!=commands.end();
+		command_t c;
+		if(found) c = iter->second;
+		pthread_mutex_unlock(&commands_mutex);
+		if(found) return (*c.handler)(app, args, out, c.arg);
+
+	}catch(exception &e){
+		out << e.what() << endl;
+		return false;
+	}
+
+	out << "unknown command \"" << cmd << "\" (try \"help\")" << endl;
+	return false;
+}
+
+//---------------------------------
+// CmdHelp
+//---------------------------------
+bool JControlServer::CmdHelp(const vector<string> &args, stringstream &out)
+{
+	out << "help                 print this message" << endl;
+	out << "pause                pause event processing" << endl;
+	out << "resume               resume event processing" << endl;
+	out << "quit                 stop event processing and exit gracefully" << endl;
+	out << "kill                 exit immediately" << endl;
+	out << "nthreads [N]         get or set the number of processing threads" << endl;
+	out << "killthread N|0xID    kill processing thread by index or pthread id" << endl;
+	out << "get NAME             get value of a configuration parameter" << endl;
+	out << "set NAME VALUE       set value of a configuration parameter" << endl;
+	out << "params [filter]      list configuration parameters" << endl;
+	out << "stats                print global processing statistics" << endl;
+	out << "threads              print per-thread processing statistics" << endl;
+	out << "sources              list active event sources" << endl;
+	out << "iostats              print I/O accounting of active event sources" << endl;
+	out << "stacks               print stack trace of every processing thread" << endl;
+	out << "command              print command line of process" << endl;
+	out << "exit                 close this connection" << endl;
+
+	pthread_mutex_lock(&commands_mutex);
+	map<string, command_t>::iterator iter = commands.begin();
+	for(; iter!=commands.end(); iter++){
+		out << setw(20) << left << iter->first << " " << iter->second.help << endl;
+	}
+	pthread_mutex_unlock(&commands_mutex);
+
+	return true;
+}
+
+//---------------------------------
+// CmdNthreads
+//---------------------------------
+bool JControlServer::CmdNthreads(const vector<string> &args, stringstream &out)
+{
+	if(args.size() < 2){
+		out << app->GetNthreads() << endl;
+		return true;
+	}
+
+	int Nthreads = atoi(args[1].c_str());
+	if(Nthreads < 1){
+		out << "bad value for nthreads: " << args[1] << endl;
+		return false;
+	}
+	app->SetNthreads(Nthreads);
+
+	return true;
+}
+
+//---------------------------------
+// CmdKillThread
+//---------------------------------
+bool JControlServer::CmdKillThread(const vector<string> &args, stringstream &out)
+{
+	if(args.size() < 2){
+		out << "usage: killthread N|0xID" << endl;
+		return false;
+	}
+
+	// If value contains an "x" assume it is in hex form and
+	// represents the pthread_t value. Otherwise, assume it
+	// is an index to the i-th thread.
+	pthread_t thr;
+	if(args[1].find("x") != string::npos){
+		thr = (pthread_t)strtoull(args[1].c_str(), NULL, 16);
+	}else{
+		thr = app->GetThreadID(atoi(args[1].c_str()));
+	}
+
+	if(!app->KillThread(thr, false)){
+		out << "thread not found: " << args[1] << endl;
+		return false;
+	}
+
+	return true;
+}
+
+//---------------------------------
+// CmdGet
+//---------------------------------
+bool JControlServer::CmdGet(const vector<string> &args, stringstream &out)
+{
+	if(args.size() < 2){
+		out << "usage: get NAME" << endl;
+		return false;
+	}
+
+	string val;
+	app->GetJParameterManager()->GetParameter(args[1], val);
+	out << val << endl;
+
+	return true;
+}
+
+//---------------------------------
+// CmdSet
+//---------------------------------
+bool JControlServer::CmdSet(const vector<string> &args, stringstream &out)
+{
+	/// Note that most parameters are only read once at the beginning
+	/// of the job so changing them here may have no effect.
+	if(args.size() < 3){
+		out << "usage: set NAME VALUE" << endl;
+		return false;
+	}
+
+	// Value may contain spaces
+	string val = args[2];
+	for(unsigned int i=3; i<args.size(); i++) val += " " + args[i];
+	app->GetJParameterManager()->SetParameter(args[1], val);
+
+	return true;
+}
+
+//---------------------------------
+// CmdParams
+//---------------------------------
+bool JControlServer::CmdParams(const vector<string> &args, stringstream &out)
+{
+	string filter = args.size()>1 ? args[1]:"";
+
+	map<string,string> parms;
+	app->GetJParameterManager()->GetParameters(parms, filter);
+	map<string,string>::iterator iter = parms.begin();
+	for(; iter!=parms.end(); iter++){
+		out << iter->first << " = " << iter->second << endl;
+	}
+
+	return true;
+}
+
+//---------------------------------
+// CmdStats
+//---------------------------------
+bool JControlServer::CmdStats(const vector<string> &args, stringstream &out)
+{
+	out << "NEvents " << app->GetNEvents() << endl;
+	out << "NEvents_read " << app->GetNEventsRead() << endl;
+	out << "Nlost_events " << app->GetNLostEvents() << endl;
+	out << "rate_instantaneous " << app->GetRate() << endl;
+	out << "rate_average " << app->GetIntegratedRate() << endl;
+	out << "Nthreads " << app->GetNthreads() << endl;
+	out << "event_buffer_size " << app->GetEventBufferSize() << endl;
+
+	return true;
+}
+
+//---------------------------------
+// CmdThreads
+//---------------------------------
+bool JControlServer::CmdThreads(const vector<string> &args, stringstream &out)
+{
+	app->ReadLock("app");
+	vector<JEventLoop*> loops = app->GetJEventLoops();
+	out << "index          thread_id    Nevents   rate(Hz)    avg(Hz)       run        event" << endl;
+	for(unsigned int i=0; i<loops.size(); i++){
+		JEventLoop *loop = loops[i];
+		out << setw(5) << i;
+		out << " 0x" << hex << setw(16) << left << (unsigned long)loop->GetPThreadID() << right << dec;
+		out << " " << setw(10) << loop->GetNevents();
+		out << " " << setw(10) << fixed << setprecision(1) << loop->GetInstantaneousRate();
+		out << " " << setw(10) << fixed << setprecision(1) << loop->GetIntegratedRate();
+		out << " " << setw(9) << loop->GetJEvent().GetRunNumber();
+		out << " " << setw(12) << loop->GetJEvent().GetEventNumber();
+		out << endl;
+	}
+	app->Unlock("app");
+
+	return true;
+}
+
+//---------------------------------
+// CmdSources
+//---------------------------------
+bool JControlServer::CmdSources(const vector<string> &args, stringstream &out)
+{
+	vector<string> classNames;
+	vector<string> sourceNames;
+	app->GetActiveEventSourceNames(classNames, sourceNames);
+	for(unsigned int i=0; i<classNames.size() && i<sourceNames.size(); i++){
+		out << classNames[i] << " " << sourceNames[i] << endl;
+	}
+
+	return true;
+}
+
+//---------------------------------
+// CmdIOStats
+//---------------------------------
+bool JControlServer::CmdIOStats(const vector<string> &args, stringstream &out)
+{
+	/// Print the I/O accounting of each active source as "name value"
+	/// pairs. Times are in seconds.
+	vector<JEventSourceIOStats> stats;
+	app->GetSourceIOStats(stats);
+
+	out << "nextevent_wait_total " << app->GetNextEventWaitTime() << endl;
+	for(unsigned int i=0; i<stats.size(); i++){
+		JEventSourceIOStats &s = stats[i];
+		out << "source " << s.class_name << " " << s.source_name << endl;
+		out << "  events " << s.Nevents << endl;
+		out << "  bytes " << s.Nbytes << endl;
+		out << "  elapsed " << s.elapsed << endl;
+		out << "  done_reading " << (s.done_reading ? 1:0) << endl;
+		out << "  getevent_time " << s.getevent_time << endl;
+		out << "  getevent_max " << s.getevent_max << endl;
+		out << "  reader_utilization " << s.GetReaderUtilization() << endl;
+		out << "  buffer_full_time " << s.buffer_full_time << endl;
+		out << "  worker_wait_time " << s.worker_wait_time << endl;
+		out << "  worker_waits " << s.Nworker_waits << endl;
+		out << "  getobjects_time " << s.getobjects_time << endl;
+		map<string, JEventSourceIOStats::getobjects_t>::iterator iter = s.getobjects.begin();
+		for(; iter!=s.getobjects.end(); iter++){
+			out << "  getobjects " << iter->first << " " << iter->second.Ncalls << " " << iter->second.time << endl;
+		}
+	}
+
+	return true;
+}
+
+//---------------------------------
+// CmdStacks
+//---------------------------------
+bool JControlServer::CmdStacks(const vector<string> &args, stringstream &out)
+{
+	/// Print the stack of every processing thread without stopping them
+	/// (unlike sending SIGUSR1 to the process). Each thread is sent a
+	/// signal whose handler records its backtrace. We wait a short time
+	/// for each to respond. The application lock is not held while
+	/// waiting so threads can still be started or stopped.
+#ifdef __linux__
+	pthread_mutex_lock(&stack_samples_mutex);
+
+	app->ReadLock("app");
+	vector<JEventLoop*> loops = app->GetJEventLoops();
+	unsigned int Nsamples = loops.size();
+	stack_sample_t *samples = new stack_sample_t[Nsamples];
+	for(unsigned int i=0; i<Nsamples; i++){
+		samples[i].thread_id = loops[i]->GetPThreadID();
+		samples[i].Nframes = 0;
+		samples[i].done = 0;
+	}
+	stack_samples = samples;
+	__sync_synchronize();
+	Nstack_samples = Nsamples;
+
+	for(unsigned int i=0; i<Nsamples; i++) pthread_kill(samples[i].thread_id, SIGRTMIN+4);
+	app->Unlock("app");
+
+	// Wait up to 1 second for all threads to respond
+	for(int j=0; j<100; j++){
+		bool all_done = true;
+		for(unsigned int i=0; i<Nsamples; i++) if(!samples[i].done) all_done = false;
+		if(all_done) break;
+		usleep(10000);
+	}
+
+	// Loops may have gone away while we waited so find them again
+	app->ReadLock("app");
+	loops = app->GetJEventLoops();
+	for(unsigned int i=0; i<Nsamples; i++){
+		out << "--- thread " << i << " (0x" << hex << (unsigned long)samples[i].thread_id << dec << ")";
+		JEventLoop *loop = NULL;
+		for(unsigned int k=0; k<loops.size(); k++) if(pthread_equal(loops[k]->GetPThreadID(), samples[i].thread_id)) loop = loops[k];
+		if(loop){
+			JEvent &event = loop->GetJEvent();
+			out << " run:" << event.GetRunNumber() << " event:" << event.GetEventNumber() << " ---" << endl;
+		}else{
+			out << " (finished) ---" << endl;
+		}
+		if(!samples[i].done){
+			out << "   (no response)" << endl;
+			continue;
+		}
+		char **symbols = backtrace_symbols(samples[i].frames, samples[i].Nframes);
+		// Skip the signal handler and the signal trampoline frames
+		for(int k=2; k<samples[i].Nframes; k++) out << "   " << (symbols ? Demangle(symbols[k]):string("?")) << endl;
+		free(symbols);
+	}
+	app->Unlock("app");
+
+	// Threads that did not respond in time may still do so later so
+	// make sure they no longer see the samples before deleting them.
+	Nstack_samples = 0;
+	__sync_synchronize();
+	for(unsigned int i=0; i<Nsamples; i++){
+		for(int j=0; j<10 && !samples[i].done; j++) usleep(1000);
+	}
+	stack_samples = NULL;
+	delete[] samples;
+
+	pthread_mutex_unlock(&stack_samples_mutex);
+	return true;
+#else
+	out << "stack traces only supported on Linux at this time" << endl;
+	return false;
+#endif // __linux__
+}
+
@@ -0,0 +1,119 @@
+// $Id$
+//
+//    File: JControlServer.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JControlServer_
+#define _JControlServer_
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+using std::string;
+using std::vector;
+using std::map;
+using std::stringstream;
+
+// Place everything in JANA namespace
+namespace jana{
+
+class JApplication;
+
+/// JControlServer allows a running JANA program to be monitored and
+/// controlled from outside through a Unix domain socket (by default
+/// /tmp/jana_ctl.<pid>). It is normally started from JApplication::Run()
+/// and is controlled with the JANA:CONTROL_SOCKET config. parameter.
+/// The janactl utility is the usual client.
+///
+/// The socket is serviced by a dedicated thread using non-blocking I/O
+/// so a slow or misbehaving client can never stall event processing.
+///
+/// The protocol is line based. The client sends one command per line.
+/// The server responds with a status line which is either "OK" or
+/// "ERROR <message>" followed by zero or more lines of output and
+/// a line containing only a single ".". Any output line that begins
+/// with a "." has another "." prepended to it (as in SMTP).
+///
+/// Plugins may add their own commands with AddCommand().
+
+class JControlServer{
+	public:
+
+		/// Handlers for commands added via AddCommand. The arguments
+		/// are the words of the command line (args[0] is the command
+		/// itself). Output should be written to "out". Return false
+		/// to indicate an error in which case the first line of "out"
+		/// is used as the error message.
+		typedef bool CommandHandler_t(JApplication *app, const vector<string> &args, stringstream &out, void *arg);
+
+		JControlServer(JApplication *app);
+		virtual ~JControlServer();
+
+		bool Start(const string &path);
+		void Stop(void);
+		bool IsRunning(void) const {return running;}
+		const string& GetPath(void) const {return path;}
+		const string& GetError(void) const {return error;}
+
+		void AddCommand(const string &name, CommandHandler_t *handler, void *arg, const string &help);
+		bool Execute(const string &line, stringstream &out);
+
+		static string GetDefaultPath(pid_t pid=getpid());
+
+		void ServiceLoop(void); ///< Used internally by the server thread
+
+	protected:
+
+		class client_t{
+			public:
+				int fd;
+				string in;
+				string out;
+				bool close_when_sent;
+		};
+
+		class command_t{
+			public:
+				CommandHandler_t *handler;
+				void *arg;
+				string help;
+		};
+
+		bool ReadClient(client_t &client);
+		bool WriteClient(client_t &client);
+		string FormatResponse(bool ok, const string &text);
+
+		bool CmdHelp(const vector<string> &args, stringstream &out);
+		bool CmdNthreads(const vector<string> &args, stringstream &out);
+		bool CmdKillThread(const vector<string> &args, stringstream &out);
+		bool CmdGet(const vector<string> &args, stringstream &out);
+		bool CmdSet(const vector<string> &args, stringstream &out);
+		bool CmdParams(const vector<string> &args, stringstream &out);
+		bool CmdStats(const vector<string> &args, stringstream &out);
+		bool CmdThreads(const vector<string> &args, stringstream &out);
+		bool CmdSources(const vector<string> &args, stringstream &out);
+		bool CmdIOStats(const vector<string> &args, stringstream &out);
+		bool CmdStacks(const vector<string> &args, stringstream &out);
+
+		JApplication *app;
+		string path;
+		string error;
+		int listen_fd;
+		bool running;
+		volatile bool stop;
+		pthread_t thr;
+		vector<client_t> clients;
+		map<string, command_t> commands;
+		pthread_mutex_t commands_mutex;
+};
+
+} // Close JANA namespace
+
+#endif // _JControlServer_
+
@@ -0,0 +1,492 @@
+// $Id$
+//
+//    File: JDecompressStream.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <iostream>
+using namespace std;
+
+#include "JDecompressStream.h"
+#include "JStreamLog.h"
+using namespace jana;
+
+// Size of chunks read and inflated when the file is not BGZF
+static const size_t kGzipChunkSize = 1048576;
+
+// Thread entry points
+static void* JDecompressStreamBuf_ReaderThread(void *arg)
+{
+	((JDecompressStreamBuf*)arg)->ReaderLoop();
+	return NULL;
+}
+static void* JDecompressStreamBuf_WorkerThread(void *arg)
+{
+	((JDecompressStreamBuf*)arg)->WorkerLoop();
+	return NULL;
+}
+
+//---------------------------------
+// JDecompressStream    (Constructor)
+//---------------------------------
+JDecompressStream::JDecompressStream(const string &filename, unsigned int Nthreads, unsigned int Nahead):std::istream(NULL),buf(filename, Nthreads, Nahead)
+{
+	init(&buf);
+	if(!buf.IsOpen()) setstate(std::ios::failbit);
+}
+
+//---------------------------------
+// JDecompressStreamBuf    (Constructor)
+//---------------------------------
+JDecompressStreamBuf::JDecompressStreamBuf(const string &filename, unsigned int Nthreads, unsigned int Nahead)
+{
+	/// Open the file and start the decompression threads. Nthreads
+	/// is the number of threads that inflate blocks in parallel (only
+	/// used for BGZF files). Nahead is the maximum number of blocks
+	/// that may be read/decompressed ahead of the consumer. If it is
+	/// zero, 4 times the number of threads is used.
+	this->filename = filename;
+	this->Nahead = Nahead>0 ? Nahead:4*(Nthreads>0 ? Nthreads:1);
+	fd = -1;
+	format = kNone;
+	Nbytes_in = Nbytes_out = 0;
+	reader_started = false;
+	stop = false;
+	reader_done = false;
+	Nunits_read = 0;
+	next_seq = 0;
+	current = NULL;
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&cond, NULL);
+	setg(NULL, NULL, NULL);
+
+#ifndef HAVE_ZLIB
+	error = "JANA was built without zlib support";
+	return;
+#endif
+
+	format = GetFormat(filename);
+	if(format == kNone){
+		error = "not a gzip file";
+		return;
+	}
+
+	fd = open(filename.c_str(), O_RDONLY);
+	if(fd<0){
+		error = strerror(errno);
+		return;
+	}
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	if(format == kBGZF){
+		if(Nthreads<1) Nthreads = 1;
+		for(unsigned int i=0; i<Nthreads; i++){
+			pthread_t thr;
+			if(pthread_create(&thr, NULL, JDecompressStreamBuf_WorkerThread, this)!=0) break;
+			workers.push_back(thr);
+		}
+	}
+	if(pthread_create(&reader_thread, NULL, JDecompressStreamBuf_ReaderThread, this)==0){
+		reader_started = true;
+	}else{
+		SetError("unable to start reader thread");
+	}
+}
+
+//---------------------------------
+// ~JDecompressStreamBuf    (Destructor)
+//---------------------------------
+JDecompressStreamBuf::~JDecompressStreamBuf()
+{
+	pthread_mutex_lock(&mutex);
+	stop = true;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+
+	if(reader_started) pthread_join(reader_thread, NULL);
+	for(unsigned int i=0; i<workers.size(); i++) pthread_join(workers[i], NULL);
+
+	for(unsigned int i=0; i<work.size(); i++) delete work[i];
+	for(map<uint64_t, unit_t*>::iterator it=done.begin(); it!=done.end(); it++) delete it->second;
+	if(current) delete current;
+	if(fd>=0) close(fd);
+
+	pthread_mutex_destroy(&mutex);
+	pthread_cond_destroy(&cond);
+}
+
+//---------------------------------
+// GetFormat
+//---------------------------------
+JDecompressStreamBuf::format_t JDecompressStreamBuf::GetFormat(const string &filename)
+{
+	/// Look at the first bytes of the file to see if it is gzip
+	/// compressed and, if so, whether it is BGZF.
+	FILE *f = fopen(filename.c_str(), "rb");
+	if(!f) return kNone;
+	unsigned char hdr[12];
+	size_t N = fread(hdr, 1, sizeof(hdr), f);
+	format_t format = kNone;
+	if(N==sizeof(hdr) && hdr[0]==0x1f && hdr[1]==0x8b && hdr[2]==8){
+		format = kGzip;
+
+		// BGZF has an extra field (FLG.FEXTRA) with a "BC" subfield
+		if(hdr[3] & 0x04){
+			uint16_t xlen = hdr[10] | (hdr[11]<<8);
+			vector<unsigned char> extra(xlen);
+			if(xlen>0 && fread(&extra[0], 1, xlen, f)==xlen){
+				for(uint16_t i=0; i+4<=xlen; ){
+					uint16_t slen = extra[i+2] | (extra[i+3]<<8);
+					if(extra[i]=='B' && extra[i+1]=='C' && slen==2){
+						format = kBGZF;
+						break;
+					}
+					i += 4 + slen;
+				}
+			}
+		}
+	}
+	fclose(f);
+
+	return format;
+}
+
+//---------------------------------
+// GetFormatName
+//---------------------------------
+const char* JDecompressStreamBuf::GetFormatName(format_t format)
+{
+	switch(format){
+		case kNone: return "uncompressed";
+		case kGzip: return "gzip";
+		case kBGZF: return "BGZF";
+	}
+	return "unknown";
+}
+
+//---------------------------------
+// underflow
+//---------------------------------
+JDecompressStreamBuf::int_type JDecompressStreamBuf::underflow(void)
+{
+	/// Called by the istream when it has used up all of the bytes of
+	/// the current block. Wait for the next one (in order) to be
+	/// inflated and make it the current one.
+	if(gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+	pthread_mutex_lock(&mutex);
+	if(current){
+		delete current;
+		current = NULL;
+		pthread_cond_broadcast(&cond); // there is now room for the reader to go ahead
+	}
+	while(true){
+		map<uint64_t, unit_t*>::iterator it = done.find(next_seq);
+		if(it != done.end()){
+			current = it->second;
+			done.erase(it);
+			next_seq++;
+			pthread_cond_broadcast(&cond);
+			if(current->out.empty()){
+				// e.g. the empty block that marks the end of a BGZF file
+				delete current;
+				current = NULL;
+				continue;
+			}
+			break;
+		}
+		if(error!="" || stop || (reader_done && next_seq>=Nunits_read)) break;
+		pthread_cond_wait(&cond, &mutex);
+	}
+	pthread_mutex_unlock(&mutex);
+
+	if(!current){
+		setg(NULL, NULL, NULL);
+		return traits_type::eof();
+	}
+
+	char *start = &current->out[0];
+	setg(start, start, start + current->out.size());
+	return traits_type::to_int_type(*gptr());
+}
+
+//---------------------------------
+// ReadFully
+//---------------------------------
+bool JDecompressStreamBuf::ReadFully(char *buff, size_t N, size_t &Nread)
+{
+	/// Read N bytes from the file. Returns false only on a read error.
+	/// Nread may be less than N at the end of the file.
+	Nread = 0;
+	while(Nread < N){
+		ssize_t n = read(fd, &buff[Nread], N-Nread);
+		if(n<0){
+			if(errno==EINTR) continue;
+			SetError(strerror(errno));
+			return false;
+		}
+		if(n==0) break;
+		Nread += n;
+	}
+	Nbytes_in += Nread;
+	return true;
+}
+
+//---------------------------------
+// SetError
+//---------------------------------
+void JDecompressStreamBuf::SetError(const string &err)
+{
+	pthread_mutex_lock(&mutex);
+	if(error==""){
+		error = err;
+		jerr<<"Error decompressing \""<<filename<<"\": "<<err<<endl;
+	}
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+//---------------------------------
+// ReaderLoop
+//---------------------------------
+void JDecompressStreamBuf::ReaderLoop(void)
+{
+	if(format == kBGZF){
+		ReadBGZF();
+	}else{
+		ReadGzip();
+	}
+
+	pthread_mutex_lock(&mutex);
+	reader_done = true;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+//---------------------------------
+// ReadBGZF
+//---------------------------------
+void JDecompressStreamBuf::ReadBGZF(void)
+{
+	/// Read the file one BGZF member at a time and queue each to be
+	/// inflated by the worker threads. The size of each member comes
+	/// from the BC field in its header so nothing needs to be inflated
+	/// to find where the next one starts.
+	while(true){
+		// Don't get more than Nahead blocks ahead of the consumer
+		pthread_mutex_lock(&mutex);
+		while(!stop && error=="" && Nunits_read-next_seq >= Nahead) pthread_cond_wait(&cond, &mutex);
+		bool quit = stop || error!="";
+		pthread_mutex_unlock(&mutex);
+		if(quit) return;
+
+		// Fixed part of header (12 bytes) plus extra field
+		char hdr[12];
+		size_t N;
+		if(!ReadFully(hdr, sizeof(hdr), N)) return;
+		if(N==0) return; // end of file
+		const unsigned char *uhdr = (const unsigned char*)hdr;
+		if(N<sizeof(hdr) || uhdr[0]!=0x1f || uhdr[1]!=0x8b || !(uhdr[3]&0x04)){
+			SetError("bad BGZF block header");
+			return;
+		}
+		uint16_t xlen = uhdr[10] | (uhdr[11]<<8);
+		vector<char> extra(xlen);
+		if(!ReadFully(&extra[0], xlen, N)) return;
+		if(N<xlen){
+			SetError("truncated BGZF block header");
+			return;
+		}
+		uint32_t bsize = 0;
+		for(uint16_t i=0; i+4<=xlen; ){
+			const unsigned char *x = (const unsigned char*)&extra[i];
+			uint16_t slen = x[2] | (x[3]<<8);
+			if(x[0]=='B' && x[1]=='C' && slen==2 && i+6<=xlen) bsize = (x[4] | (x[5]<<8)) + 1;
+			i += 4 + slen;
+		}
+		uint32_t hdr_size = sizeof(hdr) + xlen;
+		if(bsize <= hdr_size + 8){
+			SetError("BGZF block without valid BC field");
+			return;
+		}
+
+		// Copy header and read the rest of the member
+		unit_t *unit = new unit_t;
+		unit->in.resize(bsize);
+		memcpy(&unit->in[0], hdr, sizeof(hdr));
+		if(xlen>0) memcpy(&unit->in[sizeof(hdr)], &extra[0], xlen);
+		if(!ReadFully(&unit->in[hdr_size], bsize-hdr_size, N) || N<bsize-hdr_size){
+			delete unit;
+			if(error=="") SetError("truncated BGZF block");
+			return;
+		}
+
+		pthread_mutex_lock(&mutex);
+		unit->seq = Nunits_read++;
+		work.push_back(unit);
+		pthread_cond_broadcast(&cond);
+		pthread_mutex_unlock(&mutex);
+	}
+}
+
+//---------------------------------
+// WorkerLoop
+//---------------------------------
+void JDecompressStreamBuf::WorkerLoop(void)
+{
+	/// Inflate BGZF members as the reader queues them
+	pthread_mutex_lock(&mutex);
+	while(true){
+		while(work.empty() && !stop && !reader_done && error=="") pthread_cond_wait(&cond, &mutex);
+		if(work.empty() || stop || error!="") break;
+		unit_t *unit = work.front();
+		work.pop_front();
+		pthread_mutex_unlock(&mutex);
+
+		bool ok = Inflate(unit);
+
+		pthread_mutex_lock(&mutex);
+		if(!ok){
+			delete unit;
+			break;
+		}
+		done[unit->seq] = unit;
+		pthread_cond_broadcast(&cond);
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+//---------------------------------
+// Inflate
+//---------------------------------
+bool JDecompressStreamBuf::Inflate(unit_t *unit)
+{
+	/// Inflate a complete BGZF member. The uncompressed size is in
+	/// the last 4 bytes (ISIZE) so the output can be allocated up front.
+#ifdef HAVE_ZLIB
+	size_t Nin = unit->in.size();
+	const unsigned char *in = (const unsigned char*)&unit->in[0];
+	uint32_t isize = in[Nin-4] | (in[Nin-3]<<8) | (in[Nin-2]<<16) | ((uint32_t)in[Nin-1]<<24);
+	unit->out.resize(isize);
+	if(isize==0) return true;
+
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+	if(inflateInit2(&zs, 15+16) != Z_OK){  // 15+16 = expect gzip header
+		SetError("inflateInit2 failed");
+		return false;
+	}
+	zs.next_in = (Bytef*)&unit->in[0];
+	zs.avail_in = Nin;
+	zs.next_out = (Bytef*)&unit->out[0];
+	zs.avail_out = isize;
+	int ret = inflate(&zs, Z_FINISH);
+	inflateEnd(&zs);
+	if(ret != Z_STREAM_END || zs.total_out != isize){
+		SetError(string("corrupt BGZF block: ") + (zs.msg ? zs.msg:"size mismatch"));
+		return false;
+	}
+	__sync_fetch_and_add(&Nbytes_out, (uint64_t)isize);
+	return true;
+#else
+	return false;
+#endif // HAVE_ZLIB
+}
+
+//---------------------------------
+// ReadGzip
+//---------------------------------
+void JDecompressStreamBuf::ReadGzip(void)
+{
+	/// Inflate a generic gzip file in this thread, handing it to the
+	/// consumer in kGzipChunkSize blocks. Concatenated gzip members
+	/// are handled by resetting the inflater at the end of each one.
+#ifdef HAVE_ZLIB
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+	if(inflateInit2(&zs, 15+16) != Z_OK){
+		SetError("inflateInit2 failed");
+		return;
+	}
+
+	vector<char> in(kGzipChunkSize);
+	bool eof = false;
+	bool in_member = false;
+	unit_t *unit = NULL;
+	while(true){
+		if(zs.avail_in==0 && !eof){
+			size_t N;
+			if(!ReadFully(&in[0], in.size(), N)) break;
+			if(N < in.size()) eof = true;
+			zs.next_in = (Bytef*)&in[0];
+			zs.avail_in = N;
+		}
+		if(zs.avail_in==0 && eof){
+			if(in_member) SetError("truncated gzip file");
+			break;
+		}
+
+		if(!unit){
+			// Don't get more than Nahead blocks ahead of the consumer
+			pthread_mutex_lock(&mutex);
+			while(!stop && error=="" && Nunits_read-next_seq >= Nahead) pthread_cond_wait(&cond, &mutex);
+			bool quit = stop || error!="";
+			pthread_mutex_unlock(&mutex);
+			if(quit) break;
+			unit = new unit_t;
+			unit->out.resize(kGzipChunkSize);
+			zs.next_out = (Bytef*)&unit->out[0];
+			zs.avail_out = kGzipChunkSize;
+		}
+
+		in_member = true;
+		int ret = inflate(&zs, Z_NO_FLUSH);
+		if(ret == Z_STREAM_END){
+			// End of a member. There may be another one after it.
+			in_member = false;
+			inflateReset(&zs);
+		}else if(ret != Z_OK && ret != Z_BUF_ERROR){
+			SetError(string("corrupt gzip data: ") + (zs.msg ? zs.msg:""));
+			break;
+		}
+
+		bool last = eof && zs.avail_in==0 && !in_member;
+		if(zs.avail_out==0 || last){
+			unit->out.resize(kGzipChunkSize - zs.avail_out);
+			Nbytes_out += unit->out.size();
+			pthread_mutex_lock(&mutex);
+			unit->seq = Nunits_read++;
+			done[unit->seq] = unit;
+			pthread_cond_broadcast(&cond);
+			pthread_mutex_unlock(&mutex);
+			unit = NULL;
+		}
+		if(last) break;
+	}
+
+	// Hand over whatever is left in the last block
+	if(unit && error=="" && zs.avail_out<kGzipChunkSize){
+		unit->out.resize(kGzipChunkSize - zs.avail_out);
+		Nbytes_out += unit->out.size();
+		pthread_mutex_lock(&mutex);
+		unit->seq = Nunits_read++;
+		done[unit->seq] = unit;
+		pthread_cond_broadcast(&cond);
+		pthread_mutex_unlock(&mutex);
+	}else if(unit){
+		delete unit;
+	}
+	inflateEnd(&zs);
+#endif // HAVE_ZLIB
+}
+
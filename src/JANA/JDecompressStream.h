@@ -0,0 +1,134 @@
+// $Id$
+//
+//    File: JDecompressStream.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JDecompressStream_
+#define _JDecompressStream_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+using std::string;
+using std::vector;
+using std::deque;
+using std::map;
+
+// Place everything in JANA namespace
+namespace jana{
+
+/// JDecompressStreamBuf does the work for JDecompressStream. It
+/// decompresses a gzip file on dedicated threads, keeping a number of
+/// decompressed blocks ready ahead of the reader.
+///
+/// If the file is in the BGZF format (a series of independent gzip
+/// members, each with its compressed size recorded in the header, as
+/// written by bgzip), one thread reads the members off of disk and a pool
+/// of threads inflates them in parallel. Blocks are handed to the
+/// reader in file order.
+///
+/// Any other gzip file (including ones made by concatenating several
+/// gzip files) is inflated by a single thread since the boundaries of
+/// the independent pieces are not known in advance. That thread still
+/// runs ahead of the reader so the decompression overlaps with event
+/// processing.
+
+class JDecompressStreamBuf:public std::streambuf{
+	public:
+
+		enum format_t{
+			kNone = 0,  ///< not compressed
+			kGzip,      ///< gzip (possibly several concatenated members)
+			kBGZF       ///< gzip members that each give their compressed size
+		};
+
+		JDecompressStreamBuf(const string &filename, unsigned int Nthreads=4, unsigned int Nahead=0);
+		virtual ~JDecompressStreamBuf();
+
+		bool IsOpen(void) const {return fd>=0;}
+		const string& GetError(void) const {return error;}
+		format_t GetFormat(void) const {return format;}
+		unsigned int GetNthreads(void) const {return workers.size();}
+		uint64_t GetNbytesCompressed(void) const {return Nbytes_in;}
+		uint64_t GetNbytesDecompressed(void) const {return Nbytes_out;}
+
+		static format_t GetFormat(const string &filename);
+		static const char* GetFormatName(format_t format);
+
+		void ReaderLoop(void); ///< Used internally by reader thread
+		void WorkerLoop(void); ///< Used internally by worker threads
+
+	protected:
+		virtual int_type underflow(void);
+
+		class unit_t{
+			public:
+				uint64_t seq;
+				vector<char> in;
+				vector<char> out;
+		};
+
+		string filename;
+		string error;
+		int fd;
+		format_t format;
+		unsigned int Nahead;
+		uint64_t Nbytes_in;
+		uint64_t Nbytes_out;
+
+		pthread_t reader_thread;
+		bool reader_started;
+		vector<pthread_t> workers;
+		pthread_mutex_t mutex;
+		pthread_cond_t cond;
+		bool stop;
+		bool reader_done;
+		uint64_t Nunits_read;            // number of units given sequence numbers by reader
+		uint64_t next_seq;               // sequence number of next unit to give to consumer
+		deque<unit_t*> work;             // units waiting to be inflated
+		map<uint64_t, unit_t*> done;     // units inflated but not yet consumed
+		unit_t *current;                 // unit being consumed
+
+		bool ReadFully(char *buff, size_t N, size_t &Nread);
+		void SetError(const string &err);
+		bool Inflate(unit_t *unit);
+		void ReadBGZF(void);
+		void ReadGzip(void);
+};
+
+
+/// JDecompressStream is an istream that reads a gzip compressed file
+/// and returns the uncompressed bytes. Decompression happens on
+/// separate threads (see JDecompressStreamBuf) so a JEventSource that
+/// reads its input through an istream can use it in place of an
+/// ifstream. JEventSource::OpenInputStream() picks one or the other
+/// based on the first bytes of the file.
+
+class JDecompressStream:public std::istream{
+	public:
+		JDecompressStream(const string &filename, unsigned int Nthreads=4, unsigned int Nahead=0);
+		virtual ~JDecompressStream(){}
+
+		JDecompressStreamBuf* GetBuf(void){return &buf;}
+		bool IsOpen(void) const {return buf.IsOpen();}
+		const string& GetError(void) const {return buf.GetError();}
+
+		static bool IsCompressed(const string &filename){return JDecompressStreamBuf::GetFormat(filename)!=JDecompressStreamBuf::kNone;}
+
+	protected:
+		JDecompressStreamBuf buf;
+};
+
+} // Close JANA namespace
+
+#endif // _JDecompressStream_
+
@@ -21,6 +21,7 @@ JEvent::JEvent()
 	run_number = 0;
 	ref = NULL;
 	status = 0L;
+	sequence = 0;
 	sequential = false;
 }
 
@@ -47,6 +47,7 @@ class JEvent{
 		               inline void SetJEventLoop(JEventLoop *loop){this->loop=loop;}
 		               inline void FreeEvent(void){if(source)source->JEventSource::FreeEvent(*this);}
 				   inline uint64_t GetID(void) const { return id; }
+				   inline uint64_t GetSequence(void) const { return sequence; } ///< Position in the order events were read (first is 1). 0 if not read through the event buffer
 		                      void Print(void);
 
 		                  uint64_t GetStatus(void){return status;}
@@ -67,11 +68,13 @@ class JEvent{
 		JEventLoop *loop;
 		uint64_t status;
 		uint64_t id;
+		uint64_t sequence;
 		bool sequential;  ///< set to in event source to treat this as a barrier event (i.e. no other events will be processed in parallel with this one)
 		
 				   inline void SetID(uint64_t id){ this->id = id; }
+				   inline void SetSequence(uint64_t sequence){ this->sequence = sequence; }
 
-		// Both of these classes need to call SetID
+		// Both of these classes need to call SetID (JApplication also SetSequence)
 		friend class JEventSource;
 		friend class JApplication;
 };
@@ -94,7 +97,7 @@ jerror_t JEvent::GetObjects(vector<const T*> &t, JFactory_base *factory)
 	// Get list of object pointers. This will read the objects in
 	// from the source, instantiating them and handing ownership of
 	// them over to the factory object. 
-	jerror_t err = source->GetObjects(*this, factory);
+	jerror_t err = source->GetObjectsTimed(*this, factory);
 	if(err != NOERROR)return err; // if OBJECT_NOT_AVAILABLE is returned, the source could not provide the objects
 	
 	// OK, must have found some objects (possibly even zero) in the source.
@@ -0,0 +1,234 @@
+// $Id$
+//
+//    File: JEventIndex.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <sstream>
+using namespace std;
+
+#include "JEventIndex.h"
+using namespace jana;
+
+namespace{
+
+	// Start of the sidecar file. It is followed by Nentries Entry objects
+	// sorted by (run, event). The file is written in native byte order.
+	class FileHeader{
+		public:
+			char magic[4];          // "JIDX"
+			uint32_t version;
+			uint64_t source_size;   // size of source file in bytes
+			int64_t source_mtime;   // modification time of source file (s)
+			uint64_t Nentries;
+	};
+
+	const uint32_t kVersion = 1;
+
+	//-------------
+	// EntryLess
+	//-------------
+	bool EntryLess(const JEventIndex::Entry &a, const JEventIndex::Entry &b)
+	{
+		if(a.run != b.run) return a.run < b.run;
+		if(a.event != b.event) return a.event < b.event;
+		return a.ordinal < b.ordinal;
+	}
+
+	//-------------
+	// StatSource
+	//-------------
+	bool StatSource(const string &source_filename, uint64_t &size, int64_t &mtime)
+	{
+		struct stat st;
+		if(stat(source_filename.c_str(), &st) != 0) return false;
+		size = st.st_size;
+		mtime = st.st_mtime;
+		return true;
+	}
+}
+
+//---------------------------------
+// JEventIndex    (Constructor)
+//---------------------------------
+JEventIndex::JEventIndex()
+{
+	finished = false;
+}
+
+//---------------------------------
+// Clear
+//---------------------------------
+void JEventIndex::Clear(void)
+{
+	entries.clear();
+	by_ordinal.clear();
+	run_starts.clear();
+	finished = false;
+}
+
+//---------------------------------
+// Add
+//---------------------------------
+void JEventIndex::Add(int32_t run, uint64_t event, uint64_t offset, uint64_t size)
+{
+	/// Add the next event of the file. Events must be added in the
+	/// order they are in the file.
+	Entry e;
+	e.run = run;
+	e.unused = 0;
+	e.event = event;
+	e.offset = offset;
+	e.size = size;
+	e.ordinal = entries.size();
+	entries.push_back(e);
+	finished = false;
+}
+
+//---------------------------------
+// Finish
+//---------------------------------
+void JEventIndex::Finish(void)
+{
+	/// Sort the entries for lookup. Call this once all events have
+	/// been added.
+	stable_sort(entries.begin(), entries.end(), EntryLess);
+	MakeLookupTables();
+}
+
+//---------------------------------
+// MakeLookupTables
+//---------------------------------
+void JEventIndex::MakeLookupTables(void)
+{
+	by_ordinal.assign(entries.size(), 0);
+	run_starts.clear();
+	for(uint64_t i=0; i<entries.size(); i++){
+		if(entries[i].ordinal < by_ordinal.size()) by_ordinal[entries[i].ordinal] = i;
+		if(i==0 || entries[i].run != entries[i-1].run) run_starts.push_back(i);
+	}
+	finished = true;
+}
+
+//---------------------------------
+// Read
+//---------------------------------
+bool JEventIndex::Read(const string &index_filename, const string &source_filename)
+{
+	/// Read the index from the given sidecar file. Returns false
+	/// (leaving the index empty) if the file does not exist, is not
+	/// an index file, or was made from a different version of the
+	/// source file.
+	Clear();
+
+	uint64_t source_size;
+	int64_t source_mtime;
+	if(!StatSource(source_filename, source_size, source_mtime)) return false;
+
+	FILE *f = fopen(index_filename.c_str(), "rb");
+	if(!f) return false;
+
+	FileHeader header;
+	bool ok = fread(&header, sizeof(header), 1, f) == 1;
+	ok = ok && strncmp(header.magic, "JIDX", 4)==0 && header.version==kVersion;
+	ok = ok && header.source_size==source_size && header.source_mtime==source_mtime;
+
+	// Make sure the file really holds Nentries entries before allocating
+	// space for them. (A corrupt header could ask for any amount.)
+	struct stat st;
+	ok = ok && fstat(fileno(f), &st)==0 && st.st_size>=(off_t)sizeof(header);
+	ok = ok && header.Nentries <= ((uint64_t)st.st_size - sizeof(header))/sizeof(Entry);
+	if(ok){
+		entries.resize(header.Nentries);
+		if(header.Nentries>0) ok = fread(&entries[0], sizeof(Entry), header.Nentries, f) == header.Nentries;
+	}
+	fclose(f);
+
+	if(!ok){
+		Clear();
+		return false;
+	}
+
+	MakeLookupTables();
+	return true;
+}
+
+//---------------------------------
+// Write
+//---------------------------------
+bool JEventIndex::Write(const string &index_filename, const string &source_filename) const
+{
+	/// Write the index to the given sidecar file. It is written to a
+	/// temporary file first and then renamed so other processes never
+	/// see a partial index.
+	FileHeader header;
+	memcpy(header.magic, "JIDX", 4);
+	header.version = kVersion;
+	header.Nentries = entries.size();
+	if(!finished || !StatSource(source_filename, header.source_size, header.source_mtime)) return false;
+
+	stringstream ss;
+	ss<<index_filename<<".tmp"<<getpid();
+	string tmp_filename = ss.str();
+	FILE *f = fopen(tmp_filename.c_str(), "wb");
+	if(!f) return false;
+
+	bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+	if(ok && !entries.empty()) ok = fwrite(&entries[0], sizeof(Entry), entries.size(), f) == entries.size();
+	ok = (fclose(f)==0) && ok;
+	ok = ok && rename(tmp_filename.c_str(), index_filename.c_str())==0;
+	if(!ok) unlink(tmp_filename.c_str());
+
+	return ok;
+}
+
+//---------------------------------
+// Find
+//---------------------------------
+const JEventIndex::Entry* JEventIndex::Find(int32_t run, uint64_t event) const
+{
+	/// Return the entry for the given run and event or NULL if it is
+	/// not in the index. If the file has the same event more than once,
+	/// the first one in the file is returned.
+	Entry e;
+	e.run = run;
+	e.event = event;
+	e.ordinal = 0;
+	vector<Entry>::const_iterator it = lower_bound(entries.begin(), entries.end(), e, EntryLess);
+	if(it==entries.end() || it->run!=run || it->event!=event) return NULL;
+	return &(*it);
+}
+
+//---------------------------------
+// Find
+//---------------------------------
+const JEventIndex::Entry* JEventIndex::Find(uint64_t event) const
+{
+	/// Return the entry for the given event number in whichever run
+	/// it is in. If more than one run has it, the first run (lowest
+	/// run number) is used. This does one binary search per run in the
+	/// file which is normally just one.
+	for(unsigned int i=0; i<run_starts.size(); i++){
+		const Entry *e = Find(entries[run_starts[i]].run, event);
+		if(e) return e;
+	}
+	return NULL;
+}
+
+//---------------------------------
+// GetByOrdinal
+//---------------------------------
+const JEventIndex::Entry* JEventIndex::GetByOrdinal(uint64_t ordinal) const
+{
+	/// Return the entry for the ordinal-th event in the file (the first
+	/// is 0) or NULL if there are not that many.
+	if(ordinal >= by_ordinal.size()) return NULL;
+	return &entries[by_ordinal[ordinal]];
+}
@@ -0,0 +1,79 @@
+// $Id$
+//
+//    File: JEventIndex.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JEventIndex_
+#define _JEventIndex_
+
+#include <stdint.h>
+
+#include <vector>
+#include <string>
+using std::vector;
+using std::string;
+
+// Place everything in JANA namespace
+namespace jana{
+
+/// JEventIndex maps (run, event number) to where the event is in a
+/// source file. It is kept in a sidecar file next to the source
+/// (the source name with ".jidx" appended) so it only has to be made
+/// once. The sidecar records the size and modification time of the
+/// source file and is ignored if the source has changed since.
+///
+/// Entries are added in file order with Add() while the file is read
+/// (or scanned by the janaindex utility). Finish() must be called
+/// after the last one. Lookups are a binary search on (run, event).
+///
+/// The "offset" of an entry is whatever the source needs to find the
+/// event again. For sources derived from JEventSourceMMap it is the
+/// byte offset in the file.
+
+class JEventIndex{
+	public:
+
+		class Entry{
+			public:
+				int32_t run;
+				uint32_t unused;    ///< padding (keeps file layout fixed)
+				uint64_t event;
+				uint64_t offset;    ///< where the source finds the event (e.g. byte offset)
+				uint64_t size;      ///< size of event in bytes (0 if not known)
+				uint64_t ordinal;   ///< position of event in file (first is 0)
+		};
+
+		JEventIndex();
+		virtual ~JEventIndex(){}
+
+		void Clear(void);
+		void Add(int32_t run, uint64_t event, uint64_t offset, uint64_t size);
+		void Finish(void);
+
+		bool Read(const string &index_filename, const string &source_filename);
+		bool Write(const string &index_filename, const string &source_filename) const;
+
+		const Entry* Find(int32_t run, uint64_t event) const;
+		const Entry* Find(uint64_t event) const;       ///< Find event in any run
+		const Entry* GetByOrdinal(uint64_t ordinal) const;
+
+		uint64_t GetNevents(void) const {return entries.size();}
+		const vector<Entry>& GetEntries(void) const {return entries;}  ///< sorted by (run, event)
+
+		static string GetIndexFilename(const string &source_filename){return source_filename + ".jidx";}
+
+	protected:
+		vector<Entry> entries;          // sorted by (run, event) once Finish is called
+		vector<uint64_t> by_ordinal;    // index into entries for each ordinal
+		vector<uint64_t> run_starts;    // index into entries of first entry of each run
+		bool finished;
+
+		void MakeLookupTables(void);
+};
+
+} // Close JANA namespace
+
+#endif // _JEventIndex_
+
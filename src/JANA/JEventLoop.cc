@@ -20,6 +20,8 @@ using namespace std;
 #include "JApplication.h"
 #include "JEventLoop.h"
 #include "JEvent.h"
+#include "JEventSink.h"
+#include "JOrderedOutput.h"
 #include "JFactory.h"
 #include "JStreamLog.h"
 #include "JException.h"
@@ -60,19 +62,30 @@ void thread_HUP_sighandler(int sig)
 //---------------------------------
 // JEventLoop    (Constructor)
 //---------------------------------
-JEventLoop::JEventLoop(JApplication *app)
+JEventLoop::JEventLoop(JApplication *app, bool has_thread)
 {
+	/// If has_thread is false, this JEventLoop is not run by a thread of
+	/// its own. Instead, processing threads borrow it to process events
+	/// in (see JOrderedOutput). It is not counted or monitored as one of
+	/// the JApplication's threads.
+
 	// Last Resort exit strategy: If this thread stops responding, the
 	// main thread will send it a HUP signal to tell it to exit immediately.
 	signal(SIGHUP, thread_HUP_sighandler);
 
 	this->app = app;
+	this->has_thread = has_thread;
+	thread_loop = NULL;
 	jthread = NULL; // should be overwritten in AddJEventLoop
-	app->AddJEventLoop(this);
+	app->AddJEventLoop(this, has_thread);
 	event.SetJEventLoop(this);
 	initialized = false;
 	print_parameters_called = false;
 	record_call_stack = false;
+	factory_monitor = NULL;
+	factory_cache = app->GetFactoryCache();
+	stats_slot = NULL;
+	stats_slot_allocated = false;
 	pause = 0;
 	quit = 0;
 	auto_free = 1;
@@ -94,6 +107,10 @@ JEventLoop::JEventLoop(JApplication *app)
 	caller_tag = "";
 
 	event_boundaries_run = 0;
+	first_sink = 0;
+	ordered_output = NULL;
+	ordered_sequence = 0;
+	ordered_work = NULL;
 }
 
 //---------------------------------
@@ -105,6 +122,15 @@ JEventLoop::~JEventLoop()
 	/// when there are no more JEventLoops registered with it.
 	app->RemoveJEventLoop(this);
 
+	// If we are going away before our event was written, make sure
+	// the events after it are not held up waiting for it.
+	if(ordered_output && ordered_work) ordered_output->Abandon(ordered_work);
+	if(ordered_output && ordered_sequence!=0) ordered_output->Abandon(this);
+
+	// Release our slot in the shared memory statistics segment
+	if(stats_slot && app->GetStatsSegment()) app->GetStatsSegment()->FreeThreadSlot(stats_slot);
+	stats_slot = NULL;
+
 	// Call all factories' erun methods
 	for(unsigned int i=0; i<factories.size(); i++){
 		try{
@@ -157,6 +183,11 @@ JEventLoop::~JEventLoop()
 void JEventLoop::RefreshProcessorListFromJApplication(void)
 {
 	processors = app->GetProcessors();
+
+	// JApplication keeps JEventSinks after all other processors
+	for(first_sink=0; first_sink<processors.size(); first_sink++){
+		if(dynamic_cast<JEventSink*>(processors[first_sink]) != NULL) break;
+	}
 }
 
 //-------------
@@ -448,6 +479,7 @@ void JEventLoop::Initialize(void)
 
 	// Copy the event processor list to our local vector
 	RefreshProcessorListFromJApplication();
+	ordered_output = app->GetOrderedOutput();
 
 	string autoactivate;
 	try{
@@ -577,8 +609,19 @@ jerror_t JEventLoop::OneEvent(void)
 	getitimer(ITIMER_REAL, &tmr);
 	double start_time = tmr.it_value.tv_sec + tmr.it_value.tv_usec/1.0E6;
 
+	// With ordered output, the event is processed in a JEventLoop
+	// borrowed from it. That one is handed back to it with the event
+	// for the sinks to be called in order while this thread goes on
+	// to the next event.
+	JEventLoop *loop = this;
+	if(ordered_output){
+		loop = ordered_output->GetLoop(this);
+		ordered_work = loop;
+	}
+	JEvent &event = loop->event;
+
 	// Clear evnt_called flag in all factories
-	ClearFactories();
+	loop->ClearFactories();
 
 	// Try to read in an event
 	jerror_t err = NOERROR;
@@ -614,19 +657,102 @@ jerror_t JEventLoop::OneEvent(void)
 		default:
 			break;
 	}
-	if(err != NOERROR && err !=EVENT_NOT_IN_MEMORY)return err;
+	if(err != NOERROR && err !=EVENT_NOT_IN_MEMORY){
+		if(ordered_work && ordered_work->ordered_sequence==0){
+			ordered_output->Release(ordered_work);
+			ordered_work = NULL;
+		}
+		return err;
+	}
+
+	// Don't get too far ahead of the events being written in order
+	if(ordered_output && event.GetSequence()!=0){
+		loop->ordered_sequence = event.GetSequence();
+		ordered_output->WaitForWindow(loop);
+	}
+
+	// Let external monitors know what we're working on in case we stall
+	if(stats_slot){
+		stats_slot->run_number = event.GetRunNumber();
+		stats_slot->event_number = event.GetEventNumber();
+	}
 		
 	// Initialize the factory call stacks
-	error_call_stack.clear();
-	if(record_call_stack){
-		caller_name = "AutoActivated";
-		caller_tag = "";
-		call_stack.clear();
+	loop->error_call_stack.clear();
+	if(loop->record_call_stack){
+		loop->caller_name = "AutoActivated";
+		loop->caller_tag = "";
+		loop->call_stack.clear();
 	}
 
 	// Loop over the list of factories to "auto activate" and activate them
-	for(unsigned int i=0; i<auto_activated_factories.size(); i++){
-		pair<string, string> &facname = auto_activated_factories[i];
+	loop->ActivateFactories(loop->auto_activated_factories);
+
+	// Call Event Processors. If ordered output is enabled, the sinks
+	// are called from its thread in the order events were read. It
+	// also frees the event once it has done that.
+	uint64_t event_number = event.GetEventNumber();
+	int32_t run_number = event.GetRunNumber();
+	unsigned int Nprocessors = loop->ordered_sequence!=0 ? loop->first_sink:loop->processors.size();
+	for(unsigned int i=0; i<Nprocessors; i++) loop->CallProcessor(loop->processors[i], run_number, event_number);
+	if(loop != this){
+		// Loop() only sees this JEventLoop's event so let the event
+		// buffer thread know about barrier events here.
+		if(event.GetSequential()) app->SetSequentialEventComplete();
+		if(stats_slot) loop->PublishFactoryStats();
+		ordered_work = NULL;
+		if(loop->ordered_sequence!=0){
+			ordered_output->Write(loop);
+		}else{
+			if(auto_free)event.FreeEvent();
+			ordered_output->Release(loop);
+		}
+	}else{
+		if(auto_free)event.FreeEvent();
+	}
+	
+	// Get timer value at end of event and record rates
+	getitimer(ITIMER_REAL, &tmr);
+	double end_time = tmr.it_value.tv_sec + tmr.it_value.tv_usec/1.0E6;
+	delta_time_single = start_time - end_time;
+	delta_time_rate += delta_time_single;
+	Nevents_rate++;
+	delta_time += delta_time_single;
+	Nevents++;
+	if(delta_time_rate>2.0 && Nevents_rate>0){
+		rate_instantaneous = (double)Nevents_rate/delta_time_rate;
+		Nevents_rate = 0;
+		delta_time_rate = 0.0;
+	}
+	if(delta_time>0.5){
+		rate_integrated = (double)Nevents/delta_time;
+	}
+
+	// Update shared memory statistics segment (if any)
+	PublishStats();
+	
+	// We want to print the parameters after the first event so that defaults
+	// set by init or brun methods or even data objects created during the
+	// processing of the event will be included. This is not foolproof since
+	// some of these things may not occur until many events in. This also 
+	// pushes any error messages from the first event further up the screen.
+	if(!print_parameters_called){
+		print_parameters_called = true;
+		app->GetJParameterManager()->PrintParameters();
+	}
+
+	return NOERROR;
+}
+
+//-------------
+// ActivateFactories
+//-------------
+void JEventLoop::ActivateFactories(const vector<pair<string,string> > &facnames)
+{
+	/// Activate the given factories (by data name and tag) for the
+	/// current event if they have not been already.
+	for(unsigned int i=0; i<facnames.size(); i++){
+		const pair<string, string> &facname = facnames[i];
 		JFactory_base *fac = GetFactory(facname.first, (facname.second).c_str());
 		try{
 			if(fac) fac->GetNrows(record_call_stack); // if recording call stack, force GetNrows to call "Get" whether it needs to or not
@@ -640,96 +766,298 @@ jerror_t JEventLoop::OneEvent(void)
 			throw e;
 		}		
 	}
+}
+
+//-------------
+// ReadPipelineEvent
+//-------------
+jerror_t JEventLoop::ReadPipelineEvent(void)
+{
+	/// Read in the next event when this JEventLoop is used by a JPipeline.
+	/// The event is then processed by calling ProcessPipelineStage()
+	/// for each stage (possibly from different threads) and finally
+	/// EndPipelineEvent(). Together these do what OneEvent() does.
+	if(!initialized)Initialize();
+
+	ClearFactories();
+
+	jerror_t err = app->NextEvent(event);
+	if(err == EVENT_NOT_IN_MEMORY){
+		jerr<<endl<<"Event not in memory"<<endl;
+	}else if(err != NOERROR){
+		return err;
+	}
+
+	if(stats_slot){
+		stats_slot->run_number = event.GetRunNumber();
+		stats_slot->event_number = event.GetEventNumber();
+	}
+
+	error_call_stack.clear();
+	if(record_call_stack){
+		caller_name = "AutoActivated";
+		caller_tag = "";
+		call_stack.clear();
+	}
+
+	return NOERROR;
+}
+
+//-------------
+// ProcessPipelineStage
+//-------------
+void JEventLoop::ProcessPipelineStage(const vector<pair<string,string> > &facnames, bool autoactivate, bool call_processors, bool call_sinks)
+{
+	/// Do the work of one JPipeline stage for the current event. This
+	/// activates the given factories (and the AUTOACTIVATE ones if
+	/// autoactivate is true) and then calls the JEventProcessors
+	/// and/or JEventSinks.
+	if(autoactivate) ActivateFactories(auto_activated_factories);
+	ActivateFactories(facnames);
 
-	// Call Event Processors
 	uint64_t event_number = event.GetEventNumber();
 	int32_t run_number = event.GetRunNumber();
-	vector<JEventProcessor*>::iterator p = processors.begin();
+	if(call_processors){
+		for(unsigned int i=0; i<first_sink; i++) CallProcessor(processors[i], run_number, event_number);
+	}
+	if(call_sinks){
+		for(unsigned int i=first_sink; i<processors.size(); i++) CallProcessor(processors[i], run_number, event_number);
+	}
+}
 
-	for(; p!=processors.end(); p++){
-		JEventProcessor *proc = *p;
+//-------------
+// EndPipelineEvent
+//-------------
+void JEventLoop::EndPipelineEvent(void)
+{
+	/// Finish with the current event after the last JPipeline stage
+	/// (or after a stage failed).
+	if(auto_free)event.FreeEvent();
+	Nevents++;
 
-//_DBG_<<"Setting caller_name to\""<<proc->className()<<"\""<<endl;
-		if(record_call_stack){
-			caller_name = proc->className();
-			caller_tag = "";
-		}
+	PublishStats();
 
-		// Call brun routine if run number has changed or it's not been called
-		proc->LockState();
-		if(run_number!=proc->GetBRUN_RunNumber()){
-			if(proc->brun_was_called() && !proc->erun_was_called()){
-				try{
-					proc->erun();
-					proc->Set_erun_called();
-				}catch(exception &e){
-					error_call_stack_t cs = {"JEventLoop", "OneEvent  (erun)", __FILE__, __LINE__};
-					error_call_stack.push_back(cs);
-					PrintErrorCallStack();
-					_DBG_<<ansi_bold<<" EXCEPTION : "<<e.what()<< ansi_normal << endl;
-					throw e;
-				}
-			}
-			proc->Clear_brun_called();
+	if(!print_parameters_called){
+		print_parameters_called = true;
+		app->GetJParameterManager()->PrintParameters();
+	}
+
+	// If this was a barrier event then notify event buffer thread
+	// that we have finished processing it.
+	if(event.GetSequential()) app->SetSequentialEventComplete();
+}
+
+//-------------
+// WarmUp
+//-------------
+void JEventLoop::WarmUp(JEvent &warmup_event, bool all_factories)
+{
+	/// Do the per-run setup that processing the given event would cause
+	/// without calling the processors' evnt methods. brun is called for
+	/// all processors and the AUTOACTIVATE factories (or all factories
+	/// if all_factories is true) are activated so they fetch their
+	/// calibrations, geometry, etc. This is used before forking the
+	/// JANA:NPROCESSES worker processes so what gets loaded is shared by
+	/// them. Exceptions from factories are reported and otherwise ignored.
+	/// The event is not freed.
+	if(!initialized)Initialize();
+
+	ClearFactories();
+	event.SetJEventSource(warmup_event.GetJEventSource());
+	event.SetRunNumber(warmup_event.GetRunNumber());
+	event.SetEventNumber(warmup_event.GetEventNumber());
+	event.SetRef(warmup_event.GetRef());
+	event.SetStatus(warmup_event.GetStatus());
+
+	int32_t run_number = event.GetRunNumber();
+	for(unsigned int i=0; i<processors.size(); i++) CallBeginRun(processors[i], run_number);
+
+	vector<pair<string,string> > facnames = auto_activated_factories;
+	if(all_factories){
+		for(unsigned int i=0; i<factories.size(); i++){
+			facnames.push_back(pair<string,string>(factories[i]->GetDataClassName(), factories[i]->Tag()));
+		}
+	}
+	for(unsigned int i=0; i<facnames.size(); i++){
+		vector<pair<string,string> > facname(1, facnames[i]);
+		try{
+			ActivateFactories(facname);
+		}catch(exception &e){
+			jerr<<"Exception while warming up factory "<<facnames[i].first<<":"<<facnames[i].second<<" (ignored): "<<e.what()<<endl;
 		}
-		if(!proc->brun_was_called()){
+	}
+
+	ClearFactories();
+}
+
+//-------------
+// CallProcessor
+//-------------
+void JEventLoop::CallProcessor(JEventProcessor *proc, int32_t run_number, uint64_t event_number)
+{
+	/// Call the given processor's evnt method for the current event,
+	/// calling its erun and brun methods first if the run number
+	/// has changed.
+
+//_DBG_<<"Setting caller_name to\""<<proc->className()<<"\""<<endl;
+	if(record_call_stack){
+		caller_name = proc->className();
+		caller_tag = "";
+	}
+
+	CallBeginRun(proc, run_number);
+
+	// Call the event routine
+	try{
+		proc->evnt(this, event_number);
+	}catch(exception &e){
+		error_call_stack_t cs = {"JEventLoop", "OneEvent  (evnt)", __FILE__, __LINE__};
+		error_call_stack.push_back(cs);
+		PrintErrorCallStack();
+		_DBG_<<ansi_bold<<" EXCEPTION : "<<e.what()<< ansi_normal << endl;
+		throw e;
+	}
+}
+
+//-------------
+// CallBeginRun
+//-------------
+void JEventLoop::CallBeginRun(JEventProcessor *proc, int32_t run_number)
+{
+	/// Call the given processor's brun method if it has not been called
+	/// for this run number, calling erun for the previous run first.
+
+	// Call brun routine if run number has changed or it's not been called
+	proc->LockState();
+	if(run_number!=proc->GetBRUN_RunNumber()){
+		if(proc->brun_was_called() && !proc->erun_was_called()){
 			try{
-				proc->brun(this, run_number);
-				proc->Set_brun_called();
-				proc->Clear_erun_called();
-				proc->SetBRUN_RunNumber(run_number);
+				proc->erun();
+				proc->Set_erun_called();
 			}catch(exception &e){
-				error_call_stack_t cs = {"JEventLoop", "OneEvent  (brun)", __FILE__, __LINE__};
+				error_call_stack_t cs = {"JEventLoop", "OneEvent  (erun)", __FILE__, __LINE__};
 				error_call_stack.push_back(cs);
 				PrintErrorCallStack();
 				_DBG_<<ansi_bold<<" EXCEPTION : "<<e.what()<< ansi_normal << endl;
+				proc->UnlockState();
 				throw e;
 			}
 		}
-		proc->UnlockState();
-
-		// Call the event routine
+		proc->Clear_brun_called();
+	}
+	if(!proc->brun_was_called()){
 		try{
-			proc->evnt(this, event_number);
+			proc->brun(this, run_number);
+			proc->Set_brun_called();
+			proc->Clear_erun_called();
+			proc->SetBRUN_RunNumber(run_number);
 		}catch(exception &e){
-			error_call_stack_t cs = {"JEventLoop", "OneEvent  (evnt)", __FILE__, __LINE__};
+			error_call_stack_t cs = {"JEventLoop", "OneEvent  (brun)", __FILE__, __LINE__};
 			error_call_stack.push_back(cs);
 			PrintErrorCallStack();
 			_DBG_<<ansi_bold<<" EXCEPTION : "<<e.what()<< ansi_normal << endl;
+			proc->UnlockState();
 			throw e;
 		}
 	}
+	proc->UnlockState();
+}
 
-	if(auto_free)event.FreeEvent();
-	
-	// Get timer value at end of event and record rates
-	getitimer(ITIMER_REAL, &tmr);
-	double end_time = tmr.it_value.tv_sec + tmr.it_value.tv_usec/1.0E6;
-	delta_time_single = start_time - end_time;
-	delta_time_rate += delta_time_single;
-	Nevents_rate++;
-	delta_time += delta_time_single;
-	Nevents++;
-	if(delta_time_rate>2.0 && Nevents_rate>0){
-		rate_instantaneous = (double)Nevents_rate/delta_time_rate;
-		Nevents_rate = 0;
-		delta_time_rate = 0.0;
+//-------------
+// CallSinks
+//-------------
+void JEventLoop::CallSinks(void)
+{
+	/// Call the JEventSink processors for the current event. This is
+	/// called from the JOrderedOutput thread once the thread that
+	/// processed the event has handed this JEventLoop to it.
+	uint64_t event_number = event.GetEventNumber();
+	int32_t run_number = event.GetRunNumber();
+	for(unsigned int i=first_sink; i<processors.size(); i++) CallProcessor(processors[i], run_number, event_number);
+}
+
+//-------------
+// PublishStats
+//-------------
+void JEventLoop::PublishStats(void)
+{
+	/// Copy this thread's statistics into its slot in the shared memory
+	/// statistics segment owned by the JApplication. Only this thread
+	/// writes to its slot so no locking is needed. Factory call counts
+	/// are summed over all threads so only the change since the last
+	/// call is added to the shared factory slots (atomically).
+	if(!stats_slot){
+		// Only try to get a slot once
+		if(stats_slot_allocated) return;
+		stats_slot_allocated = true;
+		JStatsSegment *seg = app->GetStatsSegment();
+		if(seg) stats_slot = seg->AllocThreadSlot((uint64_t)pthread_id);
+		if(!stats_slot) return;
 	}
-	if(delta_time>0.5){
-		rate_integrated = (double)Nevents/delta_time;
+
+	stats_slot->Nevents = Nevents;
+	stats_slot->rate_instantaneous = rate_instantaneous;
+	stats_slot->rate_integrated = rate_integrated;
+	stats_slot->last_event_time = delta_time_single;
+	if(!ordered_output){
+		// With ordered output, events are processed in borrowed
+		// JEventLoops. OneEvent() sets these for each event instead.
+		stats_slot->run_number = event.GetRunNumber();
+		stats_slot->event_number = event.GetEventNumber();
 	}
-	
-	// We want to print the parameters after the first event so that defaults
-	// set by init or brun methods or even data objects created during the
-	// processing of the event will be included. This is not foolproof since
-	// some of these things may not occur until many events in. This also 
-	// pushes any error messages from the first event further up the screen.
-	if(!print_parameters_called){
-		print_parameters_called = true;
-		app->GetJParameterManager()->PrintParameters();
+
+	PublishFactoryStats();
+}
+
+//-------------
+// PublishFactoryStats
+//-------------
+void JEventLoop::PublishFactoryStats(void)
+{
+	/// Add the change in the call counts of this JEventLoop's factories
+	/// since the last call to the shared factory slots. This is called
+	/// by PublishStats() and, for JEventLoops without a thread of their
+	/// own, by the thread that borrowed it (see OneEvent()).
+	JStatsSegment *seg = app->GetStatsSegment();
+	if(!seg) return;
+
+	// The list of factories can change (rarely) so make sure our cache
+	// of shared factory slots still lines up with it.
+	bool resync = stats_factories.size()!=factories.size();
+	for(unsigned int i=0; !resync && i<factories.size(); i++){
+		if(stats_factories[i].fac != factories[i]) resync = true;
+	}
+	if(resync){
+		vector<stats_factory_t> new_stats_factories;
+		for(unsigned int i=0; i<factories.size(); i++){
+			stats_factory_t sf = {factories[i], NULL, 0, 0, 0};
+			for(unsigned int j=0; j<stats_factories.size(); j++){
+				if(stats_factories[j].fac == factories[i]){ sf = stats_factories[j]; break; }
+			}
+			if(sf.slot == NULL){
+				string nametag = factories[i]->GetDataClassName();
+				string tag = factories[i]->Tag();
+				if(tag != "") nametag += ":" + tag;
+				sf.slot = seg->GetFactorySlot(nametag);
+			}
+			new_stats_factories.push_back(sf);
+		}
+		stats_factories.swap(new_stats_factories);
 	}
 
-	return NOERROR;
+	for(unsigned int i=0; i<stats_factories.size(); i++){
+		stats_factory_t &sf = stats_factories[i];
+		if(!sf.slot) continue;
+		unsigned int calls = sf.fac->GetNcalls();
+		unsigned int gencalls = sf.fac->GetNgencalls();
+		if(calls != sf.last_calls) __sync_fetch_and_add(&sf.slot->Ncalls, (uint64_t)(calls - sf.last_calls));
+		if(gencalls != sf.last_gencalls) __sync_fetch_and_add(&sf.slot->Ngencalls, (uint64_t)(gencalls - sf.last_gencalls));
+		uint64_t evnt_ticks = sf.fac->GetEvntTicks();
+		if(evnt_ticks != sf.last_evnt_ticks) __sync_fetch_and_add(&sf.slot->evnt_ns, evnt_ticks - sf.last_evnt_ticks);
+		sf.last_calls = calls;
+		sf.last_gencalls = gencalls;
+		sf.last_evnt_ticks = evnt_ticks;
+	}
 }
 
 //-------------
@@ -9,6 +9,8 @@
 #define _JEventLoop_
 
 #include <sys/time.h>
+#include <time.h>
+#include <stdint.h>
 
 #include <vector>
 #include <list>
@@ -29,6 +31,8 @@ using std::type_info;
 #include <JANA/JEvent.h>
 #include <JANA/JThread.h>
 #include <JANA/JFactory_base.h>
+#include <JANA/JFactoryMonitor.h>
+#include <JANA/JStatsSegment.h>
 #include <JANA/JCalibration.h>
 #include <JANA/JGeometry.h>
 #include <JANA/JResourceManager.h>
@@ -45,12 +49,16 @@ namespace jana{
 template<class T> class JFactory;
 class JApplication;
 class JEventProcessor;
+class JOrderedOutput;
+class JFactoryCache;
 
 
 class JEventLoop{
 	public:
 	
 		friend class JApplication;
+		friend class JOrderedOutput;
+		friend class JPipeline;
 	
 		enum data_source_t{
 			DATA_NOT_AVAILABLE = 1,
@@ -64,8 +72,10 @@ class JEventLoop{
 			string caller_tag;
 			string callee_name;
 			string callee_tag;
-			double start_time;
-			double end_time;
+			double start_time;     // seconds (kept for backwards compatibility)
+			double end_time;       // seconds (kept for backwards compatibility)
+			uint64_t start_ticks;  // see JEventLoop::GetTicks()
+			uint64_t end_ticks;    // see JEventLoop::GetTicks()
 			data_source_t data_source;
 		}call_stack_t;
 		
@@ -76,7 +86,7 @@ class JEventLoop{
 			int line;
 		}error_call_stack_t;
 
-	                                   JEventLoop(JApplication *app); ///< Constructor
+	                                   JEventLoop(JApplication *app, bool has_thread=true); ///< Constructor
 							   virtual ~JEventLoop(); ////< Destructor
 				   virtual const char* className(void){return static_className();}
 					static const char* static_className(void){return "JEventLoop";}
@@ -91,6 +101,9 @@ class JEventLoop{
                                   void GetFactoryNames(map<string,string> &factorynames); ///< Get names of all factories in map with key=name, value=tag
                     map<string,string> GetDefaultTags(void) const {return default_tags;}
                               jerror_t ClearFactories(void); ///< Reset all factories in preparation for next event.
+                                  void SetFactoryMonitor(JFactoryMonitor *monitor){factory_monitor = monitor;} ///< Set object to be notified around every factory evnt call (NULL to disable)
+                      JFactoryMonitor* GetFactoryMonitor(void){return factory_monitor;} ///< Get object notified around every factory evnt call (may be NULL)
+                        JFactoryCache* GetFactoryCache(void){return factory_cache;} ///< Get cache of factory outputs (NULL if not enabled)
 							  jerror_t PrintFactories(int sparsify=0); ///< Print a list of all factories.
                               jerror_t Print(const string data_name, const char *tag=""); ///< Print the data of the given type
 
@@ -111,10 +124,14 @@ class JEventLoop{
                               jerror_t Loop(void); ///< Loop over events
                               jerror_t OneEvent(uint64_t event_number); ///< Process a specific single event (if source supports it)
                               jerror_t OneEvent(void); ///< Process a single event
+                              jerror_t ReadPipelineEvent(void); ///< Read next event when used by a JPipeline
+                                  void ProcessPipelineStage(const vector<pair<string,string> > &facnames, bool autoactivate, bool call_processors, bool call_sinks); ///< Do one JPipeline stage for current event
+                                  void EndPipelineEvent(void); ///< Finish current event after last JPipeline stage
+                                  void WarmUp(JEvent &warmup_event, bool all_factories); ///< Do per-run setup using the given event without processing it (see JANA:NPROCESSES)
                            inline void Pause(void){pause = 1;} ///< Pause event processing
                            inline void Resume(void){pause = 0;} ///< Resume event processing
                            inline void Quit(void){quit = 1;} ///< Clean up and exit the event loop
-                           inline bool GetQuit(void) const {return quit;}
+                           inline bool GetQuit(void) const {return (has_thread || !thread_loop) ? quit:thread_loop->quit;}
                                   void QuitProgram(void);
 
 		                               // Support for random access of events
@@ -136,6 +153,7 @@ class JEventLoop{
                                 double GetIntegratedRate(void) const {return rate_integrated;} ///< Get the current event processing rate
                                 double GetLastEventProcessingTime(void) const {return delta_time_single;}
                           unsigned int GetNevents(void) const {return Nevents;}
+                      jstats_thread_t* GetStatsSlot(void){return stats_slot;} ///< Get this thread's slot in the shared memory statistics segment (may be NULL)
 
                            inline bool CheckEventBoundary(uint64_t event_numberA, uint64_t event_numberB);
 
@@ -145,6 +163,8 @@ class JEventLoop{
 		                     inline void CallStackStart(JEventLoop::call_stack_t &cs, const string &caller_name, const string &caller_tag, const string callee_name, const string callee_tag);
 		                     inline void CallStackEnd(JEventLoop::call_stack_t &cs);
            inline vector<call_stack_t> GetCallStack(void){return call_stack;} ///< Get the current factory call stack
+    inline const vector<call_stack_t>& GetCallStackRef(void){return call_stack;} ///< Get the current factory call stack without copying it
+                static inline uint64_t GetTicks(void); ///< Get monotonic clock ticks (ns) used for call stack timing
                            inline void AddToCallStack(call_stack_t &cs){if(record_call_stack) call_stack.push_back(cs);} ///< Add specified item to call stack record but only if record_call_stack is true
                            inline void AddToErrorCallStack(error_call_stack_t &cs){error_call_stack.push_back(cs);} ///< Add layer to the factory call stack
      inline vector<error_call_stack_t> GetErrorCallStack(void){return error_call_stack;} ///< Get the current factory error call stack
@@ -190,11 +210,29 @@ class JEventLoop{
 		map<string, string> default_tags;
 		vector<pair<string,string> > auto_activated_factories;
 		bool record_call_stack;
+		JFactoryMonitor *factory_monitor;
+		JFactoryCache *factory_cache;
+		jstats_thread_t *stats_slot;
+		bool stats_slot_allocated;
+		typedef struct{
+			JFactory_base *fac;
+			jstats_factory_t *slot;
+			unsigned int last_calls;
+			unsigned int last_gencalls;
+			uint64_t last_evnt_ticks;
+		}stats_factory_t;
+		vector<stats_factory_t> stats_factories;
 		string caller_name;
 		string caller_tag;
 		vector<uint64_t> event_boundaries;
 		int32_t event_boundaries_run; ///< Run number boundaries were retrieved from (possbily 0)
 		list<uint64_t> next_events_to_process;
+		unsigned int first_sink;			///< Index of first JEventSink in processors (they are always last)
+		JOrderedOutput *ordered_output;		///< Calls sinks in the order events were read (NULL if not enabled)
+		uint64_t ordered_sequence;			///< Sequence number of current event if it has not been written by ordered_output yet
+		JEventLoop *ordered_work;			///< JEventLoop from ordered_output this thread's current event is in (NULL if none)
+		bool has_thread;					///< false for JEventLoops that threads borrow to process events in (see JOrderedOutput)
+		JEventLoop *thread_loop;			///< If !has_thread, JEventLoop of thread that last borrowed this one
 		
 		uint64_t Nevents;			      ///< Total events processed (this thread)
 		uint64_t Nevents_rate;		   ///< Num. events accumulated for "instantaneous" rate
@@ -203,6 +241,13 @@ class JEventLoop{
 		double delta_time;				///< Total time spent processing events (this thread)
 		double rate_instantaneous;		///< Latest instantaneous rate
 		double rate_integrated;			///< Rate integrated over all events
+
+		void PublishStats(void);
+		void PublishFactoryStats(void);
+		void ActivateFactories(const vector<pair<string,string> > &facnames);
+		void CallProcessor(JEventProcessor *proc, int32_t run_number, uint64_t event_number);
+		void CallBeginRun(JEventProcessor *proc, int32_t run_number);
+		void CallSinks(void);
    
 		static data_source_t null_data_source;
 
@@ -488,14 +533,12 @@ inline void JEventLoop::CallStackStart(JEventLoop::call_stack_t &cs, const strin
 	/// above, but may also be used by external actors to manipulate
 	/// the call stack (presumably for good and not evil).
 
-	struct itimerval tmr;
-	getitimer(ITIMER_PROF, &tmr);
-
 	cs.caller_name    = this->caller_name;
 	cs.caller_tag     = this->caller_tag;
 	this->caller_name = cs.callee_name = callee_name;
 	this->caller_tag  = cs.callee_tag  = callee_tag;
-	cs.start_time = tmr.it_value.tv_sec + tmr.it_value.tv_usec/1.0E6;
+	cs.start_ticks = GetTicks();
+	cs.start_time  = (double)cs.start_ticks*1.0E-9;
 }
 
 //-------------
@@ -507,14 +550,31 @@ inline void JEventLoop::CallStackEnd(JEventLoop::call_stack_t &cs)
 	/// with a previous call to CallStackStart which was
 	/// used to fill the cs structure.
 
-	struct itimerval tmr;
-	getitimer(ITIMER_PROF, &tmr);
-	cs.end_time = tmr.it_value.tv_sec + tmr.it_value.tv_usec/1.0E6;
+	cs.end_ticks = GetTicks();
+	cs.end_time  = (double)cs.end_ticks*1.0E-9;
 	caller_name = cs.caller_name;
 	caller_tag  = cs.caller_tag;
 	call_stack.push_back(cs);
 }
 
+//-------------
+// GetTicks
+//-------------
+inline uint64_t JEventLoop::GetTicks(void)
+{
+	/// Return the current value of the monotonic clock in
+	/// nanoseconds. This is what is used to time the entries
+	/// in the call stack. Integer ticks are used so that
+	/// consumers can accumulate them without loss of precision
+	/// and without converting to/from floating point on every
+	/// call. Note that unlike the ITIMER_PROF timer previously
+	/// used, this counts up so durations are end - start.
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec*1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
 //-------------
 // CheckEventBoundary
 //-------------
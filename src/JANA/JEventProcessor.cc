@@ -83,3 +83,29 @@ jerror_t JEventProcessor::fini(void)
 {
 	return NOERROR;
 }
+
+//----------------
+// worker_fini
+//----------------
+jerror_t JEventProcessor::worker_fini(string &results)
+{
+	/// When events are processed by forked worker processes
+	/// (JANA:NPROCESSES), this is called in each worker at the end in
+	/// place of fini(). Put whatever is needed to combine this worker's
+	/// results with the others' (e.g. histogram contents) in results.
+	/// It is passed to merge_worker() in the parent process, which then
+	/// calls fini(). The default returns RESOURCE_UNAVAILABLE in which
+	/// case fini() is called in each worker instead and not in the parent.
+	return RESOURCE_UNAVAILABLE;
+}
+
+//----------------
+// merge_worker
+//----------------
+jerror_t JEventProcessor::merge_worker(int worker, const string &results)
+{
+	/// Called in the parent process for each worker whose worker_fini()
+	/// returned NOERROR, with the results it filled in. This is called
+	/// from a single thread.
+	return NOERROR;
+}
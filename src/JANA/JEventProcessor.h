@@ -10,7 +10,9 @@
 
 #include <pthread.h>
 #include <vector>
+#include <string>
 using std::vector;
+using std::string;
 
 #include "jerror.h"
 #include "JParameterManager.h"
@@ -38,6 +40,8 @@ class JEventProcessor{
 		virtual jerror_t evnt(JEventLoop *eventLoop, uint64_t eventnumber);	///< Called every event.
 		virtual jerror_t erun(void);						                        ///< Called everytime run number changes, provided brun has been called.
 		virtual jerror_t fini(void);						                        ///< Called after last event of last event source has been processed.
+		virtual jerror_t worker_fini(string &results);	                        ///< Called instead of fini() in JANA:NPROCESSES worker processes. Fill results for merge_worker().
+		virtual jerror_t merge_worker(int worker, const string &results);	   ///< Called in the parent process with each worker's results before fini().
 		
 		inline int init_was_called(void){return init_called;}
 		inline int brun_was_called(void){return brun_called;}
@@ -0,0 +1,503 @@
+// $Id$
+//
+//    File: JEventRing.cc
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+using namespace std;
+
+#include "JEventRing.h"
+#include "JStreamLog.h"
+using namespace jana;
+
+// Time consumers and the producer wait to be woken before
+// checking whether the process on the other side is still alive.
+static const long kWaitNanoseconds = 100000000;
+
+static double Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + 1.0E-9*(double)ts.tv_nsec;
+}
+
+static bool ProcessIsDead(pid_t pid)
+{
+	return pid!=0 && kill(pid, 0)!=0 && errno==ESRCH;
+}
+
+//---------------------------------
+// JEventRing    (Constructor)
+//---------------------------------
+JEventRing::JEventRing()
+{
+	header = NULL;
+	slots = NULL;
+	data = NULL;
+	owner = false;
+	attached = false;
+}
+
+//---------------------------------
+// ~JEventRing    (Destructor)
+//---------------------------------
+JEventRing::~JEventRing()
+{
+	Detach();
+}
+
+//---------------------------------
+// GetName
+//---------------------------------
+string JEventRing::GetName(const string &name)
+{
+	/// Return the name of the shared memory segment for the ring with
+	/// the given name. On Linux, this will show up as
+	/// /dev/shm/jana_ring.<name>
+	return string("/jana_ring.") + name;
+}
+
+//---------------------------------
+// Create
+//---------------------------------
+bool JEventRing::Create(const string &name, uint32_t Nslots, uint64_t slot_size)
+{
+	/// Create and map a ring with Nslots slots each able to hold an
+	/// event of up to slot_size bytes. Any stale segment of the same
+	/// name is replaced. Returns false and sets the error string on
+	/// failure.
+	Detach();
+
+	if(Nslots<1 || slot_size<1){
+		error = "ring must have at least one slot of at least one byte";
+		return false;
+	}
+
+	// Start each slot's data on a cache line and the data area on a page
+	slot_size = (slot_size + 63) & ~(uint64_t)63;
+	uint64_t pagesize = (uint64_t)sysconf(_SC_PAGESIZE);
+	uint64_t data_offset = sizeof(jring_header_t) + Nslots*sizeof(jring_slot_t);
+	data_offset = ((data_offset + pagesize - 1)/pagesize)*pagesize;
+	uint64_t segment_size = data_offset + (uint64_t)Nslots*slot_size;
+
+	this->name = GetName(name);
+	shm_unlink(this->name.c_str());
+	int fd = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if(fd < 0){
+		error = string("shm_open(") + this->name + "): " + strerror(errno);
+		return false;
+	}
+	if(ftruncate(fd, segment_size) != 0){
+		error = string("ftruncate(") + this->name + "): " + strerror(errno);
+		close(fd);
+		shm_unlink(this->name.c_str());
+		return false;
+	}
+	void *ptr = mmap(NULL, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(ptr == MAP_FAILED){
+		error = string("mmap(") + this->name + "): " + strerror(errno);
+		shm_unlink(this->name.c_str());
+		return false;
+	}
+
+	// Segment is zero filled by ftruncate so all slots start out kFree.
+	header = (jring_header_t*)ptr;
+	slots = (jring_slot_t*)((uint8_t*)ptr + sizeof(jring_header_t));
+	data = (uint8_t*)ptr + data_offset;
+	owner = true;
+
+	pthread_mutexattr_t mattr;
+	pthread_mutexattr_init(&mattr);
+	pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+	pthread_mutexattr_setrobust(&mattr, PTHREAD_MUTEX_ROBUST);
+	pthread_mutex_init(&header->mutex, &mattr);
+	pthread_mutexattr_destroy(&mattr);
+
+	sem_init(&header->not_empty, 1, 0);
+	sem_init(&header->not_full, 1, 0);
+
+	// Fill in the header with the magic number last so consumers
+	// don't see a half-initialized ring.
+	header->version = JRING_VERSION;
+	header->producer_pid = getpid();
+	header->Nslots = Nslots;
+	header->slot_size = slot_size;
+	header->data_offset = data_offset;
+	header->segment_size = segment_size;
+	__sync_synchronize();
+	header->magic = JRING_MAGIC;
+
+	return true;
+}
+
+//---------------------------------
+// Attach
+//---------------------------------
+bool JEventRing::Attach(const string &name, double timeout)
+{
+	/// Map an existing ring as a consumer. If the ring does not exist
+	/// yet, keep trying for up to timeout seconds so consumers can be
+	/// started before the producer. Returns false and sets the error
+	/// string if the ring could not be attached to or was made by an
+	/// incompatible version of JANA.
+	Detach();
+
+	this->name = GetName(name);
+	double t_end = Now() + timeout;
+	int fd = -1;
+	while(true){
+		fd = shm_open(this->name.c_str(), O_RDWR, 0);
+		if(fd >= 0){
+			// Wait for producer to finish setting it up
+			struct stat st;
+			if(fstat(fd, &st)==0 && (size_t)st.st_size>=sizeof(jring_header_t)){
+				jring_header_t *h = (jring_header_t*)mmap(NULL, sizeof(jring_header_t), PROT_READ, MAP_SHARED, fd, 0);
+				if(h != MAP_FAILED){
+					bool ready = h->magic!=0;
+					munmap((void*)h, sizeof(jring_header_t));
+					if(ready) break;
+				}
+			}
+			close(fd);
+			fd = -1;
+		}else if(errno != ENOENT){
+			error = string("shm_open(") + this->name + "): " + strerror(errno);
+			return false;
+		}
+		if(Now() >= t_end){
+			error = string("shm_open(") + this->name + "): " + (fd<0 ? strerror(ENOENT):"ring was not initialized");
+			return false;
+		}
+		usleep(100000);
+	}
+
+	struct stat st;
+	fstat(fd, &st);
+	void *ptr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(ptr == MAP_FAILED){
+		error = string("mmap(") + this->name + "): " + strerror(errno);
+		return false;
+	}
+
+	header = (jring_header_t*)ptr;
+	if(header->magic!=JRING_MAGIC || header->version!=JRING_VERSION || header->segment_size!=(uint64_t)st.st_size){
+		error = this->name + " has wrong magic number, version or size";
+		munmap(ptr, st.st_size);
+		header = NULL;
+		return false;
+	}
+	slots = (jring_slot_t*)((uint8_t*)ptr + sizeof(jring_header_t));
+	data = (uint8_t*)ptr + header->data_offset;
+	owner = false;
+	attached = true;
+
+	Lock();
+	header->Nconsumers++;
+	Unlock();
+
+	return true;
+}
+
+//---------------------------------
+// Detach
+//---------------------------------
+void JEventRing::Detach(void)
+{
+	/// Unmap the ring. If we created it, it is also removed.
+	if(!header) return;
+
+	if(attached){
+		Lock();
+		header->Nconsumers--;
+		Unlock();
+		attached = false;
+	}
+
+	Remove();
+	munmap((void*)header, header->segment_size);
+	header = NULL;
+	slots = NULL;
+	data = NULL;
+}
+
+//---------------------------------
+// Remove
+//---------------------------------
+void JEventRing::Remove(void)
+{
+	/// Remove the segment name so no new consumers can attach. Processes
+	/// that already have it mapped keep it until they detach. This
+	/// does nothing unless we created the ring.
+	if(!owner) return;
+	shm_unlink(name.c_str());
+	owner = false;
+}
+
+//---------------------------------
+// Lock
+//---------------------------------
+void JEventRing::Lock(void)
+{
+	int rc = pthread_mutex_lock(&header->mutex);
+	if(rc == EOWNERDEAD) pthread_mutex_consistent(&header->mutex);
+}
+
+//---------------------------------
+// Unlock
+//---------------------------------
+void JEventRing::Unlock(void)
+{
+	pthread_mutex_unlock(&header->mutex);
+}
+
+//---------------------------------
+// Wait
+//---------------------------------
+void JEventRing::Wait(sem_t *sem, volatile uint32_t &Nwaiting, uint64_t &wait_ns)
+{
+	/// Wait to be woken with Wake() for no more than kWaitNanoseconds
+	/// and add the time waited to wait_ns. The mutex must be locked. It
+	/// is unlocked while waiting. Callers must check again whatever they
+	/// were waiting for since this can return without it having happened.
+	Nwaiting++;
+	Unlock();
+
+	struct timespec start, ts;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	clock_gettime(CLOCK_REALTIME, &ts);
+	ts.tv_nsec += kWaitNanoseconds;
+	if(ts.tv_nsec >= 1000000000){
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000;
+	}
+	while(sem_timedwait(sem, &ts)!=0 && errno==EINTR);
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	wait_ns += (uint64_t)(ts.tv_sec - start.tv_sec)*1000000000ULL + ts.tv_nsec - start.tv_nsec;
+
+	Lock();
+	if(Nwaiting>0) Nwaiting--;
+}
+
+//---------------------------------
+// Wake
+//---------------------------------
+void JEventRing::Wake(sem_t *sem, volatile uint32_t &Nwaiting, bool all)
+{
+	/// Wake one (or all) of the processes waiting in Wait(). The mutex
+	/// must be locked. Posts left over from waiters that gave up (or
+	/// died) only cause extra wake ups so are not a problem.
+	if(Nwaiting == 0) return;
+	int Nposts = all ? Nwaiting:1;
+	int value = 0;
+	sem_getvalue(sem, &value);
+	for(int i=value; i<Nposts; i++) sem_post(sem);
+}
+
+//---------------------------------
+// ReclaimIfDead
+//---------------------------------
+void JEventRing::ReclaimIfDead(jring_slot_t &slot)
+{
+	/// If the slot is claimed by a process that no longer exists, free
+	/// it. The event in it is lost. (mutex must be locked)
+	if(slot.state!=kClaimed || !ProcessIsDead(slot.consumer_pid)) return;
+	slot.state = kFree;
+	slot.consumer_pid = 0;
+	header->Nreclaimed++;
+}
+
+//---------------------------------
+// Reserve
+//---------------------------------
+uint8_t* JEventRing::Reserve(uint32_t &slot)
+{
+	/// Wait for the next slot to be free and return a pointer to its
+	/// data area (GetSlotSize() bytes) for the producer to fill in. The
+	/// event is not seen by consumers until Commit() is called. Only
+	/// the producer may call this.
+	slot = header->Nput % header->Nslots;
+	jring_slot_t &s = slots[slot];
+
+	Lock();
+	while(s.state != kFree){
+		ReclaimIfDead(s);
+		if(s.state == kFree) break;
+		uint64_t wait_ns = 0;
+		Wait(&header->not_full, header->Nwaiting_full, wait_ns);
+		header->producer_wait_ns += wait_ns;
+	}
+	s.state = kFilling;
+	Unlock();
+
+	return data + (uint64_t)slot*header->slot_size;
+}
+
+//---------------------------------
+// Commit
+//---------------------------------
+void JEventRing::Commit(uint32_t slot, uint64_t size, int32_t run_number, uint64_t event_number)
+{
+	/// Make the event filled in after Reserve() available to consumers
+	jring_slot_t &s = slots[slot];
+
+	Lock();
+	s.size = size;
+	s.run_number = run_number;
+	s.event_number = event_number;
+	s.sequence = ++header->Nput;
+	s.state = kReady;
+	Wake(&header->not_empty, header->Nwaiting_empty);
+	Unlock();
+}
+
+//---------------------------------
+// Put
+//---------------------------------
+bool JEventRing::Put(const void *buff, uint64_t size, int32_t run_number, uint64_t event_number)
+{
+	/// Copy an event into the next free slot and make it available to
+	/// consumers. Returns false if the event is too big for a slot.
+	if(size > header->slot_size){
+		stringstream ss;
+		ss<<"event of "<<size<<" bytes is larger than ring slot size ("<<header->slot_size<<" bytes)";
+		error = ss.str();
+		return false;
+	}
+	uint32_t slot;
+	uint8_t *ptr = Reserve(slot);
+	memcpy(ptr, buff, size);
+	Commit(slot, size, run_number, event_number);
+	return true;
+}
+
+//---------------------------------
+// Finish
+//---------------------------------
+void JEventRing::Finish(void)
+{
+	/// Tell consumers no more events will be put in the ring. Once they
+	/// have claimed all that are there, Claim() returns false.
+	Lock();
+	header->finished = 1;
+	Wake(&header->not_empty, header->Nwaiting_empty, true);
+	Unlock();
+}
+
+//---------------------------------
+// WaitForConsumers
+//---------------------------------
+bool JEventRing::WaitForConsumers(double timeout)
+{
+	/// Wait until every event put in the ring has been released (or
+	/// reclaimed from a dead consumer). A timeout of 0 means wait forever.
+	/// Returns false if the timeout expired first.
+	double t_end = Now() + timeout;
+
+	Lock();
+	while(true){
+		for(uint32_t i=0; i<header->Nslots; i++) ReclaimIfDead(slots[i]);
+		if(header->Nreleased + header->Nreclaimed >= header->Nput) break;
+		if(timeout>0.0 && Now()>=t_end){
+			Unlock();
+			return false;
+		}
+		uint64_t wait_ns = 0;
+		Wait(&header->not_full, header->Nwaiting_full, wait_ns);
+	}
+	Unlock();
+
+	return true;
+}
+
+//---------------------------------
+// Claim
+//---------------------------------
+bool JEventRing::Claim(Event &event)
+{
+	/// Take the next event from the ring, waiting for one if needed. The
+	/// data pointed to by event stays valid until Release(event.slot) is
+	/// called. Returns false once the producer has finished and all events
+	/// have been claimed or if the producer died.
+	Lock();
+	while(header->Nclaimed >= header->Nput){
+		if(header->finished){
+			Unlock();
+			return false;
+		}
+		if(ProcessIsDead(header->producer_pid)){
+			stringstream ss;
+			ss<<"producer process "<<header->producer_pid<<" for "<<name<<" is gone";
+			error = ss.str();
+			Unlock();
+			return false;
+		}
+		uint64_t wait_ns = 0;
+		Wait(&header->not_empty, header->Nwaiting_empty, wait_ns);
+		header->consumer_wait_ns += wait_ns;
+	}
+
+	uint32_t slot = header->Nclaimed % header->Nslots;
+	jring_slot_t &s = slots[slot];
+	s.state = kClaimed;
+	s.consumer_pid = getpid();
+	header->Nclaimed++;
+
+	event.data = data + (uint64_t)slot*header->slot_size;
+	event.size = s.size;
+	event.event_number = s.event_number;
+	event.run_number = s.run_number;
+	event.slot = slot;
+	event.sequence = s.sequence;
+
+	// Wake another consumer if there is more to do
+	if(header->Nclaimed < header->Nput) Wake(&header->not_empty, header->Nwaiting_empty);
+	Unlock();
+
+	return true;
+}
+
+//---------------------------------
+// Release
+//---------------------------------
+void JEventRing::Release(uint32_t slot)
+{
+	/// Give a slot obtained from Claim() back to the producer
+	jring_slot_t &s = slots[slot];
+
+	Lock();
+	if(s.state==kClaimed && s.consumer_pid==(uint32_t)getpid()){
+		s.state = kFree;
+		s.consumer_pid = 0;
+		header->Nreleased++;
+		Wake(&header->not_full, header->Nwaiting_full);
+	}
+	Unlock();
+}
+
+//---------------------------------
+// PrintStats
+//---------------------------------
+void JEventRing::PrintStats(void)
+{
+	/// Print the counters kept in the ring's header
+	if(!header) return;
+	jout<<"Event ring "<<name<<": "<<header->Nslots<<" slots x "<<header->slot_size<<" bytes"<<endl;
+	jout<<"       put: "<<header->Nput<<"  claimed: "<<header->Nclaimed<<"  released: "<<header->Nreleased<<"  reclaimed: "<<header->Nreclaimed<<endl;
+	jout<<fixed<<setprecision(3);
+	jout<<"   producer waited: "<<1.0E-9*(double)header->producer_wait_ns<<" s  consumers waited: "<<1.0E-9*(double)header->consumer_wait_ns<<" s"<<endl;
+}
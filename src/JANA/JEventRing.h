@@ -0,0 +1,159 @@
+// $Id$
+//
+//    File: JEventRing.h
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#ifndef _JEventRing_
+#define _JEventRing_
+
+#include <stdint.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+
+#include <string>
+using std::string;
+
+// The structures below define the layout of a block of POSIX shared
+// memory used to pass raw events from one reader process to any number
+// of worker processes. As with jstats_t (see JStatsSegment.h), the
+// layout must be fixed: no pointers, no STL containers and no virtual
+// methods. If the layout is changed in any way, JRING_VERSION must be
+// incremented.
+//
+// The segment holds a jring_header_t followed by Nslots jring_slot_t
+// and then the data areas of the slots (slot_size bytes each, starting
+// at data_offset). All fields other than the event data are only changed
+// with the mutex locked. The mutex is process shared and robust so a
+// process dying while holding it does not hang the others. Waiting is
+// done on semaphores rather than condition variables since a process
+// dying while waiting on a shared condition variable can leave it
+// unusable by the others.
+
+#define JRING_MAGIC    0x4A52494E47000001ULL  // "JRING" + 0x0001
+#define JRING_VERSION  1
+
+// Place everything in JANA namespace
+namespace jana{
+
+typedef struct{
+	volatile uint32_t state;          ///< one of JEventRing::slot_state_t
+	volatile uint32_t consumer_pid;   ///< process that claimed the event
+	volatile uint64_t sequence;       ///< 1 for first event put in ring, 2 for second, ...
+	volatile uint64_t event_number;
+	volatile int32_t  run_number;
+	volatile uint32_t pad;
+	volatile uint64_t size;           ///< bytes of event data in slot
+}jring_slot_t;
+
+typedef struct{
+	volatile uint64_t magic;
+	volatile uint32_t version;
+	volatile uint32_t producer_pid;
+	volatile uint32_t Nslots;
+	volatile uint32_t finished;       ///< set once producer has put its last event
+	volatile uint64_t slot_size;      ///< max. bytes of data per event
+	volatile uint64_t data_offset;    ///< offset of first slot's data from start of segment
+	volatile uint64_t segment_size;
+	volatile uint64_t Nput;           ///< events put in ring
+	volatile uint64_t Nclaimed;       ///< events claimed by consumers
+	volatile uint64_t Nreleased;      ///< events released by consumers
+	volatile uint64_t Nreclaimed;     ///< slots taken back from consumers that died
+	volatile uint64_t producer_wait_ns;  ///< time producer waited for a free slot
+	volatile uint64_t consumer_wait_ns;  ///< time consumers waited for an event (summed)
+	volatile uint32_t Nconsumers;     ///< consumers attached now
+	volatile uint32_t Nwaiting_empty; ///< consumers waiting on not_empty
+	volatile uint32_t Nwaiting_full;  ///< producer waiting on not_full (0 or 1)
+	volatile uint32_t pad;
+	pthread_mutex_t mutex;
+	sem_t not_empty;                  ///< consumers wait on this for events
+	sem_t not_full;                   ///< producer waits on this for free slots
+}jring_header_t;
+
+
+/// JEventRing is a ring buffer of raw events in POSIX shared memory.
+/// One reader process (the producer) creates it with Create() and puts
+/// events in with Reserve()/Commit() (or Put()). Any number of worker
+/// processes attach with Attach() and take events with Claim(). The
+/// event data is used in place in the shared memory (no copy) until
+/// the consumer calls Release() which lets the producer reuse the slot.
+///
+/// Events are claimed in the order they were put in but may be released
+/// in any order. If the producer needs a slot whose event was claimed by
+/// a process that has since died, the slot is reclaimed (and counted in
+/// Nreclaimed).
+///
+/// Segment names are given without the leading "/". The segment is
+/// named /jana_ring.<name> so it shows up as /dev/shm/jana_ring.<name>.
+
+class JEventRing{
+	public:
+
+		enum slot_state_t{
+			kFree = 0,
+			kFilling,
+			kReady,
+			kClaimed
+		};
+
+		/// An event claimed from the ring
+		class Event{
+			public:
+				const uint8_t *data;
+				uint64_t size;
+				uint64_t event_number;
+				int32_t run_number;
+				uint32_t slot;
+				uint64_t sequence;
+		};
+
+		JEventRing();
+		virtual ~JEventRing();
+
+		bool Create(const string &name, uint32_t Nslots, uint64_t slot_size);
+		bool Attach(const string &name, double timeout=0.0);
+		void Detach(void);
+		void Remove(void);
+
+		// Producer
+		uint8_t* Reserve(uint32_t &slot);
+		void Commit(uint32_t slot, uint64_t size, int32_t run_number, uint64_t event_number);
+		bool Put(const void *data, uint64_t size, int32_t run_number, uint64_t event_number);
+		void Finish(void);
+		bool WaitForConsumers(double timeout=0.0);
+
+		// Consumer
+		bool Claim(Event &event);
+		void Release(uint32_t slot);
+
+		jring_header_t* Get(void){return header;}
+		uint64_t GetSlotSize(void) const {return header ? header->slot_size:0;}
+		bool IsOwner(void) const {return owner;}
+		const string& GetError(void) const {return error;}
+		void PrintStats(void);
+
+		static string GetName(const string &name);
+
+	protected:
+
+		void Lock(void);
+		void Unlock(void);
+		void Wait(sem_t *sem, volatile uint32_t &Nwaiting, uint64_t &wait_ns);
+		void Wake(sem_t *sem, volatile uint32_t &Nwaiting, bool all=false);
+		void ReclaimIfDead(jring_slot_t &slot);
+
+		jring_header_t *header;
+		jring_slot_t *slots;
+		uint8_t *data;
+		bool owner;
+		bool attached;
+		string name;
+		string error;
+};
+
+} // Close JANA namespace
+
+#endif // _JEventRing_
+
@@ -101,6 +101,17 @@ void JEventSink::PrintWriteList(void)
 	jout<<endl;
 }
 
+//---------------------------------
+// GetWriteList
+//---------------------------------
+void JEventSink::GetWriteList(vector<pair<string,string> > &list)
+{
+	list.clear();
+	for(unsigned int i=0; i<factories_to_write.size(); i++){
+		list.push_back(pair<string,string>(factories_to_write[i].name, factories_to_write[i].tag));
+	}
+}
+
 //---------------------------------
 // ClearWriteList
 //---------------------------------
@@ -40,6 +40,7 @@ class JEventSink:public JEventProcessor{
 		void RemoveFromWriteList(string name, string tag);
 		void ClearWriteList(void);
 		void PrintWriteList(void);
+		void GetWriteList(vector<pair<string,string> > &list); ///< Get list of factories to write as (name, tag) pairs
 
 		inline void LockSink(void){pthread_mutex_lock(&sink_mutex);}
 		inline void UnlockSink(void){pthread_mutex_unlock(&sink_mutex);}
@@ -0,0 +1,258 @@
+// $Id$
+//
+//    File: JEventSocket.cc
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#include <string.h>
+#include <errno.h>
+#include <netdb.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include <sstream>
+using namespace std;
+
+#include "JEventSocket.h"
+using namespace jana;
+
+//---------------------------------
+// IsSocketAddress
+//---------------------------------
+bool JEventSocket::IsSocketAddress(const char *address)
+{
+	/// Return true if address has the form unix:PATH or tcp:HOST:PORT
+	if(address == NULL) return false;
+	if(strncmp(address, "unix:", 5)==0) return address[5]!=0;
+	if(strncmp(address, "tcp:", 4)==0) return strchr(&address[4], ':')!=NULL;
+	return false;
+}
+
+//---------------------------------
+// ParseTCP
+//---------------------------------
+bool JEventSocket::ParseTCP(const string &address, string &host, string &port)
+{
+	/// Split tcp:HOST:PORT into HOST and PORT
+	size_t pos = address.rfind(':');
+	if(address.compare(0, 4, "tcp:")!=0 || pos==string::npos || pos<4) return false;
+	host = address.substr(4, pos-4);
+	port = address.substr(pos+1);
+	return !port.empty();
+}
+
+//---------------------------------
+// Listen
+//---------------------------------
+int JEventSocket::Listen(const string &address, string &error)
+{
+	/// Create a socket listening on the given address and return its
+	/// file descriptor. For unix: addresses, any existing socket file is
+	/// replaced. Returns -1 and sets error on failure.
+	int fd = -1;
+	if(address.compare(0, 5, "unix:") == 0){
+		string path = address.substr(5);
+		struct sockaddr_un addr;
+		memset(&addr, 0, sizeof(addr));
+		if(path.size() >= sizeof(addr.sun_path)){
+			error = "socket path too long: " + path;
+			return -1;
+		}
+		addr.sun_family = AF_UNIX;
+		strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path)-1);
+		fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if(fd < 0){
+			error = string("socket: ") + strerror(errno);
+			return -1;
+		}
+		unlink(path.c_str());
+		if(bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0){
+			error = string("bind(") + path + "): " + strerror(errno);
+			close(fd);
+			return -1;
+		}
+	}else{
+		string host, port;
+		if(!ParseTCP(address, host, port)){
+			error = "bad socket address \"" + address + "\" (use unix:PATH or tcp:HOST:PORT)";
+			return -1;
+		}
+		struct addrinfo hints, *res = NULL;
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+		hints.ai_flags = AI_PASSIVE;
+		int rc = getaddrinfo((host.empty() || host=="*") ? NULL:host.c_str(), port.c_str(), &hints, &res);
+		if(rc != 0){
+			error = address + ": " + gai_strerror(rc);
+			return -1;
+		}
+		fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+		if(fd < 0){
+			error = string("socket: ") + strerror(errno);
+			freeaddrinfo(res);
+			return -1;
+		}
+		int one = 1;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+		if(bind(fd, res->ai_addr, res->ai_addrlen) != 0){
+			error = string("bind(") + address + "): " + strerror(errno);
+			freeaddrinfo(res);
+			close(fd);
+			return -1;
+		}
+		freeaddrinfo(res);
+	}
+
+	if(listen(fd, 64) != 0){
+		error = string("listen(") + address + "): " + strerror(errno);
+		close(fd);
+		Unlink(address);
+		return -1;
+	}
+
+	return fd;
+}
+
+//---------------------------------
+// Connect
+//---------------------------------
+int JEventSocket::Connect(const string &address, double timeout, string &error)
+{
+	/// Connect to the broker at the given address and return the file
+	/// descriptor. If nothing is listening there yet, keep trying for up
+	/// to timeout seconds so clients can be started before the broker.
+	/// Returns -1 and sets error on failure.
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	double t_end = (double)ts.tv_sec + 1.0E-9*(double)ts.tv_nsec + timeout;
+
+	while(true){
+		int fd = -1;
+		int err = 0;
+		if(address.compare(0, 5, "unix:") == 0){
+			string path = address.substr(5);
+			struct sockaddr_un addr;
+			memset(&addr, 0, sizeof(addr));
+			if(path.size() >= sizeof(addr.sun_path)){
+				error = "socket path too long: " + path;
+				return -1;
+			}
+			addr.sun_family = AF_UNIX;
+			strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path)-1);
+			fd = socket(AF_UNIX, SOCK_STREAM, 0);
+			if(fd>=0 && connect(fd, (struct sockaddr*)&addr, sizeof(addr))!=0){
+				err = errno;
+				close(fd);
+				fd = -1;
+			}
+		}else{
+			string host, port;
+			if(!ParseTCP(address, host, port)){
+				error = "bad socket address \"" + address + "\" (use unix:PATH or tcp:HOST:PORT)";
+				return -1;
+			}
+			struct addrinfo hints, *res = NULL;
+			memset(&hints, 0, sizeof(hints));
+			hints.ai_family = AF_UNSPEC;
+			hints.ai_socktype = SOCK_STREAM;
+			int rc = getaddrinfo(host.empty() ? "localhost":host.c_str(), port.c_str(), &hints, &res);
+			if(rc != 0){
+				error = address + ": " + gai_strerror(rc);
+				return -1;
+			}
+			for(struct addrinfo *ai=res; ai!=NULL; ai=ai->ai_next){
+				fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+				if(fd < 0) continue;
+				if(connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+				err = errno;
+				close(fd);
+				fd = -1;
+			}
+			freeaddrinfo(res);
+			if(fd >= 0){
+				int one = 1;
+				setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+			}
+		}
+		if(fd >= 0) return fd;
+
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		if((double)ts.tv_sec + 1.0E-9*(double)ts.tv_nsec >= t_end){
+			error = string("connect(") + address + "): " + strerror(err);
+			return -1;
+		}
+		usleep(100000);
+	}
+}
+
+//---------------------------------
+// Unlink
+//---------------------------------
+void JEventSocket::Unlink(const string &address)
+{
+	/// Remove the socket file of a unix: address
+	if(address.compare(0, 5, "unix:") == 0) unlink(address.substr(5).c_str());
+}
+
+//---------------------------------
+// MakeHeader
+//---------------------------------
+void JEventSocket::MakeHeader(jsocket_header_t &hdr, msg_type_t type, uint32_t count, uint64_t size)
+{
+	hdr.magic = JSOCKET_MAGIC;
+	hdr.version = JSOCKET_VERSION;
+	hdr.type = type;
+	hdr.count = count;
+	hdr.pad = 0;
+	hdr.size = size;
+}
+
+//---------------------------------
+// CheckHeader
+//---------------------------------
+bool JEventSocket::CheckHeader(const jsocket_header_t &hdr)
+{
+	/// Return true if hdr is a valid message header from a compatible
+	/// version of JANA.
+	return hdr.magic==JSOCKET_MAGIC && hdr.version==JSOCKET_VERSION && hdr.type>=kCredit && hdr.type<=kEnd;
+}
+
+//---------------------------------
+// ReadN
+//---------------------------------
+bool JEventSocket::ReadN(int fd, void *buff, size_t n)
+{
+	/// Read exactly n bytes, retrying on EINTR. Return false on
+	/// EOF or error.
+	char *p = (char*)buff;
+	while(n>0){
+		ssize_t r = read(fd, p, n);
+		if(r<0 && errno==EINTR) continue;
+		if(r<=0) return false;
+		p += r;
+		n -= r;
+	}
+	return true;
+}
+
+//---------------------------------
+// WriteN
+//---------------------------------
+bool JEventSocket::WriteN(int fd, const void *buff, size_t n)
+{
+	/// Write exactly n bytes, retrying on EINTR. Return false on error.
+	const char *p = (const char*)buff;
+	while(n>0){
+		ssize_t r = send(fd, p, n, MSG_NOSIGNAL);
+		if(r<0 && errno==EINTR) continue;
+		if(r<=0) return false;
+		p += r;
+		n -= r;
+	}
+	return true;
+}
@@ -0,0 +1,88 @@
+// $Id$
+//
+//    File: JEventSocket.h
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#ifndef _JEventSocket_
+#define _JEventSocket_
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include <string>
+using std::string;
+
+// Messages passed between an event broker (e.g. the janabroker utility)
+// and the JEventSourceSocket sources of the processes it serves. Every
+// message starts with a jsocket_header_t. The layout must be fixed, as
+// it is sent as is, and if changed in any way JSOCKET_VERSION must be
+// incremented. Both ends are assumed to have the same byte order.
+//
+//   kCredit  client -> broker  "count" more events may be sent
+//   kEvents  broker -> client  "count" jsocket_event_t followed by the
+//                              event data back to back. "size" is the
+//                              number of bytes of both together.
+//   kEnd     broker -> client  there are no more events
+
+#define JSOCKET_MAGIC    0x4A534B54  // "JSKT"
+#define JSOCKET_VERSION  1
+
+// Place everything in JANA namespace
+namespace jana{
+
+typedef struct{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t type;
+	uint32_t count;
+	uint32_t pad;
+	uint64_t size;
+}jsocket_header_t;
+
+typedef struct{
+	int32_t  run_number;
+	uint32_t pad;
+	uint64_t event_number;
+	uint64_t size;
+}jsocket_event_t;
+
+
+/// JEventSocket holds the helper routines shared by the event broker
+/// and JEventSourceSocket. Addresses have one of the forms
+///
+///    unix:/path/to/socket
+///    tcp:host:port
+///
+/// For Listen(), host may be "*" to accept connections on all
+/// interfaces. Everything here is static.
+
+class JEventSocket{
+	public:
+
+		enum msg_type_t{
+			kCredit = 1,
+			kEvents,
+			kEnd
+		};
+
+		static bool IsSocketAddress(const char *address);
+		static int Listen(const string &address, string &error);
+		static int Connect(const string &address, double timeout, string &error);
+		static void Unlink(const string &address);
+
+		static void MakeHeader(jsocket_header_t &hdr, msg_type_t type, uint32_t count, uint64_t size);
+		static bool CheckHeader(const jsocket_header_t &hdr);
+
+		static bool ReadN(int fd, void *buff, size_t n);
+		static bool WriteN(int fd, const void *buff, size_t n);
+
+	private:
+		static bool ParseTCP(const string &address, string &host, string &port);
+};
+
+} // Close JANA namespace
+
+#endif // _JEventSocket_
+
@@ -7,11 +7,16 @@
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
 using namespace std;
 
 #include "JEventSource.h"
 #include "JStreamLog.h"
 #include "JEvent.h"
+#include "JEventLoop.h"
+#include "JFactory_base.h"
+#include "JParameterManager.h"
+#include "JDecompressStream.h"
 using namespace jana;
 
 //---------------------------------
@@ -26,6 +31,21 @@ JEventSource::JEventSource(const char *source_name)
 	Nevents_read = 0;
 	done_reading = false;
 	Ncalls_to_GetEvent=0;
+
+	pthread_mutex_init(&io_mutex, NULL);
+	io_open_ticks = JEventLoop::GetTicks();
+	io_done_ticks = 0;
+	io_Nevents = 0;
+	io_Nbytes = 0;
+	io_getevent_ticks = 0;
+	io_getevent_max_ticks = 0;
+	io_buffer_full_ticks = 0;
+	io_worker_wait_ticks = 0;
+	io_Nworker_waits = 0;
+	io_getobjects_ticks = 0;
+
+	static uint64_t Nsources_created = 0;
+	serial = __sync_add_and_fetch(&Nsources_created, 1);
 }
 
 //---------------------------------
@@ -51,7 +71,30 @@ jerror_t JEventSource::GetEvent(JEvent &event)
 
 	pthread_mutex_unlock(&in_progress_mutex);
 	
-	return GetEvent(event);
+	// Time the subclass' GetEvent for the I/O accounting. If it throws,
+	// the caller considers the source finished so mark it that way here too.
+	uint64_t start_ticks = JEventLoop::GetTicks();
+	jerror_t err;
+	try{
+		err = GetEvent(event);
+	}catch(...){
+		io_done_ticks = JEventLoop::GetTicks();
+		io_getevent_ticks += io_done_ticks - start_ticks;
+		ForgetEvent(event);
+		throw;
+	}
+	uint64_t end_ticks = JEventLoop::GetTicks();
+	uint64_t delta_ticks = end_ticks - start_ticks;
+	io_getevent_ticks += delta_ticks;
+	if(delta_ticks > io_getevent_max_ticks) io_getevent_max_ticks = delta_ticks;
+	if(err == NOERROR){
+		io_Nevents++;
+	}else if(err == NO_MORE_EVENTS_IN_SOURCE){
+		io_done_ticks = end_ticks;
+	}
+	if(err != NOERROR) ForgetEvent(event);
+
+	return err;
 }
 
 //----------------
@@ -84,6 +127,40 @@ jerror_t JEventSource::GetEvent(uint64_t eventNumber, JEvent &event)
 	return GetEvent(eventNumber, event);
 }
 
+//----------------
+// SkipEvents
+//----------------
+jerror_t JEventSource::SkipEvents(uint64_t Nevents, uint64_t &Nskipped)
+{
+	/// Pass over the next Nevents events without reading them in.
+	/// Nskipped is set to the number of events actually skipped.
+	/// Subclasses return NOERROR if all Nevents were skipped and
+	/// NO_MORE_EVENTS_IN_SOURCE if the source ran out first.
+	///
+	/// This base class version returns RESOURCE_UNAVAILABLE which
+	/// tells the caller to read the events in and discard them instead.
+	Nskipped = 0;
+	return RESOURCE_UNAVAILABLE;
+}
+
+//----------------
+// SeekToEvent
+//----------------
+jerror_t JEventSource::SeekToEvent(uint64_t eventNumber, uint64_t &Nskipped)
+{
+	/// Pass over events so the next call to GetEvent returns the one
+	/// whose event number is eventNumber. Nskipped is set to the
+	/// number of events passed over. Subclasses return NOERROR if
+	/// the event was found and NO_MORE_EVENTS_IN_SOURCE if it is not
+	/// in the (rest of the) source. In the latter case the source should
+	/// have no more events to give.
+	///
+	/// This base class version returns RESOURCE_UNAVAILABLE which
+	/// tells the caller to read the events in and check each one instead.
+	Nskipped = 0;
+	return RESOURCE_UNAVAILABLE;
+}
+
 //----------------
 // GetObjects
 //----------------
@@ -94,6 +171,43 @@ jerror_t JEventSource::GetObjects(JEvent &event, JFactory_base *factory)
 	return OBJECT_NOT_AVAILABLE;
 }
 
+//----------------
+// GetObjectsTimed
+//----------------
+jerror_t JEventSource::GetObjectsTimed(JEvent &event, JFactory_base *factory)
+{
+	/// This is called from JEvent::GetObjects to dispatch to the
+	/// subclass' GetObjects method while recording the time spent
+	/// in it for the I/O accounting. Time is kept separately for
+	/// each data type (class:tag).
+	///
+	/// This is called for every factory on every event so the factory
+	/// keeps a pointer to its entry in io_getobjects. The entry is only
+	/// looked up (with io_mutex locked) the first time the factory sees
+	/// an event from this source. After that it is updated atomically.
+	uint64_t start_ticks = JEventLoop::GetTicks();
+	jerror_t err = GetObjects(event, factory);
+	uint64_t delta_ticks = JEventLoop::GetTicks() - start_ticks;
+
+	__sync_fetch_and_add(&io_getobjects_ticks, delta_ticks);
+	if(factory){
+		if(factory->getobjects_source_serial != serial){
+			string key = factory->GetDataClassName();
+			const char *tag = factory->Tag();
+			if(tag && tag[0]!=0) key = key + ":" + tag;
+
+			pthread_mutex_lock(&io_mutex);
+			factory->getobjects_counts = &io_getobjects[key];
+			pthread_mutex_unlock(&io_mutex);
+			factory->getobjects_source_serial = serial;
+		}
+		__sync_fetch_and_add(&factory->getobjects_counts->first, 1);
+		__sync_fetch_and_add(&factory->getobjects_counts->second, delta_ticks);
+	}
+
+	return err;
+}
+
 //----------------
 // FreeEvent
 //----------------
@@ -143,3 +257,153 @@ bool JEventSource::IsFinished(void)
 	return in_progess_empty;
 }
 
+//----------------
+// GetProgress
+//----------------
+void JEventSource::GetProgress(uint64_t &Ncompleted, bool &finished)
+{
+	/// Get the number of events at the start of the source that have all
+	/// been freed (i.e. completely processed or discarded). Events still
+	/// being processed and any after them are not counted even if some of
+	/// those later ones are done. finished is set to true if the source
+	/// has no more events and none are still being processed.
+	///
+	/// Event IDs are the position of each event in the source (counting
+	/// skipped events, see SkippedEvents) so this is one less than the
+	/// ID of the oldest event still in progress.
+	pthread_mutex_lock(&in_progress_mutex);
+	if(in_progess_events.empty()){
+		Ncompleted = Ncalls_to_GetEvent;
+		finished = io_done_ticks!=0;
+	}else{
+		Ncompleted = *in_progess_events.begin() - 1;
+		finished = false;
+	}
+	pthread_mutex_unlock(&in_progress_mutex);
+}
+
+//----------------
+// ForgetEvent
+//----------------
+void JEventSource::ForgetEvent(JEvent &event)
+{
+	/// Undo the recording of an event by GetEvent when the subclass did
+	/// not return one. Otherwise it would stay in progress forever and
+	/// the ID it took would throw off the position of those after it.
+	pthread_mutex_lock(&in_progress_mutex);
+	in_progess_events.erase(event.GetID());
+	if(event.GetID() == Ncalls_to_GetEvent) Ncalls_to_GetEvent--;
+	pthread_mutex_unlock(&in_progress_mutex);
+}
+
+//----------------
+// SkippedEvents
+//----------------
+void JEventSource::SkippedEvents(uint64_t Nskipped)
+{
+	/// Called by JApplication after the source passed over Nskipped
+	/// events with SkipEvents or SeekToEvent. They are counted in the
+	/// event IDs so that the ID of every event is its position in the
+	/// source no matter how we got to it.
+	pthread_mutex_lock(&in_progress_mutex);
+	Ncalls_to_GetEvent += Nskipped;
+	pthread_mutex_unlock(&in_progress_mutex);
+}
+
+//----------------
+// GetIOStats
+//----------------
+void JEventSource::GetIOStats(JEventSourceIOStats &stats)
+{
+	/// Fill in the given object with a snapshot of the I/O accounting
+	/// for this source. This may be called at any time from any
+	/// thread. The values are read without stopping the reader so
+	/// they may be very slightly inconsistent with one another.
+	stats.source_name = source_name;
+	stats.class_name = className();
+
+	uint64_t done_ticks = io_done_ticks;
+	uint64_t end_ticks = done_ticks!=0 ? done_ticks:JEventLoop::GetTicks();
+	stats.done_reading = done_ticks!=0;
+	stats.Nevents = io_Nevents;
+	stats.Nbytes = io_Nbytes;
+	stats.elapsed = 1.0E-9*(double)(end_ticks - io_open_ticks);
+	stats.getevent_time = 1.0E-9*(double)io_getevent_ticks;
+	stats.getevent_max = 1.0E-9*(double)io_getevent_max_ticks;
+	stats.buffer_full_time = 1.0E-9*(double)io_buffer_full_ticks;
+	stats.worker_wait_time = 1.0E-9*(double)io_worker_wait_ticks;
+	stats.Nworker_waits = io_Nworker_waits;
+	stats.getobjects_time = 1.0E-9*(double)io_getobjects_ticks;
+
+	stats.getobjects.clear();
+	pthread_mutex_lock(&io_mutex);
+	map<string, pair<uint64_t, uint64_t> >::iterator iter = io_getobjects.begin();
+	for(; iter!=io_getobjects.end(); iter++){
+		JEventSourceIOStats::getobjects_t &g = stats.getobjects[iter->first];
+		g.Ncalls = iter->second.first;
+		g.time = 1.0E-9*(double)iter->second.second;
+	}
+	pthread_mutex_unlock(&io_mutex);
+}
+
+//----------------
+// PrintIOStats
+//----------------
+void JEventSource::PrintIOStats(void)
+{
+	/// Print a summary of the I/O accounting for this source. This is
+	/// called by JApplication when the source is finished (unless
+	/// JANA:SOURCE_IO_STATS is set to 0).
+	JEventSourceIOStats stats;
+	GetIOStats(stats);
+
+	double Nevents = stats.Nevents>0 ? (double)stats.Nevents:1.0;
+
+	jout<<"I/O summary for source \""<<stats.source_name<<"\" ("<<stats.class_name<<"):"<<endl;
+	jout<<fixed<<setprecision(3);
+	jout<<"              events read: "<<stats.Nevents<<" in "<<stats.elapsed<<" s"<<endl;
+	if(stats.Nbytes>0){
+		jout<<"               bytes read: "<<stats.Nbytes<<" ("<<stats.GetByteRate()/1.0E6<<" MB/s overall, ";
+		jout<<stats.GetReadRate()/1.0E6<<" MB/s while reading)"<<endl;
+	}
+	jout<<"         time in GetEvent: "<<stats.getevent_time<<" s ("<<1.0E6*stats.getevent_time/Nevents<<" us/event, max "<<1.0E3*stats.getevent_max<<" ms)"<<endl;
+	jout<<"       reader utilization: "<<100.0*stats.GetReaderUtilization()<<" %"<<endl;
+	jout<<"  reader buffer-full wait: "<<stats.buffer_full_time<<" s"<<endl;
+	jout<<"    worker NextEvent wait: "<<stats.worker_wait_time<<" s (summed over threads, "<<stats.Nworker_waits<<" events waited for)"<<endl;
+	jout<<"       time in GetObjects: "<<stats.getobjects_time<<" s (summed over threads)"<<endl;
+	map<string, JEventSourceIOStats::getobjects_t>::iterator iter = stats.getobjects.begin();
+	for(; iter!=stats.getobjects.end(); iter++){
+		jout<<"          "<<setw(32)<<left<<iter->first<<right;
+		jout<<" "<<setw(10)<<iter->second.Ncalls<<" calls "<<setw(10)<<iter->second.time<<" s"<<endl;
+	}
+	jout.unsetf(ios::floatfield);
+	jout<<setprecision(6);
+}
+
+//---------------------------------
+// OpenInputStream
+//---------------------------------
+istream* JEventSource::OpenInputStream(const string &filename)
+{
+	/// Return an istream for reading the given file. The first bytes of
+	/// the file are checked for the gzip signature. If found, the file is
+	/// decompressed on separate threads (in parallel if it is BGZF) ahead
+	/// of the reads. Otherwise, the file is read through a plain ifstream.
+	if(!JDecompressStream::IsCompressed(filename)) return new ifstream(filename.c_str(), ios::binary);
+
+	unsigned int DECOMPRESS_THREADS = 4;
+	unsigned int DECOMPRESS_AHEAD = 0;
+	if(gPARMS){
+		gPARMS->SetDefaultParameter("JANA:DECOMPRESS_THREADS", DECOMPRESS_THREADS, "Number of threads used to decompress BGZF compressed input files");
+		gPARMS->SetDefaultParameter("JANA:DECOMPRESS_AHEAD", DECOMPRESS_AHEAD, "Max. number of compressed blocks decompressed ahead of the source (0=4*JANA:DECOMPRESS_THREADS)");
+	}
+	JDecompressStream *s = new JDecompressStream(filename, DECOMPRESS_THREADS, DECOMPRESS_AHEAD);
+	JDecompressStreamBuf *buf = s->GetBuf();
+	if(s->IsOpen()){
+		jout<<"Decompressing \""<<filename<<"\" ("<<JDecompressStreamBuf::GetFormatName(buf->GetFormat())<<") with "<<(buf->GetNthreads()>0 ? buf->GetNthreads():1)<<" thread(s)"<<endl;
+	}else{
+		jerr<<"Unable to decompress \""<<filename<<"\": "<<s->GetError()<<endl;
+	}
+
+	return s;
+}
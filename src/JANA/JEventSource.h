@@ -13,9 +13,12 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <map>
+#include <istream>
 using std::vector;
 using std::string;
 using std::set;
+using std::map;
 
 #include <pthread.h>
 
@@ -33,6 +36,51 @@ namespace jana{
 
 class JFactory_base;
 class JEvent;
+class JApplication;
+class JEventIndex;
+
+/// Snapshot of the I/O accounting kept by a JEventSource. This
+/// is filled by JEventSource::GetIOStats() and can be obtained for
+/// all active sources while processing with
+/// JApplication::GetSourceIOStats(). All times are wall clock
+/// times in seconds.
+///
+/// The "reader" is the event buffer thread that calls GetEvent. The
+/// "workers" are the processing threads that take events from the
+/// event buffer. A reader utilization near 1 means the job is limited
+/// by reading (I/O or parsing in GetEvent). A significant worker wait
+/// time with a low reader utilization means the event buffer is too
+/// shallow. A large buffer_full_time means the workers are the
+/// bottleneck (CPU bound).
+class JEventSourceIOStats{
+	public:
+		class getobjects_t{
+			public:
+				getobjects_t():Ncalls(0),time(0.0){}
+				uint64_t Ncalls;
+				double time;
+		};
+
+		JEventSourceIOStats():Nevents(0),Nbytes(0),elapsed(0.0),getevent_time(0.0),getevent_max(0.0),buffer_full_time(0.0),worker_wait_time(0.0),Nworker_waits(0),getobjects_time(0.0),done_reading(false){}
+
+		string source_name;
+		string class_name;
+		uint64_t Nevents;          ///< Events successfully returned by GetEvent
+		uint64_t Nbytes;           ///< Bytes read (only if the source reports them via AddBytesRead)
+		double elapsed;            ///< Time from source creation until it finished reading (or now)
+		double getevent_time;      ///< Time reader spent in GetEvent
+		double getevent_max;       ///< Longest single call to GetEvent
+		double buffer_full_time;   ///< Time reader was blocked waiting for space in the event buffer
+		double worker_wait_time;   ///< Time workers spent in NextEvent waiting for events from this source
+		uint64_t Nworker_waits;    ///< Number of events for which a worker had to wait at all
+		double getobjects_time;    ///< Time spent in GetObjects (all threads, all data types)
+		map<string, getobjects_t> getobjects; ///< GetObjects calls and time by "class:tag"
+		bool done_reading;
+
+		double GetReaderUtilization(void) const {return elapsed>0.0 ? getevent_time/elapsed:0.0;}
+		double GetReadRate(void) const {return getevent_time>0.0 ? (double)Nbytes/getevent_time:0.0;} ///< bytes/s while in GetEvent
+		double GetByteRate(void) const {return elapsed>0.0 ? (double)Nbytes/elapsed:0.0;} ///< bytes/s overall
+};
 
 
 /// This is the base class for event sources in JANA. See
@@ -96,6 +144,19 @@ class JEvent;
 /// 	</pre>
 /// </ul>
 ///
+/// Sources that can pass over events cheaply (e.g. by skipping whole
+/// blocks of a file, or because they have an index) can implement
+/// SkipEvents and SeekToEvent. JApplication uses them for the
+/// EVENTS_TO_SKIP and SKIP_TO_EVENT parameters instead of reading
+/// every unwanted event into a JEvent and discarding it.
+///
+/// Sources whose events are contiguous byte ranges in the input can
+/// also implement GetRawEvent to give those bytes. Events can then be
+/// skimmed (copied to a new file as they are) without decoding them.
+/// If the file format needs more than the event bytes concatenated,
+/// the source also gives the framing to write around them via
+/// GetRawFileHeader, GetRawEventHeader and GetRawFileTrailer.
+///
 
 
 class JEventSource{
@@ -112,8 +173,24 @@ class JEventSource{
 		virtual bool     HasRandomAccess(void){ return false; }          ///< Does base class support Random Access
 		virtual jerror_t GetEvent(uint64_t eventNumber, JEvent &event);  ///< Get specific event
 
+		virtual jerror_t SkipEvents(uint64_t Nevents, uint64_t &Nskipped);            ///< Skip events without reading them
+		virtual jerror_t SeekToEvent(uint64_t eventNumber, uint64_t &Nskipped);        ///< Skip ahead to the event with this event number
+		virtual const JEventIndex* GetEventIndex(void){return NULL;}                  ///< Event index of source (if it has one)
+
 		inline const char* GetSourceName(void){return source_name.c_str();} ///< Get this sources name
+		inline uint64_t GetSerial(void) const {return serial;} ///< Unique number for this source (never reused, unlike its address)
 		bool IsFinished(void);
+		void GetProgress(uint64_t &Ncompleted, bool &finished);   ///< Number of events from start of source that are all done (see JCheckpoint)
+		void SkippedEvents(uint64_t Nskipped);                    ///< Record events passed over with SkipEvents/SeekToEvent
+
+		// Raw event access (used by skimming sinks to copy events without decoding them)
+		virtual bool GetRawEvent(JEvent &event, const void* &data, uint64_t &size){return false;} ///< Get bytes of event exactly as in input
+		virtual void GetRawFileHeader(vector<char> &header){}                                    ///< Bytes to write at start of a file of raw events
+		virtual void GetRawEventHeader(JEvent &event, uint64_t size, vector<char> &header){}      ///< Bytes to write before each raw event
+		virtual void GetRawFileTrailer(vector<char> &trailer){}                                  ///< Bytes to write at end of a file of raw events
+
+		void GetIOStats(JEventSourceIOStats &stats);  ///< Get snapshot of I/O accounting for this source
+		void PrintIOStats(void);                      ///< Print summary of I/O accounting for this source
 
 	protected:
 		string source_name;
@@ -127,9 +204,47 @@ class JEventSource{
 
 		inline void LockRead(void){pthread_mutex_lock(&read_mutex);}
 		inline void UnlockRead(void){pthread_mutex_unlock(&read_mutex);}
-	
+
+		/// Subclasses should call this from GetEvent (or GetObjects if
+		/// data is read there) with the number of bytes read from the
+		/// underlying file/stream so that throughput can be reported.
+		inline void AddBytesRead(uint64_t Nbytes){__sync_fetch_and_add(&io_Nbytes, Nbytes);}
+
+		/// Open a file for reading through an istream. If the file is gzip
+		/// compressed, a JDecompressStream is returned which decompresses
+		/// it on JANA:DECOMPRESS_THREADS threads. Otherwise, an ifstream is
+		/// returned. The caller owns the stream.
+		std::istream* OpenInputStream(const string &filename);
+
 	private:
 
+		friend class JEvent;
+		friend class JApplication;
+
+		void ForgetEvent(JEvent &event);
+
+		// I/O accounting. Times are JEventLoop::GetTicks() (ns). The GetEvent
+		// and buffer values are only written by the event buffer thread.
+		// The others are updated atomically since they come from the
+		// processing threads.
+		uint64_t io_open_ticks;
+		uint64_t io_done_ticks;
+		uint64_t io_Nevents;
+		uint64_t io_Nbytes;
+		uint64_t io_getevent_ticks;
+		uint64_t io_getevent_max_ticks;
+		uint64_t io_buffer_full_ticks;
+		uint64_t io_worker_wait_ticks;
+		uint64_t io_Nworker_waits;
+		uint64_t io_getobjects_ticks;
+		map<string, std::pair<uint64_t, uint64_t> > io_getobjects; // key=class:tag val=(Ncalls, ticks). Entries are never removed.
+		pthread_mutex_t io_mutex;
+		uint64_t serial;
+
+		jerror_t GetObjectsTimed(JEvent &event, JFactory_base *factory);
+		inline void AddBufferFullTicks(uint64_t ticks){io_buffer_full_ticks += ticks;}
+		inline void AddWorkerWaitTicks(uint64_t ticks){__sync_fetch_and_add(&io_worker_wait_ticks, ticks); __sync_fetch_and_add(&io_Nworker_waits, 1);}
+
 };
 
 } // Close JANA namespace
@@ -0,0 +1,378 @@
+// $Id$
+//
+//    File: JEventSourceMMap.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <iostream>
+using namespace std;
+
+#include "JEventSourceMMap.h"
+#include "JEvent.h"
+#include "JStreamLog.h"
+#include "JParameterManager.h"
+using namespace jana;
+
+//---------------------------------
+// JEventSourceMMap    (Constructor)
+//---------------------------------
+JEventSourceMMap::JEventSourceMMap(const char *source_name):JEventSource(source_name)
+{
+	buff = NULL;
+	file_size = 0;
+	position = 0;
+	next_ordinal = 0;
+	have_index = false;
+	building_index = false;
+	Nwindows_released = 0;
+	last_readahead_window = 0;
+	pthread_mutex_init(&window_mutex, NULL);
+
+	uint32_t MMAP_WINDOW_MB = 16;
+	uint32_t EVENT_INDEX = 1;
+	Nreadahead = 2;
+	if(gPARMS){
+		gPARMS->SetDefaultParameter("JANA:MMAP_WINDOW_MB", MMAP_WINDOW_MB, "Size in MB of the windows memory mapped event sources are read ahead and released in");
+		gPARMS->SetDefaultParameter("JANA:MMAP_READAHEAD", Nreadahead, "Number of windows ahead of the current one memory mapped event sources ask the kernel to read in");
+		gPARMS->SetDefaultParameter("JANA:EVENT_INDEX", EVENT_INDEX, "Event index sidecar files (<source>.jidx): 0=ignore, 1=use if present, 2=use if present or write one while reading");
+	}
+	if(MMAP_WINDOW_MB<1) MMAP_WINDOW_MB = 1;
+
+	// Window size must be a multiple of the page size for madvise
+	uint64_t page_size = sysconf(_SC_PAGESIZE);
+	window_size = (uint64_t)MMAP_WINDOW_MB*1024*1024;
+	window_size = ((window_size + page_size - 1)/page_size)*page_size;
+
+	int fd = open(source_name, O_RDONLY);
+	if(fd<0){
+		jerr<<"Unable to open \""<<source_name<<"\": "<<strerror(errno)<<endl;
+		return;
+	}
+	struct stat st;
+	if(fstat(fd, &st)!=0 || st.st_size==0){
+		jerr<<"Unable to map \""<<source_name<<"\": "<<(st.st_size==0 ? "empty file":strerror(errno))<<endl;
+		close(fd);
+		return;
+	}
+	file_size = st.st_size;
+
+	void *addr = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(addr == MAP_FAILED){
+		jerr<<"Unable to map \""<<source_name<<"\": "<<strerror(errno)<<endl;
+		file_size = 0;
+		return;
+	}
+	buff = (const uint8_t*)addr;
+
+	uint64_t Nwindows = (file_size + window_size - 1)/window_size;
+	window_refs.resize(Nwindows, 0);
+	window_released.resize(Nwindows, false);
+
+	madvise((void*)buff, file_size, MADV_SEQUENTIAL);
+	ReadAhead(0);
+
+	if(EVENT_INDEX>=1){
+		have_index = index.Read(JEventIndex::GetIndexFilename(source_name), source_name);
+		if(have_index) jout<<"Using event index for \""<<source_name<<"\" ("<<index.GetNevents()<<" events)"<<endl;
+	}
+	building_index = !have_index && EVENT_INDEX>=2;
+}
+
+//---------------------------------
+// ~JEventSourceMMap    (Destructor)
+//---------------------------------
+JEventSourceMMap::~JEventSourceMMap()
+{
+	if(buff) munmap((void*)buff, file_size);
+}
+
+//---------------------------------
+// GetEvent
+//---------------------------------
+jerror_t JEventSourceMMap::GetEvent(JEvent &event)
+{
+	/// Get the next event from the file. The subclass' FindEvent is
+	/// called to tell how big it is. The event's ref is set to a View
+	/// of its bytes in the mapping and the windows it covers are
+	/// marked as in use until it is freed.
+	if(!buff) return EVENT_SOURCE_NOT_OPEN;
+	if(position >= file_size){
+		EndOfFile();
+		return NO_MORE_EVENTS_IN_SOURCE;
+	}
+
+	uint64_t Nbytes = 0;
+	jerror_t err = FindEvent(&buff[position], file_size-position, Nbytes, event);
+	if(err==NOERROR && (Nbytes==0 || Nbytes > file_size-position)) err = NO_MORE_EVENTS_IN_SOURCE;
+	if(err != NOERROR){
+		if(err == NO_MORE_EVENTS_IN_SOURCE) EndOfFile();
+		return err;
+	}
+	if(building_index) index.Add(event.GetRunNumber(), event.GetEventNumber(), position, Nbytes);
+
+	View *view = new View;
+	view->data = &buff[position];
+	view->size = Nbytes;
+	view->offset = position;
+	view->user = NULL;
+
+	uint64_t first_window = position/window_size;
+	uint64_t last_window = (position+Nbytes-1)/window_size;
+
+	pthread_mutex_lock(&window_mutex);
+	for(uint64_t i=first_window; i<=last_window; i++) window_refs[i]++;
+	position += Nbytes;
+	next_ordinal++;
+
+	// Release any windows we have now moved completely past that
+	// are no longer used by any events.
+	uint64_t current_window = position/window_size;
+	for(uint64_t i=first_window; i<current_window && i<window_refs.size(); i++){
+		if(window_refs[i]==0) ReleaseWindow(i);
+	}
+	pthread_mutex_unlock(&window_mutex);
+
+	if(current_window != last_readahead_window) ReadAhead(current_window);
+
+	AddBytesRead(Nbytes);
+	event.SetJEventSource(this);
+	event.SetRef(view);
+
+	return NOERROR;
+}
+
+//---------------------------------
+// FreeEvent
+//---------------------------------
+void JEventSourceMMap::FreeEvent(JEvent &event)
+{
+	/// Release the event's hold on the windows it covers. Any that
+	/// are now unused and that reading has moved past are released.
+	View *view = (View*)event.GetRef();
+	if(!view) return;
+
+	uint64_t first_window = view->offset/window_size;
+	uint64_t last_window = (view->offset+view->size-1)/window_size;
+
+	pthread_mutex_lock(&window_mutex);
+	uint64_t current_window = position/window_size;
+	for(uint64_t i=first_window; i<=last_window; i++){
+		if(window_refs[i]>0) window_refs[i]--;
+		if(window_refs[i]==0 && i<current_window) ReleaseWindow(i);
+	}
+	pthread_mutex_unlock(&window_mutex);
+
+	delete view;
+}
+
+//---------------------------------
+// GetRawEvent
+//---------------------------------
+bool JEventSourceMMap::GetRawEvent(JEvent &event, const void* &data, uint64_t &size)
+{
+	/// The raw event is just the event's View. Subclasses whose file
+	/// format needs framing around the events should also override
+	/// the GetRaw...Header methods of JEventSource.
+	View *view = (View*)event.GetRef();
+	if(!view) return false;
+	data = view->data;
+	size = view->size;
+	return true;
+}
+
+//---------------------------------
+// GetEvent
+//---------------------------------
+jerror_t JEventSourceMMap::GetEvent(uint64_t eventNumber, JEvent &event)
+{
+	/// Random access by event number using the event index. Reading
+	/// continues sequentially from the event after it.
+	const JEventIndex::Entry *e = have_index ? index.Find(eventNumber):NULL;
+	if(!e) return NO_MORE_EVENTS_IN_SOURCE;
+
+	SetPosition(e->offset, e->ordinal);
+	return GetEvent(event);
+}
+
+//---------------------------------
+// SkipEvents
+//---------------------------------
+jerror_t JEventSourceMMap::SkipEvents(uint64_t Nevents, uint64_t &Nskipped)
+{
+	/// With an event index, skipping is just a jump to the position
+	/// of the event after the skipped ones.
+	if(!have_index) return JEventSource::SkipEvents(Nevents, Nskipped);
+
+	uint64_t Nleft = index.GetNevents() - next_ordinal;
+	if(Nevents >= Nleft){
+		Nskipped = Nleft;
+		SkipBytes(file_size-position, Nleft);
+		return Nevents==Nleft ? NOERROR:NO_MORE_EVENTS_IN_SOURCE;
+	}
+
+	const JEventIndex::Entry *e = index.GetByOrdinal(next_ordinal+Nevents);
+	Nskipped = Nevents;
+	SetPosition(e->offset, e->ordinal);
+	return NOERROR;
+}
+
+//---------------------------------
+// SeekToEvent
+//---------------------------------
+jerror_t JEventSourceMMap::SeekToEvent(uint64_t eventNumber, uint64_t &Nskipped)
+{
+	/// Look the event up in the event index and jump to it. If it is
+	/// not in the index, or is before the current position, the rest of
+	/// the file is skipped.
+	if(!have_index) return JEventSource::SeekToEvent(eventNumber, Nskipped);
+
+	const JEventIndex::Entry *e = index.Find(eventNumber);
+	if(!e || e->ordinal<next_ordinal){
+		Nskipped = index.GetNevents() - next_ordinal;
+		SkipBytes(file_size-position, Nskipped);
+		return NO_MORE_EVENTS_IN_SOURCE;
+	}
+
+	Nskipped = e->ordinal - next_ordinal;
+	SetPosition(e->offset, e->ordinal);
+	return NOERROR;
+}
+
+//---------------------------------
+// BuildEventIndex
+//---------------------------------
+bool JEventSourceMMap::BuildEventIndex(JEventIndex &index)
+{
+	/// Fill the given index by scanning the whole file with FindEvent.
+	/// This does not change where the source is reading from, but
+	/// must not be called while it is being read since FindEvent is
+	/// not expected to be thread safe. Pages are released as the scan
+	/// moves past them. Returns false if the file could not be mapped.
+	index.Clear();
+	if(!buff) return false;
+
+	uint64_t pos = 0;
+	uint64_t released = 0;
+	while(pos < file_size){
+		JEvent event;
+		uint64_t Nbytes = 0;
+		if(FindEvent(&buff[pos], file_size-pos, Nbytes, event) != NOERROR) break;
+		if(Nbytes==0 || Nbytes > file_size-pos) break;
+		index.Add(event.GetRunNumber(), event.GetEventNumber(), pos, Nbytes);
+		pos += Nbytes;
+
+		uint64_t done = (pos/window_size)*window_size;
+		if(done > released){
+			madvise((void*)&buff[released], done-released, MADV_DONTNEED);
+			released = done;
+		}
+	}
+	index.Finish();
+
+	return true;
+}
+
+//---------------------------------
+// SkipBytes
+//---------------------------------
+void JEventSourceMMap::SkipBytes(uint64_t Nbytes, uint64_t Nevents)
+{
+	/// Move the read position ahead by Nbytes, which hold Nevents
+	/// events, without making any events. Windows that are skipped
+	/// entirely are never touched.
+	if(Nbytes > file_size-position) Nbytes = file_size-position;
+	SetPosition(position+Nbytes, next_ordinal+Nevents);
+}
+
+//---------------------------------
+// SetPosition
+//---------------------------------
+void JEventSourceMMap::SetPosition(uint64_t new_position, uint64_t ordinal)
+{
+	/// Move the read position. ordinal is the number of events before
+	/// the new position. Windows moved past that are not in use are
+	/// released. If moving back, windows that were released are
+	/// marked so they will be released again.
+	if(new_position > file_size) new_position = file_size;
+
+	// An index made while reading would be missing events now
+	if(building_index && !(new_position==position && ordinal==next_ordinal)) building_index = false;
+
+	pthread_mutex_lock(&window_mutex);
+	uint64_t first_window = position/window_size;
+	position = new_position;
+	next_ordinal = ordinal;
+	uint64_t current_window = position/window_size;
+	for(uint64_t i=first_window; i<current_window && i<window_refs.size(); i++){
+		if(window_refs[i]==0) ReleaseWindow(i);
+	}
+	for(uint64_t i=current_window; i<window_released.size(); i++) window_released[i] = false;
+	pthread_mutex_unlock(&window_mutex);
+
+	if(current_window != last_readahead_window) ReadAhead(current_window);
+}
+
+//---------------------------------
+// EndOfFile
+//---------------------------------
+void JEventSourceMMap::EndOfFile(void)
+{
+	/// Called when GetEvent finds no more events. If an event index
+	/// was being made and the whole file was read, write it.
+	if(!building_index) return;
+	building_index = false;
+
+	index.Finish();
+	string index_filename = JEventIndex::GetIndexFilename(source_name);
+	if(index.Write(index_filename, source_name)){
+		jout<<"Wrote event index \""<<index_filename<<"\" ("<<index.GetNevents()<<" events)"<<endl;
+		have_index = true;
+	}else{
+		jerr<<"Unable to write event index \""<<index_filename<<"\"!"<<endl;
+	}
+}
+
+//---------------------------------
+// ReadAhead
+//---------------------------------
+void JEventSourceMMap::ReadAhead(uint64_t iwindow)
+{
+	/// Ask the kernel to start reading in the given window and the
+	/// Nreadahead windows after it. This returns immediately.
+	last_readahead_window = iwindow;
+
+	uint64_t start = iwindow*window_size;
+	if(start >= file_size) return;
+	uint64_t len = (uint64_t)(Nreadahead+1)*window_size;
+	if(start+len > file_size) len = file_size - start;
+	madvise((void*)&buff[start], len, MADV_WILLNEED);
+}
+
+//---------------------------------
+// ReleaseWindow
+//---------------------------------
+void JEventSourceMMap::ReleaseWindow(uint64_t iwindow)
+{
+	/// Drop the pages of the given window from this process. They can
+	/// still be accessed (they would just be read in again). This must
+	/// be called with window_mutex locked.
+	if(window_released[iwindow]) return;
+
+	uint64_t start = iwindow*window_size;
+	uint64_t len = window_size;
+	if(start+len > file_size) len = file_size - start;
+	madvise((void*)&buff[start], len, MADV_DONTNEED);
+
+	window_released[iwindow] = true;
+	Nwindows_released++;
+}
+
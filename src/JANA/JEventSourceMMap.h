@@ -0,0 +1,122 @@
+// $Id$
+//
+//    File: JEventSourceMMap.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JEventSourceMMap_
+#define _JEventSourceMMap_
+
+#include <stdint.h>
+
+#include <vector>
+using std::vector;
+
+#include <JANA/JEventSource.h>
+#include <JANA/JEventIndex.h>
+
+// Place everything in JANA namespace
+namespace jana{
+
+/// JEventSourceMMap is a base class for event sources that read files
+/// whose events are contiguous byte ranges. The file is memory mapped
+/// and each event is handed to the framework as a JEventSourceMMap::View
+/// (via JEvent::GetRef()) which points directly into the mapping.
+/// Nothing is copied into private buffers.
+///
+/// To keep the resident memory bounded for large files, the mapping is
+/// treated as a sequence of fixed size windows (JANA:MMAP_WINDOW_MB).
+/// As reading moves into a window, the kernel is asked to start reading
+/// the next JANA:MMAP_READAHEAD windows in (MADV_WILLNEED). Once
+/// reading has moved past a window and every event that refers to it
+/// has been freed, its pages are released (MADV_DONTNEED).
+///
+/// Subclasses implement FindEvent() to tell how many bytes starting
+/// at a given position make up the next event. They implement
+/// GetObjects as usual, getting the bytes from the View. If they override
+/// FreeEvent, they must call JEventSourceMMap::FreeEvent() from it.
+/// Subclasses that can tell event sizes without looking at every event
+/// can implement SkipEvents/SeekToEvent using SkipBytes().
+///
+/// If there is an event index sidecar file for the source (see
+/// JEventIndex and the janaindex utility), it is used for random access
+/// by event number and for SkipEvents/SeekToEvent. JANA:EVENT_INDEX=2
+/// makes one while reading if there is none. It is written once the
+/// whole file has been read from start to end.
+
+class JEventSourceMMap:public JEventSource{
+	public:
+
+		/// What the ref of each JEvent from this source points to
+		class View{
+			public:
+				const uint8_t *data;   ///< first byte of event in mapping
+				uint64_t size;         ///< number of bytes in event
+				uint64_t offset;       ///< offset of first byte in file
+				void *user;            ///< for subclass use (not touched by base class)
+		};
+
+		JEventSourceMMap(const char *source_name);
+		virtual ~JEventSourceMMap();
+		virtual const char* className(void){return static_className();}
+		static const char* static_className(void){return "JEventSourceMMap";}
+
+		using JEventSource::GetEvent;
+		jerror_t GetEvent(JEvent &event);
+		virtual void FreeEvent(JEvent &event);
+		virtual bool GetRawEvent(JEvent &event, const void* &data, uint64_t &size);
+
+		bool HasRandomAccess(void){return have_index;}
+		jerror_t GetEvent(uint64_t eventNumber, JEvent &event);
+		jerror_t SkipEvents(uint64_t Nevents, uint64_t &Nskipped);
+		jerror_t SeekToEvent(uint64_t eventNumber, uint64_t &Nskipped);
+
+		bool BuildEventIndex(JEventIndex &index);
+		const JEventIndex* GetEventIndex(void){return have_index ? &index:NULL;}
+
+		bool IsMapped(void) const {return buff!=NULL;}
+		uint64_t GetFileSize(void) const {return file_size;}
+		uint64_t GetPosition(void) const {return position;}
+		uint64_t GetNwindowsReleased(void) const {return Nwindows_released;}
+
+	protected:
+
+		/// Determine the size of the event starting at data[0]. Navailable
+		/// is the number of bytes left in the file. Set Nbytes to the
+		/// number of bytes in the event and fill in the event and run
+		/// numbers in "event". Return NO_MORE_EVENTS_IN_SOURCE if there
+		/// is no complete event left.
+		virtual jerror_t FindEvent(const uint8_t *data, uint64_t Navailable, uint64_t &Nbytes, JEvent &event)=0;
+
+		void SkipBytes(uint64_t Nbytes, uint64_t Nevents);  ///< Move position ahead without making events (for SkipEvents)
+
+		const uint8_t *buff;
+		uint64_t file_size;
+		uint64_t position;
+
+	private:
+
+		uint64_t window_size;
+		uint32_t Nreadahead;
+		vector<uint32_t> window_refs;   // number of unfreed events using each window
+		vector<bool> window_released;
+		uint64_t Nwindows_released;
+		uint64_t last_readahead_window;
+		pthread_mutex_t window_mutex;
+
+		JEventIndex index;
+		bool have_index;
+		bool building_index;
+		uint64_t next_ordinal;          // number of events before position
+
+		void SetPosition(uint64_t new_position, uint64_t ordinal);
+		void EndOfFile(void);
+		void ReadAhead(uint64_t iwindow);
+		void ReleaseWindow(uint64_t iwindow);
+};
+
+} // Close JANA namespace
+
+#endif // _JEventSourceMMap_
+
@@ -0,0 +1,126 @@
+// $Id$
+//
+//    File: JEventSourceRing.cc
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#include <string.h>
+
+#include <iostream>
+using namespace std;
+
+#include "JEventSourceRing.h"
+#include "JEvent.h"
+#include "JStreamLog.h"
+#include "JParameterManager.h"
+using namespace jana;
+
+//---------------------------------
+// JEventSourceRing    (Constructor)
+//---------------------------------
+JEventSourceRing::JEventSourceRing(const char *source_name):JEventSource(source_name)
+{
+	double RING_ATTACH_TIMEOUT = 30.0;
+	if(gPARMS) gPARMS->SetDefaultParameter("JANA:RING_ATTACH_TIMEOUT", RING_ATTACH_TIMEOUT, "Seconds an event source of the form ring:NAME waits for the reader process to create the ring");
+
+	string name = GetRingName(source_name);
+	if(!ring.Attach(name, RING_ATTACH_TIMEOUT)){
+		jerr<<"Unable to attach to event ring \""<<name<<"\": "<<ring.GetError()<<endl;
+		return;
+	}
+	jout<<"Attached to event ring \""<<name<<"\" ("<<ring.Get()->Nslots<<" slots x "<<ring.GetSlotSize()<<" bytes)"<<endl;
+}
+
+//---------------------------------
+// ~JEventSourceRing    (Destructor)
+//---------------------------------
+JEventSourceRing::~JEventSourceRing()
+{
+
+}
+
+//---------------------------------
+// IsRingName
+//---------------------------------
+bool JEventSourceRing::IsRingName(const char *source_name)
+{
+	/// Return true if source_name has the form ring:NAME
+	return source_name!=NULL && strncmp(source_name, "ring:", 5)==0 && source_name[5]!=0;
+}
+
+//---------------------------------
+// GetRingName
+//---------------------------------
+string JEventSourceRing::GetRingName(const char *source_name)
+{
+	/// Return the NAME part of a source name of the form ring:NAME
+	return IsRingName(source_name) ? string(&source_name[5]):string(source_name);
+}
+
+//---------------------------------
+// GetEvent
+//---------------------------------
+jerror_t JEventSourceRing::GetEvent(JEvent &event)
+{
+	/// Claim the next event from the ring, waiting for the reader to put
+	/// one in if needed. The event's ref is set to a View of its bytes
+	/// in the ring's slot.
+	if(!IsAttached()) return EVENT_SOURCE_NOT_OPEN;
+
+	JEventRing::Event rev;
+	if(!ring.Claim(rev)){
+		if(!ring.GetError().empty()) jerr<<ring.GetError()<<endl;
+		return NO_MORE_EVENTS_IN_SOURCE;
+	}
+
+	View *view = new View;
+	view->data = rev.data;
+	view->size = rev.size;
+	view->slot = rev.slot;
+	view->user = NULL;
+
+	AddBytesRead(rev.size);
+	event.SetRunNumber(rev.run_number);
+	event.SetEventNumber(rev.event_number);
+	event.SetJEventSource(this);
+	event.SetRef(view);
+
+	return NOERROR;
+}
+
+//---------------------------------
+// FreeEvent
+//---------------------------------
+void JEventSourceRing::FreeEvent(JEvent &event)
+{
+	/// Give the event's slot back to the reader
+	View *view = (View*)event.GetRef();
+	if(!view) return;
+
+	ring.Release(view->slot);
+	delete view;
+}
+
+//---------------------------------
+// GetObjects
+//---------------------------------
+jerror_t JEventSourceRing::GetObjects(JEvent &event, JFactory_base *factory)
+{
+	/// Subclasses decode the raw bytes. By default nothing comes from
+	/// the source so all objects are made by factories.
+	return OBJECT_NOT_AVAILABLE;
+}
+
+//---------------------------------
+// GetRawEvent
+//---------------------------------
+bool JEventSourceRing::GetRawEvent(JEvent &event, const void* &data, uint64_t &size)
+{
+	/// The raw event is just the event's View
+	View *view = (View*)event.GetRef();
+	if(!view) return false;
+	data = view->data;
+	size = view->size;
+	return true;
+}
@@ -0,0 +1,70 @@
+// $Id$
+//
+//    File: JEventSourceRing.h
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#ifndef _JEventSourceRing_
+#define _JEventSourceRing_
+
+#include <stdint.h>
+
+#include <JANA/JEventSource.h>
+#include <JANA/JEventRing.h>
+
+// Place everything in JANA namespace
+namespace jana{
+
+/// JEventSourceRing is a base class for event sources that take raw
+/// events from a JEventRing in shared memory filled by a separate reader
+/// process (e.g. the janaring utility). Source names have the form
+/// "ring:NAME". Each event is handed to the framework as a
+/// JEventSourceRing::View (via JEvent::GetRef()) which points directly
+/// into the ring's slot. Nothing is copied. The slot is given back to
+/// the reader when the event is freed.
+///
+/// If the ring does not exist yet, the source waits for up to
+/// JANA:RING_ATTACH_TIMEOUT seconds for the reader to create it.
+///
+/// Subclasses implement GetObjects as usual, getting the bytes from
+/// the View. If they override FreeEvent, they must call
+/// JEventSourceRing::FreeEvent() from it.
+
+class JEventSourceRing:public JEventSource{
+	public:
+
+		/// What the ref of each JEvent from this source points to
+		class View{
+			public:
+				const uint8_t *data;   ///< first byte of event in ring
+				uint64_t size;         ///< number of bytes in event
+				uint32_t slot;         ///< ring slot holding the event
+				void *user;            ///< for subclass use (not touched by base class)
+		};
+
+		JEventSourceRing(const char *source_name);
+		virtual ~JEventSourceRing();
+		virtual const char* className(void){return static_className();}
+		static const char* static_className(void){return "JEventSourceRing";}
+
+		using JEventSource::GetEvent;
+		jerror_t GetEvent(JEvent &event);
+		virtual void FreeEvent(JEvent &event);
+		virtual jerror_t GetObjects(JEvent &event, JFactory_base *factory);
+		virtual bool GetRawEvent(JEvent &event, const void* &data, uint64_t &size);
+
+		bool IsAttached(void){return ring.Get()!=NULL;}
+		JEventRing& GetRing(void){return ring;}
+
+		static bool IsRingName(const char *source_name);
+		static string GetRingName(const char *source_name);
+
+	protected:
+		JEventRing ring;
+};
+
+} // Close JANA namespace
+
+#endif // _JEventSourceRing_
+
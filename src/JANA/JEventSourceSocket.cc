@@ -0,0 +1,229 @@
+// $Id$
+//
+//    File: JEventSourceSocket.cc
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#include <string.h>
+
+#include <iostream>
+using namespace std;
+
+#include "JEventSourceSocket.h"
+#include "JEvent.h"
+#include "JStreamLog.h"
+#include "JParameterManager.h"
+using namespace jana;
+
+//---------------------------------
+// JEventSourceSocket    (Constructor)
+//---------------------------------
+JEventSourceSocket::JEventSourceSocket(const char *source_name):JEventSource(source_name)
+{
+	fd = -1;
+	got_end = false;
+	Nbatches = 0;
+	pthread_mutex_init(&credit_mutex, NULL);
+	pthread_cond_init(&credit_cond, NULL);
+
+	Ncredits = 64;
+	double SOCKET_CONNECT_TIMEOUT = 30.0;
+	if(gPARMS){
+		gPARMS->SetDefaultParameter("JANA:SOCKET_CREDITS", Ncredits, "Most events a source reading from an event broker (unix:PATH or tcp:HOST:PORT) holds at once");
+		gPARMS->SetDefaultParameter("JANA:SOCKET_CONNECT_TIMEOUT", SOCKET_CONNECT_TIMEOUT, "Seconds a source reading from an event broker keeps trying to connect to it");
+	}
+	if(Ncredits < 1) Ncredits = 1;
+	Nunfilled = 0;
+	Nto_return = Ncredits;
+
+	string error;
+	fd = JEventSocket::Connect(source_name, SOCKET_CONNECT_TIMEOUT, error);
+	if(fd < 0){
+		jerr<<"Unable to connect to event broker: "<<error<<endl;
+		return;
+	}
+	jout<<"Connected to event broker at "<<source_name<<endl;
+}
+
+//---------------------------------
+// ~JEventSourceSocket    (Destructor)
+//---------------------------------
+JEventSourceSocket::~JEventSourceSocket()
+{
+	if(fd >= 0) close(fd);
+
+	// Events never given out
+	while(!queue.empty()){
+		View *view = queue.front();
+		queue.pop_front();
+		if(--view->batch->Nrefs == 0) delete view->batch;
+		delete view;
+	}
+
+	pthread_mutex_destroy(&credit_mutex);
+	pthread_cond_destroy(&credit_cond);
+}
+
+//---------------------------------
+// GetEvent
+//---------------------------------
+jerror_t JEventSourceSocket::GetEvent(JEvent &event)
+{
+	/// Get the next event, reading another batch from the broker if
+	/// none are left from the last one.
+	if(fd < 0) return EVENT_SOURCE_NOT_OPEN;
+
+	while(queue.empty()){
+		if(got_end) return NO_MORE_EVENTS_IN_SOURCE;
+
+		// Give credit for freed events back to the broker. To keep
+		// the number of messages down this is only done once half of
+		// it has come back unless the broker has none left at all. If
+		// every event we may hold is still in use, wait for one to be
+		// freed.
+		pthread_mutex_lock(&credit_mutex);
+		while(Nunfilled==0 && Nto_return==0) pthread_cond_wait(&credit_cond, &credit_mutex);
+		uint32_t Ncredit = 0;
+		if(Nto_return>0 && (Nunfilled==0 || Nto_return>=(Ncredits+1)/2)){
+			Ncredit = Nto_return;
+			Nto_return = 0;
+			Nunfilled += Ncredit;
+		}
+		pthread_mutex_unlock(&credit_mutex);
+
+		if(Ncredit > 0){
+			jsocket_header_t hdr;
+			JEventSocket::MakeHeader(hdr, JEventSocket::kCredit, Ncredit, 0);
+			if(!JEventSocket::WriteN(fd, &hdr, sizeof(hdr))){
+				jerr<<"Lost connection to event broker at "<<GetSourceName()<<endl;
+				return NO_MORE_EVENTS_IN_SOURCE;
+			}
+		}
+
+		if(!ReadBatch()) return NO_MORE_EVENTS_IN_SOURCE;
+	}
+
+	View *view = queue.front();
+	queue.pop_front();
+
+	AddBytesRead(view->size);
+	event.SetRunNumber(view->run_number);
+	event.SetEventNumber(view->event_number);
+	event.SetJEventSource(this);
+	event.SetRef(view);
+
+	return NOERROR;
+}
+
+//---------------------------------
+// ReadBatch
+//---------------------------------
+bool JEventSourceSocket::ReadBatch(void)
+{
+	/// Read one message from the broker. Events are added to the queue.
+	/// Returns false if the connection was lost or the message is bad.
+	jsocket_header_t hdr;
+	if(!JEventSocket::ReadN(fd, &hdr, sizeof(hdr))){
+		jerr<<"Lost connection to event broker at "<<GetSourceName()<<endl;
+		return false;
+	}
+	if(!JEventSocket::CheckHeader(hdr)){
+		jerr<<"Bad message from event broker at "<<GetSourceName()<<" (wrong version of JANA?)"<<endl;
+		return false;
+	}
+
+	if(hdr.type == JEventSocket::kEnd){
+		got_end = true;
+		return true;
+	}
+	if(hdr.type!=JEventSocket::kEvents || hdr.count==0 || hdr.size<hdr.count*sizeof(jsocket_event_t)){
+		jerr<<"Unexpected message from event broker at "<<GetSourceName()<<endl;
+		return false;
+	}
+
+	Batch *batch = new Batch;
+	batch->buff.resize(hdr.size);
+	batch->Nrefs = hdr.count;
+	if(!JEventSocket::ReadN(fd, &batch->buff[0], hdr.size)){
+		jerr<<"Lost connection to event broker at "<<GetSourceName()<<endl;
+		delete batch;
+		return false;
+	}
+
+	// The events must fill the rest of the message exactly
+	const jsocket_event_t *records = (const jsocket_event_t*)batch->buff.data();
+	uint64_t offset = hdr.count*sizeof(jsocket_event_t);
+	bool ok = true;
+	for(uint32_t i=0; ok && i<hdr.count; i++){
+		ok = records[i].size <= hdr.size-offset;
+		if(ok) offset += records[i].size;
+	}
+	if(!ok || offset!=hdr.size){
+		jerr<<"Bad event sizes in message from event broker at "<<GetSourceName()<<endl;
+		delete batch;
+		return false;
+	}
+
+	offset = hdr.count*sizeof(jsocket_event_t);
+	for(uint32_t i=0; i<hdr.count; i++){
+		View *view = new View;
+		view->data = batch->buff.data()+offset;
+		view->size = records[i].size;
+		view->run_number = records[i].run_number;
+		view->event_number = records[i].event_number;
+		view->batch = batch;
+		view->user = NULL;
+		queue.push_back(view);
+		offset += records[i].size;
+	}
+
+	pthread_mutex_lock(&credit_mutex);
+	Nunfilled = hdr.count<Nunfilled ? Nunfilled-hdr.count:0;
+	pthread_mutex_unlock(&credit_mutex);
+	Nbatches++;
+
+	return true;
+}
+
+//---------------------------------
+// FreeEvent
+//---------------------------------
+void JEventSourceSocket::FreeEvent(JEvent &event)
+{
+	/// Free the batch if this was its last event and give the credit
+	/// for it back.
+	View *view = (View*)event.GetRef();
+	if(!view) return;
+
+	pthread_mutex_lock(&credit_mutex);
+	if(--view->batch->Nrefs == 0) delete view->batch;
+	Nto_return++;
+	pthread_cond_signal(&credit_cond);
+	pthread_mutex_unlock(&credit_mutex);
+
+	delete view;
+}
+
+//---------------------------------
+// GetObjects
+//---------------------------------
+jerror_t JEventSourceSocket::GetObjects(JEvent &event, JFactory_base *factory)
+{
+	/// Subclasses decode the raw bytes. By default nothing comes from
+	/// the source so all objects are made by factories.
+	return OBJECT_NOT_AVAILABLE;
+}
+
+//---------------------------------
+// GetRawEvent
+//---------------------------------
+bool JEventSourceSocket::GetRawEvent(JEvent &event, const void* &data, uint64_t &size)
+{
+	/// The raw event is just the event's View
+	View *view = (View*)event.GetRef();
+	if(!view) return false;
+	data = view->data;
+	size = view->size;
+	return true;
+}
@@ -0,0 +1,101 @@
+// $Id$
+//
+//    File: JEventSourceSocket.h
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#ifndef _JEventSourceSocket_
+#define _JEventSourceSocket_
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <deque>
+#include <vector>
+using std::deque;
+using std::vector;
+
+#include <JANA/JEventSource.h>
+#include <JANA/JEventSocket.h>
+
+// Place everything in JANA namespace
+namespace jana{
+
+/// JEventSourceSocket is a base class for event sources that get raw
+/// events from an event broker (e.g. the janabroker utility) over a
+/// Unix domain or TCP socket. Source names are the broker's address:
+/// unix:/path/to/socket or tcp:host:port (see JEventSocket).
+///
+/// Events arrive in batches. Each event is handed to the framework as a
+/// JEventSourceSocket::View (via JEvent::GetRef()) pointing into the
+/// batch which is deleted once all of its events have been freed.
+///
+/// Flow control is credit based. The source tells the broker how many
+/// more events it may send (JANA:SOCKET_CREDITS to start with) and
+/// gives credit back as events are freed. The broker never sends more
+/// than it has been given credit for so a slow process never has more
+/// than JANA:SOCKET_CREDITS events waiting and fast ones are not held
+/// back by it.
+///
+/// If the broker is not running yet, the source keeps trying to
+/// connect for up to JANA:SOCKET_CONNECT_TIMEOUT seconds.
+///
+/// Subclasses implement GetObjects as usual, getting the bytes from
+/// the View. If they override FreeEvent, they must call
+/// JEventSourceSocket::FreeEvent() from it.
+
+class JEventSourceSocket:public JEventSource{
+	public:
+
+		/// Events received in one message from the broker
+		class Batch{
+			public:
+				vector<uint8_t> buff;
+				uint32_t Nrefs;        ///< events not yet freed
+		};
+
+		/// What the ref of each JEvent from this source points to
+		class View{
+			public:
+				const uint8_t *data;   ///< first byte of event in batch
+				uint64_t size;         ///< number of bytes in event
+				int32_t run_number;
+				uint64_t event_number;
+				Batch *batch;
+				void *user;            ///< for subclass use (not touched by base class)
+		};
+
+		JEventSourceSocket(const char *source_name);
+		virtual ~JEventSourceSocket();
+		virtual const char* className(void){return static_className();}
+		static const char* static_className(void){return "JEventSourceSocket";}
+
+		using JEventSource::GetEvent;
+		jerror_t GetEvent(JEvent &event);
+		virtual void FreeEvent(JEvent &event);
+		virtual jerror_t GetObjects(JEvent &event, JFactory_base *factory);
+		virtual bool GetRawEvent(JEvent &event, const void* &data, uint64_t &size);
+
+		bool IsConnected(void) const {return fd>=0;}
+		uint64_t GetNbatches(void) const {return Nbatches;}
+
+	protected:
+
+		bool ReadBatch(void);
+
+		int fd;
+		uint32_t Ncredits;           ///< JANA:SOCKET_CREDITS
+		uint32_t Nunfilled;          ///< credit given to broker not yet used
+		uint32_t Nto_return;         ///< freed events not yet given back as credit
+		bool got_end;
+		uint64_t Nbatches;
+		deque<View*> queue;          ///< received but not yet given out
+		pthread_mutex_t credit_mutex;
+		pthread_cond_t credit_cond;
+};
+
+} // Close JANA namespace
+
+#endif // _JEventSourceSocket_
+
@@ -17,6 +17,7 @@ using std::string;
 #include "JEventLoop.h"
 #include "JFactory_base.h"
 #include "JEvent.h"
+#include "JFactoryCache.h"
 
 // The following is here just so we can use ROOT's THtml class to generate documentation.
 #if defined(__CINT__) || defined(__CLING__)
@@ -81,6 +82,7 @@ class JFactory:public JFactory_base{
 		inline const char* className(void){return T::static_className();}
 		inline const char* GetDataClassName(void){return className();}
 		inline void toStrings(vector<vector<pair<string,string> > > &items, bool append_types=false) const;
+		inline void GetExistingObjects(vector<const JObject*> &objs) const;
 		virtual const char* Tag(void){return tag_str;}
 		inline int GetDataClassSize(void){return sizeof(T);}
 		inline int GetEventCalled(void){return evnt_called;}
@@ -101,8 +103,11 @@ class JFactory:public JFactory_base{
 		jerror_t Reset(void);
 		jerror_t HardReset(void);
 		void SetFactoryPointers(void);
+		bool LoadFromCache(JFactoryCache *cache, int32_t run_number, uint64_t event_number);
+		void StoreInCache(uint64_t event_number);
 		
 		data_origin_t data_origin;
+		const vector<JField> *cache_fields;
 };
 
 
@@ -129,6 +134,14 @@ JFactory<T>::JFactory(const char *tag)
 	tag_str = tag;
 	Ncalls_to_Get = 0;
 	Ncalls_to_evnt = 0;
+	evnt_ticks = 0;
+	cache_version = 0;
+	cache_table = NULL;
+	cache_run = 0;
+	cache_run_valid = false;
+	cache_fields = NULL;
+	getobjects_source_serial = 0;
+	getobjects_counts = NULL;
 
 	// Allow any factory to have its debug_level set via environment variable
 	debug_level = 0;
@@ -289,18 +302,35 @@ jerror_t JFactory<T>::Get(vector<const T*> &d)
 		brun_eventnumber = event_number;
 	}
 	
+	// Use the objects from the factory cache if they are there
+	JFactoryCache *cache = TestFactoryFlag(CACHEABLE) ? eventLoop->GetFactoryCache():NULL;
+	if(cache && LoadFromCache(cache, run_number, event_number)){
+		CopyFrom(d);
+		evnt_called = 1;
+		busy = 0;
+		return NOERROR;
+	}
+
 	// Call evnt routine to generate data
+	JFactoryMonitor *monitor = eventLoop->GetFactoryMonitor();
+	uint64_t start_ticks = JEventLoop::GetTicks();
 	try{
 		Ncalls_to_evnt++;
+		if(monitor) monitor->EvntStart(this);
 		evnt(eventLoop, event_number);
+		if(monitor) monitor->EvntEnd(this);
+		evnt_ticks += JEventLoop::GetTicks() - start_ticks;
 		CopyFrom(d);
 	}catch(std::exception &e){
+		if(monitor) monitor->EvntEnd(this);
+		evnt_ticks += JEventLoop::GetTicks() - start_ticks;
 		string tag_plus = string(Tag()) + " (evnt)";
 		JEventLoop::error_call_stack_t cs = {GetDataClassName(), tag_plus.c_str(), __FILE__, __LINE__};
 		eventLoop->AddToErrorCallStack(cs);
 		busy = 0; // clear busy flag since where exiting early and no longer "busy"
 		throw e;
 	}
+	if(cache && cache_table && cache->CanWrite()) StoreInCache(event_number);
 	evnt_called = 1;
 	busy=0;
 	
@@ -408,6 +438,88 @@ void JFactory<T>::SetFactoryPointers(void)
 	}
 }
 
+//-------------
+// LoadFromCache
+//-------------
+template<class T>
+bool JFactory<T>::LoadFromCache(JFactoryCache *cache, int32_t run_number, uint64_t event_number)
+{
+	/// Fill _data with objects for this event read from the factory
+	/// cache (see JFactoryCache). Returns false if they are not there
+	/// or can not be read, in which case evnt should be called.
+	///
+	/// The cache table is looked up on the first call for each run.
+
+	if(!cache_run_valid || run_number!=cache_run){
+		// Make an object just to get its fields
+		T *t = JFactoryCacheNew<T>::New();
+		cache_fields = t ? static_cast<JObject*>(t)->GetFields():NULL;
+		delete t;
+		cache_table = cache->GetTable(this, eventLoop, cache_fields);
+		cache_run = run_number;
+		cache_run_valid = true;
+	}
+	if(!cache_table || !cache->CanRead()) return false;
+
+	vector<char> buff;
+	if(!cache_table->Load(event_number, buff)) return false;
+
+	// Data is number of objects followed by the fields of each
+	const char *ptr = buff.empty() ? NULL:&buff[0];
+	const char *end = ptr + buff.size();
+	uint32_t Nobjects = 0;
+	bool ok = buff.size() >= sizeof(Nobjects);
+	if(ok){
+		memcpy(&Nobjects, ptr, sizeof(Nobjects));
+		ptr += sizeof(Nobjects);
+	}
+	vector<T*> objs;
+	for(uint32_t i=0; ok && i<Nobjects; i++){
+		T *t = JFactoryCacheNew<T>::New();
+		objs.push_back(t);
+		ok = JField::Deserialize(static_cast<JObject*>(t), *cache_fields, ptr, end);
+	}
+	if(!ok || ptr!=end){
+		for(unsigned int i=0; i<objs.size(); i++) delete objs[i];
+		__sync_fetch_and_add(&cache_table->Nbad, 1);
+		return false;
+	}
+
+	_data.insert(_data.end(), objs.begin(), objs.end());
+
+	return true;
+}
+
+//-------------
+// StoreInCache
+//-------------
+template<class T>
+void JFactory<T>::StoreInCache(uint64_t event_number)
+{
+	/// Write the objects evnt just made for this event to the factory
+	/// cache. Nothing is written if any of them is of a class derived
+	/// from T that has its own fields since it would be read back as
+	/// a plain T. Once a write to the table fails nothing more is
+	/// stored in it. Events not stored for either reason are counted.
+	if(!cache_table->CanStore()){
+		__sync_fetch_and_add(&cache_table->Nfailed, 1);
+		return;
+	}
+	vector<char> buff;
+	uint32_t Nobjects = _data.size();
+	buff.resize(sizeof(Nobjects));
+	memcpy(&buff[0], &Nobjects, sizeof(Nobjects));
+	for(unsigned int i=0; i<_data.size(); i++){
+		const JObject *obj = static_cast<const JObject*>(_data[i]);
+		if(obj->GetFields() != cache_fields){
+			__sync_fetch_and_add(&cache_table->Nderived, 1);
+			return;
+		}
+		JField::Serialize(obj, *cache_fields, buff);
+	}
+	if(!cache_table->Store(event_number, buff)) __sync_fetch_and_add(&cache_table->Nfailed, 1);
+}
+
 //-------------
 // CopyTo
 //-------------
@@ -550,6 +662,24 @@ void JFactory<T>::toStrings(vector<vector<pair<string,string> > > &items, bool a
 	}
 }
 
+//-------------
+// GetExistingObjects
+//-------------
+template<class T>
+void JFactory<T>::GetExistingObjects(vector<const JObject*> &objs) const
+{
+	/// Fill objs with pointers to the JObject part of the objects
+	/// already created by this factory for the current event. Like
+	/// toStrings, this will not activate the factory. Generic output
+	/// plugins can use this with JObject::GetFields() to read the
+	/// data members of classes that declare them.
+	///
+	/// The objs vector is cleared upon entry.
+
+	objs.clear();
+	for(unsigned int i=0;i<_data.size();i++) objs.push_back(static_cast<const JObject*>(_data[i]));
+}
+
 #endif //__CINT__  __CLING__
 
 
@@ -0,0 +1,438 @@
+// $Id$
+//
+//    File: JFactoryCache.cc
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <iomanip>
+#include <sstream>
+using namespace std;
+
+#include "JFactoryCache.h"
+#include "JFactory_base.h"
+#include "JEventLoop.h"
+#include "JParameterManager.h"
+#include "JStreamLog.h"
+#include "md5.h"
+using namespace jana;
+
+//---------------------------------
+// JFactoryCacheTable    (Constructor)
+//---------------------------------
+JFactoryCacheTable::JFactoryCacheTable(const string &filename, const string &nametag)
+{
+	this->filename = filename;
+	this->nametag = nametag;
+	fd = -1;
+	writable = false;
+	pthread_mutex_init(&mutex, NULL);
+
+	Nlookups = 0;
+	Nhits = 0;
+	Nstored = 0;
+	Nbad = 0;
+	Nfailed = 0;
+	Nderived = 0;
+	Nbytes_read = 0;
+	Nbytes_written = 0;
+}
+
+//---------------------------------
+// ~JFactoryCacheTable    (Destructor)
+//---------------------------------
+JFactoryCacheTable::~JFactoryCacheTable()
+{
+	if(fd>=0) close(fd);
+	pthread_mutex_destroy(&mutex);
+}
+
+//---------------------------------
+// Lock
+//---------------------------------
+bool JFactoryCacheTable::Lock(short type)
+{
+	/// Lock (F_RDLCK or F_WRLCK) or unlock (F_UNLCK) the whole file,
+	/// waiting if another process holds it. These are POSIX record locks
+	/// rather than flock() locks since they are owned by the process. A
+	/// file opened before the JANA:NPROCESSES workers were forked is
+	/// shared by all of them and flock() would not keep them apart.
+	/// Threads of this process are kept apart by mutex.
+	struct flock fl;
+	memset(&fl, 0, sizeof(fl));
+	fl.l_type = type;
+	fl.l_whence = SEEK_SET;
+	fl.l_start = 0;
+	fl.l_len = 0; // whole file
+	while(fcntl(fd, F_SETLKW, &fl)!=0){
+		if(errno!=EINTR) return false;
+	}
+	return true;
+}
+
+//---------------------------------
+// Open
+//---------------------------------
+bool JFactoryCacheTable::Open(bool writable, string &error)
+{
+	/// Open the file and read the headers of the records already in it.
+	/// If writable is true, the file is created if it does not exist
+	/// and, if the last record is incomplete, truncated to remove it so
+	/// records appended later can be found. Otherwise the file is only
+	/// read and a missing file just means the table is empty. The file
+	/// is locked while it is scanned. Since Store holds the same lock
+	/// while appending, an incomplete record seen here was left by a
+	/// job that died and not one still being written.
+	this->writable = writable;
+	if(writable){
+		fd = open(filename.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+	}else{
+		fd = open(filename.c_str(), O_RDONLY);
+		if(fd<0 && errno==ENOENT) return true;
+	}
+	if(fd<0){
+		error = "Unable to open \"" + filename + "\": " + strerror(errno);
+		return false;
+	}
+
+	if(!Lock(writable ? F_WRLCK:F_RDLCK)){
+		error = "Unable to lock \"" + filename + "\": " + strerror(errno);
+		return false;
+	}
+
+	struct stat st;
+	if(fstat(fd, &st)!=0){
+		error = "Unable to stat \"" + filename + "\": " + strerror(errno);
+		Lock(F_UNLCK);
+		return false;
+	}
+
+	uint64_t offset = 0;
+	uint64_t file_size = st.st_size;
+	while(offset + sizeof(jfcache_record_t) <= file_size){
+		jfcache_record_t rec;
+		if(pread(fd, &rec, sizeof(rec), offset) != (ssize_t)sizeof(rec)) break;
+		if(rec.magic != JFCACHE_MAGIC) break;
+		uint64_t data_offset = offset + sizeof(rec);
+		if(data_offset + rec.size > file_size) break;
+		index[rec.event] = std::make_pair(data_offset, rec.size); // later records replace earlier ones
+		offset = data_offset + rec.size;
+	}
+	if(offset < file_size && !writable){
+		jerr<<"Factory cache file \""<<filename<<"\" has "<<file_size-offset<<" bytes of incomplete or bad data at the end. Ignoring it."<<endl;
+	}else if(offset < file_size){
+		jerr<<"Factory cache file \""<<filename<<"\" has "<<file_size-offset<<" bytes of incomplete or bad data at the end. Removing it."<<endl;
+		if(ftruncate(fd, offset)!=0){
+			error = "Unable to truncate \"" + filename + "\": " + strerror(errno);
+			Lock(F_UNLCK);
+			return false;
+		}
+	}
+	Lock(F_UNLCK);
+
+	return true;
+}
+
+//---------------------------------
+// Load
+//---------------------------------
+bool JFactoryCacheTable::Load(uint64_t event, vector<char> &buff)
+{
+	/// Copy the data stored for the given event into buff. Returns false
+	/// if there is none. The record's header is read again and checked
+	/// so that if the file was changed behind our back (e.g. truncated
+	/// by hand) we do not hand back some other event's data.
+	__sync_fetch_and_add(&Nlookups, 1);
+
+	pthread_mutex_lock(&mutex);
+	map<uint64_t, std::pair<uint64_t, uint64_t> >::iterator it = index.find(event);
+	bool found = it!=index.end();
+	uint64_t offset = found ? it->second.first:0;
+	uint64_t size = found ? it->second.second:0;
+	pthread_mutex_unlock(&mutex);
+	if(!found) return false;
+
+	jfcache_record_t rec;
+	if(pread(fd, &rec, sizeof(rec), offset-sizeof(rec)) != (ssize_t)sizeof(rec)) return false;
+	if(rec.magic!=JFCACHE_MAGIC || rec.event!=event || rec.size!=size) return false;
+	buff.resize(size);
+	if(size>0 && pread(fd, &buff[0], size, offset) != (ssize_t)size) return false;
+
+	__sync_fetch_and_add(&Nhits, 1);
+	__sync_fetch_and_add(&Nbytes_read, size);
+	return true;
+}
+
+//---------------------------------
+// Store
+//---------------------------------
+bool JFactoryCacheTable::Store(uint64_t event, const vector<char> &buff)
+{
+	/// Append the data for the given event to the file. The header and
+	/// data are written with a single write() so that records from
+	/// other processes appending to the same file are not mixed in.
+	/// The file is locked while writing (see Open). If the write fails,
+	/// the part of the record that was written is truncated away and the
+	/// table is made read-only. Returns false if the record was not stored.
+	jfcache_record_t rec;
+	rec.magic = JFCACHE_MAGIC;
+	rec.event = event;
+	rec.size = buff.size();
+
+	vector<char> out(sizeof(rec) + buff.size());
+	memcpy(&out[0], &rec, sizeof(rec));
+	if(!buff.empty()) memcpy(&out[sizeof(rec)], &buff[0], buff.size());
+
+	pthread_mutex_lock(&mutex);
+	if(!writable){
+		pthread_mutex_unlock(&mutex);
+		return false;
+	}
+	if(!Lock(F_WRLCK)){
+		writable = false;
+		pthread_mutex_unlock(&mutex);
+		jerr<<"Unable to lock factory cache file \""<<filename<<"\": "<<strerror(errno)<<". No more "<<nametag<<" objects will be stored in it."<<endl;
+		return false;
+	}
+	ssize_t N = write(fd, &out[0], out.size());
+	if(N != (ssize_t)out.size()){
+		string why = N<0 ? strerror(errno):"short write";
+		writable = false;
+		if(N>0){
+			// With O_APPEND the file position is left at the end of what we wrote
+			off_t end = lseek(fd, 0, SEEK_CUR);
+			if(end<0 || ftruncate(fd, end-N)!=0) why += string(" (unable to remove partial record: ") + strerror(errno) + ")";
+		}
+		Lock(F_UNLCK);
+		pthread_mutex_unlock(&mutex);
+		jerr<<"Unable to write to factory cache file \""<<filename<<"\": "<<why<<". No more "<<nametag<<" objects will be stored in it."<<endl;
+		return false;
+	}
+	// With O_APPEND the file position is left at the end of what we wrote
+	off_t end = lseek(fd, 0, SEEK_CUR);
+	Lock(F_UNLCK);
+	index[event] = std::make_pair((uint64_t)end - buff.size(), (uint64_t)buff.size());
+	pthread_mutex_unlock(&mutex);
+
+	__sync_fetch_and_add(&Nstored, 1);
+	__sync_fetch_and_add(&Nbytes_written, out.size());
+	return true;
+}
+
+
+//---------------------------------
+// JFactoryCache    (Constructor)
+//---------------------------------
+JFactoryCache::JFactoryCache(const string &dir, mode_t mode)
+{
+	this->dir = dir;
+	this->mode = mode;
+	pthread_mutex_init(&mutex, NULL);
+
+	if(mkdir(dir.c_str(), 0755)!=0 && errno!=EEXIST){
+		jerr<<"Unable to create factory cache directory \""<<dir<<"\": "<<strerror(errno)<<endl;
+	}
+}
+
+//---------------------------------
+// ~JFactoryCache    (Destructor)
+//---------------------------------
+JFactoryCache::~JFactoryCache()
+{
+	map<string, JFactoryCacheTable*>::iterator it = tables.begin();
+	for(; it!=tables.end(); it++) delete it->second;
+	tables.clear();
+	pthread_mutex_destroy(&mutex);
+}
+
+//---------------------------------
+// ParseMode
+//---------------------------------
+bool JFactoryCache::ParseMode(const string &str, mode_t &mode)
+{
+	/// Convert the value of JANA:FACTORY_CACHE_MODE
+	if(str=="rw")    { mode = kReadWrite; return true; }
+	if(str=="read")  { mode = kRead;      return true; }
+	if(str=="write") { mode = kWrite;     return true; }
+	return false;
+}
+
+//---------------------------------
+// GetContext
+//---------------------------------
+uint64_t JFactoryCache::GetContext(JFactory_base *fac, const vector<JField> &fields)
+{
+	/// Hash everything other than the run and event that the factory's
+	/// output depends on (as far as we can tell). See the comments in
+	/// JFactoryCache.h for what goes in.
+	stringstream ss;
+	ss<<fac->GetDataClassName()<<":"<<fac->Tag()<<"\n";
+	ss<<"version "<<fac->GetCacheVersion()<<"\n";
+	for(unsigned int i=0; i<fields.size(); i++){
+		ss<<"field "<<fields[i].name<<" "<<fields[i].GetTypeName()<<"\n";
+	}
+
+	const vector<string> &keys = fac->GetCacheParameters();
+	for(unsigned int i=0; i<keys.size(); i++){
+		string val = "<unset>";
+		try{
+			gPARMS->GetParameter(keys[i], val);
+		}catch(...){}
+		ss<<"param "<<keys[i]<<"="<<val<<"\n";
+	}
+
+	// Same as used by JApplication::GetJCalibration
+	string url     = "file://./";
+	string context = "default";
+	if( getenv("JANA_CALIB_URL"    )!=NULL ) url     = getenv("JANA_CALIB_URL");
+	if( getenv("JANA_CALIB_CONTEXT")!=NULL ) context = getenv("JANA_CALIB_CONTEXT");
+	gPARMS->SetDefaultParameter("JANA_CALIB_URL",     url,     "URL used to access calibration constants");
+	gPARMS->SetDefaultParameter("JANA_CALIB_CONTEXT", context, "Calibration context to pass on to concrete JCalibration derived class");
+	ss<<"calib "<<url<<" "<<context<<"\n";
+
+	string str = ss.str();
+	md5_state_t pms;
+	md5_byte_t digest[16];
+	md5_init(&pms);
+	md5_append(&pms, (const md5_byte_t *)str.c_str(), str.size());
+	md5_finish(&pms, digest);
+
+	uint64_t hash = 0;
+	for(int i=0; i<8; i++) hash = (hash<<8) | digest[i];
+	return hash;
+}
+
+//---------------------------------
+// GetTable
+//---------------------------------
+JFactoryCacheTable* JFactoryCache::GetTable(JFactory_base *fac, JEventLoop *loop, const vector<JField> *fields)
+{
+	/// Get the table for the factory's outputs for the run of the
+	/// event currently in loop. This is called by JFactory<T> when it
+	/// starts on a new run. fields should be those of the factory's
+	/// object class or NULL if it does not have any (or can not be
+	/// made with a default constructor). NULL is returned if the
+	/// factory can not be cached. A message saying why is printed
+	/// the first time for each factory.
+	string nametag = fac->GetDataClassName();
+	if(string(fac->Tag())!="") nametag += string(":") + fac->Tag();
+
+	string why;
+	if(fields==NULL){
+		why = "its class has no default constructor or does not declare its fields with JOBJECT_FIELDS";
+	}else if(fac->TestFactoryFlag(JFactory_base::PERSISTANT)){
+		why = "it is PERSISTANT";
+	}else if(fac->TestFactoryFlag(JFactory_base::NOT_OBJECT_OWNER)){
+		why = "it is NOT_OBJECT_OWNER";
+	}
+
+	uint64_t context = why.empty() ? GetContext(fac, *fields):0;
+	int32_t run = loop->GetJEvent().GetRunNumber();
+
+	string fname = nametag;
+	for(unsigned int i=0; i<fname.size(); i++){
+		if(fname[i]==':' || fname[i]=='/') fname[i] = '_';
+	}
+	stringstream ss;
+	ss<<dir<<"/"<<fname<<"."<<hex<<setw(16)<<setfill('0')<<context<<dec<<"."<<run<<".jfc";
+	string filename = ss.str();
+
+	pthread_mutex_lock(&mutex);
+
+	if(!why.empty()){
+		if(not_cacheable.find(nametag)==not_cacheable.end()){
+			jerr<<"Factory "<<nametag<<" is flagged CACHEABLE but can not be cached since "<<why<<endl;
+			not_cacheable.insert(nametag);
+		}
+		pthread_mutex_unlock(&mutex);
+		return NULL;
+	}
+
+	JFactoryCacheTable *table = NULL;
+	map<string, JFactoryCacheTable*>::iterator it = tables.find(filename);
+	if(it!=tables.end()){
+		table = it->second;
+	}else{
+		table = new JFactoryCacheTable(filename, nametag);
+		string error;
+		if(!table->Open(CanWrite(), error)){
+			jerr<<"Factory cache for "<<nametag<<" not used: "<<error<<endl;
+			delete table;
+			table = NULL;
+		}
+		tables[filename] = table; // NULL entries keep us from trying again
+	}
+
+	pthread_mutex_unlock(&mutex);
+
+	return table;
+}
+
+//---------------------------------
+// PrintStats
+//---------------------------------
+void JFactoryCache::PrintStats(void)
+{
+	/// Print number of lookups and hits for each factory (summed over runs)
+	typedef struct{
+		uint64_t Nlookups;
+		uint64_t Nhits;
+		uint64_t Nstored;
+		uint64_t Nbad;
+		uint64_t Nfailed;
+		uint64_t Nderived;
+		uint64_t Nbytes_read;
+		uint64_t Nbytes_written;
+	}totals_t;
+	map<string, totals_t> totals;
+	pthread_mutex_lock(&mutex);
+	map<string, JFactoryCacheTable*>::iterator it = tables.begin();
+	for(; it!=tables.end(); it++){
+		JFactoryCacheTable *table = it->second;
+		if(!table) continue;
+		if(totals.find(table->GetNametag())==totals.end()){
+			totals_t zero = {0, 0, 0, 0, 0, 0, 0, 0};
+			totals[table->GetNametag()] = zero;
+		}
+		totals_t &t = totals[table->GetNametag()];
+		t.Nlookups       += table->Nlookups;
+		t.Nhits          += table->Nhits;
+		t.Nstored        += table->Nstored;
+		t.Nbad           += table->Nbad;
+		t.Nfailed        += table->Nfailed;
+		t.Nderived       += table->Nderived;
+		t.Nbytes_read    += table->Nbytes_read;
+		t.Nbytes_written += table->Nbytes_written;
+	}
+	pthread_mutex_unlock(&mutex);
+
+	if(totals.empty()) return;
+
+	// Hits that could not be used had evnt called so are counted as misses
+	const char *modes[] = {"rw", "read", "write"};
+	jout<<"Factory cache \""<<dir<<"\" (mode "<<modes[mode]<<"):"<<endl;
+	jout<<"   factory                          lookups       hits   hit rate     stored   MB read  MB written"<<endl;
+	map<string, totals_t>::iterator itt = totals.begin();
+	for(; itt!=totals.end(); itt++){
+		totals_t &t = itt->second;
+		uint64_t Nhits = t.Nhits - t.Nbad;
+		double rate = t.Nlookups>0 ? 100.0*(double)Nhits/(double)t.Nlookups:0.0;
+		stringstream ss;
+		ss<<"   "<<left<<setw(30)<<itt->first<<right;
+		ss<<setw(10)<<t.Nlookups<<" "<<setw(10)<<Nhits<<" "<<setw(9)<<fixed<<setprecision(1)<<rate<<"% ";
+		ss<<setw(10)<<t.Nstored<<" "<<setw(9)<<setprecision(2)<<1.0E-6*(double)t.Nbytes_read<<" "<<setw(11)<<1.0E-6*(double)t.Nbytes_written;
+		if(t.Nbad) ss<<"  ("<<t.Nbad<<" unreadable)";
+		if(t.Nfailed) ss<<"  ("<<t.Nfailed<<" not stored)";
+		if(t.Nderived) ss<<"  ("<<t.Nderived<<" not cacheable)";
+		jout<<ss.str()<<endl;
+	}
+}
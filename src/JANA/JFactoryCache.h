@@ -0,0 +1,166 @@
+// $Id$
+//
+//    File: JFactoryCache.h
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#ifndef _JFactoryCache_
+#define _JFactoryCache_
+
+#include <stdint.h>
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <type_traits>
+using std::string;
+using std::vector;
+using std::map;
+using std::set;
+
+#include "JField.h"
+
+// Place everything in JANA namespace
+namespace jana{
+
+class JFactory_base;
+class JEventLoop;
+
+/// JFactoryCacheTable holds the cached outputs of one factory for one
+/// run and one context (see JFactoryCache). They are kept in a file
+/// that records are only ever appended to. Each record is a
+/// jfcache_record_t followed by the serialized objects for one event.
+/// The file is scanned when the table is opened to find the events it
+/// already has. A record cut short (e.g. because the job writing it
+/// died) ends the scan and is truncated away. The file is locked while
+/// it is scanned and while records are appended so that other jobs (or
+/// JANA:NPROCESSES workers) using the same file do not see records that
+/// are still being written. Tables opened read-only
+/// never change the file. If a write fails (e.g. the disk is full) what
+/// was written of the record is truncated away and nothing more is
+/// stored in the table.
+///
+/// Load and Store may be called from any thread.
+
+typedef struct{
+	uint64_t magic;
+	uint64_t event;
+	uint64_t size;     ///< bytes of data following this header
+}jfcache_record_t;
+
+#define JFCACHE_MAGIC  0x4A46434143480001ULL  // "JFCACH" + 0x0001
+
+class JFactoryCacheTable{
+	public:
+		JFactoryCacheTable(const string &filename, const string &nametag);
+		virtual ~JFactoryCacheTable();
+
+		bool Open(bool writable, string &error);
+		bool Load(uint64_t event, vector<char> &buff);
+		bool Store(uint64_t event, const vector<char> &buff);
+		bool CanStore(void) const {return writable;}
+
+		const string& GetFilename(void) const {return filename;}
+		const string& GetNametag(void) const {return nametag;}
+
+		// Statistics. Updated atomically.
+		uint64_t Nlookups;
+		uint64_t Nhits;
+		uint64_t Nstored;
+		uint64_t Nbad;          ///< hits that could not be used (see JFactory<T>::LoadFromCache)
+		uint64_t Nfailed;       ///< events that could not be stored (see JFactory<T>::StoreInCache)
+		uint64_t Nderived;      ///< events not stored due to objects of derived classes (see JFactory<T>::StoreInCache)
+		uint64_t Nbytes_read;
+		uint64_t Nbytes_written;
+
+	protected:
+		string filename;
+		string nametag;
+		bool Lock(short type);
+
+		int fd;
+		bool writable;          ///< cleared if a write fails
+		pthread_mutex_t mutex;
+		map<uint64_t, std::pair<uint64_t, uint64_t> > index; // event -> (offset, size) of data
+};
+
+/// JFactoryCache keeps the objects made by factories on disk so that
+/// later jobs with the same configuration can read them back instead
+/// of making them again. It is enabled by setting the JANA:FACTORY_CACHE
+/// config. parameter to a directory. Only factories that set the
+/// CACHEABLE flag (see JFactory_base) are cached.
+///
+/// Objects are stored using the fields their class declares with
+/// JOBJECT_FIELDS (see JField.h). The class must have a default
+/// constructor and all of an object's state must be in its fields.
+/// Associated objects and pointers to other objects are not stored.
+///
+/// Outputs are keyed by run, event and a "context" which is a hash of:
+///
+///   - the factory's class name and tag
+///   - the names and types of the object's fields
+///   - the values of the config. parameters the factory lists with
+///     JFactory_base::AddCacheParameter()
+///   - the calibration URL and context (JANA_CALIB_URL, JANA_CALIB_CONTEXT)
+///   - the factory's cache version (JFactory_base::SetCacheVersion())
+///
+/// Changing any of these makes the factory miss and make the objects
+/// again. Changes to the factory's code are not seen. A factory should
+/// increase its cache version when its output changes (or the cache
+/// directory should be cleared). Events are found by event number so
+/// they must be unique within a run.
+///
+/// There is one file for each factory, context and run:
+///
+///    <dir>/<class>_<tag>.<context>.<run>.jfc
+///
+/// JANA:FACTORY_CACHE_MODE can be "rw" (default, read what is there and
+/// store what is not), "read" (never store) or "write" (never read, i.e.
+/// remake everything and store it again). A summary of lookups and hits
+/// for each factory is printed at the end.
+
+class JFactoryCache{
+	public:
+
+		enum mode_t{
+			kReadWrite,
+			kRead,
+			kWrite
+		};
+
+		JFactoryCache(const string &dir, mode_t mode=kReadWrite);
+		virtual ~JFactoryCache();
+
+		bool CanRead(void) const {return mode!=kWrite;}
+		bool CanWrite(void) const {return mode!=kRead;}
+		const string& GetDirectory(void) const {return dir;}
+
+		JFactoryCacheTable* GetTable(JFactory_base *fac, JEventLoop *loop, const vector<JField> *fields);
+		uint64_t GetContext(JFactory_base *fac, const vector<JField> &fields);
+		void PrintStats(void);
+
+		static bool ParseMode(const string &str, mode_t &mode);
+
+	protected:
+		string dir;
+		mode_t mode;
+		pthread_mutex_t mutex;
+		map<string, JFactoryCacheTable*> tables;  // key is filename
+		set<string> not_cacheable;                // nametags already warned about
+};
+
+/// Used by JFactory<T> to make objects read from the cache. This gives
+/// NULL for classes without a default constructor so that JFactory<T>
+/// still compiles for them. (They are reported as not cacheable.)
+template<class T, bool D=std::is_default_constructible<T>::value>
+struct JFactoryCacheNew{ static T* New(void){return new T();} };
+template<class T>
+struct JFactoryCacheNew<T, false>{ static T* New(void){return NULL;} };
+
+} // Close JANA namespace
+
+#endif // _JFactoryCache_
+
@@ -0,0 +1,41 @@
+// $Id$
+//
+//    File: JFactoryMonitor.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JFactoryMonitor_
+#define _JFactoryMonitor_
+
+// Place everything in JANA namespace
+namespace jana{
+
+class JFactory_base;
+
+/// A JFactoryMonitor can be attached to a JEventLoop in order to have
+/// code run immediately before and after every call a factory's evnt
+/// method. This is intended for profiling tools (e.g. the janapfm
+/// plugin which reads hardware counters around each call).
+///
+/// Calls are made from the thread that owns the JEventLoop so
+/// implementations do not need to be thread safe, but they should
+/// be fast since they are called for every factory on every event.
+/// Note that calls may be nested since one factory's evnt method
+/// will often request objects from other factories. EvntEnd is
+/// called even if evnt throws an exception.
+///
+/// The JEventLoop does not take ownership of the monitor.
+
+class JFactoryMonitor{
+	public:
+		virtual ~JFactoryMonitor(){}
+
+		virtual void EvntStart(JFactory_base *factory)=0; ///< Called just before factory->evnt()
+		virtual void EvntEnd(JFactory_base *factory)=0;   ///< Called just after factory->evnt()
+};
+
+} // Close JANA namespace
+
+#endif // _JFactoryMonitor_
+
@@ -4,10 +4,14 @@
 #ifndef _JFACTORY_BASE_H_
 #define _JFACTORY_BASE_H_
 
+#include <stdint.h>
+
 #include <vector>
 #include <string>
+#include <map>
 using std::vector;
 using std::string;
+using std::map;
 
 #include "JEventProcessor.h"
 
@@ -23,6 +27,7 @@ typedef unsigned long oid_t;
 namespace jana{
 
 class JEventLoop;
+class JFactoryCacheTable;
 
 /// This class is used as a base class for all factory classes.
 /// Typically, a factory object will be an instance of the
@@ -42,6 +47,7 @@ class JFactory_base:public JEventProcessor{
 	
 	
 	friend class JEvent;
+	friend class JEventSource;
 
 	public:
 	
@@ -62,6 +68,18 @@ class JFactory_base:public JEventProcessor{
 		/// Returns the number of events this factory had to generate data for.
 		int GetNgencalls(void){return Ncalls_to_evnt;}
 		
+		/// Returns the total time (in ns) spent in this factory's evnt method. This
+		/// includes time spent in any other factories it called.
+		uint64_t GetEvntTicks(void){return evnt_ticks;}
+		
+		/// Add to the named performance counter for this factory. This is
+		/// normally called by a JFactoryMonitor (e.g. from the janapfm plugin)
+		/// with the counts accumulated during a call to evnt.
+		void AddPerfCount(const string &name, uint64_t counts){perf_counts[name] += counts;}
+		
+		/// Returns the performance counters accumulated for this factory (if any)
+		const map<string, uint64_t>& GetPerfCounts(void){return perf_counts;}
+		
 		/// Delete the factory's data depending on the flags
 		virtual jerror_t Reset(void)=0;
 		
@@ -79,6 +97,9 @@ class JFactory_base:public JEventProcessor{
 		string toString(void) const;
 		virtual void toStrings(vector<vector<pair<string,string> > > &items, bool append_types=false) const =0;
 
+		/// Get pointers to objects that already exist for this event without activating the factory
+		virtual void GetExistingObjects(vector<const JObject*> &objs) const =0;
+
 		/// The data tag string associated with this factory. Most factories
 		/// will not overide this.
 		virtual inline const char* Tag(void){return "";}
@@ -96,7 +117,8 @@ class JFactory_base:public JEventProcessor{
 			JFACTORY_NULL		=0x00,
 			PERSISTANT			=0x01,
 			WRITE_TO_OUTPUT	=0x02,
-			NOT_OBJECT_OWNER	=0x04
+			NOT_OBJECT_OWNER	=0x04,
+			CACHEABLE			=0x08
 		};
 		
 		/// Get all flags in the form of a single word
@@ -116,6 +138,20 @@ class JFactory_base:public JEventProcessor{
 		inline bool TestFactoryFlag(JFactory_Flags_t f){
 			return (flags & (unsigned int)f) == (unsigned int)f;
 		}
+
+		/// Add a config. parameter this factory's output depends on. Its
+		/// value goes into the key used for the factory's outputs in the
+		/// factory cache (see JFactoryCache). This only matters for
+		/// factories with the CACHEABLE flag set. Call it from the
+		/// constructor or init().
+		void AddCacheParameter(const string &key){cache_parameters.push_back(key);}
+		const vector<string>& GetCacheParameters(void) const {return cache_parameters;}
+
+		/// Set the version of this factory's output. Increase it when a
+		/// change to the factory changes what it makes so that outputs
+		/// from before the change are not read from the factory cache.
+		void SetCacheVersion(unsigned int version){cache_version = version;}
+		unsigned int GetCacheVersion(void) const {return cache_version;}
 		
 	
 	protected:
@@ -125,6 +161,15 @@ class JFactory_base:public JEventProcessor{
 		int busy;
 		unsigned int Ncalls_to_Get;
 		unsigned int Ncalls_to_evnt;
+		uint64_t evnt_ticks;
+		map<string, uint64_t> perf_counts;
+		vector<string> cache_parameters;
+		unsigned int cache_version;
+		JFactoryCacheTable *cache_table;  ///< factory cache table for cache_run (NULL if not cached)
+		int32_t cache_run;
+		bool cache_run_valid;             ///< cache_table was looked up for cache_run
+		uint64_t getobjects_source_serial;              ///< source getobjects_counts is in (see JEventSource::GetObjectsTimed)
+		std::pair<uint64_t, uint64_t> *getobjects_counts; ///< (Ncalls, ticks) of GetObjects for this factory's type
 
 };
 
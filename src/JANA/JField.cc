@@ -0,0 +1,371 @@
+// $Id$
+//
+//    File: JField.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <stdio.h>
+
+#include "JField.h"
+#include "JObject.h"
+using namespace jana;
+
+namespace{
+
+	// Holds a value copied out of an object
+	class value_t{
+		public:
+			union{
+				int8_t i8; uint8_t u8; int16_t i16; uint16_t u16;
+				int32_t i32; uint32_t u32; int64_t i64; uint64_t u64;
+				float f; double d; bool b;
+			};
+			string s;
+	};
+
+	//-------------
+	// AppendUInt
+	//-------------
+	inline void AppendUInt(string &str, uint64_t v, bool negative=false)
+	{
+		char buff[24];
+		char *end = &buff[sizeof(buff)];
+		char *p = end;
+		do{
+			*--p = '0' + (char)(v%10);
+			v /= 10;
+		}while(v);
+		if(negative) *--p = '-';
+		str.append(p, end-p);
+	}
+
+	//-------------
+	// AppendInt
+	//-------------
+	inline void AppendInt(string &str, int64_t v)
+	{
+		if(v<0){
+			AppendUInt(str, (uint64_t)0 - (uint64_t)v, true);
+		}else{
+			AppendUInt(str, (uint64_t)v);
+		}
+	}
+
+	//-------------
+	// AppendPrintf
+	//-------------
+	template<typename V>
+	void AppendPrintf(string &str, const char *format, V v)
+	{
+		char buff[256];
+		int N = snprintf(buff, sizeof(buff), format, v);
+		if(N<0) return;
+		if(N < (int)sizeof(buff)){
+			str.append(buff, N);
+		}else{
+			vector<char> big(N+1);
+			snprintf(&big[0], big.size(), format, v);
+			str.append(&big[0], N);
+		}
+	}
+
+	// Type names used in the "name:type:value" form of toStrings
+	// when append_types is set. These are the names AddString uses
+	// for the same types (it does not know 8 bit integers or bool).
+	const char *append_type_names[] = {
+		"unknown", "unknown",
+		"short",   "ushort",
+		"int",     "uint",
+		"long",    "ulong",
+		"float",   "double",
+		"unknown",
+		"string"
+	};
+}
+
+//---------------------------------
+// JField    (Constructor)
+//---------------------------------
+JField::JField(const char *name, const char *format, type_t type, ptrdiff_t offset, getter_t getter):
+	name(name),format(format),type(type),offset(offset),getter(getter)
+{
+	/// Normally called via the JFIELD or JFIELD_METHOD macros
+
+	// Formats that Format() can do without printf
+	plain_format = true;
+	if(format==NULL) return;
+	static const char *int_formats[] = {"%d", "%i", "%u", "%ld", "%li", "%lu", "%lld", "%lli", "%llu", "%hd", "%hu", "%hhd", "%hhu", NULL};
+	switch(type){
+		case kFloat:
+		case kDouble:
+			plain_format = false;
+			break;
+		case kString:
+			plain_format = strcmp(format, "%s")==0;
+			break;
+		default:
+			plain_format = false;
+			for(const char **f=int_formats; *f; f++){
+				if(strcmp(format, *f)==0){
+					plain_format = true;
+					break;
+				}
+			}
+			break;
+	}
+}
+
+//---------------------------------
+// GetTypeSize
+//---------------------------------
+unsigned int JField::GetTypeSize(type_t type)
+{
+	switch(type){
+		case kInt8:   return sizeof(int8_t);
+		case kUInt8:  return sizeof(uint8_t);
+		case kInt16:  return sizeof(int16_t);
+		case kUInt16: return sizeof(uint16_t);
+		case kInt32:  return sizeof(int32_t);
+		case kUInt32: return sizeof(uint32_t);
+		case kInt64:  return sizeof(int64_t);
+		case kUInt64: return sizeof(uint64_t);
+		case kFloat:  return sizeof(float);
+		case kDouble: return sizeof(double);
+		case kBool:   return sizeof(bool);
+		default:      return 0;
+	}
+}
+
+//---------------------------------
+// GetTypeName
+//---------------------------------
+const char* JField::GetTypeName(type_t type)
+{
+	switch(type){
+		case kInt8:   return "int8";
+		case kUInt8:  return "uint8";
+		case kInt16:  return "int16";
+		case kUInt16: return "uint16";
+		case kInt32:  return "int32";
+		case kUInt32: return "uint32";
+		case kInt64:  return "int64";
+		case kUInt64: return "uint64";
+		case kFloat:  return "float";
+		case kDouble: return "double";
+		case kBool:   return "bool";
+		case kString: return "string";
+		default:      return "unknown";
+	}
+}
+
+//---------------------------------
+// GetValue
+//---------------------------------
+void JField::GetValue(const JObject *obj, void *val) const
+{
+	/// Copy the value of this field for the given object into val.
+	/// val must point to a variable of the type of the field
+	/// (std::string for kString).
+	if(getter){
+		getter(obj, val);
+	}else if(type==kString){
+		*(string*)val = *(const string*)GetPointer(obj);
+	}else{
+		memcpy(val, GetPointer(obj), GetSize());
+	}
+}
+
+//---------------------------------
+// Format
+//---------------------------------
+void JField::Format(const JObject *obj, string &str) const
+{
+	/// Append the value of this field for the given object to str,
+	/// formatted using the format the field was declared with.
+
+	// Get pointer to value
+	value_t v;
+	const void *ptr = &v;
+	if(getter){
+		getter(obj, type==kString ? (void*)&v.s:(void*)&v);
+		if(type==kString) ptr = &v.s;
+	}else{
+		ptr = GetPointer(obj);
+	}
+
+	if(plain_format){
+		switch(type){
+			case kInt8:   AppendInt(str, *(const int8_t*)ptr);    break;
+			case kUInt8:  AppendUInt(str, *(const uint8_t*)ptr);  break;
+			case kInt16:  AppendInt(str, *(const int16_t*)ptr);   break;
+			case kUInt16: AppendUInt(str, *(const uint16_t*)ptr); break;
+			case kInt32:  AppendInt(str, *(const int32_t*)ptr);   break;
+			case kUInt32: AppendUInt(str, *(const uint32_t*)ptr); break;
+			case kInt64:  AppendInt(str, *(const int64_t*)ptr);   break;
+			case kUInt64: AppendUInt(str, *(const uint64_t*)ptr); break;
+			case kFloat:  AppendPrintf(str, "%g", (double)*(const float*)ptr); break;
+			case kDouble: AppendPrintf(str, "%g", *(const double*)ptr);        break;
+			case kBool:   str += *(const bool*)ptr ? '1':'0';     break;
+			case kString: str += *(const string*)ptr;             break;
+		}
+		return;
+	}
+
+	// Values are promoted to the types printf expects for them
+	switch(type){
+		case kInt8:   AppendPrintf(str, format, (int)*(const int8_t*)ptr);                break;
+		case kUInt8:  AppendPrintf(str, format, (unsigned int)*(const uint8_t*)ptr);      break;
+		case kInt16:  AppendPrintf(str, format, (int)*(const int16_t*)ptr);               break;
+		case kUInt16: AppendPrintf(str, format, (unsigned int)*(const uint16_t*)ptr);     break;
+		case kInt32:  AppendPrintf(str, format, (int)*(const int32_t*)ptr);               break;
+		case kUInt32: AppendPrintf(str, format, (unsigned int)*(const uint32_t*)ptr);     break;
+		case kInt64:  AppendPrintf(str, format, (long long)*(const int64_t*)ptr);         break;
+		case kUInt64: AppendPrintf(str, format, (unsigned long long)*(const uint64_t*)ptr); break;
+		case kFloat:  AppendPrintf(str, format, (double)*(const float*)ptr);              break;
+		case kDouble: AppendPrintf(str, format, *(const double*)ptr);                     break;
+		case kBool:   AppendPrintf(str, format, (int)*(const bool*)ptr);                  break;
+		case kString: AppendPrintf(str, format, ((const string*)ptr)->c_str());           break;
+	}
+}
+
+//---------------------------------
+// FormatRaw
+//---------------------------------
+void JField::FormatRaw(const JObject *obj, string &str) const
+{
+	/// Append the value of this field for the given object to str
+	/// ignoring the declared format. Floating point values are
+	/// written with enough digits to get back the exact value.
+	value_t v;
+	const void *ptr = &v;
+	if(getter){
+		getter(obj, type==kString ? (void*)&v.s:(void*)&v);
+		if(type==kString) ptr = &v.s;
+	}else{
+		ptr = GetPointer(obj);
+	}
+
+	switch(type){
+		case kInt8:   AppendInt(str, *(const int8_t*)ptr);    break;
+		case kUInt8:  AppendUInt(str, *(const uint8_t*)ptr);  break;
+		case kInt16:  AppendInt(str, *(const int16_t*)ptr);   break;
+		case kUInt16: AppendUInt(str, *(const uint16_t*)ptr); break;
+		case kInt32:  AppendInt(str, *(const int32_t*)ptr);   break;
+		case kUInt32: AppendUInt(str, *(const uint32_t*)ptr); break;
+		case kInt64:  AppendInt(str, *(const int64_t*)ptr);   break;
+		case kUInt64: AppendUInt(str, *(const uint64_t*)ptr); break;
+		case kFloat:  AppendPrintf(str, "%.9g", (double)*(const float*)ptr); break;
+		case kDouble: AppendPrintf(str, "%.17g", *(const double*)ptr);       break;
+		case kBool:   str += *(const bool*)ptr ? '1':'0';     break;
+		case kString: str += *(const string*)ptr;             break;
+	}
+}
+
+//---------------------------------
+// ToStrings
+//---------------------------------
+void JField::ToStrings(const JObject *obj, const vector<JField> &fields, vector<pair<string,string> > &items)
+{
+	/// Add one item per field to items the same way toStrings() would
+	/// if it called AddString for each. This is what the toStrings()
+	/// method defined by JOBJECT_FIELDS calls.
+	bool append_types = obj->GetAppendTypes();
+	size_t Nitems = items.size();
+	items.resize(Nitems + fields.size());
+	for(unsigned int i=0; i<fields.size(); i++){
+		const JField &field = fields[i];
+		pair<string,string> &item = items[Nitems+i];
+		item.first = field.name;
+		field.Format(obj, item.second);
+		if(append_types){
+			// Value is written the way AddString writes it: with an
+			// ostream's default formatting for the types it knows and
+			// with the declared format for those it doesn't.
+			item.first += ':';
+			item.first += append_type_names[field.type];
+			item.first += ':';
+			switch(field.type){
+				case kInt8:
+				case kUInt8:
+				case kBool:
+					item.first += item.second;
+					break;
+				case kFloat:
+				case kDouble:
+					AppendPrintf(item.first, "%g", field.GetAs<double>(obj));
+					break;
+				default:
+					field.FormatRaw(obj, item.first);
+					break;
+			}
+		}
+	}
+}
+
+//---------------------------------
+// Serialize
+//---------------------------------
+void JField::Serialize(const JObject *obj, const vector<JField> &fields, vector<char> &buff)
+{
+	/// Append the values of all fields of obj to buff. Fixed size
+	/// types are copied as they are in memory. Strings are written as
+	/// a uint32 length followed by the characters.
+	value_t v;
+	for(unsigned int i=0; i<fields.size(); i++){
+		const JField &field = fields[i];
+		const char *ptr;
+		size_t N;
+		if(field.type == kString){
+			const string *s = &v.s;
+			if(field.getter){
+				field.getter(obj, &v.s);
+			}else{
+				s = (const string*)field.GetPointer(obj);
+			}
+			uint32_t len = s->size();
+			buff.insert(buff.end(), (const char*)&len, (const char*)&len + sizeof(len));
+			ptr = s->data();
+			N = len;
+		}else{
+			if(field.getter){
+				field.getter(obj, &v);
+				ptr = (const char*)&v;
+			}else{
+				ptr = (const char*)field.GetPointer(obj);
+			}
+			N = field.GetSize();
+		}
+		buff.insert(buff.end(), ptr, ptr+N);
+	}
+}
+
+//---------------------------------
+// Deserialize
+//---------------------------------
+bool JField::Deserialize(JObject *obj, const vector<JField> &fields, const char* &ptr, const char *end)
+{
+	/// Set the fields of obj from values written by Serialize. ptr is
+	/// advanced past the values. Values of fields that are not data
+	/// members (JFIELD_METHOD) are skipped. Returns false if there
+	/// are not enough bytes between ptr and end.
+	for(unsigned int i=0; i<fields.size(); i++){
+		const JField &field = fields[i];
+		if(field.type == kString){
+			uint32_t len;
+			if(end-ptr < (ptrdiff_t)sizeof(len)) return false;
+			memcpy(&len, ptr, sizeof(len));
+			ptr += sizeof(len);
+			if(end-ptr < (ptrdiff_t)len) return false;
+			if(field.IsMember()) ((string*)field.GetPointer(obj))->assign(ptr, len);
+			ptr += len;
+		}else{
+			size_t N = field.GetSize();
+			if(end-ptr < (ptrdiff_t)N) return false;
+			if(field.IsMember()) memcpy(field.GetPointer(obj), ptr, N);
+			ptr += N;
+		}
+	}
+	return true;
+}
+
@@ -0,0 +1,231 @@
+// $Id$
+//
+//    File: JField.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JField_
+#define _JField_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+#include <type_traits>
+#include <utility>
+using std::string;
+using std::vector;
+using std::pair;
+
+// Place everything in JANA namespace
+namespace jana{
+
+class JObject;
+
+/// JField describes one data member of a JObject class: its name, its
+/// type and where to find it in the object. A class lists its fields
+/// once with the JOBJECT_FIELDS macro (see below). Generic code
+/// (janaroot, janacolumnar, ...) can then read the values directly
+/// in binary form without calling toStrings() and parsing the strings.
+/// The toStrings() method of such classes is derived from the fields
+/// so they do not need to write one.
+///
+/// Values that are not data members can be described with a const
+/// method that returns them (see JFIELD_METHOD). Those fields are
+/// written, but can not be set when reading back.
+///
+/// Formatting a field (Format) uses the printf style format given
+/// when the field was declared. Integers with no format or a plain
+/// format like "%d" are converted without going through printf.
+
+class JField{
+	public:
+
+		enum type_t{
+			kInt8 = 0, kUInt8,
+			kInt16, kUInt16,
+			kInt32, kUInt32,
+			kInt64, kUInt64,
+			kFloat, kDouble,
+			kBool,
+			kString     ///< std::string
+		};
+
+		typedef void (*getter_t)(const JObject *obj, void *val);
+
+		const char *name;
+		const char *format;   ///< printf style format (NULL for default)
+		type_t type;
+		ptrdiff_t offset;     ///< of member from JObject part of object (if getter is NULL)
+		getter_t getter;      ///< copies value into val (NULL for data members)
+		bool plain_format;    ///< true if format needs no printf (set by constructor)
+
+		JField(const char *name, const char *format, type_t type, ptrdiff_t offset, getter_t getter=NULL);
+
+		bool IsMember(void) const {return getter==NULL;}
+		unsigned int GetSize(void) const {return GetTypeSize(type);}
+		const char* GetTypeName(void) const {return GetTypeName(type);}
+
+		/// Pointer to the member in obj. Only valid if IsMember() is true.
+		const void* GetPointer(const JObject *obj) const {return (const char*)obj + offset;}
+		void* GetPointer(JObject *obj) const {return (char*)obj + offset;}
+
+		void GetValue(const JObject *obj, void *val) const;
+		template<typename V> V GetAs(const JObject *obj) const;
+
+		void Format(const JObject *obj, string &str) const;
+		string Format(const JObject *obj) const {string str; Format(obj, str); return str;}
+		void FormatRaw(const JObject *obj, string &str) const;
+
+		static unsigned int GetTypeSize(type_t type); ///< 0 for strings
+		static const char* GetTypeName(type_t type);
+
+		static void ToStrings(const JObject *obj, const vector<JField> &fields, vector<pair<string,string> > &items);
+		static void Serialize(const JObject *obj, const vector<JField> &fields, vector<char> &buff);
+		static bool Deserialize(JObject *obj, const vector<JField> &fields, const char* &ptr, const char *end);
+
+		//---- used by JFIELD and JFIELD_METHOD macros ----
+
+		template<typename M, bool E=std::is_enum<M>::value> struct IntType{typedef M type;};
+		template<typename M, bool I=(std::is_integral<M>::value || std::is_enum<M>::value)> struct Type;
+
+		template<class T, class C, class M>
+		static JField Member(const char *name, M C::*member, const char *format);
+
+		template<class T, class R, R (T::*method)() const>
+		static JField Method(const char *name, const char *format);
+
+		template<class T, class R, R (T::*method)() const>
+		static void CallMethod(const JObject *obj, void *val){
+			*(typename std::decay<R>::type*)val = (static_cast<const T*>(obj)->*method)();
+		}
+};
+
+//---------------------------------
+// Type
+//---------------------------------
+// Maps a C++ type to type_t. Unsupported member types give a compile
+// time error. Enums are stored as integers of the same size.
+template<typename M> struct JField::IntType<M, true>{typedef typename std::underlying_type<M>::type type;};
+template<typename M, bool I> struct JField::Type{};
+template<typename M> struct JField::Type<M, true>{
+	static const bool is_signed = std::is_signed<typename IntType<M>::type>::value;
+	static const type_t type = std::is_same<M,bool>::value ? kBool:
+	                           sizeof(M)==1 ? (is_signed ? kInt8:kUInt8):
+	                           sizeof(M)==2 ? (is_signed ? kInt16:kUInt16):
+	                           sizeof(M)==4 ? (is_signed ? kInt32:kUInt32):
+	                                          (is_signed ? kInt64:kUInt64);
+};
+template<> struct JField::Type<float, false>{static const type_t type = kFloat;};
+template<> struct JField::Type<double, false>{static const type_t type = kDouble;};
+template<> struct JField::Type<string, false>{static const type_t type = kString;};
+
+//---------------------------------
+// Member
+//---------------------------------
+template<class T, class C, class M>
+JField JField::Member(const char *name, M C::*member, const char *format)
+{
+	/// Make a JField for a data member of class T (possibly one T
+	/// inherits from C). The offset is found using an uninitialized
+	/// buffer the size of T so no T object is created. This is the
+	/// same thing the offsetof macro does and has the same limits:
+	/// T must not inherit JObject or C virtually.
+	M T::*ptr = member;
+	typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type buff;
+	const T *t = reinterpret_cast<const T*>(&buff);
+	ptrdiff_t offset = (const char*)&(t->*ptr) - (const char*)static_cast<const JObject*>(t);
+	return JField(name, format, Type<M>::type, offset);
+}
+
+//---------------------------------
+// Method
+//---------------------------------
+template<class T, class R, R (T::*method)() const>
+JField JField::Method(const char *name, const char *format)
+{
+	/// Make a JField for a value returned by a const method of T
+	return JField(name, format, Type<typename std::decay<R>::type>::type, 0, &CallMethod<T, R, method>);
+}
+
+//---------------------------------
+// GetAs
+//---------------------------------
+template<typename V>
+V JField::GetAs(const JObject *obj) const
+{
+	/// Get the value of a numeric field converted to type V. This
+	/// returns 0 for strings.
+	union{
+		int8_t i8; uint8_t u8; int16_t i16; uint16_t u16;
+		int32_t i32; uint32_t u32; int64_t i64; uint64_t u64;
+		float f; double d; bool b;
+	} u;
+	const void *ptr = &u;
+	if(type==kString) return V(0);
+	if(getter){
+		getter(obj, &u);
+	}else{
+		ptr = GetPointer(obj);
+	}
+	switch(type){
+		case kInt8:   return (V)*(const int8_t*)ptr;
+		case kUInt8:  return (V)*(const uint8_t*)ptr;
+		case kInt16:  return (V)*(const int16_t*)ptr;
+		case kUInt16: return (V)*(const uint16_t*)ptr;
+		case kInt32:  return (V)*(const int32_t*)ptr;
+		case kUInt32: return (V)*(const uint32_t*)ptr;
+		case kInt64:  return (V)*(const int64_t*)ptr;
+		case kUInt64: return (V)*(const uint64_t*)ptr;
+		case kFloat:  return (V)*(const float*)ptr;
+		case kDouble: return (V)*(const double*)ptr;
+		case kBool:   return (V)*(const bool*)ptr;
+		default:      return V(0);
+	}
+}
+
+} // Close JANA namespace
+
+/// Declare the fields of a JObject class. This goes in the public part
+/// of the class definition after JOBJECT_PUBLIC. It defines GetFields()
+/// and a toStrings() made from the fields, so the class must not
+/// define toStrings() itself. e.g.
+///
+///  class MyHit:public JObject{
+///     public:
+///        JOBJECT_PUBLIC(MyHit);
+///
+///        int wire;
+///        double t;
+///        double E;
+///
+///        JOBJECT_FIELDS(MyHit,
+///           JFIELD(wire, "%d"),
+///           JFIELD(t,    "%3.1f"),
+///           JFIELD(E,    "%5.3f"),
+///           JFIELD_METHOD(Ecorr, GetCorrectedE, "%5.3f"));
+///
+///        double GetCorrectedE(void) const {return E*1.02;}
+///  };
+///
+/// Fields of a parent class are not inherited. A class that has its own
+/// JOBJECT_FIELDS must list them again.
+#define JOBJECT_FIELDS(T, ...) \
+	typedef T jfields_self_t; \
+	static const vector<jana::JField>& static_fields(void){static const vector<jana::JField> fields = {__VA_ARGS__}; return fields;} \
+	virtual const vector<jana::JField>* GetFields(void) const {return &static_fields();} \
+	virtual void toStrings(vector<pair<string,string> > &items) const {jana::JField::ToStrings(this, static_fields(), items);}
+
+/// Field for a data member of the class (see JOBJECT_FIELDS)
+#define JFIELD(member, format) \
+	jana::JField::Member<jfields_self_t>(#member, &jfields_self_t::member, format)
+
+/// Field for the value returned by a const method of the class (see JOBJECT_FIELDS)
+#define JFIELD_METHOD(name, method, format) \
+	jana::JField::Method<jfields_self_t, decltype(std::declval<const jfields_self_t&>().method()), &jfields_self_t::method>(#name, format)
+
+#endif // _JField_
+
@@ -29,6 +29,8 @@ using std::stringstream;
 // The following is here just so we can use ROOT's THtml class to generate documentation.
 #include "cint.h"
 
+#include "JField.h"
+
 
 /// The JObject class is a base class for all data classes.
 /// (See JFactory and JFactory_base for algorithm classes.)
@@ -47,6 +49,10 @@ using std::stringstream;
 /// the object's last generation in the inheritance chain by name. This
 /// also allows for possible upgrades to JANA in the future without
 /// requiring classes that inherit from JObject to be redefined explicity.
+///
+/// Classes may also describe their data members once with the
+/// JOBJECT_FIELDS macro (see JField.h) instead of writing a toStrings()
+/// method. This lets output plugins read the values in binary form.
 #define JOBJECT_PUBLIC(T) \
 	virtual const char* className(void) const {return static_className();} \
 	static const char* static_className(void) {return #T;} \
@@ -152,6 +158,10 @@ class JObject{
 		virtual void toStrings(vector<pair<string,string> > &items)const;
 		template<typename T> void AddString(vector<pair<string,string> > &items, const char *name, const char *format, const T &val) const;
 
+		/// Descriptions of the data members of this class. This is NULL
+		/// unless the class declares them with JOBJECT_FIELDS.
+		virtual const vector<JField>* GetFields(void) const {return NULL;}
+
 		// Methods for attaching and retrieving log messages to/from object
 		void AddLog(string &message) const {messagelog.push_back(message);}
 		void AddLog(vector<string> &messages) const {messagelog.insert(messagelog.end(), messages.begin(), messages.end());}
@@ -0,0 +1,427 @@
+// $Id$
+//
+//    File: JOrderedOutput.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include <iostream>
+#include <iomanip>
+using namespace std;
+
+#include "JOrderedOutput.h"
+#include "JApplication.h"
+#include "JEventLoop.h"
+#include "JThread.h"
+#include "JStreamLog.h"
+using namespace jana;
+
+void* LaunchOrderedOutputThread(void *arg);
+
+//---------------------------------
+// JOrderedOutput    (Constructor)
+//---------------------------------
+JOrderedOutput::JOrderedOutput(JApplication *app, uint64_t window, double stall_warn)
+{
+	this->app = app;
+	this->window = window>0 ? window:1;
+	this->stall_warn = stall_warn;
+	running = false;
+	stop = false;
+	next_sequence = 1;
+
+	Nwritten = 0;
+	Nskipped = 0;
+	Nmissing = 0;
+	Nstalls = 0;
+	Nerrors = 0;
+	Nloops = 0;
+	max_pending = 0;
+	window_wait_ticks = 0;
+	Nwindow_waits = 0;
+	stall_ticks = 0;
+
+	// An error checking mutex lets Abandon() tell whether the thread
+	// calling it already holds the lock. That happens if the thread was
+	// killed while waiting on one of the condition variables.
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ERRORCHECK);
+	pthread_mutex_init(&mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+	pthread_cond_init(&writer_cond, NULL);
+	pthread_cond_init(&threads_cond, NULL);
+}
+
+//---------------------------------
+// ~JOrderedOutput    (Destructor)
+//---------------------------------
+JOrderedOutput::~JOrderedOutput()
+{
+	Stop();
+	pthread_cond_destroy(&threads_cond);
+	pthread_cond_destroy(&writer_cond);
+	pthread_mutex_destroy(&mutex);
+}
+
+//---------------------------------
+// Start
+//---------------------------------
+bool JOrderedOutput::Start(void)
+{
+	/// Launch the thread that calls the sinks. Returns false and sets
+	/// the error string on failure.
+	if(running) return true;
+
+	stop = false;
+	if(pthread_create(&thr, NULL, LaunchOrderedOutputThread, this) != 0){
+		error = "unable to create ordered output thread";
+		return false;
+	}
+	running = true;
+
+	return true;
+}
+
+//---------------------------------
+// Stop
+//---------------------------------
+void JOrderedOutput::Stop(void)
+{
+	/// Stop the writer thread and delete the JEventLoops made for
+	/// threads to borrow. This should only be called once all
+	/// processing threads are done. The writer first writes all events
+	/// left in the reorder buffer, in order. Earlier events that never
+	/// arrived (e.g. ones left in the event buffer when quitting) are
+	/// passed over and counted.
+	if(running){
+		pthread_mutex_lock(&mutex);
+		stop = true;
+		pthread_cond_signal(&writer_cond);
+		pthread_cond_broadcast(&threads_cond);
+		pthread_mutex_unlock(&mutex);
+
+		pthread_join(thr, NULL);
+		running = false;
+	}
+
+	// Deleting a JEventLoop whose event was not written calls Abandon()
+	// which takes the mutex so it can not be held here.
+	pthread_mutex_lock(&mutex);
+	vector<JEventLoop*> my_loops;
+	my_loops.swap(loops);
+	free_loops.clear();
+	pthread_mutex_unlock(&mutex);
+	for(unsigned int i=0; i<my_loops.size(); i++) delete my_loops[i];
+}
+
+//---------------------------------
+// GetLoop
+//---------------------------------
+JEventLoop* JOrderedOutput::GetLoop(JEventLoop *thread_loop)
+{
+	/// Get a JEventLoop for the given processing thread to process its
+	/// next event in. One is made if none are free. It should be given
+	/// back with Write() once the event's sequence number is set, or
+	/// with Release() if the event will not be written.
+	JEventLoop *loop = NULL;
+	pthread_mutex_lock(&mutex);
+	if(!free_loops.empty()){
+		loop = free_loops.back();
+		free_loops.pop_back();
+	}
+	pthread_mutex_unlock(&mutex);
+
+	if(!loop){
+		// The JEventLoop constructor locks the JApplication so don't
+		// hold the mutex while making one.
+		loop = new JEventLoop(app, false);
+		loop->Initialize();
+		pthread_mutex_lock(&mutex);
+		loops.push_back(loop);
+		Nloops++;
+		pthread_mutex_unlock(&mutex);
+	}
+
+	// Signals, heartbeats and quitting go to the borrowing thread
+	loop->thread_loop = thread_loop;
+	loop->jthread = thread_loop->jthread;
+	loop->pthread_id = thread_loop->pthread_id;
+	loop->auto_free = thread_loop->auto_free;
+
+	return loop;
+}
+
+//---------------------------------
+// Release
+//---------------------------------
+void JOrderedOutput::Release(JEventLoop *loop)
+{
+	/// Give back a JEventLoop from GetLoop() without writing its event
+	/// (e.g. no event could be read into it).
+	pthread_mutex_lock(&mutex);
+	free_loops.push_back(loop);
+	pthread_mutex_unlock(&mutex);
+}
+
+//---------------------------------
+// WaitForWindow
+//---------------------------------
+void JOrderedOutput::WaitForWindow(JEventLoop *loop)
+{
+	/// Wait until the loop's current event is within the window of
+	/// events allowed ahead of the next one to be written.
+	uint64_t sequence = loop->GetJEvent().GetSequence();
+
+	pthread_mutex_lock(&mutex);
+	if(sequence >= next_sequence + window && !stop){
+		uint64_t start = JEventLoop::GetTicks();
+		while(sequence >= next_sequence + window && !stop) Wait(&threads_cond, loop);
+		window_wait_ticks += JEventLoop::GetTicks() - start;
+		Nwindow_waits++;
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+//---------------------------------
+// Write
+//---------------------------------
+void JOrderedOutput::Write(JEventLoop *loop)
+{
+	/// Put the loop (from GetLoop()) in the reorder buffer for the
+	/// writer thread to call the sinks for its current event. This
+	/// returns right away. The calling thread must not use the loop
+	/// after this.
+	uint64_t sequence = loop->GetJEvent().GetSequence();
+
+	pthread_mutex_lock(&mutex);
+	entry_t &entry = pending[sequence];
+	entry.loop = loop;
+	entry.in_progress = false;
+	if(pending.size() > max_pending) max_pending = pending.size();
+	if(sequence == next_sequence) pthread_cond_signal(&writer_cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+//---------------------------------
+// Skip
+//---------------------------------
+void JOrderedOutput::Skip(uint64_t sequence)
+{
+	/// Record that the event with the given sequence number will never
+	/// be written so the writer does not wait for it.
+	if(sequence == 0) return;
+
+	pthread_mutex_lock(&mutex);
+	if(sequence >= next_sequence){
+		skipped.insert(sequence);
+		Nskipped++;
+		if(sequence == next_sequence) pthread_cond_signal(&writer_cond);
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+//---------------------------------
+// Abandon
+//---------------------------------
+void JOrderedOutput::Abandon(JEventLoop *loop)
+{
+	/// Called for a JEventLoop from GetLoop() whose event will not be
+	/// written, either because the thread that borrowed it is going
+	/// away before handing it to Write() (e.g. a processor threw an
+	/// exception or the thread was killed) or because it is deleted
+	/// while still in the reorder buffer. The event is removed from the
+	/// reorder buffer, waiting first if the writer is calling the sinks
+	/// for it right now. The loop is not lent out again.
+	///
+	/// If the thread was killed in pthread_cond_wait, it will already
+	/// hold the mutex (see constructor).
+	int err = pthread_mutex_lock(&mutex);
+	if(err!=0 && err!=EDEADLK) return;
+
+	for(unsigned int i=0; i<free_loops.size(); i++){
+		if(free_loops[i] == loop){
+			free_loops.erase(free_loops.begin()+i);
+			break;
+		}
+	}
+
+	uint64_t sequence = loop->ordered_sequence;
+	map<uint64_t, entry_t>::iterator it;
+	while(sequence!=0 && (it=pending.find(sequence))!=pending.end() && it->second.in_progress){
+		pthread_cond_wait(&threads_cond, &mutex);
+	}
+	sequence = loop->ordered_sequence; // 0 if the writer finished it
+	if(sequence != 0){
+		pending.erase(sequence);
+		if(sequence >= next_sequence){
+			skipped.insert(sequence);
+			Nskipped++;
+			if(sequence == next_sequence) pthread_cond_signal(&writer_cond);
+		}
+		loop->ordered_sequence = 0;
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+//---------------------------------
+// Wait
+//---------------------------------
+void JOrderedOutput::Wait(pthread_cond_t *cond, JEventLoop *loop)
+{
+	/// Wait on the given condition for up to 1/2 second. The mutex must
+	/// be locked. Waiting here is not a stalled thread so the thread's
+	/// heartbeat is reset so the main thread does not kill it.
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	struct timespec abstime;
+	abstime.tv_sec = now.tv_sec;
+	abstime.tv_nsec = now.tv_usec*1000 + 500000000;
+	if(abstime.tv_nsec >= 1000000000){
+		abstime.tv_sec++;
+		abstime.tv_nsec -= 1000000000;
+	}
+	pthread_cond_timedwait(cond, &mutex, &abstime);
+
+	if(loop && loop->jthread) loop->jthread->heartbeat = 0.0;
+}
+
+//---------------------------------
+// Advance
+//---------------------------------
+void JOrderedOutput::Advance(void)
+{
+	/// Move on to the next sequence number and wake threads waiting
+	/// for their turn or the window. The mutex must be locked.
+	next_sequence++;
+	pthread_cond_broadcast(&threads_cond);
+}
+
+//---------------------------------
+// LaunchOrderedOutputThread
+//---------------------------------
+void* LaunchOrderedOutputThread(void *arg)
+{
+	// Processing threads get the signals meant for the process
+	// as a whole (e.g. SIGINT) so block them all here.
+	sigset_t set;
+	sigfillset(&set);
+	pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+	((JOrderedOutput*)arg)->WriterLoop();
+
+	return NULL;
+}
+
+//---------------------------------
+// WriterLoop
+//---------------------------------
+void JOrderedOutput::WriterLoop(void)
+{
+	/// Call the sinks for each event in sequence order as soon as it
+	/// is in the reorder buffer. If the next event is not there yet but
+	/// later ones are, the time is counted as a stall and a warning is
+	/// printed if it lasts longer than JANA:ORDERED_OUTPUT_STALL_WARN.
+	/// Once told to stop, no more events will arrive so the writer
+	/// goes past any it is still waiting on to write the rest.
+	pthread_mutex_lock(&mutex);
+
+	uint64_t stall_start = 0;
+	bool stall_warned = false;
+	while(true){
+
+		// Pass over events that will never arrive
+		while(skipped.erase(next_sequence)) Advance();
+
+		map<uint64_t, entry_t>::iterator it = pending.find(next_sequence);
+		if(it == pending.end()){
+			if(stop){
+				if(pending.empty()) break;
+				uint64_t first = pending.begin()->first;
+				set<uint64_t>::iterator end = skipped.lower_bound(first);
+				Nmissing += first - next_sequence - std::distance(skipped.begin(), end);
+				skipped.erase(skipped.begin(), end);
+				next_sequence = first - 1;
+				Advance();
+				continue;
+			}
+
+			// Check whether later events are waiting on this one
+			bool stalled = pending.lower_bound(next_sequence) != pending.end();
+			uint64_t now = JEventLoop::GetTicks();
+			if(stalled && stall_start==0){
+				stall_start = now;
+				stall_warned = false;
+			}
+			if(stall_start!=0 && !stall_warned && stall_warn>0.0 && (double)(now-stall_start)/1.0E9 > stall_warn){
+				jerr<<"Ordered output has waited "<<(double)(now-stall_start)/1.0E9<<" s for event with sequence number "<<next_sequence<<". "<<pending.size()<<" events are waiting to be written."<<endl;
+				stall_warned = true;
+			}
+
+			Wait(&writer_cond, NULL);
+			continue;
+		}
+
+		// Next event is here
+		if(stall_start != 0){
+			uint64_t ticks = JEventLoop::GetTicks() - stall_start;
+			stall_ticks += ticks;
+			if(stall_warn>0.0 && (double)ticks/1.0E9 > stall_warn) Nstalls++;
+			stall_start = 0;
+		}
+
+		JEventLoop *loop = it->second.loop;
+		it->second.in_progress = true;
+		pthread_mutex_unlock(&mutex);
+
+		// The processing thread has moved on so exceptions from the
+		// sinks can only be reported here.
+		JEvent &event = loop->GetJEvent();
+		try{
+			loop->CallSinks();
+		}catch(exception &e){
+			jerr<<"Exception thrown by sink for run:event "<<event.GetRunNumber()<<":"<<event.GetEventNumber()<<" : "<<e.what()<<endl;
+			Nerrors++;
+		}
+		if(loop->auto_free) event.FreeEvent();
+
+		pthread_mutex_lock(&mutex);
+		pending.erase(next_sequence);
+		loop->ordered_sequence = 0;
+		free_loops.push_back(loop);
+		Nwritten++;
+		Advance();
+	}
+
+	pthread_mutex_unlock(&mutex);
+}
+
+//---------------------------------
+// PrintStats
+//---------------------------------
+void JOrderedOutput::PrintStats(void)
+{
+	/// Print summary of reordering. The wait times are summed over all
+	/// processing threads.
+	double window_wait = (double)window_wait_ticks/1.0E9;
+	double stall = (double)stall_ticks/1.0E9;
+
+	jout<<"Ordered output:"<<endl;
+	jout<<"   events written in order: "<<Nwritten;
+	if(Nskipped>0) jout<<" ("<<Nskipped<<" never arrived and were skipped)";
+	jout<<endl;
+	if(Nmissing>0) jout<<"   events not processed before stopping (written past): "<<Nmissing<<endl;
+	if(Nerrors>0) jout<<"   events for which a sink threw an exception: "<<Nerrors<<endl;
+	jout<<"   max. events in reorder buffer: "<<max_pending<<" (window: "<<window<<")"<<endl;
+	jout<<"   JEventLoops made for processing threads to borrow: "<<Nloops<<endl;
+	jout<<"   time threads waited for window: "<<fixed<<setprecision(2)<<window_wait<<" s ("<<Nwindow_waits<<" times)"<<endl;
+	jout<<"   time writer waited on next event: "<<stall<<" s";
+	if(stall_warn>0.0) jout<<" ("<<Nstalls<<" stalls over "<<stall_warn<<" s)";
+	jout<<endl;
+	jout.unsetf(ios::fixed);
+}
+
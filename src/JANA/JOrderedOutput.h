@@ -0,0 +1,117 @@
+// $Id$
+//
+//    File: JOrderedOutput.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JOrderedOutput_
+#define _JOrderedOutput_
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <string>
+#include <map>
+#include <set>
+#include <vector>
+using std::string;
+using std::map;
+using std::set;
+using std::vector;
+
+// Place everything in JANA namespace
+namespace jana{
+
+class JApplication;
+class JEventLoop;
+
+/// JOrderedOutput calls the JEventSink processors for events in the
+/// order the events were read, even though the events are processed in
+/// parallel. It is enabled with the JANA:ORDERED_OUTPUT config.
+/// parameter and created by JApplication::Run() when there is at least
+/// one sink.
+///
+/// Every event put in the event buffer is given a sequence number
+/// (JEvent::GetSequence()). The sinks need the factories that made the
+/// event's objects so each event is processed in a JEventLoop borrowed
+/// from here (GetLoop()) rather than the processing thread's own. Once
+/// the other processors have been called, the thread hands the borrowed
+/// JEventLoop to Write() which puts it in the reorder buffer and returns
+/// right away. A dedicated thread calls the sinks for events in sequence
+/// order and then makes the JEventLoop available to be borrowed again.
+///
+/// The number of events that may be ahead of the oldest one not yet
+/// written is limited by JANA:ORDERED_OUTPUT_WINDOW. A thread that gets
+/// an event beyond that waits in WaitForWindow() before processing it.
+/// This is the only place processing threads wait. It bounds the reorder
+/// buffer (and the number of JEventLoops made) when one event takes much
+/// longer than the others.
+///
+/// Events that will never be written (e.g. their thread was killed or
+/// they were dropped from the event buffer) must be passed to Skip()
+/// (or their JEventLoop to Abandon()) so the ones after them are not
+/// held up.
+
+class JOrderedOutput{
+	public:
+		JOrderedOutput(JApplication *app, uint64_t window, double stall_warn);
+		virtual ~JOrderedOutput();
+
+		bool Start(void);
+		void Stop(void);
+		const string& GetError(void) const {return error;}
+
+		JEventLoop* GetLoop(JEventLoop *thread_loop);
+		void Release(JEventLoop *loop);
+		void WaitForWindow(JEventLoop *loop);
+		void Write(JEventLoop *loop);
+		void Skip(uint64_t sequence);
+		void Abandon(JEventLoop *loop);
+		void PrintStats(void);
+
+		void WriterLoop(void); ///< Used internally by the writer thread
+
+	protected:
+
+		class entry_t{
+			public:
+				JEventLoop *loop;
+				bool in_progress;
+		};
+
+		void Wait(pthread_cond_t *cond, JEventLoop *loop);
+		void Advance(void);
+
+		JApplication *app;
+		uint64_t window;
+		double stall_warn;
+		string error;
+		bool running;
+		bool stop;
+		pthread_t thr;
+		pthread_mutex_t mutex;
+		pthread_cond_t writer_cond;   // writer waits on this for the next event
+		pthread_cond_t threads_cond;  // processing threads wait on this for their turn
+		map<uint64_t, entry_t> pending;  // events waiting to be written by sequence
+		set<uint64_t> skipped;           // sequence numbers that will never arrive
+		uint64_t next_sequence;          // sequence number of next event to write
+		vector<JEventLoop*> loops;       // all JEventLoops made to be borrowed (deleted by Stop)
+		vector<JEventLoop*> free_loops;  // ones not in use
+
+		uint64_t Nwritten;
+		uint64_t Nskipped;
+		uint64_t Nmissing;           // sequence numbers never seen when stopped
+		uint64_t Nstalls;
+		uint64_t Nerrors;            // events for which a sink threw an exception
+		uint64_t Nloops;             // JEventLoops made to be borrowed
+		uint64_t max_pending;
+		uint64_t window_wait_ticks;  // time threads waited for their event to be in the window
+		uint64_t Nwindow_waits;
+		uint64_t stall_ticks;        // time writer waited on next event while later ones were ready
+};
+
+} // Close JANA namespace
+
+#endif // _JOrderedOutput_
+
@@ -0,0 +1,518 @@
+// $Id$
+//
+//    File: JPipeline.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <stdlib.h>
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <set>
+using namespace std;
+
+#include "JPipeline.h"
+#include "JApplication.h"
+#include "JEventLoop.h"
+#include "JParameterManager.h"
+#include "JThread.h"
+#include "JStreamLog.h"
+using namespace jana;
+
+void* LaunchPipelineThread(void *arg);
+
+//---------------------------------
+// JPipeline    (Constructor)
+//---------------------------------
+JPipeline::JPipeline(JApplication *app)
+{
+	this->app = app;
+	start_ticks = 0;
+	stop_ticks = 0;
+	running = false;
+	ordered_queue = NULL;
+	isinks = 0;
+	ordered = false;
+	pthread_mutex_init(&mutex, NULL);
+}
+
+//---------------------------------
+// ~JPipeline    (Destructor)
+//---------------------------------
+JPipeline::~JPipeline()
+{
+	Stop();
+	for(unsigned int i=0; i<stages.size(); i++) delete stages[i];
+	stages.clear();
+	pthread_mutex_destroy(&mutex);
+}
+
+//---------------------------------
+// Configure
+//---------------------------------
+bool JPipeline::Configure(const string &spec)
+{
+	/// Set up the stages from the value of the JANA:PIPELINE config.
+	/// parameter which is a comma separated list of name:Nthreads.
+	/// The settings of the individual stages are read from the other
+	/// JANA:PIPELINE:... parameters. Returns false and sets the error
+	/// string if there is a problem.
+	JParameterManager *jparms = app->GetJParameterManager();
+
+	set<string> names;
+	stringstream ss(spec);
+	string item;
+	while(getline(ss, item, ',')){
+		if(item.empty()) continue;
+		Stage *stage = new Stage;
+		size_t pos = item.find(':');
+		stage->name = item.substr(0, pos);
+		if(pos != string::npos) stage->Nthreads = atoi(item.substr(pos+1).c_str());
+		stages.push_back(stage);
+		if(stage->name.empty() || stage->Nthreads<1){
+			error = "bad stage \"" + item + "\" in JANA:PIPELINE (should be name:Nthreads)";
+			return false;
+		}
+		if(names.count(stage->name)){
+			error = "stage \"" + stage->name + "\" given twice in JANA:PIPELINE";
+			return false;
+		}
+		names.insert(stage->name);
+	}
+	if(stages.empty()){
+		error = "no stages given in JANA:PIPELINE";
+		return false;
+	}
+
+	// Factories and queue size for each stage
+	for(unsigned int i=0; i<stages.size(); i++){
+		Stage *stage = stages[i];
+		string FACTORIES;
+		jparms->SetDefaultParameter("JANA:PIPELINE:" + stage->name + ":FACTORIES", FACTORIES, "Comma separated list of factories (name or name:tag) activated by pipeline stage " + stage->name);
+		stringstream ssf(FACTORIES);
+		while(getline(ssf, item, ',')){
+			if(item.empty()) continue;
+			size_t pos = item.find(':');
+			string name = item.substr(0, pos);
+			string tag = pos==string::npos ? "":item.substr(pos+1);
+			stage->factories.push_back(pair<string,string>(name, tag));
+		}
+
+		// The first stage takes events from the event buffer (see
+		// MAX_EVENTS_IN_BUFFER) so does not have a queue of its own.
+		if(i==0) continue;
+		stage->queue_size = 2*stage->Nthreads;
+		jparms->SetDefaultParameter("JANA:PIPELINE:" + stage->name + ":QUEUE", stage->queue_size, "Max. number of events waiting for pipeline stage " + stage->name);
+		if(stage->queue_size<1) stage->queue_size = 1;
+	}
+
+	// Stages processors and sinks are called in
+	string PROCESSORS = stages.back()->name;
+	string SINKS = stages.back()->name;
+	jparms->SetDefaultParameter("JANA:PIPELINE:PROCESSORS", PROCESSORS, "Pipeline stage that calls the JEventProcessors");
+	jparms->SetDefaultParameter("JANA:PIPELINE:SINKS", SINKS, "Pipeline stage that calls the JEventSinks. Must not be before the JANA:PIPELINE:PROCESSORS stage");
+	int iprocessors = -1;
+	int isinks = -1;
+	for(unsigned int i=0; i<stages.size(); i++){
+		if(stages[i]->name == PROCESSORS) iprocessors = i;
+		if(stages[i]->name == SINKS) isinks = i;
+	}
+	if(iprocessors<0 || isinks<0){
+		error = "no pipeline stage \"" + (iprocessors<0 ? PROCESSORS:SINKS) + "\" for " + (iprocessors<0 ? "JANA:PIPELINE:PROCESSORS":"JANA:PIPELINE:SINKS");
+		return false;
+	}
+	if(isinks < iprocessors){
+		error = "JANA:PIPELINE:SINKS stage is before JANA:PIPELINE:PROCESSORS stage";
+		return false;
+	}
+	stages[iprocessors]->processors = true;
+	stages[isinks]->sinks = true;
+	this->isinks = isinks;
+
+	// Have sinks see events in the order they were read (if requested)
+	jparms->SetDefaultParameter("JANA:ORDERED_OUTPUT", ordered, "Set to 1 to have JEventSinks see events in the order they were read. With JANA:PIPELINE, the queue in front of the JANA:PIPELINE:SINKS stage is ordered and that stage gets one thread.");
+	if(ordered && isinks==0){
+		jout<<"JANA:ORDERED_OUTPUT can not be used when the JANA:PIPELINE:SINKS stage is the first stage. Events will not be written in order."<<endl;
+		ordered = false;
+	}
+	if(ordered && stages[isinks]->Nthreads>1){
+		jout<<"JANA:ORDERED_OUTPUT is set so pipeline stage "<<stages[isinks]->name<<" (JANA:PIPELINE:SINKS) will use 1 thread instead of "<<stages[isinks]->Nthreads<<endl;
+		stages[isinks]->Nthreads = 1;
+	}
+
+	return true;
+}
+
+//---------------------------------
+// Start
+//---------------------------------
+bool JPipeline::Start(void)
+{
+	/// Create the JEventLoops and launch the threads for all stages.
+	/// Returns false and sets the error string on failure.
+	if(running) return true;
+
+	// Enough JEventLoops to keep every thread busy and fill every queue
+	unsigned int Nloops = 0;
+	for(unsigned int i=0; i<stages.size(); i++) Nloops += stages[i]->Nthreads + stages[i]->queue_size;
+	queues.push_back(new Queue(Nloops));
+	for(unsigned int i=1; i<stages.size(); i++) queues.push_back(new Queue(stages[i]->queue_size, ordered && i==isinks));
+	if(ordered) ordered_queue = queues[isinks];
+	for(unsigned int i=0; i<Nloops; i++){
+		JEventLoop *loop = new JEventLoop(app);
+		loops.push_back(loop);
+		uint64_t wait_ticks;
+		queues[0]->Push(loop, wait_ticks);
+	}
+
+	start_ticks = JEventLoop::GetTicks();
+	running = true;
+	Nrunning.assign(stages.size(), 0);
+	for(unsigned int i=0; i<stages.size(); i++){
+		for(unsigned int j=0; j<stages[i]->Nthreads; j++){
+			pair<JPipeline*, unsigned int> *arg = new pair<JPipeline*, unsigned int>(this, i);
+			pthread_t thr;
+			if(pthread_create(&thr, NULL, LaunchPipelineThread, arg) != 0){
+				delete arg;
+				error = "unable to create thread for pipeline stage " + stages[i]->name;
+				break;
+			}
+			pthread_mutex_lock(&mutex);
+			threads.push_back(thr);
+			Nrunning[i]++;
+			pthread_mutex_unlock(&mutex);
+		}
+		if(!error.empty()) break;
+	}
+
+	// If not all threads could be made, have the ones that were stop
+	if(!error.empty()){
+		app->Quit();
+		return false;
+	}
+
+	return true;
+}
+
+//---------------------------------
+// IsRunning
+//---------------------------------
+bool JPipeline::IsRunning(void)
+{
+	/// Returns true while any stage still has threads running
+	pthread_mutex_lock(&mutex);
+	bool any = false;
+	for(unsigned int i=0; i<Nrunning.size(); i++) if(Nrunning[i]>0) any = true;
+	pthread_mutex_unlock(&mutex);
+
+	return any;
+}
+
+//---------------------------------
+// Stop
+//---------------------------------
+void JPipeline::Stop(void)
+{
+	/// Wait for all threads to finish and delete the JEventLoops. The
+	/// threads finish on their own once there are no more events (or
+	/// JApplication::Quit() is called).
+	if(!running) return;
+
+	for(unsigned int i=0; i<threads.size(); i++) pthread_join(threads[i], NULL);
+	threads.clear();
+	stop_ticks = JEventLoop::GetTicks();
+	running = false;
+
+	for(unsigned int i=0; i<queues.size(); i++){
+		stages[i]->max_queued = queues[i]->max_size;
+		delete queues[i];
+	}
+	queues.clear();
+	ordered_queue = NULL;
+	for(unsigned int i=0; i<loops.size(); i++) delete loops[i];
+	loops.clear();
+}
+
+//---------------------------------
+// Skip
+//---------------------------------
+void JPipeline::Skip(uint64_t sequence)
+{
+	/// Record that the event with the given sequence number was taken
+	/// out of the event buffer without being processed. (See
+	/// JApplication::NextEvent(uint64_t, JEvent&).)
+	if(ordered_queue) ordered_queue->Skip(sequence);
+}
+
+//---------------------------------
+// LaunchPipelineThread
+//---------------------------------
+void* LaunchPipelineThread(void *arg)
+{
+	pair<JPipeline*, unsigned int> *p = (pair<JPipeline*, unsigned int>*)arg;
+	JPipeline *pipeline = p->first;
+	unsigned int istage = p->second;
+	delete p;
+
+	pipeline->StageThread(istage);
+
+	return NULL;
+}
+
+//---------------------------------
+// StageThread
+//---------------------------------
+void JPipeline::StageThread(unsigned int istage)
+{
+	/// Take events from the queue in front of the given stage, do the
+	/// stage's work on them and pass them on to the next stage. Threads
+	/// of the first stage get an unused JEventLoop and read the next
+	/// event into it. After the last stage, the JEventLoop goes back to
+	/// be reused.
+	Stage *stage = stages[istage];
+	bool last = istage+1 == stages.size();
+	uint64_t input_wait_ticks = 0;
+	uint64_t output_wait_ticks = 0;
+	uint64_t busy_ticks = 0;
+
+	while(true){
+		uint64_t wait_ticks = 0;
+		JEventLoop *loop = queues[istage]->Pop(wait_ticks);
+		input_wait_ticks += wait_ticks;
+		if(!loop) break; // previous stage is done
+
+		// Signals meant for this JEventLoop (e.g. from janactl) should
+		// go to the thread now working on it.
+		loop->pthread_id = pthread_self();
+		if(loop->jthread){
+			loop->jthread->thread_id = pthread_self();
+			loop->jthread->heartbeat = 0.0;
+		}
+
+		if(istage == 0){
+			if(app->GetQuittingStatus()){
+				queues[0]->Push(loop, wait_ticks);
+				break;
+			}
+			uint64_t start = JEventLoop::GetTicks();
+			jerror_t err = loop->ReadPipelineEvent();
+			input_wait_ticks += JEventLoop::GetTicks() - start;
+			if(err != NOERROR){
+				queues[0]->Push(loop, wait_ticks);
+				break;
+			}
+		}
+
+		uint64_t start = JEventLoop::GetTicks();
+		bool ok = true;
+		try{
+			loop->ProcessPipelineStage(stage->factories, istage==0, stage->processors, stage->sinks);
+		}catch(exception &e){
+			JEvent &event = loop->GetJEvent();
+			jerr<<"Exception in pipeline stage "<<stage->name<<" (run:event="<<event.GetRunNumber()<<":"<<event.GetEventNumber()<<"). Event dropped: "<<e.what()<<endl;
+			ok = false;
+		}
+		// An event dropped before the sinks stage will never get to an
+		// ordered queue in front of it so it should not wait for it
+		if(!ok && ordered_queue && istage<isinks) ordered_queue->Skip(loop->GetJEvent().GetSequence());
+		if(!ok || last) loop->EndPipelineEvent();
+		busy_ticks += JEventLoop::GetTicks() - start;
+		__sync_fetch_and_add(ok ? &stage->Nevents:&stage->Nfailed, (uint64_t)1);
+
+		wait_ticks = 0;
+		if(!ok || last){
+			queues[0]->Push(loop, wait_ticks);
+		}else{
+			queues[istage+1]->Push(loop, wait_ticks);
+		}
+		output_wait_ticks += wait_ticks;
+	}
+
+	__sync_fetch_and_add(&stage->input_wait_ticks, input_wait_ticks);
+	__sync_fetch_and_add(&stage->output_wait_ticks, output_wait_ticks);
+	__sync_fetch_and_add(&stage->busy_ticks, busy_ticks);
+
+	StageDone(istage);
+}
+
+//---------------------------------
+// StageDone
+//---------------------------------
+void JPipeline::StageDone(unsigned int istage)
+{
+	/// Called as each thread of a stage finishes. Once they all have,
+	/// the next stage's queue is closed so its threads finish once it
+	/// is empty.
+	pthread_mutex_lock(&mutex);
+	bool stage_done = --Nrunning[istage] == 0;
+	pthread_mutex_unlock(&mutex);
+
+	if(stage_done && istage+1<queues.size()) queues[istage+1]->Close();
+}
+
+//---------------------------------
+// PrintStats
+//---------------------------------
+void JPipeline::PrintStats(void)
+{
+	/// Print the statistics for each stage. Busy and wait times are
+	/// given as a fraction of the time available to the stage's threads
+	/// (number of threads times the time the pipeline ran).
+	uint64_t end = running ? JEventLoop::GetTicks():stop_ticks;
+	double elapsed = (double)(end - start_ticks)/1.0E9;
+	if(elapsed <= 0.0) return;
+
+	jout<<"Pipeline stages ("<<fixed<<setprecision(2)<<elapsed<<" s):"<<endl;
+	jout<<"   "<<left<<setw(16)<<"stage"<<right<<setw(8)<<"threads"<<setw(10)<<"events"<<setw(11)<<"rate(Hz)"<<setw(8)<<"busy"<<setw(10)<<"wait in"<<setw(10)<<"wait out"<<setw(12)<<"max queued"<<endl;
+	for(unsigned int i=0; i<stages.size(); i++){
+		Stage *stage = stages[i];
+		double available = elapsed*(double)stage->Nthreads;
+		stringstream queued;
+		if(i==0){
+			queued<<"-";
+		}else{
+			queued<<stage->max_queued<<"/"<<stage->queue_size;
+		}
+		jout<<"   "<<left<<setw(16)<<stage->name<<right<<setw(8)<<stage->Nthreads<<setw(10)<<stage->Nevents;
+		jout<<setw(11)<<setprecision(1)<<(double)stage->Nevents/elapsed;
+		jout<<setw(7)<<100.0*(double)stage->busy_ticks/1.0E9/available<<"%";
+		jout<<setw(9)<<100.0*(double)stage->input_wait_ticks/1.0E9/available<<"%";
+		jout<<setw(9)<<100.0*(double)stage->output_wait_ticks/1.0E9/available<<"%";
+		jout<<setw(12)<<queued.str()<<endl;
+		if(stage->Nfailed>0) jout<<"      ("<<stage->Nfailed<<" events dropped due to exceptions)"<<endl;
+	}
+	jout.unsetf(ios::fixed);
+}
+
+//---------------------------------
+// Queue    (Constructor)
+//---------------------------------
+JPipeline::Queue::Queue(unsigned int capacity, bool ordered)
+{
+	this->capacity = capacity;
+	this->ordered = ordered;
+	max_size = 0;
+	next_sequence = 1;
+	closed = false;
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&not_empty, NULL);
+	pthread_cond_init(&not_full, NULL);
+}
+
+//---------------------------------
+// Queue    (Destructor)
+//---------------------------------
+JPipeline::Queue::~Queue()
+{
+	pthread_cond_destroy(&not_full);
+	pthread_cond_destroy(&not_empty);
+	pthread_mutex_destroy(&mutex);
+}
+
+//---------------------------------
+// Queue::Push
+//---------------------------------
+void JPipeline::Queue::Push(JEventLoop *loop, uint64_t &wait_ticks)
+{
+	/// Add a JEventLoop to the end of the queue, waiting for room if
+	/// it is full. The time spent waiting is added to wait_ticks. An
+	/// ordered queue never waits.
+	uint64_t sequence = loop->GetJEvent().GetSequence();
+	pthread_mutex_lock(&mutex);
+	if(ordered && sequence!=0){
+		waiting[sequence] = loop;
+	}else{
+		if(!ordered && loops.size() >= capacity){
+			uint64_t start = JEventLoop::GetTicks();
+			while(loops.size() >= capacity) pthread_cond_wait(&not_full, &mutex);
+			wait_ticks += JEventLoop::GetTicks() - start;
+		}
+		loops.push_back(loop);
+	}
+	if(loops.size()+waiting.size() > max_size) max_size = loops.size()+waiting.size();
+	pthread_cond_signal(&not_empty);
+	pthread_mutex_unlock(&mutex);
+}
+
+//---------------------------------
+// Queue::Pop
+//---------------------------------
+JEventLoop* JPipeline::Queue::Pop(uint64_t &wait_ticks)
+{
+	/// Take the JEventLoop at the front of the queue, waiting for one
+	/// if it is empty. Returns NULL once the queue is empty and has been
+	/// closed. The time spent waiting is added to wait_ticks. An ordered
+	/// queue also waits while the next event in sequence is not there.
+	pthread_mutex_lock(&mutex);
+	JEventLoop *loop = Take();
+	if(!loop && !closed){
+		uint64_t start = JEventLoop::GetTicks();
+		while(!loop && !closed){
+			pthread_cond_wait(&not_empty, &mutex);
+			loop = Take();
+		}
+		wait_ticks += JEventLoop::GetTicks() - start;
+	}
+	if(!loop) loop = Take(); // closed. Take() no longer waits on missing events
+	if(loop) pthread_cond_signal(&not_full);
+	pthread_mutex_unlock(&mutex);
+
+	return loop;
+}
+
+//---------------------------------
+// Queue::Take
+//---------------------------------
+JEventLoop* JPipeline::Queue::Take(void)
+{
+	/// Remove and return the next JEventLoop to hand out or NULL if
+	/// there is none. For an ordered queue this is the one with the
+	/// next sequence number. Once the queue is closed, the ones after
+	/// missing sequence numbers are handed out too since nothing more
+	/// will arrive. The mutex must be locked.
+	if(!loops.empty()){
+		JEventLoop *loop = loops.front();
+		loops.pop_front();
+		return loop;
+	}
+	while(skipped.erase(next_sequence)) next_sequence++;
+	if(waiting.empty()) return NULL;
+
+	map<uint64_t, JEventLoop*>::iterator it = waiting.begin();
+	if(it->first!=next_sequence && !closed) return NULL;
+	JEventLoop *loop = it->second;
+	next_sequence = it->first + 1;
+	waiting.erase(it);
+
+	return loop;
+}
+
+//---------------------------------
+// Queue::Skip
+//---------------------------------
+void JPipeline::Queue::Skip(uint64_t sequence)
+{
+	/// Record that the event with the given sequence number will never
+	/// be pushed so an ordered queue does not wait for it.
+	if(!ordered || sequence==0) return;
+	pthread_mutex_lock(&mutex);
+	if(sequence >= next_sequence) skipped.insert(sequence);
+	pthread_cond_signal(&not_empty);
+	pthread_mutex_unlock(&mutex);
+}
+
+//---------------------------------
+// Queue::Close
+//---------------------------------
+void JPipeline::Queue::Close(void)
+{
+	/// No more JEventLoops will be pushed. Threads waiting in Pop()
+	/// return once the queue is empty.
+	pthread_mutex_lock(&mutex);
+	closed = true;
+	pthread_cond_broadcast(&not_empty);
+	pthread_mutex_unlock(&mutex);
+}
+
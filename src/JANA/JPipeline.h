@@ -0,0 +1,161 @@
+// $Id$
+//
+//    File: JPipeline.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JPipeline_
+#define _JPipeline_
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <set>
+#include <utility>
+using std::string;
+using std::vector;
+using std::list;
+using std::map;
+using std::set;
+using std::pair;
+
+// Place everything in JANA namespace
+namespace jana{
+
+class JApplication;
+class JEventLoop;
+
+/// JPipeline processes events through a series of named stages, each
+/// with its own pool of threads, instead of having every thread do all
+/// of the work for an event. It is used by JApplication::Run() in place
+/// of the usual processing threads when the JANA:PIPELINE config.
+/// parameter is set. e.g.
+///
+///    -PJANA:PIPELINE=decode:2,reconstruct:8,write:1
+///    -PJANA:PIPELINE:decode:FACTORIES=DHit,DCluster:fast
+///    -PJANA:PIPELINE:PROCESSORS=reconstruct
+///
+/// Events are read from the event sources by the event buffer thread as
+/// usual. The first stage takes them from the event buffer. Each stage
+/// activates the factories listed for it (and the first stage the
+/// AUTOACTIVATE ones) so the work of those factories, including getting
+/// objects from the source, is done by that stage's threads. The
+/// JEventProcessors are called in the JANA:PIPELINE:PROCESSORS stage and
+/// the JEventSinks in the JANA:PIPELINE:SINKS stage (both default to the
+/// last stage). Anything not activated before is made on demand by the
+/// stage that first asks for it.
+///
+/// The data for an event lives in the factories of a JEventLoop so the
+/// JEventLoop is passed from stage to stage along with the event. There
+/// is a fixed pool of them, enough to fill every stage's threads and
+/// every queue. The queue in front of each stage is bounded by
+/// JANA:PIPELINE:<stage>:QUEUE (default twice the stage's threads) so a
+/// slow stage holds up the ones before it rather than using more memory.
+///
+/// Stages with more than one thread finish events in whatever order
+/// they happen to. If JANA:ORDERED_OUTPUT is set, the queue in front of
+/// the sinks stage hands out events in the order they were read instead
+/// and that stage is run with a single thread so the sinks see them in
+/// that order. Events that arrive early wait in the queue. It is not
+/// bounded by its size then (that could deadlock with the event it is
+/// waiting for stuck behind the stage before it) so how far the other
+/// stages can get ahead of the oldest event not yet written is limited
+/// only by the pool of JEventLoops. This is not possible if the sinks
+/// stage is the first one.
+///
+/// Statistics for each stage (busy time, time waiting for events and
+/// time waiting for room in the next queue) are printed at the end.
+
+class JPipeline{
+	public:
+
+		class Stage{
+			public:
+				string name;
+				unsigned int Nthreads;
+				unsigned int queue_size;       ///< Max. events waiting for this stage
+				vector<pair<string,string> > factories;  ///< (name, tag) of factories to activate
+				bool processors;               ///< Call JEventProcessors
+				bool sinks;                    ///< Call JEventSinks
+
+				uint64_t Nevents;
+				uint64_t Nfailed;              ///< Events dropped due to an exception
+				uint64_t busy_ticks;           ///< Time doing this stage's work (summed over threads)
+				uint64_t input_wait_ticks;     ///< Time waiting for events
+				uint64_t output_wait_ticks;    ///< Time waiting for room in next stage's queue
+				unsigned int max_queued;
+
+				Stage():Nthreads(1),queue_size(0),processors(false),sinks(false),Nevents(0),Nfailed(0),busy_ticks(0),input_wait_ticks(0),output_wait_ticks(0),max_queued(0){}
+		};
+
+		JPipeline(JApplication *app);
+		virtual ~JPipeline();
+
+		bool Configure(const string &spec);
+		bool Start(void);
+		bool IsRunning(void);
+		void Stop(void);
+		void PrintStats(void);
+		const string& GetError(void) const {return error;}
+		const vector<Stage*>& GetStages(void) const {return stages;}
+
+		void Skip(uint64_t sequence);
+		void StageThread(unsigned int istage); ///< Used internally by the stage threads
+
+	protected:
+
+		/// Bounded queue of JEventLoops between stages. An ordered queue
+		/// hands them out in order of their events' sequence numbers
+		/// (JEvent::GetSequence()) and is not bounded (see above).
+		class Queue{
+			public:
+				Queue(unsigned int capacity, bool ordered=false);
+				~Queue();
+				void Push(JEventLoop *loop, uint64_t &wait_ticks);
+				JEventLoop* Pop(uint64_t &wait_ticks);
+				void Skip(uint64_t sequence);
+				void Close(void);
+
+				unsigned int capacity;
+				unsigned int max_size;
+				bool ordered;
+			protected:
+				JEventLoop* Take(void);
+
+				list<JEventLoop*> loops;               // all of them if not ordered. Only ones without a sequence number if ordered
+				map<uint64_t, JEventLoop*> waiting;    // ordered: by sequence number
+				set<uint64_t> skipped;                 // ordered: sequence numbers that will never arrive
+				uint64_t next_sequence;                // ordered: sequence number of next one to hand out
+				bool closed;
+				pthread_mutex_t mutex;
+				pthread_cond_t not_empty;
+				pthread_cond_t not_full;
+		};
+
+		void StageDone(unsigned int istage);
+
+		JApplication *app;
+		string error;
+		vector<Stage*> stages;
+		vector<Queue*> queues;         // queues[i] feeds stage i. queues[0] holds unused JEventLoops
+		Queue *ordered_queue;          // queue in front of sinks stage if JANA:ORDERED_OUTPUT is set (NULL if not)
+		unsigned int isinks;           // index of stage that calls the sinks
+		bool ordered;                  // JANA:ORDERED_OUTPUT is set (and possible)
+		vector<JEventLoop*> loops;
+		vector<pthread_t> threads;
+		vector<unsigned int> Nrunning; // threads of each stage still running
+		pthread_mutex_t mutex;
+		uint64_t start_ticks;
+		uint64_t stop_ticks;
+		bool running;
+};
+
+} // Close JANA namespace
+
+#endif // _JPipeline_
+
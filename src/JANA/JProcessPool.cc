@@ -0,0 +1,415 @@
+// $Id$
+//
+//    File: JProcessPool.cc
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+using namespace std;
+
+#include "JProcessPool.h"
+#include "JApplication.h"
+#include "JEventProcessor.h"
+#include "JStreamLog.h"
+using namespace jana;
+
+// Read or write exactly n bytes, retrying on EINTR. Return false on
+// EOF or error.
+static bool ReadN(int fd, void *buf, size_t n)
+{
+	char *p = (char*)buf;
+	while(n>0){
+		ssize_t r = read(fd, p, n);
+		if(r<0 && errno==EINTR) continue;
+		if(r<=0) return false;
+		p += r;
+		n -= r;
+	}
+	return true;
+}
+
+static bool WriteN(int fd, const void *buf, size_t n)
+{
+	const char *p = (const char*)buf;
+	while(n>0){
+		ssize_t r = write(fd, p, n);
+		if(r<0 && errno==EINTR) continue;
+		if(r<=0) return false;
+		p += r;
+		n -= r;
+	}
+	return true;
+}
+
+//---------------------------------
+// JProcessPool    (Constructor)
+//---------------------------------
+JProcessPool::JProcessPool(JApplication *app, unsigned int Nworkers, uint64_t chunk_size)
+{
+	this->app = app;
+	this->Nworkers = Nworkers>0 ? Nworkers:1;
+	this->chunk_size = chunk_size>0 ? chunk_size:1;
+	worker_id = -1;
+	next_first = 0;
+	range_end = 0;
+	fd_to_parent = -1;
+	fd_from_parent = -1;
+	got_results.resize(app->GetProcessors().size(), false);
+}
+
+//---------------------------------
+// ~JProcessPool    (Destructor)
+//---------------------------------
+JProcessPool::~JProcessPool()
+{
+	for(unsigned int i=0; i<workers.size(); i++){
+		if(workers[i].fd_in >= 0) close(workers[i].fd_in);
+		if(workers[i].fd_out >= 0) close(workers[i].fd_out);
+	}
+	if(fd_to_parent >= 0) close(fd_to_parent);
+	if(fd_from_parent >= 0) close(fd_from_parent);
+}
+
+//---------------------------------
+// Fork
+//---------------------------------
+bool JProcessPool::Fork(void)
+{
+	/// Fork the worker processes. This returns in the parent and in each
+	/// worker (check IsWorker()). No other threads may be running since
+	/// only the calling thread exists in the workers. Returns false in
+	/// the parent (with the error string set) if no worker could be
+	/// started.
+
+	// Anything still buffered would otherwise be printed once per process
+	cout.flush();
+	cerr.flush();
+	jout.flush();
+	jerr.flush();
+	fflush(NULL);
+
+	// A worker that dies would otherwise take the parent with it when
+	// the parent writes to its pipe.
+	signal(SIGPIPE, SIG_IGN);
+
+	for(unsigned int i=0; i<Nworkers; i++){
+		int up[2], down[2];
+		if(pipe(up) != 0) { error = string("pipe: ") + strerror(errno); break; }
+		if(pipe(down) != 0){
+			error = string("pipe: ") + strerror(errno);
+			close(up[0]); close(up[1]);
+			break;
+		}
+
+		pid_t pid = fork();
+		if(pid < 0){
+			error = string("fork: ") + strerror(errno);
+			close(up[0]); close(up[1]); close(down[0]); close(down[1]);
+			break;
+		}
+
+		if(pid == 0){
+			// Worker. Close the parent's ends of the other workers' pipes.
+			for(unsigned int j=0; j<workers.size(); j++){
+				close(workers[j].fd_in);
+				close(workers[j].fd_out);
+			}
+			workers.clear();
+			close(up[0]);
+			close(down[1]);
+			fd_to_parent = up[1];
+			fd_from_parent = down[0];
+			worker_id = i;
+			return true;
+		}
+
+		// Parent
+		close(up[1]);
+		close(down[0]);
+		Worker w;
+		w.pid = pid;
+		w.fd_in = up[0];
+		w.fd_out = down[1];
+		w.Nevents = 0;
+		w.Nchunks = 0;
+		w.chunk_first = w.chunk_end = 0;
+		w.done = false;
+		w.exited = false;
+		w.status = 0;
+		workers.push_back(w);
+	}
+
+	if(workers.empty()) return false;
+	if(workers.size() < Nworkers){
+		jerr<<"Only "<<workers.size()<<" of "<<Nworkers<<" worker processes could be started ("<<error<<")"<<endl;
+	}
+
+	return true;
+}
+
+//---------------------------------
+// NextChunk
+//---------------------------------
+bool JProcessPool::NextChunk(uint64_t Nevents, uint64_t &first, uint64_t &end)
+{
+	/// Ask the parent for another chunk of events to process. Nevents is
+	/// the number processed by this worker so far (for the parent's
+	/// rate display). On return, events first to end-1 are to be
+	/// processed. Returns false if there are no more.
+	msg_header_t h = {kRequest, 0, Nevents, 0};
+	if(!WriteN(fd_to_parent, &h, sizeof(h))) return false;
+
+	uint64_t range[2];
+	if(!ReadN(fd_from_parent, range, sizeof(range))) return false;
+	if(range[0] >= range[1]) return false;
+	first = range[0];
+	end = range[1];
+
+	return true;
+}
+
+//---------------------------------
+// SendResults
+//---------------------------------
+void JProcessPool::SendResults(unsigned int iproc, const string &results)
+{
+	/// Send the results from a processor's worker_fini() to the parent
+	msg_header_t h = {kResults, iproc, 0, results.size()};
+	if(!WriteN(fd_to_parent, &h, sizeof(h)) || !WriteN(fd_to_parent, results.data(), results.size())){
+		jerr<<"Unable to send results for processor "<<iproc<<" to parent process"<<endl;
+	}
+}
+
+//---------------------------------
+// Exit
+//---------------------------------
+void JProcessPool::Exit(uint64_t Nevents, int exit_code)
+{
+	/// Tell the parent this worker is finished and exit. The rest of
+	/// the program (e.g. the remainder of main()) is only run by the
+	/// parent.
+	msg_header_t h = {kDone, 0, Nevents, 0};
+	WriteN(fd_to_parent, &h, sizeof(h));
+	close(fd_to_parent);
+	close(fd_from_parent);
+
+	cout.flush();
+	cerr.flush();
+	jout.flush();
+	jerr.flush();
+	fflush(NULL);
+	_exit(exit_code);
+}
+
+//---------------------------------
+// SetRange
+//---------------------------------
+void JProcessPool::SetRange(uint64_t first, uint64_t end)
+{
+	/// Set the events to be handed out to the workers: first to end-1
+	/// counting from the start of the input.
+	next_first = first;
+	range_end = end;
+}
+
+//---------------------------------
+// Serve
+//---------------------------------
+void JProcessPool::Serve(double timeout)
+{
+	/// Handle messages from the workers for up to timeout seconds and
+	/// collect any that have exited.
+	vector<struct pollfd> fds;
+	vector<Worker*> ws;
+	for(unsigned int i=0; i<workers.size(); i++){
+		Worker *w = &workers[i];
+		if(w->fd_in < 0) continue;
+		struct pollfd p;
+		p.fd = w->fd_in;
+		p.events = POLLIN;
+		p.revents = 0;
+		fds.push_back(p);
+		ws.push_back(w);
+	}
+
+	if(!fds.empty()){
+		int n = poll(&fds[0], fds.size(), (int)(timeout*1000.0));
+		for(unsigned int i=0; n>0 && i<fds.size(); i++){
+			if(fds[i].revents & (POLLIN | POLLHUP | POLLERR)) Handle(ws[i]);
+		}
+	}else{
+		usleep((useconds_t)(timeout*1.0E6));
+	}
+
+	for(unsigned int i=0; i<workers.size(); i++) Reap(&workers[i]);
+}
+
+//---------------------------------
+// Handle
+//---------------------------------
+void JProcessPool::Handle(Worker *w)
+{
+	/// Handle one message from the given worker
+	msg_header_t h;
+	if(!ReadN(w->fd_in, &h, sizeof(h))){
+		// Worker closed its end (it exited or died)
+		close(w->fd_in);
+		close(w->fd_out);
+		w->fd_in = w->fd_out = -1;
+		if(!w->done){
+			jerr<<"Worker "<<(w-&workers[0])<<" (pid "<<w->pid<<") ended without finishing.";
+			if(w->chunk_end > w->chunk_first) jerr<<" Some of events "<<w->chunk_first<<"-"<<w->chunk_end-1<<" may not have been processed.";
+			jerr<<endl;
+		}
+		return;
+	}
+
+	int worker = w - &workers[0];
+	switch(h.type){
+		case kRequest:{
+			w->Nevents = h.value;
+			uint64_t range[2] = {next_first, next_first};
+			if(next_first < range_end){
+				range[1] = next_first + chunk_size;
+				if(range[1] > range_end) range[1] = range_end;
+				next_first = range[1];
+				w->Nchunks++;
+				w->chunk_first = range[0];
+				w->chunk_end = range[1];
+			}
+			WriteN(w->fd_out, range, sizeof(range));
+			break;
+		}
+		case kResults:{
+			string results(h.size, '\0');
+			if(h.size>0 && !ReadN(w->fd_in, &results[0], h.size)){
+				jerr<<"Incomplete results from worker "<<worker<<" for processor "<<h.iproc<<endl;
+				break;
+			}
+			vector<JEventProcessor*> processors = app->GetProcessors();
+			if(h.iproc >= processors.size()) break;
+			try{
+				processors[h.iproc]->merge_worker(worker, results);
+			}catch(exception &e){
+				jerr<<"Exception merging results from worker "<<worker<<" for processor "<<processors[h.iproc]->className()<<": "<<e.what()<<endl;
+			}
+			got_results[h.iproc] = true;
+			break;
+		}
+		case kDone:
+			w->Nevents = h.value;
+			w->done = true;
+			w->chunk_first = w->chunk_end = 0;
+			break;
+	}
+}
+
+//---------------------------------
+// Reap
+//---------------------------------
+void JProcessPool::Reap(Worker *w)
+{
+	/// Collect the exit status of the worker if it has exited
+	if(w->exited) return;
+	int status = 0;
+	if(waitpid(w->pid, &status, WNOHANG) != w->pid) return;
+	w->exited = true;
+	w->status = status;
+	if(WIFSIGNALED(status)){
+		jerr<<"Worker "<<(w-&workers[0])<<" (pid "<<w->pid<<") was killed by signal "<<WTERMSIG(status)<<endl;
+	}
+}
+
+//---------------------------------
+// IsDone
+//---------------------------------
+bool JProcessPool::IsDone(void) const
+{
+	/// Returns true once all workers have exited and all their
+	/// messages have been handled.
+	for(unsigned int i=0; i<workers.size(); i++){
+		if(!workers[i].exited || workers[i].fd_in>=0) return false;
+	}
+	return true;
+}
+
+//---------------------------------
+// GetNevents
+//---------------------------------
+uint64_t JProcessPool::GetNevents(void) const
+{
+	/// Total events processed by the workers as of their last message
+	uint64_t N = 0;
+	for(unsigned int i=0; i<workers.size(); i++) N += workers[i].Nevents;
+	return N;
+}
+
+//---------------------------------
+// GotResults
+//---------------------------------
+bool JProcessPool::GotResults(unsigned int iproc) const
+{
+	/// Returns true if any worker sent results from worker_fini() for
+	/// the processor with the given index.
+	return iproc<got_results.size() ? got_results[iproc]:false;
+}
+
+//---------------------------------
+// Signal
+//---------------------------------
+void JProcessPool::Signal(int signo)
+{
+	/// Send a signal to all workers that are still running
+	for(unsigned int i=0; i<workers.size(); i++){
+		if(!workers[i].exited) kill(workers[i].pid, signo);
+	}
+}
+
+//---------------------------------
+// GetExitCode
+//---------------------------------
+int JProcessPool::GetExitCode(void) const
+{
+	/// Returns the first non-zero exit code of the workers. Workers
+	/// killed by a signal give EX_SOFTWARE.
+	for(unsigned int i=0; i<workers.size(); i++){
+		const Worker &w = workers[i];
+		if(!w.exited) continue;
+		if(WIFSIGNALED(w.status)) return EX_SOFTWARE;
+		if(WIFEXITED(w.status) && WEXITSTATUS(w.status)!=0) return WEXITSTATUS(w.status);
+	}
+	return 0;
+}
+
+//---------------------------------
+// PrintStats
+//---------------------------------
+void JProcessPool::PrintStats(void)
+{
+	/// Print a line for each worker process
+	jout<<"Worker processes:"<<endl;
+	jout<<"   worker      pid    chunks      events  exit"<<endl;
+	for(unsigned int i=0; i<workers.size(); i++){
+		const Worker &w = workers[i];
+		stringstream exit_str;
+		if(!w.exited){
+			exit_str<<"running";
+		}else if(WIFSIGNALED(w.status)){
+			exit_str<<"signal "<<WTERMSIG(w.status);
+		}else{
+			exit_str<<WEXITSTATUS(w.status);
+		}
+		jout<<"   "<<setw(6)<<i<<" "<<setw(8)<<w.pid<<" "<<setw(9)<<w.Nchunks<<" "<<setw(11)<<w.Nevents<<"  "<<exit_str.str()<<endl;
+	}
+}
@@ -0,0 +1,129 @@
+// $Id$
+//
+//    File: JProcessPool.h
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#ifndef _JProcessPool_
+#define _JProcessPool_
+
+#include <sys/types.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+// Place everything in JANA namespace
+namespace jana{
+
+class JApplication;
+
+/// JProcessPool processes events in several forked worker processes
+/// instead of (or as well as) several threads. It is used by
+/// JApplication::Run() when the JANA:NPROCESSES config. parameter is
+/// greater than 1. This can scale better than threads alone when threads
+/// contend for locks or the memory allocator.
+///
+/// The parent process initializes everything (plugins, processors'
+/// init) and does the per-run setup for the first event (see
+/// JEventLoop::WarmUp) before forking. Whatever that loads (calibrations,
+/// geometry, code) is shared copy-on-write by the workers. Each worker
+/// then runs NTHREADS processing threads as usual.
+///
+/// Every worker has its own copy of the event sources. The parent hands
+/// out chunks of JANA:NPROCESSES_CHUNK consecutive events (counted from
+/// the start of the input like EVENTS_TO_SKIP) to whichever worker asks
+/// next and each worker skips over the events it was not given. This is
+/// fastest for sources that implement JEventSource::SkipEvents(). The
+/// first event, used for the warm-up, is processed by worker 0.
+///
+/// At the end, the workers call erun() as usual and, in place of fini(),
+/// each processor's worker_fini(). The results it fills in are sent to
+/// the parent which passes them to that processor's merge_worker() and
+/// then calls its fini(). Processors that do not implement worker_fini()
+/// have fini() called in every worker instead.
+///
+/// Messages go over a pair of pipes between the parent and each worker.
+
+class JProcessPool{
+	public:
+		JProcessPool(JApplication *app, unsigned int Nworkers, uint64_t chunk_size);
+		virtual ~JProcessPool();
+
+		bool Fork(void);
+		bool IsWorker(void) const {return worker_id>=0;}
+		int GetWorkerID(void) const {return worker_id;}
+		const string& GetError(void) const {return error;}
+
+		// Called in workers
+		bool NextChunk(uint64_t Nevents, uint64_t &first, uint64_t &end);
+		void SendResults(unsigned int iproc, const string &results);
+		void Exit(uint64_t Nevents, int exit_code);
+
+		// Called in the parent
+		void SetRange(uint64_t first, uint64_t end);
+		void Serve(double timeout);
+		bool IsDone(void) const;
+		uint64_t GetNevents(void) const;
+		bool GotResults(unsigned int iproc) const;
+		void Signal(int signo);
+		int GetExitCode(void) const;
+		void PrintStats(void);
+
+	protected:
+
+		enum msg_type_t{
+			kRequest,   // worker wants another chunk (value=events processed)
+			kResults,   // results for processor iproc follow
+			kDone       // worker is finished (value=events processed)
+		};
+
+		class msg_header_t{
+			public:
+				uint32_t type;
+				uint32_t iproc;
+				uint64_t value;
+				uint64_t size;
+		};
+
+		class Worker{
+			public:
+				pid_t pid;
+				int fd_in;          // parent reads messages from worker
+				int fd_out;         // parent writes replies to worker
+				uint64_t Nevents;
+				uint64_t Nchunks;
+				uint64_t chunk_first;   // last chunk given out
+				uint64_t chunk_end;
+				bool done;          // sent kDone
+				bool exited;        // has been waited for
+				int status;         // from waitpid
+		};
+
+		void Handle(Worker *w);
+		void Reap(Worker *w);
+
+		JApplication *app;
+		unsigned int Nworkers;
+		uint64_t chunk_size;
+		int worker_id;              // -1 in parent
+		string error;
+		vector<Worker> workers;
+		vector<bool> got_results;   // by processor index
+
+		// parent
+		uint64_t next_first;
+		uint64_t range_end;
+
+		// worker
+		int fd_to_parent;
+		int fd_from_parent;
+};
+
+} // Close JANA namespace
+
+#endif // _JProcessPool_
+
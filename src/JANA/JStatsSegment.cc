@@ -0,0 +1,249 @@
+// $Id$
+//
+//    File: JStatsSegment.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include <sstream>
+using namespace std;
+
+#include "JStatsSegment.h"
+using namespace jana;
+
+
+//---------------------------------
+// JStatsSegment    (Constructor)
+//---------------------------------
+JStatsSegment::JStatsSegment()
+{
+	stats = NULL;
+	owner = false;
+	Nthread_slots_allocated = 0;
+	pthread_mutex_init(&mutex, NULL);
+}
+
+//---------------------------------
+// ~JStatsSegment    (Destructor)
+//---------------------------------
+JStatsSegment::~JStatsSegment()
+{
+	Detach();
+	pthread_mutex_destroy(&mutex);
+}
+
+//---------------------------------
+// GetName
+//---------------------------------
+string JStatsSegment::GetName(pid_t pid)
+{
+	/// Return the name of the shared memory segment used by the
+	/// process with the given PID. On Linux, this will show up
+	/// as /dev/shm/jana_stats.<pid>
+	stringstream ss;
+	ss << "/jana_stats." << pid;
+	return ss.str();
+}
+
+//---------------------------------
+// Create
+//---------------------------------
+bool JStatsSegment::Create(pid_t pid)
+{
+	/// Create and map the shared memory segment for the given PID
+	/// (normally our own). Any stale segment left over from a
+	/// previous process with the same PID is replaced. Returns
+	/// false and sets the error string on failure.
+	Detach();
+
+	name = GetName(pid);
+	shm_unlink(name.c_str());
+	int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if(fd < 0){
+		error = string("shm_open(") + name + "): " + strerror(errno);
+		return false;
+	}
+	if(ftruncate(fd, sizeof(jstats_t)) != 0){
+		error = string("ftruncate(") + name + "): " + strerror(errno);
+		close(fd);
+		shm_unlink(name.c_str());
+		return false;
+	}
+	void *ptr = mmap(NULL, sizeof(jstats_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(ptr == MAP_FAILED){
+		error = string("mmap(") + name + "): " + strerror(errno);
+		shm_unlink(name.c_str());
+		return false;
+	}
+
+	// Segment is zero filled by ftruncate. Fill in the header with the
+	// magic number last so readers don't see a half-initialized block.
+	stats = (jstats_t*)ptr;
+	owner = true;
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	stats->version = JSTATS_VERSION;
+	stats->pid = pid;
+	stats->start_time = stats->update_time = (double)tv.tv_sec + 1.0E-6*(double)tv.tv_usec;
+	__sync_synchronize();
+	stats->magic = JSTATS_MAGIC;
+
+	return true;
+}
+
+//---------------------------------
+// Attach
+//---------------------------------
+bool JStatsSegment::Attach(pid_t pid)
+{
+	/// Map the statistics segment of an existing process read-only.
+	/// Returns false and sets the error string if the segment does
+	/// not exist or was written by an incompatible version of JANA.
+	Detach();
+
+	name = GetName(pid);
+	int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if(fd < 0){
+		error = string("shm_open(") + name + "): " + strerror(errno);
+		return false;
+	}
+	struct stat st;
+	if(fstat(fd, &st)!=0 || (size_t)st.st_size<sizeof(jstats_t)){
+		error = name + " is too small to be a JANA statistics segment";
+		close(fd);
+		return false;
+	}
+	void *ptr = mmap(NULL, sizeof(jstats_t), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(ptr == MAP_FAILED){
+		error = string("mmap(") + name + "): " + strerror(errno);
+		return false;
+	}
+
+	stats = (jstats_t*)ptr;
+	if(stats->magic!=JSTATS_MAGIC || stats->version!=JSTATS_VERSION){
+		error = name + " has wrong magic number or version";
+		Detach();
+		return false;
+	}
+
+	return true;
+}
+
+//---------------------------------
+// Detach
+//---------------------------------
+void JStatsSegment::Detach(void)
+{
+	/// Unmap the segment. If we created it, it is also removed.
+	if(!stats) return;
+
+	Remove();
+	munmap((void*)stats, sizeof(jstats_t));
+	stats = NULL;
+	owner = false;
+}
+
+//---------------------------------
+// Remove
+//---------------------------------
+void JStatsSegment::Remove(void)
+{
+	/// Flag the segment as finished and remove its name so no new
+	/// monitors can attach. The memory stays mapped (and writable)
+	/// until Detach() is called or this object is deleted. This
+	/// does nothing if we are not the owner.
+	if(!stats || !owner) return;
+
+	stats->finished = 1;
+	if(!name.empty()) shm_unlink(name.c_str());
+	name = "";
+}
+
+//---------------------------------
+// AllocThreadSlot
+//---------------------------------
+jstats_thread_t* JStatsSegment::AllocThreadSlot(uint64_t thread_id)
+{
+	/// Reserve a per-thread slot. Returns NULL if all slots are taken
+	/// (or we are not the owner) in which case the thread simply won't
+	/// be published.
+	if(!stats || !owner) return NULL;
+
+	jstats_thread_t *slot = NULL;
+	pthread_mutex_lock(&mutex);
+	for(unsigned int i=0; i<JSTATS_MAX_THREADS; i++){
+		if(stats->threads[i].in_use) continue;
+		slot = &stats->threads[i];
+		memset((void*)slot, 0, sizeof(jstats_thread_t));
+		slot->thread_index = Nthread_slots_allocated++;
+		slot->thread_id = thread_id;
+		__sync_synchronize();
+		slot->in_use = 1;
+		break;
+	}
+	pthread_mutex_unlock(&mutex);
+
+	return slot;
+}
+
+//---------------------------------
+// FreeThreadSlot
+//---------------------------------
+void JStatsSegment::FreeThreadSlot(jstats_thread_t *slot)
+{
+	if(!slot) return;
+	pthread_mutex_lock(&mutex);
+	slot->in_use = 0;
+	pthread_mutex_unlock(&mutex);
+}
+
+//---------------------------------
+// GetFactorySlot
+//---------------------------------
+jstats_factory_t* JStatsSegment::GetFactorySlot(const string &nametag)
+{
+	/// Return the slot for the factory with the given name:tag, creating
+	/// it if needed. Slots are shared by all threads and are never freed
+	/// so callers should look this up once and keep the pointer. Counts
+	/// are added to the slot with atomic operations. Returns NULL if there
+	/// is no room left.
+	if(!stats || !owner) return NULL;
+
+	jstats_factory_t *slot = NULL;
+	pthread_mutex_lock(&mutex);
+	for(unsigned int i=0; i<stats->Nfactories; i++){
+		if(nametag == stats->factories[i].name){
+			slot = &stats->factories[i];
+			break;
+		}
+	}
+	if(!slot && stats->Nfactories<JSTATS_MAX_FACTORIES){
+		slot = &stats->factories[stats->Nfactories];
+		SetString(slot->name, nametag, JSTATS_NAME_LEN);
+		__sync_synchronize();
+		stats->Nfactories++;
+	}
+	pthread_mutex_unlock(&mutex);
+
+	return slot;
+}
+
+//---------------------------------
+// SetString
+//---------------------------------
+void JStatsSegment::SetString(char *dest, const string &src, unsigned int maxlen)
+{
+	/// Copy a string into a fixed length field, truncating if needed.
+	strncpy(dest, src.c_str(), maxlen-1);
+	dest[maxlen-1] = 0;
+}
+
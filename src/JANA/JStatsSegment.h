@@ -0,0 +1,124 @@
+// $Id$
+//
+//    File: JStatsSegment.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JStatsSegment_
+#define _JStatsSegment_
+
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <string>
+using std::string;
+
+// The structures below define the layout of a block of POSIX shared
+// memory that JApplication publishes its processing statistics into.
+// This allows external programs (e.g. janatop) to monitor a running
+// process without any cooperation from it beyond this memory being
+// updated. Because of this, the layout must be fixed: no pointers,
+// no STL containers and no virtual methods. If the layout is changed
+// in any way, JSTATS_VERSION must be incremented.
+//
+// Every field has exactly one writer (either the main thread or the
+// processing thread that owns a slot) so no locking is needed for
+// updates. Readers may therefore see a partially updated block, but
+// each individual (naturally aligned) field will always be consistent.
+
+#define JSTATS_MAGIC         0x4A53544154530001ULL  // "JSTATS" + 0x0001
+#define JSTATS_VERSION       2
+#define JSTATS_MAX_THREADS   256
+#define JSTATS_MAX_FACTORIES 512
+#define JSTATS_NAME_LEN      128
+
+// Place everything in JANA namespace
+namespace jana{
+
+typedef struct{
+	volatile uint32_t in_use;             ///< non-zero if a JEventLoop currently owns this slot
+	volatile uint32_t thread_index;       ///< order in which thread was launched
+	volatile uint64_t thread_id;          ///< pthread_t of thread (as integer)
+	volatile uint64_t Nevents;            ///< events processed by this thread
+	volatile double   rate_instantaneous; ///< Hz
+	volatile double   rate_integrated;    ///< Hz
+	volatile double   last_event_time;    ///< seconds spent on most recent event
+	volatile double   heartbeat;          ///< seconds since thread last finished an event (updated by main thread)
+	volatile int32_t  run_number;         ///< run number of current/last event
+	volatile uint32_t pad;
+	volatile uint64_t event_number;       ///< event number of current/last event
+}jstats_thread_t;
+
+typedef struct{
+	char name[JSTATS_NAME_LEN];           ///< "class:tag" (set once when slot is registered)
+	volatile uint64_t Ncalls;             ///< calls to Get summed over all threads
+	volatile uint64_t Ngencalls;          ///< calls to evnt summed over all threads
+	volatile uint64_t evnt_ns;            ///< time spent in evnt summed over all threads (includes nested factories)
+}jstats_factory_t;
+
+typedef struct{
+	volatile uint64_t magic;
+	volatile uint32_t version;
+	volatile uint32_t pid;
+	volatile double   start_time;         ///< unix time segment was created
+	volatile double   update_time;        ///< unix time global fields were last updated
+	volatile uint64_t NEvents;            ///< events processed
+	volatile uint64_t NEvents_read;       ///< events read from source(s)
+	volatile uint64_t Nlost_events;       ///< events lost to stalled threads
+	volatile double   rate_instantaneous; ///< Hz
+	volatile double   rate_average;       ///< Hz
+	volatile uint32_t Nthreads;           ///< desired number of processing threads
+	volatile uint32_t Nthreads_running;   ///< number of processing threads actually running
+	volatile uint32_t event_buffer_size;  ///< events currently in event buffer
+	volatile uint32_t event_buffer_max;   ///< max. events allowed in event buffer
+	volatile uint32_t Nfactories;         ///< number of entries in factories[] that are valid
+	volatile uint32_t finished;           ///< set to non-zero when event processing is complete
+	char source_name[256];                ///< current event source
+	char command[256];                    ///< command line of process (truncated)
+	jstats_thread_t  threads[JSTATS_MAX_THREADS];
+	jstats_factory_t factories[JSTATS_MAX_FACTORIES];
+}jstats_t;
+
+
+/// JStatsSegment manages the shared memory segment that holds a jstats_t
+/// block. The owning process calls Create() which makes the segment and
+/// removes it again when this object is deleted. Monitoring programs call
+/// Attach() with the PID of the process they want to watch.
+
+class JStatsSegment{
+	public:
+		JStatsSegment();
+		virtual ~JStatsSegment();
+
+		bool Create(pid_t pid=getpid());
+		bool Attach(pid_t pid);
+		void Detach(void);
+		void Remove(void);
+
+		jstats_t* Get(void){return stats;}
+		bool IsOwner(void) const {return owner;}
+		const string& GetError(void) const {return error;}
+
+		jstats_thread_t* AllocThreadSlot(uint64_t thread_id);
+		void FreeThreadSlot(jstats_thread_t *slot);
+		jstats_factory_t* GetFactorySlot(const string &nametag);
+
+		void SetString(char *dest, const string &src, unsigned int maxlen);
+
+		static string GetName(pid_t pid);
+
+	protected:
+		jstats_t *stats;
+		bool owner;
+		string name;
+		string error;
+		uint32_t Nthread_slots_allocated;
+		pthread_mutex_t mutex;
+};
+
+} // Close JANA namespace
+
+#endif // _JStatsSegment_
+
@@ -0,0 +1,126 @@
+// $Id$
+//
+//    File: JThreadTuner.cc
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#include <sstream>
+#include <iomanip>
+using namespace std;
+
+#include "JThreadTuner.h"
+using namespace jana;
+
+//---------------------------------
+// JThreadTuner    (Constructor)
+//---------------------------------
+JThreadTuner::JThreadTuner(unsigned int Nmax, double interval, double efficiency)
+{
+	this->Nmax = Nmax>0 ? Nmax:1;
+	this->interval = interval>0.0 ? interval:1.0;
+	this->efficiency = efficiency;
+
+	// Give threads time to start and get through their first events
+	// (which are often slow) before measuring.
+	settle_time = this->interval/5.0;
+	if(settle_time < 1.0) settle_time = 1.0;
+
+	state = kSettling;
+	Nthreads = 1;
+	Ngood = 1;
+	Nbad = 0;
+	start_t = -1.0;
+	start_events = 0;
+}
+
+//---------------------------------
+// Update
+//---------------------------------
+unsigned int JThreadTuner::Update(uint64_t Nevents, double t)
+{
+	/// Called periodically with the number of events processed so far
+	/// and the current time in seconds. Returns the number of threads
+	/// that should be running.
+	if(start_t < 0.0) start_t = t;
+
+	switch(state){
+		case kSettling:
+			if(t - start_t >= settle_time){
+				state = kMeasuring;
+				start_t = t;
+				start_events = Nevents;
+			}
+			break;
+		case kMeasuring:
+			if(t - start_t >= interval){
+				Measured((double)(Nevents - start_events)/(t - start_t));
+				if(state != kDone) Try(Nthreads, t);
+			}
+			break;
+		case kDone:
+			break;
+	}
+
+	return Nthreads;
+}
+
+//---------------------------------
+// Measured
+//---------------------------------
+void JThreadTuner::Measured(double rate)
+{
+	/// Record the rate for the current number of threads and decide
+	/// what to try next. Nthreads is set to the next number to try or,
+	/// if done, to the number chosen.
+	rates[Nthreads] = rate;
+
+	if(Nthreads != Ngood){
+		// Rate each added thread gave compared to what each thread
+		// was giving at the last good setting.
+		double r_good = rates[Ngood];
+		double per_thread = r_good/(double)Ngood;
+		double per_added = (rate - r_good)/(double)(Nthreads - Ngood);
+		if(per_thread>0.0 && per_added >= efficiency*per_thread){
+			Ngood = Nthreads;
+		}else{
+			Nbad = Nthreads;
+		}
+	}
+
+	// Double until a step does not scale, then bisect
+	unsigned int next = Nbad==0 ? 2*Ngood:(Ngood + Nbad)/2;
+	if(next > Nmax) next = Nmax;
+	if(next <= Ngood){
+		Nthreads = Ngood;
+		state = kDone;
+	}else{
+		Nthreads = next;
+	}
+}
+
+//---------------------------------
+// Try
+//---------------------------------
+void JThreadTuner::Try(unsigned int N, double t)
+{
+	Nthreads = N;
+	state = kSettling;
+	start_t = t;
+}
+
+//---------------------------------
+// GetSummary
+//---------------------------------
+string JThreadTuner::GetSummary(void) const
+{
+	/// Return the measured rates as a string. e.g.
+	/// "1:98.2Hz 2:195.1Hz 4:382.7Hz 8:401.3Hz 6:399.8Hz 5:388.0Hz"
+	stringstream ss;
+	ss<<fixed<<setprecision(1);
+	for(map<unsigned int, double>::const_iterator it=rates.begin(); it!=rates.end(); it++){
+		if(it!=rates.begin()) ss<<" ";
+		ss<<it->first<<":"<<it->second<<"Hz";
+	}
+	return ss.str();
+}
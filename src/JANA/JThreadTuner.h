@@ -0,0 +1,77 @@
+// $Id$
+//
+//    File: JThreadTuner.h
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#ifndef _JThreadTuner_
+#define _JThreadTuner_
+
+#include <stdint.h>
+
+#include <string>
+#include <map>
+using std::string;
+using std::map;
+
+// Place everything in JANA namespace
+namespace jana{
+
+/// JThreadTuner picks the number of processing threads by measuring the
+/// event rate as threads are added. It is used by JApplication::Run()
+/// when NTHREADS is set to "auto".
+///
+/// Processing starts with one thread. Each setting is given a short
+/// time to settle and then the integrated rate is measured for
+/// JANA:NTHREADS_AUTO_INTERVAL seconds. The number of threads is doubled
+/// as long as the added threads each give at least
+/// JANA:NTHREADS_AUTO_EFFICIENCY of what a single thread was giving
+/// (1.0 would be perfect scaling). Once a step falls short, the number
+/// between the last good one and the one that fell short is found by
+/// bisection. The result is the knee of the scaling curve: the point past
+/// which more threads mostly just take cores away from other jobs on the
+/// node.
+///
+/// Call Update() periodically with the total number of events processed.
+/// It returns the number of threads that should be running.
+
+class JThreadTuner{
+	public:
+		JThreadTuner(unsigned int Nmax, double interval, double efficiency);
+		virtual ~JThreadTuner(){}
+
+		unsigned int Update(uint64_t Nevents, double t);
+		unsigned int GetNthreads(void) const {return Nthreads;}
+		bool IsDone(void) const {return state==kDone;}
+		string GetSummary(void) const;
+
+	protected:
+
+		enum state_t{
+			kSettling,
+			kMeasuring,
+			kDone
+		};
+
+		void Measured(double rate);
+		void Try(unsigned int N, double t);
+
+		unsigned int Nmax;
+		double interval;
+		double settle_time;
+		double efficiency;
+
+		state_t state;
+		unsigned int Nthreads;      // number of threads being tried
+		unsigned int Ngood;         // largest number found to scale well
+		unsigned int Nbad;          // smallest number found not to (0 if none yet)
+		double start_t;
+		uint64_t start_events;
+		map<unsigned int, double> rates;  // measured rate (Hz) by number of threads
+};
+
+} // Close JANA namespace
+
+#endif // _JThreadTuner_
+
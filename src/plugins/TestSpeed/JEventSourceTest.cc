@@ -109,6 +109,33 @@ jerror_t JEventSourceTest::GetEvent(JEvent &event)
 	return NOERROR;
 }
 
+//----------------
+// SkipEvents
+//----------------
+jerror_t JEventSourceTest::SkipEvents(uint64_t Nevents, uint64_t &Nskipped)
+{
+	/// Events are made up as they are asked for so skipping them only
+	/// means advancing the event number. There is no I/O delay for
+	/// skipped events.
+	Nevents_read += Nevents;
+	Nskipped = Nevents;
+
+	return NOERROR;
+}
+
+//----------------
+// SeekToEvent
+//----------------
+jerror_t JEventSourceTest::SeekToEvent(uint64_t eventNumber, uint64_t &Nskipped)
+{
+	/// Event numbers just count up from 1 so an event number we are
+	/// already past will never come.
+	Nskipped = 0;
+	if(eventNumber <= (uint64_t)Nevents_read) return NO_MORE_EVENTS_IN_SOURCE;
+
+	return SkipEvents(eventNumber-1-Nevents_read, Nskipped);
+}
+
 //----------------
 // FreeEvent
 //----------------
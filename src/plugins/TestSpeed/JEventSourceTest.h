@@ -30,6 +30,8 @@ class JEventSourceTest:public JEventSource
 		jerror_t GetEvent(JEvent &event);
 		void FreeEvent(JEvent &event);
 		jerror_t GetObjects(JEvent &event, JFactory_base *factory);
+		jerror_t SkipEvents(uint64_t Nevents, uint64_t &Nskipped);
+		jerror_t SeekToEvent(uint64_t eventNumber, uint64_t &Nskipped);
 		
 	private:
 	
@@ -21,12 +21,11 @@ class JRawData:public JObject{
 		int channel;
 		int adc;
 		
-		void toStrings(vector<pair<string,string> > &items)const{
-			AddString(items, "crate", "%d", crate);
-			AddString(items, "slot", "%d", slot);
-			AddString(items, "channel", "%d", channel);
-			AddString(items, "adc", "%d", adc);
-		}
+		JOBJECT_FIELDS(JRawData,
+			JFIELD(crate,   "%d"),
+			JFIELD(slot,    "%d"),
+			JFIELD(channel, "%d"),
+			JFIELD(adc,     "%d"));
 };
 
 #endif // _JRawData_
@@ -20,11 +20,10 @@ class JTest:public JObject{
 		double y;
 		double z;
 		
-		void toStrings(vector<pair<string,string> > &items)const{
-			AddString(items, "x", "%3.2f", x);
-			AddString(items, "y", "%3.2f", y);
-			AddString(items, "z", "%3.2f", z);
-		}
+		JOBJECT_FIELDS(JTest,
+			JFIELD(x, "%3.2f"),
+			JFIELD(y, "%3.2f"),
+			JFIELD(z, "%3.2f"));
 };
 
 #endif // _JTest_
@@ -25,6 +25,12 @@ JTest_factory::JTest_factory(void)
 	// completely.
 	governor_iterations = 1000;
 	gPARMS->SetDefaultParameter("GOVERNOR_ITERATIONS", governor_iterations);
+
+	// JTest objects can be kept in the factory cache (-PJANA:FACTORY_CACHE=dir)
+	// since they declare their fields. The governor doesn't change the
+	// values, but is listed as an example of a parameter that would.
+	SetFactoryFlag(CACHEABLE);
+	AddCacheParameter("GOVERNOR_ITERATIONS");
 }
 
 //------------------
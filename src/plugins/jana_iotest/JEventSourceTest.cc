@@ -42,6 +42,17 @@ void InitPlugin(JApplication *app){
 	cout<<endl;
 	cout<<"this will cause the source the reads to be done in 1kB(=1024 byte) blocks."<<endl;
 	cout<<endl;
+	cout<<"To read the file some other way than through an ifstream add:"<<endl;
+	cout<<endl;
+	cout<<"    -PREAD_MODE=pread    (one pread per block)"<<endl;
+	cout<<"    -PREAD_MODE=mmap     (memory map the file)"<<endl;
+	cout<<"    -PREAD_MODE=async    (keep -PASYNC_QUEUE_DEPTH=8 reads in flight using"<<endl;
+	cout<<"                          -PASYNC_METHOD=auto|io_uring|threads)"<<endl;
+	cout<<endl;
+	cout<<"Compare the MB/s in the I/O summary printed at the end for each."<<endl;
+	cout<<"In the default (ifstream) mode, gzip compressed files are decompressed"<<endl;
+	cout<<"on -PJANA:DECOMPRESS_THREADS threads (in parallel for BGZF files)."<<endl;
+	cout<<endl;
 	cout<<endl;
 }
 } // "C"
@@ -60,7 +71,8 @@ JEventSourceTest::JEventSourceTest(const char* source_name):JEventSource(source_
 	
 	buff = new char[READ_BLOCK_SIZE];
 	
-	ifs = new ifstream(source_name);
+	// This is an ifstream unless the file is gzip compressed
+	ifs = OpenInputStream(source_name);
 }
 
 //----------------
@@ -88,6 +100,7 @@ jerror_t JEventSourceTest::GetEvent(JEvent &event)
 
 	// Read in block of events
 	ifs->read(buff, READ_BLOCK_SIZE);
+	AddBytesRead(ifs->gcount());
 	if(ifs->eof())return NO_MORE_EVENTS_IN_SOURCE;
 
 	// Copy the reference info into the JEvent object
@@ -99,6 +112,46 @@ jerror_t JEventSourceTest::GetEvent(JEvent &event)
 	return NOERROR;
 }
 
+//----------------
+// SkipEvents
+//----------------
+jerror_t JEventSourceTest::SkipEvents(uint64_t Nevents, uint64_t &Nskipped)
+{
+	/// Seek past the blocks if the file allows it. Compressed files
+	/// can't seek so the blocks are read and thrown away (still without
+	/// making events for them).
+	Nskipped = 0;
+	streampos pos = ifs->tellg();
+	if(pos != streampos(-1)){
+		ifs->seekg(0, ios::end);
+		uint64_t Nblocks_left = (uint64_t)(ifs->tellg() - pos)/READ_BLOCK_SIZE;
+		Nskipped = Nevents<Nblocks_left ? Nevents:Nblocks_left;
+		ifs->seekg(pos + (streamoff)(Nskipped*READ_BLOCK_SIZE));
+	}else{
+		ifs->clear();
+		while(Nskipped<Nevents){
+			ifs->ignore(READ_BLOCK_SIZE);
+			if((unsigned long)ifs->gcount() < READ_BLOCK_SIZE) break;
+			AddBytesRead(READ_BLOCK_SIZE);
+			Nskipped++;
+		}
+	}
+	Nevents_read += Nskipped;
+
+	return Nskipped==Nevents ? NOERROR:NO_MORE_EVENTS_IN_SOURCE;
+}
+
+//----------------
+// SeekToEvent
+//----------------
+jerror_t JEventSourceTest::SeekToEvent(uint64_t eventNumber, uint64_t &Nskipped)
+{
+	/// The event number is the block number so this is just a skip.
+	/// If we are already past it, skip the rest of the file.
+	uint64_t Nevents = eventNumber>(uint64_t)Nevents_read ? eventNumber-1-Nevents_read:~(uint64_t)0;
+	return SkipEvents(Nevents, Nskipped);
+}
+
 //----------------
 // FreeEvent
 //----------------
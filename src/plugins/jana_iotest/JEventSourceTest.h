@@ -31,11 +31,13 @@ class JEventSourceTest:public JEventSource
 		jerror_t GetEvent(JEvent &event);
 		void FreeEvent(JEvent &event);
 		jerror_t GetObjects(JEvent &event, JFactory_base *factory);
+		jerror_t SkipEvents(uint64_t Nevents, uint64_t &Nskipped);
+		jerror_t SeekToEvent(uint64_t eventNumber, uint64_t &Nskipped);
 		
 	private:
 	
 		unsigned long READ_BLOCK_SIZE;
-		ifstream *ifs;
+		istream *ifs;
 		char *buff;
 };
 
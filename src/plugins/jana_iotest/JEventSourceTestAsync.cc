@@ -0,0 +1,131 @@
+// $Id$
+//
+//    File: JEventSourceTestAsync.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <iostream>
+using namespace std;
+
+#include <JANA/JParameterManager.h>
+#include <JANA/JEvent.h>
+#include <JANA/JStreamLog.h>
+
+#include "JEventSourceTestAsync.h"
+
+//----------------
+// Constructor
+//----------------
+JEventSourceTestAsync::JEventSourceTestAsync(const char* source_name, bool async):JEventSource(source_name)
+{
+	READ_BLOCK_SIZE = 837;
+	uint32_t ASYNC_QUEUE_DEPTH = 8;
+	string ASYNC_METHOD = "auto";
+	gPARMS->SetDefaultParameter("READ_BLOCK_SIZE",READ_BLOCK_SIZE);
+	if(async){
+		gPARMS->SetDefaultParameter("ASYNC_QUEUE_DEPTH", ASYNC_QUEUE_DEPTH, "Number of reads to keep in flight for READ_MODE=async");
+		gPARMS->SetDefaultParameter("ASYNC_METHOD", ASYNC_METHOD, "How READ_MODE=async does its reads: auto, io_uring or threads");
+	}else{
+		ASYNC_QUEUE_DEPTH = 0;
+	}
+
+	reader = new JAsyncReader(source_name, READ_BLOCK_SIZE, ASYNC_QUEUE_DEPTH, JAsyncReader::GetMethodByName(ASYNC_METHOD));
+	if(!reader->IsOpen()){
+		jerr<<"Unable to open \""<<source_name<<"\": "<<reader->GetError()<<endl;
+	}else{
+		jout<<"Reading \""<<source_name<<"\" with "<<reader->GetMethodName();
+		if(async) jout<<" (queue depth "<<ASYNC_QUEUE_DEPTH<<")";
+		jout<<endl;
+	}
+}
+
+//----------------
+// Destructor
+//----------------
+JEventSourceTestAsync::~JEventSourceTestAsync()
+{
+	delete reader;
+}
+
+//----------------
+// GetEvent
+//----------------
+jerror_t JEventSourceTestAsync::GetEvent(JEvent &event)
+{
+	if(!reader->IsOpen()) return EVENT_SOURCE_NOT_OPEN;
+
+	JAsyncReader::Block *block = reader->Next();
+	if(!block){
+		if(reader->GetError() != "") jerr<<"Error reading \""<<source_name<<"\": "<<reader->GetError()<<endl;
+		return NO_MORE_EVENTS_IN_SOURCE;
+	}
+	AddBytesRead(block->size);
+
+	// As with the ifstream version, a partial block at the end of the file is ignored
+	if(block->size < READ_BLOCK_SIZE){
+		reader->Release(block);
+		return NO_MORE_EVENTS_IN_SOURCE;
+	}
+
+	event.SetJEventSource(this);
+	event.SetEventNumber(++Nevents_read);
+	event.SetRunNumber(1234);
+	event.SetRef(block);
+
+	return NOERROR;
+}
+
+//----------------
+// FreeEvent
+//----------------
+void JEventSourceTestAsync::FreeEvent(JEvent &event)
+{
+	reader->Release((JAsyncReader::Block*)event.GetRef());
+}
+
+//----------------
+// GetRawEvent
+//----------------
+bool JEventSourceTestAsync::GetRawEvent(JEvent &event, const void* &data, uint64_t &size)
+{
+	JAsyncReader::Block *block = (JAsyncReader::Block*)event.GetRef();
+	if(!block) return false;
+	data = block->data;
+	size = block->size;
+	return true;
+}
+
+//----------------
+// SkipEvents
+//----------------
+jerror_t JEventSourceTestAsync::SkipEvents(uint64_t Nevents, uint64_t &Nskipped)
+{
+	/// The reader already has reads in flight ahead of us so it can't
+	/// seek. Blocks are taken from it and handed right back, which
+	/// still saves making and processing an event for each.
+	Nskipped = 0;
+	if(!reader->IsOpen()) return EVENT_SOURCE_NOT_OPEN;
+
+	while(Nskipped<Nevents){
+		JAsyncReader::Block *block = reader->Next();
+		if(!block) return NO_MORE_EVENTS_IN_SOURCE;
+		AddBytesRead(block->size);
+		bool partial = block->size < READ_BLOCK_SIZE;
+		reader->Release(block);
+		if(partial) return NO_MORE_EVENTS_IN_SOURCE;
+		Nevents_read++;
+		Nskipped++;
+	}
+
+	return NOERROR;
+}
+
+//----------------
+// SeekToEvent
+//----------------
+jerror_t JEventSourceTestAsync::SeekToEvent(uint64_t eventNumber, uint64_t &Nskipped)
+{
+	uint64_t Nevents = eventNumber>(uint64_t)Nevents_read ? eventNumber-1-Nevents_read:~(uint64_t)0;
+	return SkipEvents(Nevents, Nskipped);
+}
@@ -0,0 +1,42 @@
+// $Id$
+//
+//    File: JEventSourceTestAsync.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JEventSourceTestAsync_
+#define _JEventSourceTestAsync_
+
+#include <JANA/JEventSource.h>
+#include <JANA/JAsyncReader.h>
+using namespace jana;
+
+/// Same as JEventSourceTest except the file is read with a JAsyncReader.
+/// Each "event" is one READ_BLOCK_SIZE block. With -PREAD_MODE=pread the
+/// blocks are read one at a time with pread when asked for. With
+/// -PREAD_MODE=async, ASYNC_QUEUE_DEPTH reads are kept in flight ahead
+/// of the event buffer using ASYNC_METHOD (auto, io_uring or threads).
+
+class JEventSourceTestAsync:public JEventSource
+{
+	public:
+		JEventSourceTestAsync(const char* source_name, bool async);
+		virtual ~JEventSourceTestAsync();
+		virtual const char* className(void){return static_className();}
+		static const char* static_className(void){return "JEventSourceTestAsync";}
+
+		jerror_t GetEvent(JEvent &event);
+		void FreeEvent(JEvent &event);
+		bool GetRawEvent(JEvent &event, const void* &data, uint64_t &size);
+		jerror_t SkipEvents(uint64_t Nevents, uint64_t &Nskipped);
+		jerror_t SeekToEvent(uint64_t eventNumber, uint64_t &Nskipped);
+		jerror_t GetObjects(JEvent &event, JFactory_base *factory){return OBJECT_NOT_AVAILABLE;}
+
+	protected:
+		unsigned long READ_BLOCK_SIZE;
+		JAsyncReader *reader;
+};
+
+#endif // _JEventSourceTestAsync_
+
@@ -11,6 +11,12 @@ using std::string;
 
 #include "JEventSourceTestGenerator.h"
 #include "JEventSourceTest.h"
+#include "JEventSourceTestMMap.h"
+#include "JEventSourceTestAsync.h"
+#include "JEventSourceTestRing.h"
+#include "JEventSourceTestSocket.h"
+
+#include <JANA/JParameterManager.h>
 
 //---------------------------------
 // Description
@@ -36,6 +42,18 @@ double JEventSourceTestGenerator::CheckOpenable(string source)
 //---------------------------------
 JEventSource* JEventSourceTestGenerator::MakeJEventSource(string source)
 {
+	// Blocks put in an event ring by the janaring utility
+	if(JEventSourceRing::IsRingName(source.c_str())) return new JEventSourceTestRing(source.c_str());
+
+	// Blocks sent by the janabroker utility
+	if(JEventSocket::IsSocketAddress(source.c_str())) return new JEventSourceTestSocket(source.c_str());
+
+	string READ_MODE = "ifstream";
+	gPARMS->SetDefaultParameter("READ_MODE", READ_MODE, "How jana_iotest reads the file: ifstream, pread, mmap or async");
+	if(READ_MODE == "mmap") return new JEventSourceTestMMap(source.c_str());
+	if(READ_MODE == "pread") return new JEventSourceTestAsync(source.c_str(), false);
+	if(READ_MODE == "async") return new JEventSourceTestAsync(source.c_str(), true);
+
 	return new JEventSourceTest(source.c_str());
 }
 		
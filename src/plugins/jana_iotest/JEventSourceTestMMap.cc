@@ -0,0 +1,76 @@
+// $Id$
+//
+//    File: JEventSourceTestMMap.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <unistd.h>
+
+#include <JANA/JParameterManager.h>
+#include <JANA/JEvent.h>
+
+#include "JEventSourceTestMMap.h"
+
+//----------------
+// Constructor
+//----------------
+JEventSourceTestMMap::JEventSourceTestMMap(const char* source_name):JEventSourceMMap(source_name)
+{
+	READ_BLOCK_SIZE = 837;
+	gPARMS->SetDefaultParameter("READ_BLOCK_SIZE",READ_BLOCK_SIZE);
+	checksum = 0;
+}
+
+//----------------
+// FindEvent
+//----------------
+jerror_t JEventSourceTestMMap::FindEvent(const uint8_t *data, uint64_t Navailable, uint64_t &Nbytes, JEvent &event)
+{
+	/// Every event is READ_BLOCK_SIZE bytes. As with the ifstream version,
+	/// a partial block at the end of the file is ignored.
+	if(Navailable < READ_BLOCK_SIZE) return NO_MORE_EVENTS_IN_SOURCE;
+	Nbytes = READ_BLOCK_SIZE;
+
+	// Touch every page of the block so that the data is actually read
+	// in (the ifstream version copies it all into its buffer).
+	static const uint64_t page_size = sysconf(_SC_PAGESIZE);
+	for(uint64_t i=0; i<Nbytes; i+=page_size) checksum += data[i];
+	checksum += data[Nbytes-1];
+
+	// Number events by their position so they are numbered the same
+	// no matter how we got to them (e.g. through the event index)
+	Nevents_read++;
+	event.SetEventNumber((data-buff)/READ_BLOCK_SIZE + 1);
+	event.SetRunNumber(1234);
+
+	return NOERROR;
+}
+
+//----------------
+// SkipEvents
+//----------------
+jerror_t JEventSourceTestMMap::SkipEvents(uint64_t Nevents, uint64_t &Nskipped)
+{
+	/// All blocks are the same size so the position can just be moved.
+	/// The skipped blocks are never paged in.
+	Nskipped = 0;
+	if(!IsMapped()) return EVENT_SOURCE_NOT_OPEN;
+
+	uint64_t Nblocks_left = (file_size-position)/READ_BLOCK_SIZE;
+	Nskipped = Nevents<Nblocks_left ? Nevents:Nblocks_left;
+	SkipBytes(Nskipped*READ_BLOCK_SIZE, Nskipped);
+
+	return Nskipped==Nevents ? NOERROR:NO_MORE_EVENTS_IN_SOURCE;
+}
+
+//----------------
+// SeekToEvent
+//----------------
+jerror_t JEventSourceTestMMap::SeekToEvent(uint64_t eventNumber, uint64_t &Nskipped)
+{
+	/// Event numbers count blocks from the start of the file
+	uint64_t next_event = position/READ_BLOCK_SIZE + 1;
+	uint64_t Nevents = eventNumber>=next_event ? eventNumber-next_event:~(uint64_t)0;
+	return SkipEvents(Nevents, Nskipped);
+}
@@ -0,0 +1,39 @@
+// $Id$
+//
+//    File: JEventSourceTestMMap.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JEventSourceTestMMap_
+#define _JEventSourceTestMMap_
+
+#include <JANA/JEventSourceMMap.h>
+using namespace jana;
+
+/// Same as JEventSourceTest except the file is memory mapped (see
+/// JEventSourceMMap) instead of being read through an ifstream. Each
+/// "event" is a READ_BLOCK_SIZE byte view of the file. Select it with
+/// -PREAD_MODE=mmap.
+
+class JEventSourceTestMMap:public JEventSourceMMap
+{
+	public:
+		JEventSourceTestMMap(const char* source_name);
+		virtual ~JEventSourceTestMMap(){}
+		virtual const char* className(void){return static_className();}
+		static const char* static_className(void){return "JEventSourceTestMMap";}
+
+		jerror_t GetObjects(JEvent &event, JFactory_base *factory){return OBJECT_NOT_AVAILABLE;}
+		jerror_t SkipEvents(uint64_t Nevents, uint64_t &Nskipped);
+		jerror_t SeekToEvent(uint64_t eventNumber, uint64_t &Nskipped);
+
+	protected:
+		jerror_t FindEvent(const uint8_t *data, uint64_t Navailable, uint64_t &Nbytes, JEvent &event);
+
+		unsigned long READ_BLOCK_SIZE;
+		uint64_t checksum;
+};
+
+#endif // _JEventSourceTestMMap_
+
@@ -0,0 +1,31 @@
+// $Id$
+//
+//    File: JEventSourceTestRing.cc
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#include <unistd.h>
+
+#include <JANA/JEvent.h>
+
+#include "JEventSourceTestRing.h"
+
+//----------------
+// GetEvent
+//----------------
+jerror_t JEventSourceTestRing::GetEvent(JEvent &event)
+{
+	jerror_t err = JEventSourceRing::GetEvent(event);
+	if(err != NOERROR) return err;
+
+	// Touch every page of the block as JEventSourceTestMMap does so
+	// the comparison with the other read modes is fair.
+	static const uint64_t page_size = sysconf(_SC_PAGESIZE);
+	View *view = (View*)event.GetRef();
+	for(uint64_t i=0; i<view->size; i+=page_size) checksum += view->data[i];
+	if(view->size>0) checksum += view->data[view->size-1];
+	Nevents_read++;
+
+	return NOERROR;
+}
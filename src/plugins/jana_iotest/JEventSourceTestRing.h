@@ -0,0 +1,35 @@
+// $Id$
+//
+//    File: JEventSourceTestRing.h
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#ifndef _JEventSourceTestRing_
+#define _JEventSourceTestRing_
+
+#include <JANA/JEventSourceRing.h>
+using namespace jana;
+
+/// Same as JEventSourceTestMMap except the blocks come from an event
+/// ring filled by a separate reader process (see JEventSourceRing and
+/// the janaring utility). Used whenever the source name has the form
+/// ring:NAME.
+
+class JEventSourceTestRing:public JEventSourceRing
+{
+	public:
+		JEventSourceTestRing(const char* source_name):JEventSourceRing(source_name),checksum(0){}
+		virtual ~JEventSourceTestRing(){}
+		virtual const char* className(void){return static_className();}
+		static const char* static_className(void){return "JEventSourceTestRing";}
+
+		using JEventSourceRing::GetEvent;
+		jerror_t GetEvent(JEvent &event);
+
+	protected:
+		uint64_t checksum;
+};
+
+#endif // _JEventSourceTestRing_
+
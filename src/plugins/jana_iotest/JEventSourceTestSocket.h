@@ -0,0 +1,35 @@
+// $Id$
+//
+//    File: JEventSourceTestSocket.h
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+#ifndef _JEventSourceTestSocket_
+#define _JEventSourceTestSocket_
+
+#include <JANA/JEventSourceSocket.h>
+using namespace jana;
+
+/// Same as JEventSourceTestMMap except the blocks come from an event
+/// broker over a socket (see JEventSourceSocket and the janabroker
+/// utility). Used whenever the source name has the form unix:PATH or
+/// tcp:HOST:PORT.
+
+class JEventSourceTestSocket:public JEventSourceSocket
+{
+	public:
+		JEventSourceTestSocket(const char* source_name):JEventSourceSocket(source_name),checksum(0){}
+		virtual ~JEventSourceTestSocket(){}
+		virtual const char* className(void){return static_className();}
+		static const char* static_className(void){return "JEventSourceTestSocket";}
+
+		using JEventSourceSocket::GetEvent;
+		jerror_t GetEvent(JEvent &event);
+
+	protected:
+		uint64_t checksum;
+};
+
+#endif // _JEventSourceTestSocket_
+
@@ -0,0 +1,351 @@
+// $Id$
+//
+//    File: JColumnarChunk.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <sstream>
+using std::stringstream;
+
+#include "JColumnarChunk.h"
+
+//---------------------------------
+// GetTypeSize
+//---------------------------------
+unsigned int JColumnar::GetTypeSize(uint8_t type)
+{
+	switch(type){
+		case kInt8:   case kUInt8:  case kBool: return 1;
+		case kInt16:  case kUInt16: return 2;
+		case kInt32:  case kUInt32: case kFloat: return 4;
+		case kInt64:  case kUInt64: case kDouble: return 8;
+		default: return 0;
+	}
+}
+
+//---------------------------------
+// GetTypeName
+//---------------------------------
+const char* JColumnar::GetTypeName(uint8_t type)
+{
+	switch(type){
+		case kString: return "string";
+		case kInt8:   return "int8";
+		case kUInt8:  return "uint8";
+		case kInt16:  return "int16";
+		case kUInt16: return "uint16";
+		case kInt32:  return "int32";
+		case kUInt32: return "uint32";
+		case kInt64:  return "int64";
+		case kUInt64: return "uint64";
+		case kFloat:  return "float";
+		case kDouble: return "double";
+		case kBool:   return "bool";
+	}
+	return "unknown";
+}
+
+//---------------------------------
+// GetRow
+//---------------------------------
+const char* JColumnarColumn::GetRow(uint64_t row) const
+{
+	if(row >= Nrows) return NULL;
+	if(type == JColumnar::kString){
+		if(row >= offsets.size()) return NULL;
+		return &data.data[offsets[row]];
+	}
+	return &data.data[row*JColumnar::GetTypeSize(type)];
+}
+
+//---------------------------------
+// GetString
+//---------------------------------
+string JColumnarColumn::GetString(uint64_t row) const
+{
+	const char *p = GetRow(row);
+	if(!p || type!=JColumnar::kString) return "";
+	uint32_t N;
+	memcpy(&N, p, sizeof(N));
+	return string(p+sizeof(N), N);
+}
+
+//---------------------------------
+// ToString
+//---------------------------------
+string JColumnarColumn::ToString(uint64_t row) const
+{
+	if(!GetRow(row)) return "";
+	stringstream ss;
+	switch(type){
+		case JColumnar::kString: return GetString(row);
+		case JColumnar::kInt8:   ss<<(int)GetValue<int8_t>(row); break;
+		case JColumnar::kUInt8:  ss<<(unsigned int)GetValue<uint8_t>(row); break;
+		case JColumnar::kInt16:  ss<<GetValue<int16_t>(row); break;
+		case JColumnar::kUInt16: ss<<GetValue<uint16_t>(row); break;
+		case JColumnar::kInt32:  ss<<GetValue<int32_t>(row); break;
+		case JColumnar::kUInt32: ss<<GetValue<uint32_t>(row); break;
+		case JColumnar::kInt64:  ss<<GetValue<int64_t>(row); break;
+		case JColumnar::kUInt64: ss<<GetValue<uint64_t>(row); break;
+		case JColumnar::kFloat:  ss<<GetValue<float>(row); break;
+		case JColumnar::kDouble: ss<<GetValue<double>(row); break;
+		case JColumnar::kBool:   ss<<(GetValue<uint8_t>(row) ? "true":"false"); break;
+	}
+	return ss.str();
+}
+
+//---------------------------------
+// GetColumn
+//---------------------------------
+JColumnarColumn* JColumnarGroup::GetColumn(const string &name) const
+{
+	map<string, JColumnarColumn*>::const_iterator it = column_index.find(name);
+	return it==column_index.end() ? NULL:it->second;
+}
+
+//---------------------------------
+// AddColumn
+//---------------------------------
+JColumnarColumn* JColumnarGroup::AddColumn(const string &name, uint8_t type)
+{
+	JColumnarColumn *col = new JColumnarColumn;
+	col->name = name;
+	col->type = type;
+	col->Nrows = 0;
+	columns.push_back(col);
+	column_index[name] = col;
+	return col;
+}
+
+//---------------------------------
+// GetNbytes
+//---------------------------------
+uint64_t JColumnarChunk::GetNbytes(void) const
+{
+	/// Approximate size of the serialized chunk
+	uint64_t N = event_numbers.size()*(sizeof(uint64_t)+sizeof(int32_t));
+	for(unsigned int i=0; i<groups.size(); i++){
+		N += groups[i]->counts.size()*sizeof(uint32_t);
+		for(unsigned int j=0; j<groups[i]->columns.size(); j++) N += groups[i]->columns[j]->data.size();
+	}
+	return N;
+}
+
+//---------------------------------
+// GetGroup
+//---------------------------------
+JColumnarGroup* JColumnarChunk::GetGroup(const string &name, const string &tag) const
+{
+	map<string, JColumnarGroup*>::const_iterator it = group_index.find(tag=="" ? name:name+":"+tag);
+	return it==group_index.end() ? NULL:it->second;
+}
+
+//---------------------------------
+// AddGroup
+//---------------------------------
+JColumnarGroup* JColumnarChunk::AddGroup(const string &name, const string &tag, const string &codec)
+{
+	/// Add a group for the given factory. If events have already been
+	/// added to the chunk before the current one, they are given zero
+	/// objects.
+	JColumnarGroup *group = new JColumnarGroup;
+	group->name = name;
+	group->tag = tag;
+	group->codec = codec;
+	if(!event_numbers.empty()) group->counts.resize(event_numbers.size()-1, 0);
+	groups.push_back(group);
+	group_index[group->GetNameTag()] = group;
+	return group;
+}
+
+//---------------------------------
+// EndEvent
+//---------------------------------
+void JColumnarChunk::EndEvent(void)
+{
+	/// Give zero objects for the current event to any group that
+	/// was not filled for it.
+	for(unsigned int i=0; i<groups.size(); i++){
+		if(groups[i]->counts.size() < event_numbers.size()) groups[i]->counts.resize(event_numbers.size(), 0);
+	}
+}
+
+//---------------------------------
+// Clear
+//---------------------------------
+void JColumnarChunk::Clear(void)
+{
+	event_numbers.clear();
+	run_numbers.clear();
+	for(unsigned int i=0; i<groups.size(); i++) delete groups[i];
+	groups.clear();
+	group_index.clear();
+}
+
+//---------------------------------
+// Serialize
+//---------------------------------
+void JColumnarChunk::Serialize(JColumnarBuffer &buff) const
+{
+	buff.clear();
+	buff.data.reserve(GetNbytes() + 1024);
+
+	uint32_t Nevents = event_numbers.size();
+	buff.Put(Nevents);
+	if(Nevents>0){
+		buff.Put(&event_numbers[0], Nevents*sizeof(uint64_t));
+		buff.Put(&run_numbers[0], Nevents*sizeof(int32_t));
+	}
+
+	uint32_t Ngroups = groups.size();
+	buff.Put(Ngroups);
+	for(unsigned int i=0; i<groups.size(); i++){
+		const JColumnarGroup *group = groups[i];
+		buff.PutString(group->name);
+		buff.PutString(group->tag);
+		buff.PutString(group->codec);
+		buff.Put(group->Nobjects);
+		if(Nevents>0) buff.Put(&group->counts[0], Nevents*sizeof(uint32_t));
+		uint32_t Ncolumns = group->columns.size();
+		buff.Put(Ncolumns);
+		for(unsigned int j=0; j<group->columns.size(); j++){
+			const JColumnarColumn *col = group->columns[j];
+			buff.PutString(col->name);
+			buff.Put(col->type);
+			buff.Put(col->Nrows);
+			uint64_t Nbytes = col->data.size();
+			buff.Put(Nbytes);
+			buff.Put(col->data.ptr(), Nbytes);
+		}
+	}
+}
+
+//---------------------------------
+// Deserialize
+//---------------------------------
+bool JColumnarChunk::Deserialize(JColumnarBuffer &buff)
+{
+	/// Fill this chunk from a buffer written by Serialize. The row
+	/// offsets of string columns and the first row of each event in
+	/// every group are filled in so that objects can be looked up
+	/// directly. Returns false if the buffer is corrupt.
+	Clear();
+	buff.rpos = 0;
+
+	uint32_t Nevents;
+	if(!buff.Get(Nevents)) return false;
+	if((uint64_t)Nevents*(sizeof(uint64_t)+sizeof(int32_t)) > buff.size()-buff.rpos) return false;
+	event_numbers.resize(Nevents);
+	run_numbers.resize(Nevents);
+	if(Nevents>0){
+		if(!buff.Get(&event_numbers[0], Nevents*sizeof(uint64_t))) return false;
+		if(!buff.Get(&run_numbers[0], Nevents*sizeof(int32_t))) return false;
+	}
+
+	uint32_t Ngroups;
+	if(!buff.Get(Ngroups)) return false;
+	for(uint32_t i=0; i<Ngroups; i++){
+		string name, tag, codec;
+		if(!buff.GetString(name) || !buff.GetString(tag) || !buff.GetString(codec)) return false;
+		JColumnarGroup *group = AddGroup(name, tag, codec);
+		if(!buff.Get(group->Nobjects)) return false;
+		if((uint64_t)Nevents*sizeof(uint32_t) > buff.size()-buff.rpos) return false;
+		group->counts.resize(Nevents);
+		group->first.resize(Nevents);
+		if(Nevents>0 && !buff.Get(&group->counts[0], Nevents*sizeof(uint32_t))) return false;
+		uint64_t row = 0;
+		for(uint32_t k=0; k<Nevents; k++){
+			group->first[k] = row;
+			row += group->counts[k];
+		}
+		if(row != group->Nobjects) return false;
+
+		uint32_t Ncolumns;
+		if(!buff.Get(Ncolumns)) return false;
+		for(uint32_t j=0; j<Ncolumns; j++){
+			string cname;
+			uint8_t type;
+			uint64_t Nrows, Nbytes;
+			if(!buff.GetString(cname) || !buff.Get(type) || !buff.Get(Nrows) || !buff.Get(Nbytes)) return false;
+			if(Nbytes > buff.size()-buff.rpos) return false;
+
+			// Check sizes before allocating anything based on them. Each
+			// string takes at least the 4 bytes of its length.
+			if(type == JColumnar::kString){
+				if(Nrows > Nbytes/sizeof(uint32_t)) return false;
+			}else{
+				unsigned int size = JColumnar::GetTypeSize(type);
+				if(size==0 || Nrows > Nbytes/size || Nrows*size != Nbytes) return false;
+			}
+
+			JColumnarColumn *col = group->AddColumn(cname, type);
+			col->Nrows = Nrows;
+			col->data.Put(&buff.data[buff.rpos], Nbytes);
+			buff.rpos += Nbytes;
+
+			if(type == JColumnar::kString){
+				col->offsets.resize(Nrows);
+				uint64_t pos = 0;
+				for(uint64_t r=0; r<Nrows; r++){
+					if(pos + sizeof(uint32_t) > Nbytes) return false;
+					col->offsets[r] = pos;
+					uint32_t N;
+					memcpy(&N, &col->data.data[pos], sizeof(N));
+					if(pos + sizeof(N) + N > Nbytes) return false;
+					pos += sizeof(N) + N;
+				}
+				if(pos != Nbytes) return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+//---------------------------------
+// Compress
+//---------------------------------
+bool JColumnarChunk::Compress(const JColumnarBuffer &in, JColumnarBuffer &out, int level)
+{
+	/// Compress "in" into "out" with zlib. Returns false (and leaves
+	/// "out" empty) if JANA was built without zlib or level is 0.
+	out.clear();
+#ifdef HAVE_ZLIB
+	if(level<=0) return false;
+	uLongf N = compressBound(in.size());
+	out.data.resize(N);
+	if(compress2((Bytef*)out.ptr(), &N, (const Bytef*)in.ptr(), in.size(), level) != Z_OK){
+		out.clear();
+		return false;
+	}
+	out.data.resize(N);
+	return true;
+#else
+	return false;
+#endif // HAVE_ZLIB
+}
+
+//---------------------------------
+// Decompress
+//---------------------------------
+bool JColumnarChunk::Decompress(const char *in, size_t Nin, JColumnarBuffer &out, size_t Nout)
+{
+	out.clear();
+#ifdef HAVE_ZLIB
+	out.data.resize(Nout);
+	uLongf N = Nout;
+	if(uncompress((Bytef*)out.ptr(), &N, (const Bytef*)in, Nin) != Z_OK || N != Nout){
+		out.clear();
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif // HAVE_ZLIB
+}
+
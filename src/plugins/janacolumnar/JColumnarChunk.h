@@ -0,0 +1,184 @@
+// $Id$
+//
+//    File: JColumnarChunk.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JColumnarChunk_
+#define _JColumnarChunk_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+#include <map>
+using std::string;
+using std::vector;
+using std::map;
+
+/// File format constants. A .jcol file is:
+///
+///   file header:  kFileMagic, version (uint32 each)
+///   chunk:        kChunkMagic, flags, Nevents (uint32 each),
+///                 stored size, uncompressed size (uint64 each),
+///                 payload (a serialized JColumnarChunk, zlib
+///                 compressed if flags & kChunkCompressed)
+///   ... more chunks ...
+///   index:        kIndexMagic (uint32), Nentries (uint64), then
+///                 JColumnarIndexEntry for every event
+///   footer:       offset of index (uint64), kEndMagic (uint32)
+///
+/// All values are written in the byte order of the writing machine
+/// (little endian in practice). The index and footer are written when
+/// the file is closed. If they are missing (e.g. the writing program
+/// crashed) the reader rebuilds the index by scanning the chunks.
+
+namespace JColumnar{
+	const uint32_t kFileMagic  = 0x4C4F434A; // "JCOL"
+	const uint32_t kChunkMagic = 0x4B48434A; // "JCHK"
+	const uint32_t kIndexMagic = 0x5844494A; // "JIDX"
+	const uint32_t kEndMagic   = 0x444E454A; // "JEND"
+	const uint32_t kVersion    = 1;
+	const uint32_t kChunkCompressed = 0x1;
+
+	/// Column types. Fixed size types are stored as packed arrays.
+	/// Strings are stored as a uint32 length followed by the bytes.
+	enum type_t{
+		kString = 0,
+		kInt8, kUInt8,
+		kInt16, kUInt16,
+		kInt32, kUInt32,
+		kInt64, kUInt64,
+		kFloat, kDouble,
+		kBool
+	};
+	unsigned int GetTypeSize(uint8_t type); ///< 0 for strings
+	const char* GetTypeName(uint8_t type);
+}
+
+/// One entry of the event index stored at the end of the file
+class JColumnarIndexEntry{
+	public:
+		uint64_t event_number;
+		int32_t run_number;
+		uint32_t row;           ///< position of event in its chunk
+		uint64_t chunk_offset;  ///< file offset of chunk header
+};
+
+/// Growable byte buffer with simple put/get methods used to serialize
+/// chunks. Get methods advance an internal read position.
+class JColumnarBuffer{
+	public:
+		JColumnarBuffer():rpos(0){}
+
+		void clear(void){data.clear(); rpos=0;}
+		size_t size(void) const {return data.size();}
+		const char* ptr(void) const {return data.empty() ? NULL:&data[0];}
+		char* ptr(void){return data.empty() ? NULL:&data[0];}
+
+		void Put(const void *p, size_t N){
+			if(N==0) return;
+			size_t pos = data.size();
+			data.resize(pos + N);
+			memcpy(&data[pos], p, N);
+		}
+		template<typename T> void Put(const T &t){Put(&t, sizeof(T));}
+		void PutString(const string &s){
+			uint32_t N = s.size();
+			Put(N);
+			Put(s.data(), N);
+		}
+
+		bool Get(void *p, size_t N){
+			if(rpos+N > data.size()) return false;
+			if(N>0) memcpy(p, &data[rpos], N);
+			rpos += N;
+			return true;
+		}
+		template<typename T> bool Get(T &t){return Get(&t, sizeof(T));}
+		bool GetString(string &s){
+			uint32_t N;
+			if(!Get(N) || rpos+N > data.size()) return false;
+			s.assign(&data[rpos], N);
+			rpos += N;
+			return true;
+		}
+
+		vector<char> data;
+		size_t rpos;
+};
+
+/// A column of values for one member of one class
+class JColumnarColumn{
+	public:
+		string name;
+		uint8_t type;
+		uint64_t Nrows;
+		JColumnarBuffer data;
+		vector<uint64_t> offsets;  ///< start of each row for string columns (reading only)
+
+		template<typename T> void Append(const T &t){data.Put(t); Nrows++;}
+		void AppendString(const string &s){data.PutString(s); Nrows++;}
+
+		const char* GetRow(uint64_t row) const; ///< Pointer to value of given row (NULL if out of range)
+		string GetString(uint64_t row) const;
+		string ToString(uint64_t row) const; ///< Value of any type formatted as a string
+		template<typename T> T GetValue(uint64_t row) const {T t; memcpy(&t, GetRow(row), sizeof(T)); return t;}
+};
+
+/// The objects of one factory (class + tag) for all events in a chunk.
+/// counts holds the number of objects in each event. The objects of
+/// all events are stored one after the other in the columns.
+class JColumnarGroup{
+	public:
+		string name;
+		string tag;
+		string codec;
+		uint64_t Nobjects;
+		vector<uint32_t> counts;
+		vector<uint64_t> first;   ///< first row of each event (reading only)
+		vector<JColumnarColumn*> columns;
+
+		JColumnarGroup():Nobjects(0){}
+		~JColumnarGroup(){for(unsigned int i=0; i<columns.size(); i++) delete columns[i];}
+
+		string GetNameTag(void) const {return tag=="" ? name:name+":"+tag;}
+		JColumnarColumn* GetColumn(const string &name) const;
+		JColumnarColumn* AddColumn(const string &name, uint8_t type);
+
+	protected:
+		map<string, JColumnarColumn*> column_index;
+};
+
+/// A set of consecutive events written by one thread. This is the unit
+/// that is compressed and written to (or read from) the file.
+class JColumnarChunk{
+	public:
+		JColumnarChunk(){}
+		~JColumnarChunk(){Clear();}
+
+		vector<uint64_t> event_numbers;
+		vector<int32_t> run_numbers;
+		vector<JColumnarGroup*> groups;
+
+		uint32_t GetNevents(void) const {return event_numbers.size();}
+		uint64_t GetNbytes(void) const;
+		JColumnarGroup* GetGroup(const string &name, const string &tag) const;
+		JColumnarGroup* AddGroup(const string &name, const string &tag, const string &codec);
+		void EndEvent(void);
+		void Clear(void);
+
+		void Serialize(JColumnarBuffer &buff) const;
+		bool Deserialize(JColumnarBuffer &buff);
+
+		static bool Compress(const JColumnarBuffer &in, JColumnarBuffer &out, int level);
+		static bool Decompress(const char *in, size_t Nin, JColumnarBuffer &out, size_t Nout);
+
+	protected:
+		map<string, JColumnarGroup*> group_index;
+};
+
+#endif // _JColumnarChunk_
+
@@ -0,0 +1,209 @@
+// $Id$
+//
+//    File: JColumnarCodec.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <pthread.h>
+
+#include "JColumnarCodec.h"
+#include "JColumnarObject.h"
+
+static map<string, JColumnarCodec*> codecs;
+static pthread_mutex_t codecs_mutex = PTHREAD_MUTEX_INITIALIZER;
+static JColumnarCodecStrings strings_codec;
+static JColumnarCodecFields fields_codec;
+
+//---------------------------------
+// Register
+//---------------------------------
+void JColumnarCodec::Register(const string &classname, JColumnarCodec *codec)
+{
+	/// Use the given codec for all objects of the named class. This
+	/// should be called from InitPlugin. The codec is never deleted.
+	pthread_mutex_lock(&codecs_mutex);
+	codecs[classname] = codec;
+	pthread_mutex_unlock(&codecs_mutex);
+}
+
+//---------------------------------
+// GetRegisteredCodec
+//---------------------------------
+JColumnarCodec* JColumnarCodec::GetRegisteredCodec(const string &classname)
+{
+	/// Get the codec registered for the given class (NULL if none)
+	pthread_mutex_lock(&codecs_mutex);
+	map<string, JColumnarCodec*>::iterator it = codecs.find(classname);
+	JColumnarCodec *codec = it==codecs.end() ? NULL:it->second;
+	pthread_mutex_unlock(&codecs_mutex);
+	return codec;
+}
+
+//---------------------------------
+// GetCodec
+//---------------------------------
+JColumnarCodec* JColumnarCodec::GetCodec(const string &classname, const JObject *obj)
+{
+	/// Get the codec to write objects of the given class with. obj is
+	/// one of the objects and is used to see if the class has fields.
+	JColumnarCodec *codec = GetRegisteredCodec(classname);
+	if(codec) return codec;
+	if(obj && obj->GetFields()) return &fields_codec;
+	return &strings_codec;
+}
+
+//---------------------------------
+// GetCodec
+//---------------------------------
+JColumnarCodec* JColumnarCodec::GetCodec(const string &classname, const string &codecname)
+{
+	/// Get the codec to read objects of the given class that were
+	/// written with the named codec. Returns NULL if there is none.
+	JColumnarCodec *codec = GetRegisteredCodec(classname);
+	if(codec && codecname == codec->GetName()) return codec;
+	if(codecname == fields_codec.GetName()) return &fields_codec;
+	if(codecname == strings_codec.GetName()) return &strings_codec;
+	return NULL;
+}
+
+//---------------------------------
+// Write
+//---------------------------------
+void JColumnarCodecStrings::Write(const vector<JObject*> &objs, JColumnarGroup &group)
+{
+	/// Add one string column per member name returned by toStrings.
+	/// Members are matched by name so a column that did not exist
+	/// for earlier objects (or that is missing for this one) is
+	/// padded with empty strings to keep all columns the same length.
+	vector<pair<string,string> > items;
+	for(unsigned int i=0; i<objs.size(); i++){
+		items.clear();
+		objs[i]->toStrings(items);
+		uint64_t row = group.Nobjects;
+		for(unsigned int j=0; j<items.size(); j++){
+			JColumnarColumn *col = group.GetColumn(items[j].first);
+			if(!col) col = group.AddColumn(items[j].first, JColumnar::kString);
+			if(col->Nrows > row) continue; // duplicate member name
+			while(col->Nrows < row) col->AppendString("");
+			col->AppendString(items[j].second);
+		}
+		group.Nobjects++;
+		for(unsigned int j=0; j<group.columns.size(); j++){
+			while(group.columns[j]->Nrows < group.Nobjects) group.columns[j]->AppendString("");
+		}
+	}
+}
+
+//---------------------------------
+// ReadGeneric
+//---------------------------------
+bool JColumnarCodecStrings::ReadGeneric(const JColumnarGroup &group, uint64_t first, uint32_t N, vector<JObject*> &objs)
+{
+	/// Create a JColumnarObject for each row. This works for groups
+	/// written by any codec. Non-string columns are formatted as strings.
+	for(uint32_t i=0; i<N; i++){
+		JColumnarObject *obj = new JColumnarObject;
+		obj->original_class = group.name;
+		obj->original_tag = group.tag;
+		for(unsigned int j=0; j<group.columns.size(); j++){
+			const JColumnarColumn *col = group.columns[j];
+			obj->members.push_back(pair<string,string>(col->name, col->ToString(first+i)));
+		}
+		objs.push_back(obj);
+	}
+	return true;
+}
+
+//---------------------------------
+// Write
+//---------------------------------
+void JColumnarCodecFields::Write(const vector<JObject*> &objs, JColumnarGroup &group)
+{
+	/// Add one column per field. The values are filled one column
+	/// at a time so each column's buffer is appended to in a tight loop.
+	if(objs.empty()) return;
+	const vector<JField> *fields = objs[0]->GetFields();
+	if(!fields) return; // codec registered for class without fields
+
+	if(group.columns.empty()){
+		for(unsigned int j=0; j<fields->size(); j++) group.AddColumn((*fields)[j].name, GetColumnType((*fields)[j].type));
+	}
+
+	string str;
+	uint64_t val;
+	for(unsigned int j=0; j<fields->size() && j<group.columns.size(); j++){
+		const JField &field = (*fields)[j];
+		JColumnarColumn *col = group.columns[j];
+		unsigned int size = field.GetSize();
+		for(unsigned int i=0; i<objs.size(); i++){
+			if(field.type == JField::kString){
+				field.GetValue(objs[i], &str);
+				col->AppendString(str);
+			}else if(field.IsMember()){
+				col->data.Put(field.GetPointer(objs[i]), size);
+				col->Nrows++;
+			}else{
+				field.GetValue(objs[i], &val);
+				col->data.Put(&val, size);
+				col->Nrows++;
+			}
+		}
+	}
+	group.Nobjects += objs.size();
+}
+
+//---------------------------------
+// SetFields
+//---------------------------------
+bool JColumnarCodecFields::SetFields(const JColumnarGroup &group, uint64_t first, vector<JObject*> &objs, size_t Nskip)
+{
+	/// Copy the column values into the fields of the given objects.
+	/// Columns are matched to fields by name. Fields with no column
+	/// of the right type (e.g. the class changed since the file was
+	/// written) are left as the constructor set them.
+	if(objs.size()<=Nskip) return true;
+	const vector<JField> *fields = objs[Nskip]->GetFields();
+	if(!fields) return false;
+
+	for(unsigned int j=0; j<fields->size(); j++){
+		const JField &field = (*fields)[j];
+		if(!field.IsMember()) continue;
+		const JColumnarColumn *col = group.GetColumn(field.name);
+		if(!col || col->type!=GetColumnType(field.type)) continue;
+		unsigned int size = field.GetSize();
+		for(size_t i=Nskip; i<objs.size(); i++){
+			uint64_t row = first + (i-Nskip);
+			if(field.type == JField::kString){
+				*(string*)field.GetPointer(objs[i]) = col->GetString(row);
+			}else{
+				const char *ptr = col->GetRow(row);
+				if(!ptr) return false;
+				memcpy(field.GetPointer(objs[i]), ptr, size);
+			}
+		}
+	}
+	return true;
+}
+
+//---------------------------------
+// GetColumnType
+//---------------------------------
+uint8_t JColumnarCodecFields::GetColumnType(JField::type_t type)
+{
+	switch(type){
+		case JField::kInt8:   return JColumnar::kInt8;
+		case JField::kUInt8:  return JColumnar::kUInt8;
+		case JField::kInt16:  return JColumnar::kInt16;
+		case JField::kUInt16: return JColumnar::kUInt16;
+		case JField::kInt32:  return JColumnar::kInt32;
+		case JField::kUInt32: return JColumnar::kUInt32;
+		case JField::kInt64:  return JColumnar::kInt64;
+		case JField::kUInt64: return JColumnar::kUInt64;
+		case JField::kFloat:  return JColumnar::kFloat;
+		case JField::kDouble: return JColumnar::kDouble;
+		case JField::kBool:   return JColumnar::kBool;
+		default:              return JColumnar::kString;
+	}
+}
+
@@ -0,0 +1,95 @@
+// $Id$
+//
+//    File: JColumnarCodec.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JColumnarCodec_
+#define _JColumnarCodec_
+
+#include <string>
+#include <vector>
+#include <map>
+using std::string;
+using std::vector;
+using std::map;
+
+#include <JANA/JObject.h>
+using namespace jana;
+
+#include "JColumnarChunk.h"
+
+/// A JColumnarCodec converts the objects of one class to and from the
+/// columns of a JColumnarGroup. Codecs can be registered for specific
+/// classes with Register(). Classes with no registered codec are
+/// written with JColumnarCodecFields if they describe their members
+/// with JOBJECT_FIELDS. Otherwise JColumnarCodecStrings is used which
+/// stores the output of toStrings() with one string column per member.
+///
+/// Write() is called from the processing threads, each with its own
+/// group, so codecs must not keep per-event state.
+
+class JColumnarCodec{
+	public:
+		virtual ~JColumnarCodec(){}
+
+		/// Name stored in the file for groups written with this codec
+		virtual const char* GetName(void) const =0;
+
+		/// Append one row per object to the group's columns
+		virtual void Write(const vector<JObject*> &objs, JColumnarGroup &group) =0;
+
+		/// Create N objects from the rows of the group starting at
+		/// "first". Return false if this codec can't recreate them.
+		virtual bool Read(const JColumnarGroup &group, uint64_t first, uint32_t N, vector<JObject*> &objs){return false;}
+
+		static void Register(const string &classname, JColumnarCodec *codec);
+		static JColumnarCodec* GetRegisteredCodec(const string &classname);
+		static JColumnarCodec* GetCodec(const string &classname, const JObject *obj);
+		static JColumnarCodec* GetCodec(const string &classname, const string &codecname);
+};
+
+/// Generic codec that stores the output of toStrings() for any JObject
+class JColumnarCodecStrings:public JColumnarCodec{
+	public:
+		const char* GetName(void) const {return "strings";}
+		void Write(const vector<JObject*> &objs, JColumnarGroup &group);
+
+		/// Create JColumnarObject objects (works for any class)
+		bool ReadGeneric(const JColumnarGroup &group, uint64_t first, uint32_t N, vector<JObject*> &objs);
+};
+
+/// Codec for classes that describe their members with JOBJECT_FIELDS.
+/// Each field is stored in a column of its own type with the values
+/// copied straight out of the objects. This is used automatically for
+/// such classes, but can only make JColumnarObject objects when
+/// reading since it does not know how to create the original class.
+/// To get the original objects back, register JColumnarCodecFieldsT
+/// for the class in InitPlugin:
+///
+///   JColumnarCodec::Register("MyHit", new JColumnarCodecFieldsT<MyHit>());
+class JColumnarCodecFields:public JColumnarCodec{
+	public:
+		const char* GetName(void) const {return "fields";}
+		void Write(const vector<JObject*> &objs, JColumnarGroup &group);
+
+		/// Set the fields of objs[Nskip] ... from the rows starting at "first"
+		bool SetFields(const JColumnarGroup &group, uint64_t first, vector<JObject*> &objs, size_t Nskip=0);
+
+		static uint8_t GetColumnType(JField::type_t type);
+};
+
+/// JColumnarCodecFields that creates objects of class T when reading
+template<class T>
+class JColumnarCodecFieldsT:public JColumnarCodecFields{
+	public:
+		bool Read(const JColumnarGroup &group, uint64_t first, uint32_t N, vector<JObject*> &objs){
+			size_t Nskip = objs.size();
+			for(uint32_t i=0; i<N; i++) objs.push_back(new T());
+			return SetFields(group, first, objs, Nskip);
+		}
+};
+
+#endif // _JColumnarCodec_
+
@@ -0,0 +1,47 @@
+// $Id$
+//
+//    File: JColumnarObject.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JColumnarObject_
+#define _JColumnarObject_
+
+#include <JANA/JObject.h>
+using namespace jana;
+
+/// JColumnarObject is a generic object read back from a .jcol file
+/// for classes that have no codec able to recreate the original
+/// objects. It holds the member names and values exactly as the
+/// original object's toStrings gave them when they were written.
+/// They are provided in the factory whose tag is the original
+/// class name (and tag). e.g. for DTrack:ALT objects:
+///
+///   vector<const JColumnarObject*> tracks;
+///   loop->Get(tracks, "DTrack:ALT");
+///
+/// (this requires -PJANA:AUTOFACTORYCREATE=1 since no factory for
+/// that tag exists otherwise).
+
+class JColumnarObject:public JObject{
+	public:
+		JOBJECT_PUBLIC(JColumnarObject);
+
+		string original_class;
+		string original_tag;
+		vector<pair<string,string> > members;
+
+		void toStrings(vector<pair<string,string> > &items)const{
+			items.insert(items.end(), members.begin(), members.end());
+		}
+
+		/// Get value of named member as a string ("" if not present)
+		string Get(const string &name) const {
+			for(unsigned int i=0; i<members.size(); i++) if(members[i].first==name) return members[i].second;
+			return "";
+		}
+};
+
+#endif // _JColumnarObject_
+
@@ -0,0 +1,259 @@
+// $Id$
+//
+//    File: JEventSinkColumnar.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+using namespace std;
+
+#include <JANA/JApplication.h>
+#include <JANA/JEvent.h>
+
+#include "JEventSinkColumnar.h"
+
+//---------------------------------
+// JEventSinkColumnar    (Constructor)
+//---------------------------------
+JEventSinkColumnar::JEventSinkColumnar()
+{
+	active = false;
+	file = NULL;
+	file_offset = 0;
+	Nchunks = 0;
+	Nbytes_raw = 0;
+	Nbytes_stored = 0;
+	pthread_mutex_init(&file_mutex, NULL);
+	pthread_key_create(&buffer_key, NULL);
+}
+
+//---------------------------------
+// ~JEventSinkColumnar    (Destructor)
+//---------------------------------
+JEventSinkColumnar::~JEventSinkColumnar()
+{
+	if(file) fclose(file);
+	for(unsigned int i=0; i<buffers.size(); i++) delete buffers[i];
+	pthread_key_delete(buffer_key);
+}
+
+//---------------------------------
+// init
+//---------------------------------
+jerror_t JEventSinkColumnar::init(void)
+{
+	OUTPUT_FILE = "jana.jcol";
+	WRITEOUT = "";
+	CHUNK_EVENTS = 1000;
+	CHUNK_MB = 16;
+	COMPRESSION = 1;
+
+	JParameterManager *parms = app->GetJParameterManager();
+	parms->SetDefaultParameter("JCOL:OUTPUT_FILE", OUTPUT_FILE, "Name of .jcol file to write");
+	parms->SetDefaultParameter("JCOL:WRITEOUT", WRITEOUT, "Comma separated list of factories (name:tag) to write to .jcol file or \"all\"");
+	parms->SetDefaultParameter("JCOL:CHUNK_EVENTS", CHUNK_EVENTS, "Max. number of events in each chunk of .jcol file");
+	parms->SetDefaultParameter("JCOL:CHUNK_MB", CHUNK_MB, "Max. size in MB (before compression) of each chunk of .jcol file");
+	parms->SetDefaultParameter("JCOL:COMPRESSION", COMPRESSION, "zlib compression level for .jcol file chunks (0=no compression)");
+	if(CHUNK_EVENTS<1) CHUNK_EVENTS = 1;
+
+	return NOERROR;
+}
+
+//---------------------------------
+// brun_sink
+//---------------------------------
+jerror_t JEventSinkColumnar::brun_sink(JEventLoop *loop, int32_t runnumber)
+{
+	/// Build the write list and open the output file. This is only
+	/// called once (for the first thread to get here).
+	if(WRITEOUT == "all"){
+		AddAllToWriteList(loop);
+	}else{
+		stringstream ss(WRITEOUT);
+		string nametag;
+		while(getline(ss, nametag, ',')){
+			// Strip white space and trailing ":"
+			stringstream ss2(nametag);
+			ss2 >> nametag;
+			if(nametag.size()>0 && nametag[nametag.size()-1]==':') nametag.erase(nametag.size()-1);
+			if(nametag == "") continue;
+			size_t pos = nametag.find(':');
+			if(pos == string::npos){
+				AddToWriteList(nametag, "");
+			}else{
+				AddToWriteList(nametag.substr(0, pos), nametag.substr(pos+1));
+			}
+		}
+	}
+	GetWriteList(write_list);
+	if(write_list.empty()) return NOERROR;
+
+	for(unsigned int i=0; i<write_list.size(); i++) codecs.push_back(JColumnarCodec::GetRegisteredCodec(write_list[i].first));
+
+	file = fopen(OUTPUT_FILE.c_str(), "wb");
+	if(!file){
+		jerr<<"Unable to open \""<<OUTPUT_FILE<<"\" for writing!"<<endl;
+		return RESOURCE_UNAVAILABLE;
+	}
+	uint32_t header[2] = {JColumnar::kFileMagic, JColumnar::kVersion};
+	fwrite(header, sizeof(header), 1, file);
+	file_offset = sizeof(header);
+
+	jout<<"Writing to \""<<OUTPUT_FILE<<"\":"<<endl;
+	for(unsigned int i=0; i<write_list.size(); i++){
+		jout<<"   "<<write_list[i].first<<(write_list[i].second=="" ? "":":")<<write_list[i].second;
+		if(codecs[i]) jout<<" ("<<codecs[i]->GetName()<<")";
+		jout<<endl;
+	}
+
+	active = true;
+
+	return NOERROR;
+}
+
+//---------------------------------
+// evnt
+//---------------------------------
+jerror_t JEventSinkColumnar::evnt(JEventLoop *loop, uint64_t eventnumber)
+{
+	/// Add the objects of all factories in the write list for this
+	/// event to this thread's chunk. The chunk is written out once
+	/// it is full.
+	if(!active) return NOERROR;
+
+	ThreadBuffer *tb = (ThreadBuffer*)pthread_getspecific(buffer_key);
+	if(!tb){
+		tb = new ThreadBuffer;
+		tb->codecs = codecs;
+		pthread_setspecific(buffer_key, tb);
+		pthread_mutex_lock(&file_mutex);
+		buffers.push_back(tb);
+		pthread_mutex_unlock(&file_mutex);
+	}
+
+	JColumnarChunk &chunk = tb->chunk;
+	chunk.event_numbers.push_back(eventnumber);
+	chunk.run_numbers.push_back(loop->GetJEvent().GetRunNumber());
+
+	for(unsigned int i=0; i<write_list.size(); i++){
+		const string &name = write_list[i].first;
+		const string &tag = write_list[i].second;
+		JFactory_base *fac = loop->GetFactory(name, tag.c_str(), false);
+		if(!fac) continue;
+
+		// Get() returns pointers to the JObject part of each object
+		fac->GetNrows();
+		vector<void*> &vobjs = fac->Get();
+		tb->objs.clear();
+		for(unsigned int j=0; j<vobjs.size(); j++) tb->objs.push_back((JObject*)vobjs[j]);
+
+		// Unless one was registered, the codec depends on whether the
+		// class has fields which can only be checked with an object.
+		JColumnarCodec* &codec = tb->codecs[i];
+		if(!codec && !tb->objs.empty()) codec = JColumnarCodec::GetCodec(name, tb->objs[0]);
+
+		JColumnarGroup *group = chunk.GetGroup(name, tag);
+		if(!group) group = chunk.AddGroup(name, tag, codec ? codec->GetName():"");
+		if(codec){
+			if(group->codec == "") group->codec = codec->GetName();
+			codec->Write(tb->objs, *group);
+		}
+		group->counts.push_back(tb->objs.size());
+	}
+	chunk.EndEvent();
+
+	if(chunk.GetNevents()>=CHUNK_EVENTS || chunk.GetNbytes()>=(uint64_t)CHUNK_MB*1024*1024) Flush(tb);
+
+	return NOERROR;
+}
+
+//---------------------------------
+// fini
+//---------------------------------
+jerror_t JEventSinkColumnar::fini(void)
+{
+	if(!active) return NOERROR;
+
+	// Write whatever is left in each thread's chunk. All processing
+	// threads are finished by now.
+	for(unsigned int i=0; i<buffers.size(); i++){
+		if(buffers[i]->chunk.GetNevents()>0) Flush(buffers[i]);
+	}
+
+	WriteIndex();
+	fclose(file);
+	file = NULL;
+	active = false;
+
+	double MB_raw = (double)Nbytes_raw/1024.0/1024.0;
+	double MB_stored = (double)Nbytes_stored/1024.0/1024.0;
+	jout<<"Wrote "<<index.size()<<" events in "<<Nchunks<<" chunks to \""<<OUTPUT_FILE<<"\" (";
+	jout<<fixed<<setprecision(2)<<MB_stored<<" MB";
+	if(Nbytes_stored>0 && Nbytes_stored!=Nbytes_raw) jout<<", compression ratio "<<MB_raw/MB_stored;
+	jout<<")"<<endl;
+
+	return NOERROR;
+}
+
+//---------------------------------
+// Flush
+//---------------------------------
+void JEventSinkColumnar::Flush(ThreadBuffer *tb)
+{
+	/// Serialize and compress the thread's chunk (without holding any
+	/// lock) and then append it to the file and its events to the index.
+	JColumnarChunk &chunk = tb->chunk;
+	chunk.Serialize(tb->raw);
+	bool compressed = JColumnarChunk::Compress(tb->raw, tb->compressed, COMPRESSION);
+	JColumnarBuffer &payload = compressed ? tb->compressed:tb->raw;
+
+	uint32_t hdr32[3] = {JColumnar::kChunkMagic, compressed ? JColumnar::kChunkCompressed:0, chunk.GetNevents()};
+	uint64_t hdr64[2] = {payload.size(), tb->raw.size()};
+
+	pthread_mutex_lock(&file_mutex);
+	uint64_t chunk_offset = file_offset;
+	fwrite(hdr32, sizeof(hdr32), 1, file);
+	fwrite(hdr64, sizeof(hdr64), 1, file);
+	fwrite(payload.ptr(), 1, payload.size(), file);
+	file_offset += sizeof(hdr32) + sizeof(hdr64) + payload.size();
+	for(uint32_t i=0; i<chunk.GetNevents(); i++){
+		JColumnarIndexEntry e;
+		e.event_number = chunk.event_numbers[i];
+		e.run_number = chunk.run_numbers[i];
+		e.row = i;
+		e.chunk_offset = chunk_offset;
+		index.push_back(e);
+	}
+	Nchunks++;
+	Nbytes_raw += tb->raw.size();
+	Nbytes_stored += payload.size();
+	pthread_mutex_unlock(&file_mutex);
+
+	chunk.Clear();
+}
+
+//---------------------------------
+// WriteIndex
+//---------------------------------
+void JEventSinkColumnar::WriteIndex(void)
+{
+	uint64_t index_offset = file_offset;
+	uint32_t magic = JColumnar::kIndexMagic;
+	uint64_t Nentries = index.size();
+	fwrite(&magic, sizeof(magic), 1, file);
+	fwrite(&Nentries, sizeof(Nentries), 1, file);
+	for(uint64_t i=0; i<Nentries; i++){
+		const JColumnarIndexEntry &e = index[i];
+		fwrite(&e.event_number, sizeof(e.event_number), 1, file);
+		fwrite(&e.run_number, sizeof(e.run_number), 1, file);
+		fwrite(&e.row, sizeof(e.row), 1, file);
+		fwrite(&e.chunk_offset, sizeof(e.chunk_offset), 1, file);
+	}
+	uint32_t end = JColumnar::kEndMagic;
+	fwrite(&index_offset, sizeof(index_offset), 1, file);
+	fwrite(&end, sizeof(end), 1, file);
+}
+
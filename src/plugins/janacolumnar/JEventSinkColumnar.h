@@ -0,0 +1,80 @@
+// $Id$
+//
+//    File: JEventSinkColumnar.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JEventSinkColumnar_
+#define _JEventSinkColumnar_
+
+#include <stdio.h>
+#include <pthread.h>
+
+#include <JANA/JEventSink.h>
+using namespace jana;
+
+#include "JColumnarChunk.h"
+#include "JColumnarCodec.h"
+
+/// JEventSinkColumnar writes the objects of selected factories to a
+/// .jcol file (see JColumnarChunk.h for the format). Each processing
+/// thread fills its own JColumnarChunk so no lock is held while objects
+/// are serialized or compressed. Only appending a finished chunk to the
+/// file (and its events to the index) is done under a lock.
+///
+/// Select the factories to write with -PJCOL:WRITEOUT=name[:tag],...
+/// (or "all" for every factory marked WRITE_TO_OUTPUT). Nothing is
+/// written if it is not set.
+
+class JEventSinkColumnar:public JEventSink{
+	public:
+		JEventSinkColumnar();
+		virtual ~JEventSinkColumnar();
+		virtual const char* className(void){return static_className();}
+		static const char* static_className(void){return "JEventSinkColumnar";}
+
+		/// Per-thread buffers
+		class ThreadBuffer{
+			public:
+				JColumnarChunk chunk;
+				JColumnarBuffer raw;
+				JColumnarBuffer compressed;
+				vector<JObject*> objs;
+				vector<JColumnarCodec*> codecs;  // one for each entry in write_list (NULL until known)
+		};
+
+	protected:
+		jerror_t init(void);
+		jerror_t brun_sink(JEventLoop *loop, int32_t runnumber);
+		jerror_t evnt(JEventLoop *loop, uint64_t eventnumber);
+		jerror_t fini(void);
+
+		void Flush(ThreadBuffer *tb);
+		void WriteIndex(void);
+
+	private:
+		string OUTPUT_FILE;
+		string WRITEOUT;
+		uint32_t CHUNK_EVENTS;
+		uint32_t CHUNK_MB;
+		int COMPRESSION;
+
+		bool active;
+		vector<pair<string,string> > write_list;
+		vector<JColumnarCodec*> codecs;   // registered codec (or NULL) for each entry in write_list
+
+		FILE *file;
+		uint64_t file_offset;
+		pthread_mutex_t file_mutex;
+		pthread_key_t buffer_key;
+		vector<ThreadBuffer*> buffers;
+		vector<JColumnarIndexEntry> index;
+
+		uint64_t Nchunks;
+		uint64_t Nbytes_raw;
+		uint64_t Nbytes_stored;
+};
+
+#endif // _JEventSinkColumnar_
+
@@ -0,0 +1,372 @@
+// $Id$
+//
+//    File: JEventSourceColumnar.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <iostream>
+using namespace std;
+
+#include <JANA/JApplication.h>
+#include <JANA/JFactory_base.h>
+#include <JANA/JEventLoop.h>
+#include <JANA/JEvent.h>
+
+#include "JEventSourceColumnar.h"
+#include "JEventSourceColumnarGenerator.h"
+#include "JEventSinkColumnar.h"
+#include "JColumnarObject.h"
+
+// Routine used to allow us to register our JEventSourceGenerator
+extern "C"{
+void InitPlugin(JApplication *app){
+	InitJANAPlugin(app);
+	app->AddEventSourceGenerator(new JEventSourceColumnarGenerator());
+	app->AddProcessor(new JEventSinkColumnar(), true);
+}
+} // "C"
+
+// Size of chunk header on disk
+static const uint64_t kChunkHeaderSize = 3*sizeof(uint32_t) + 2*sizeof(uint64_t);
+
+// Size of index entry on disk
+static const uint64_t kIndexEntrySize = sizeof(uint64_t) + sizeof(int32_t) + sizeof(uint32_t) + sizeof(uint64_t);
+
+// Read exactly N bytes at offset
+static bool ReadAt(int fd, void *buff, size_t N, uint64_t offset)
+{
+	size_t Nread = 0;
+	while(Nread < N){
+		ssize_t n = pread(fd, (char*)buff + Nread, N - Nread, offset + Nread);
+		if(n<0 && errno==EINTR) continue;
+		if(n<=0) return false;
+		Nread += n;
+	}
+	return true;
+}
+
+//----------------
+// Constructor
+//----------------
+JEventSourceColumnar::JEventSourceColumnar(const char* source_name):JEventSource(source_name)
+{
+	next_entry = 0;
+	current_chunk = NULL;
+	file_size = 0;
+	pthread_mutex_init(&chunk_mutex, NULL);
+
+	fd = open(source_name, O_RDONLY);
+	if(fd<0){
+		jerr<<"Unable to open \""<<source_name<<"\": "<<strerror(errno)<<endl;
+		return;
+	}
+	struct stat st;
+	if(fstat(fd, &st)==0) file_size = st.st_size;
+
+	if(!ReadIndex()){
+		jout<<"No index found in \""<<source_name<<"\" (file not closed properly?). Scanning chunks ..."<<endl;
+		if(!ScanChunks()) jerr<<"Problem scanning \""<<source_name<<"\". Only the first "<<index.size()<<" events will be read."<<endl;
+	}
+	for(uint64_t i=0; i<index.size(); i++) event_lookup[index[i].event_number] = i;
+
+	jout<<"Opened \""<<source_name<<"\" with "<<index.size()<<" events"<<endl;
+}
+
+//----------------
+// Destructor
+//----------------
+JEventSourceColumnar::~JEventSourceColumnar()
+{
+	if(current_chunk) ReleaseChunk(current_chunk);
+	if(fd>=0) close(fd);
+}
+
+//----------------
+// CheckMagic
+//----------------
+bool JEventSourceColumnar::CheckMagic(const string &filename)
+{
+	int fd = open(filename.c_str(), O_RDONLY);
+	if(fd<0) return false;
+	uint32_t header[2] = {0, 0};
+	bool ok = ReadAt(fd, header, sizeof(header), 0);
+	close(fd);
+	return ok && header[0]==JColumnar::kFileMagic;
+}
+
+//----------------
+// ReadIndex
+//----------------
+bool JEventSourceColumnar::ReadIndex(void)
+{
+	/// Read the event index from the end of the file
+	uint64_t index_offset;
+	uint32_t end;
+	uint64_t footer_size = sizeof(index_offset) + sizeof(end);
+	if(file_size < 2*sizeof(uint32_t) + footer_size) return false;
+	if(!ReadAt(fd, &index_offset, sizeof(index_offset), file_size-footer_size)) return false;
+	if(!ReadAt(fd, &end, sizeof(end), file_size-sizeof(end))) return false;
+	if(end != JColumnar::kEndMagic || index_offset >= file_size) return false;
+
+	uint32_t magic;
+	uint64_t Nentries;
+	if(!ReadAt(fd, &magic, sizeof(magic), index_offset)) return false;
+	if(!ReadAt(fd, &Nentries, sizeof(Nentries), index_offset+sizeof(magic))) return false;
+	if(magic != JColumnar::kIndexMagic) return false;
+	uint64_t start = index_offset + sizeof(magic) + sizeof(Nentries);
+	if(start + Nentries*kIndexEntrySize + footer_size != file_size) return false;
+
+	vector<char> buff(Nentries*kIndexEntrySize);
+	if(Nentries>0 && !ReadAt(fd, &buff[0], buff.size(), start)) return false;
+	index.resize(Nentries);
+	const char *p = buff.empty() ? NULL:&buff[0];
+	for(uint64_t i=0; i<Nentries; i++){
+		JColumnarIndexEntry &e = index[i];
+		memcpy(&e.event_number, p, sizeof(e.event_number)); p += sizeof(e.event_number);
+		memcpy(&e.run_number, p, sizeof(e.run_number));     p += sizeof(e.run_number);
+		memcpy(&e.row, p, sizeof(e.row));                   p += sizeof(e.row);
+		memcpy(&e.chunk_offset, p, sizeof(e.chunk_offset)); p += sizeof(e.chunk_offset);
+	}
+
+	return true;
+}
+
+//----------------
+// ScanChunks
+//----------------
+bool JEventSourceColumnar::ScanChunks(void)
+{
+	/// Build the index by reading every chunk in the file. This is
+	/// only needed if the index was not written.
+	index.clear();
+	uint64_t offset = 2*sizeof(uint32_t);
+	while(offset < file_size){
+		uint32_t flags, Nevents;
+		uint64_t Nstored, Nraw;
+		if(!ReadChunkHeader(offset, flags, Nevents, Nstored, Nraw)){
+			// Either the index or a partially written chunk
+			uint32_t magic = 0;
+			ReadAt(fd, &magic, sizeof(magic), offset);
+			return magic == JColumnar::kIndexMagic;
+		}
+		ChunkRef *ref = LoadChunk(offset);
+		if(!ref) return false;
+		for(uint32_t i=0; i<ref->chunk.GetNevents(); i++){
+			JColumnarIndexEntry e;
+			e.event_number = ref->chunk.event_numbers[i];
+			e.run_number = ref->chunk.run_numbers[i];
+			e.row = i;
+			e.chunk_offset = offset;
+			index.push_back(e);
+		}
+		ReleaseChunk(ref);
+		offset += kChunkHeaderSize + Nstored;
+	}
+	return true;
+}
+
+//----------------
+// ReadChunkHeader
+//----------------
+bool JEventSourceColumnar::ReadChunkHeader(uint64_t offset, uint32_t &flags, uint32_t &Nevents, uint64_t &Nstored, uint64_t &Nraw)
+{
+	uint32_t hdr32[3];
+	uint64_t hdr64[2];
+	if(offset + kChunkHeaderSize > file_size) return false;
+	if(!ReadAt(fd, hdr32, sizeof(hdr32), offset)) return false;
+	if(!ReadAt(fd, hdr64, sizeof(hdr64), offset+sizeof(hdr32))) return false;
+	if(hdr32[0] != JColumnar::kChunkMagic) return false;
+	flags = hdr32[1];
+	Nevents = hdr32[2];
+	Nstored = hdr64[0];
+	Nraw = hdr64[1];
+	return offset + kChunkHeaderSize + Nstored <= file_size;
+}
+
+//----------------
+// LoadChunk
+//----------------
+JEventSourceColumnar::ChunkRef* JEventSourceColumnar::LoadChunk(uint64_t offset)
+{
+	/// Read, decompress and deserialize the chunk at the given offset.
+	/// The returned chunk has a reference count of 1.
+	uint32_t flags, Nevents;
+	uint64_t Nstored, Nraw;
+	if(!ReadChunkHeader(offset, flags, Nevents, Nstored, Nraw)){
+		jerr<<"Bad chunk header at offset "<<offset<<" in \""<<source_name<<"\""<<endl;
+		return NULL;
+	}
+
+	stored.clear();
+	stored.data.resize(Nstored);
+	if(Nstored>0 && !ReadAt(fd, stored.ptr(), Nstored, offset+kChunkHeaderSize)) return NULL;
+	AddBytesRead(kChunkHeaderSize + Nstored);
+
+	JColumnarBuffer *payload = &stored;
+	if(flags & JColumnar::kChunkCompressed){
+		if(!JColumnarChunk::Decompress(stored.ptr(), Nstored, raw, Nraw)){
+			jerr<<"Unable to decompress chunk at offset "<<offset<<" in \""<<source_name<<"\""<<endl;
+			return NULL;
+		}
+		payload = &raw;
+	}
+
+	ChunkRef *ref = new ChunkRef;
+	ref->offset = offset;
+	ref->Nrefs = 1;
+	if(!ref->chunk.Deserialize(*payload) || ref->chunk.GetNevents()!=Nevents){
+		jerr<<"Corrupt chunk at offset "<<offset<<" in \""<<source_name<<"\""<<endl;
+		delete ref;
+		return NULL;
+	}
+
+	return ref;
+}
+
+//----------------
+// ReleaseChunk
+//----------------
+void JEventSourceColumnar::ReleaseChunk(ChunkRef *chunk)
+{
+	pthread_mutex_lock(&chunk_mutex);
+	bool last = --chunk->Nrefs == 0;
+	pthread_mutex_unlock(&chunk_mutex);
+	if(last) delete chunk;
+}
+
+//----------------
+// GetEvent
+//----------------
+jerror_t JEventSourceColumnar::GetEvent(JEvent &event)
+{
+	if(fd<0) return EVENT_SOURCE_NOT_OPEN;
+	if(next_entry >= index.size()) return NO_MORE_EVENTS_IN_SOURCE;
+
+	return ReadEntry(next_entry++, event);
+}
+
+//----------------
+// GetEvent
+//----------------
+jerror_t JEventSourceColumnar::GetEvent(uint64_t eventNumber, JEvent &event)
+{
+	/// Random access to event by its event number. Sequential reading
+	/// continues from the event written after it.
+	if(fd<0) return EVENT_SOURCE_NOT_OPEN;
+	map<uint64_t, uint64_t>::iterator it = event_lookup.find(eventNumber);
+	if(it == event_lookup.end()) return NO_MORE_EVENTS_IN_SOURCE;
+
+	next_entry = it->second + 1;
+	return ReadEntry(it->second, event);
+}
+
+//----------------
+// ReadEntry
+//----------------
+jerror_t JEventSourceColumnar::ReadEntry(uint64_t ientry, JEvent &event)
+{
+	const JColumnarIndexEntry &e = index[ientry];
+
+	// Events of the same chunk share it. Keep one reference as the
+	// current chunk so it is not re-read for the next event.
+	if(!current_chunk || current_chunk->offset != e.chunk_offset){
+		if(current_chunk) ReleaseChunk(current_chunk);
+		current_chunk = LoadChunk(e.chunk_offset);
+		if(!current_chunk) return NO_MORE_EVENTS_IN_SOURCE;
+	}
+	if(e.row >= current_chunk->chunk.GetNevents()) return NO_MORE_EVENTS_IN_SOURCE;
+
+	pthread_mutex_lock(&chunk_mutex);
+	current_chunk->Nrefs++;
+	pthread_mutex_unlock(&chunk_mutex);
+
+	EventRef *ref = new EventRef;
+	ref->chunk = current_chunk;
+	ref->row = e.row;
+	Nevents_read++;
+
+	event.SetJEventSource(this);
+	event.SetEventNumber(e.event_number);
+	event.SetRunNumber(e.run_number);
+	event.SetRef(ref);
+
+	return NOERROR;
+}
+
+//----------------
+// FreeEvent
+//----------------
+void JEventSourceColumnar::FreeEvent(JEvent &event)
+{
+	EventRef *ref = (EventRef*)event.GetRef();
+	if(!ref) return;
+	ReleaseChunk(ref->chunk);
+	delete ref;
+}
+
+//----------------
+// GetObjects
+//----------------
+jerror_t JEventSourceColumnar::GetObjects(JEvent &event, JFactory_base *factory)
+{
+	/// Recreate the objects for the given factory from the event's
+	/// chunk. If the factory is for JColumnarObject, its tag is taken
+	/// to be the original class name (and tag) and generic objects are
+	/// made which works for any class.
+
+	// We must have a factory to hold the data
+	if(!factory)throw RESOURCE_UNAVAILABLE;
+
+	EventRef *ref = (EventRef*)event.GetRef();
+	if(!ref) throw RESOURCE_UNAVAILABLE;
+	const JColumnarChunk &chunk = ref->chunk->chunk;
+
+	string name = factory->GetDataClassName();
+	string tag = factory->Tag();
+	bool generic = (name == JColumnarObject::static_className());
+	if(generic){
+		size_t pos = tag.find(':');
+		name = tag.substr(0, pos);
+		tag = pos==string::npos ? "":tag.substr(pos+1);
+	}
+
+	const JColumnarGroup *group = chunk.GetGroup(name, tag);
+	if(!group) return OBJECT_NOT_AVAILABLE;
+
+	vector<JObject*> objs;
+	uint64_t first = group->first[ref->row];
+	uint32_t N = group->counts[ref->row];
+	bool ok = false;
+	if(N==0){
+		ok = true; // (group may not have a codec if it has no objects)
+	}else if(generic){
+		JColumnarCodecStrings codec;
+		ok = codec.ReadGeneric(*group, first, N, objs);
+	}else{
+		JColumnarCodec *codec = JColumnarCodec::GetCodec(name, group->codec);
+		if(codec) ok = codec->Read(*group, first, N, objs);
+	}
+	if(!ok){
+		for(unsigned int i=0; i<objs.size(); i++) delete objs[i];
+		pthread_mutex_lock(&chunk_mutex);
+		bool first_time = warned.insert(group->GetNameTag()).second;
+		pthread_mutex_unlock(&chunk_mutex);
+		if(first_time){
+			jout<<group->GetNameTag()<<" objects in \""<<source_name<<"\" were written with the \""<<group->codec<<"\" codec"<<endl;
+			jout<<"which can't recreate them. Get them as JColumnarObject with tag \""<<group->GetNameTag()<<"\" instead."<<endl;
+		}
+		return OBJECT_NOT_AVAILABLE;
+	}
+
+	factory->CopyTo(objs);
+
+	return NOERROR;
+}
+
@@ -0,0 +1,92 @@
+// $Id$
+//
+//    File: JEventSourceColumnar.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JEventSourceColumnar_
+#define _JEventSourceColumnar_
+
+#include <pthread.h>
+
+#include <vector>
+#include <string>
+#include <map>
+#include <set>
+using namespace std;
+
+#include <JANA/JEventSource.h>
+#include <JANA/jerror.h>
+using namespace jana;
+
+#include "JColumnarChunk.h"
+#include "JColumnarCodec.h"
+
+/// JEventSourceColumnar reads .jcol files written by JEventSinkColumnar.
+/// Events are read in the order they were written (which is chunk by
+/// chunk, so not necessarily in event number order when several threads
+/// wrote the file). The event index at the end of the file allows
+/// random access by event number.
+///
+/// Objects are provided through GetObjects so factories of the stored
+/// classes should be check-source-first (the default). Objects are
+/// recreated using the codec registered for the class (see
+/// JColumnarCodec). Groups written with the generic "strings" codec can
+/// only be read back as JColumnarObject objects via the factory whose
+/// tag is the original "class" or "class:tag".
+
+class JEventSourceColumnar:public JEventSource
+{
+	public:
+		JEventSourceColumnar(const char* source_name);
+		virtual ~JEventSourceColumnar();
+		virtual const char* className(void){return static_className();}
+		static const char* static_className(void){return "JEventSourceColumnar";}
+
+		jerror_t GetEvent(JEvent &event);
+		void FreeEvent(JEvent &event);
+		jerror_t GetObjects(JEvent &event, JFactory_base *factory);
+
+		bool HasRandomAccess(void){return true;}
+		jerror_t GetEvent(uint64_t eventNumber, JEvent &event);
+
+		static bool CheckMagic(const string &filename);
+
+		/// A decompressed chunk shared by all of its events
+		class ChunkRef{
+			public:
+				JColumnarChunk chunk;
+				uint64_t offset;
+				uint32_t Nrefs;
+		};
+
+		/// What the JEvent's ref points to
+		class EventRef{
+			public:
+				ChunkRef *chunk;
+				uint32_t row;
+		};
+
+	protected:
+		int fd;
+		uint64_t file_size;
+		vector<JColumnarIndexEntry> index;
+		map<uint64_t, uint64_t> event_lookup;   // key=event number  val=position in index
+		uint64_t next_entry;
+		ChunkRef *current_chunk;
+		pthread_mutex_t chunk_mutex;
+		JColumnarBuffer stored;
+		JColumnarBuffer raw;
+		set<string> warned;
+
+		bool ReadIndex(void);
+		bool ScanChunks(void);
+		bool ReadChunkHeader(uint64_t offset, uint32_t &flags, uint32_t &Nevents, uint64_t &Nstored, uint64_t &Nraw);
+		ChunkRef* LoadChunk(uint64_t offset);
+		jerror_t ReadEntry(uint64_t ientry, JEvent &event);
+		void ReleaseChunk(ChunkRef *chunk);
+};
+
+#endif // _JEventSourceColumnar_
+
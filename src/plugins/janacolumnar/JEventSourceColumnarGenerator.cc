@@ -0,0 +1,37 @@
+// $Id$
+//
+//    File: JEventSourceColumnarGenerator.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <string>
+using std::string;
+
+#include "JEventSourceColumnarGenerator.h"
+#include "JEventSourceColumnar.h"
+
+//---------------------------------
+// Description
+//---------------------------------
+const char* JEventSourceColumnarGenerator::Description(void)
+{
+	return "JANA columnar (.jcol)";
+}
+
+//---------------------------------
+// CheckOpenable
+//---------------------------------
+double JEventSourceColumnarGenerator::CheckOpenable(string source)
+{
+	return JEventSourceColumnar::CheckMagic(source) ? 1.0:0.0;
+}
+
+//---------------------------------
+// MakeJEventSource
+//---------------------------------
+JEventSource* JEventSourceColumnarGenerator::MakeJEventSource(string source)
+{
+	return new JEventSourceColumnar(source.c_str());
+}
+
@@ -0,0 +1,28 @@
+// $Id$
+//
+//    File: JEventSourceColumnarGenerator.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JEventSourceColumnarGenerator_
+#define _JEventSourceColumnarGenerator_
+
+#include <JANA/JEventSourceGenerator.h>
+using namespace jana;
+
+class JEventSourceColumnarGenerator:public JEventSourceGenerator{
+	public:
+		JEventSourceColumnarGenerator(){}
+		~JEventSourceColumnarGenerator(){}
+		const char* className(void){return static_className();}
+		static const char* static_className(void){return "JEventSourceColumnarGenerator";}
+
+		const char* Description(void);
+		double CheckOpenable(string source);
+		JEventSource* MakeJEventSource(string source);
+
+};
+
+#endif // _JEventSourceColumnarGenerator_
+
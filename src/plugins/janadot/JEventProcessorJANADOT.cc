@@ -23,6 +23,14 @@ void InitPlugin(JApplication *app){
 }
 } // "C"
 
+//------------------------------------------------------------------
+// ~JEventProcessorJANADOT
+//------------------------------------------------------------------
+JEventProcessorJANADOT::~JEventProcessorJANADOT()
+{
+	for(unsigned int i=0; i<thread_stats.size(); i++) delete thread_stats[i];
+}
+
 //------------------------------------------------------------------
 // init 
 //------------------------------------------------------------------
@@ -33,6 +41,9 @@ jerror_t JEventProcessorJANADOT::init(void)
 	bool record_call_stack=true;
 	force_all_factories_active = false;
 	suppress_unused_factories = true;
+	has_focus = false;
+	call_log_filename = "";
+	call_log_max_events = 10000;
 	try{
 		app->GetJParameterManager()->SetDefaultParameter("RECORD_CALL_STACK", record_call_stack);
 		if(app->GetJParameterManager()->Exists("FORCE_ALL_FACTORIES_ACTIVE")){
@@ -43,6 +54,8 @@ jerror_t JEventProcessorJANADOT::init(void)
 			app->GetJParameterManager()->GetParameter("JANADOT:FOCUS", focus_factory);
 			jout<<" Setting JANADOT focus to: "<<focus_factory<<endl;
 		}
+		app->GetJParameterManager()->SetDefaultParameter("JANADOT:CALL_LOG", call_log_filename, "If set, write the per-event factory call timings to this file (for use with janacritpath)");
+		app->GetJParameterManager()->SetDefaultParameter("JANADOT:CALL_LOG_MAX_EVENTS", call_log_max_events, "Maximum number of events recorded per thread in the JANADOT:CALL_LOG file");
 		app->GetJParameterManager()->SetDefaultParameter("JANADOT:SUPPRESS_UNUSED_FACTORIES", suppress_unused_factories, "If true, then do not list factories in groups that did not show up in list of factories recorded during processing. If false, these will show up as white ovals with no connections (ghosts)");
 
 		// User can specify grouping using configuration parameters starting with
@@ -123,11 +136,35 @@ jerror_t JEventProcessorJANADOT::evnt(JEventLoop *loop, uint64_t eventnumber)
 		for(unsigned int i=0; i<factories.size(); i++)factories[i]->GetNrows();
 	}
 
+	// Get the stats object for this thread. These are kept as user references
+	// on the JEventLoop so that each thread only ever touches its own maps
+	// and no lock is needed here. The mutex is only taken the first time a
+	// thread (JEventLoop) is seen so the object can be registered for merging.
+	ThreadStats *tstats = loop->GetRef<ThreadStats>();
+	if(!tstats){
+		tstats = new ThreadStats();
+		loop->SetRef(tstats);
+		pthread_mutex_lock(&mutex);
+		thread_stats.push_back(tstats);
+		pthread_mutex_unlock(&mutex);
+	}
+
 	// Get the call stack for ths event and add the results to our stats
-	vector<JEventLoop::call_stack_t> stack = loop->GetCallStack();
+	const vector<JEventLoop::call_stack_t> &stack = loop->GetCallStackRef();
 	
-	// Lock mutex in case we are running with multiple threads
-	pthread_mutex_lock(&mutex);
+	JEvent &jevent = loop->GetJEvent();
+	RunStats &rstats = tstats->run_stats[jevent.GetRunNumber()];
+	rstats.Nevents++;
+
+	// Optionally keep the individual calls for the call log
+	EventRecord *erec = NULL;
+	if(!call_log_filename.empty() && tstats->event_records.size()<call_log_max_events){
+		tstats->event_records.push_back(EventRecord());
+		erec = &tstats->event_records.back();
+		erec->run_number = jevent.GetRunNumber();
+		erec->event_number = jevent.GetEventNumber();
+		erec->calls.reserve(stack.size());
+	}
 	
 	// Loop over the call stack elements and add in the values
 	for(unsigned int i=0; i<stack.size(); i++){
@@ -136,12 +173,28 @@ jerror_t JEventProcessorJANADOT::evnt(JEventLoop *loop, uint64_t eventnumber)
 		string nametag1 = MakeNametag(stack[i].caller_name, stack[i].caller_tag);
 		string nametag2 = MakeNametag(stack[i].callee_name, stack[i].callee_tag);
 
-		FactoryCallStats &fcallstats1 = factory_stats[nametag1];
-		FactoryCallStats &fcallstats2 = factory_stats[nametag2];
+		FactoryCallStats &fcallstats1 = tstats->factory_stats[nametag1];
+		FactoryCallStats &fcallstats2 = tstats->factory_stats[nametag2];
 		
-		double delta_t = (stack[i].start_time - stack[i].end_time)*1000.0;
+		uint64_t delta_t = stack[i].end_ticks - stack[i].start_ticks;
 		fcallstats1.time_waiting += delta_t;
 		fcallstats2.time_waited_on += delta_t;
+		
+		// Time spent in the callee itself is its total time minus the time
+		// it spent waiting on its own callees. Accumulate both sides here.
+		rstats.self_ticks[nametag2] += (int64_t)delta_t;
+		rstats.self_ticks[nametag1] -= (int64_t)delta_t;
+		rstats.callees[nametag1].insert(nametag2);
+		
+		if(erec){
+			CallRecord crec;
+			crec.caller = nametag1;
+			crec.callee = nametag2;
+			crec.start_ticks = stack[i].start_ticks;
+			crec.end_ticks = stack[i].end_ticks;
+			crec.data_source = (int)stack[i].data_source;
+			erec->calls.push_back(crec);
+		}
 
 		// Get pointer to CallStats object representing this calling pair
 		CallLink link;
@@ -149,34 +202,31 @@ jerror_t JEventProcessorJANADOT::evnt(JEventLoop *loop, uint64_t eventnumber)
 		link.caller_tag  = stack[i].caller_tag;
 		link.callee_name = stack[i].callee_name;
 		link.callee_tag  = stack[i].callee_tag;
-		CallStats &stats = call_links[link]; // get pointer to stats object or create if it doesn't exist
+		CallStats &stats = tstats->call_links[link]; // get pointer to stats object or create if it doesn't exist
 		
 		switch(stack[i].data_source){
 			case JEventLoop::DATA_NOT_AVAILABLE:
 				stats.Ndata_not_available++;
-				stats.data_not_available_ms += delta_t;
+				stats.data_not_available_ticks += delta_t;
 				break;
 			case JEventLoop::DATA_FROM_CACHE:
 				fcallstats2.Nfrom_cache++;
 				stats.Nfrom_cache++;
-				stats.from_cache_ms += delta_t;
+				stats.from_cache_ticks += delta_t;
 				break;
 			case JEventLoop::DATA_FROM_SOURCE:
 				fcallstats2.Nfrom_source++;
 				stats.Nfrom_source++;
-				stats.from_source_ms += delta_t;
+				stats.from_source_ticks += delta_t;
 				break;
 			case JEventLoop::DATA_FROM_FACTORY:
 				fcallstats2.Nfrom_factory++;
 				stats.Nfrom_factory++;
-				stats.from_factory_ms += delta_t;
+				stats.from_factory_ticks += delta_t;
 				break;				
 		}
 		
 	}
-	
-	// Unlock mutex
-	pthread_mutex_unlock(&mutex);
 
 	return NOERROR;
 }
@@ -186,6 +236,12 @@ jerror_t JEventProcessorJANADOT::evnt(JEventLoop *loop, uint64_t eventnumber)
 //------------------------------------------------------------------
 jerror_t JEventProcessorJANADOT::fini(void)
 {
+	// Write out individual calls if requested. This needs to be
+	// done before merging since that clears the thread stats.
+	if(!call_log_filename.empty()) WriteCallLog();
+
+	// Combine the stats from all threads into the global maps
+	MergeThreadStats();
 
 	// In order to get the total time we have to first get a list of 
 	// the event processors (i.e. top-level callers). We can tell
@@ -203,7 +259,7 @@ jerror_t JEventProcessorJANADOT::fini(void)
 
 	// Loop over list a second time so we can get the total ticks for
 	// the process in order to add the percentage to the label below
-	double total_ms = 0.0;
+	uint64_t total_ticks = 0;
 	for(iter=call_links.begin(); iter!=call_links.end(); iter++){
 		const CallLink &link = iter->first;
 		CallStats &stats = iter->second;
@@ -211,11 +267,29 @@ jerror_t JEventProcessorJANADOT::fini(void)
 		string callee = MakeNametag(link.callee_name, link.callee_tag);
 
 		if(callees.find(caller) == callees.end()){
-			total_ms += stats.from_factory_ms + stats.from_source_ms + stats.from_cache_ms + stats.data_not_available_ms;
+			total_ticks += stats.from_factory_ticks + stats.from_source_ticks + stats.from_cache_ticks + stats.data_not_available_ticks;
 		}
 	}
+	double total_ms = TicksToMs(total_ticks);
 	if(total_ms == 0.0)total_ms = 1.0;
 	
+	// Find the critical path for each run. Links that are on the critical
+	// path of any run are highlighted in the graph.
+	map<int32_t, vector<string> > critical_paths;
+	map<int32_t, double> critical_path_ms;
+	set<pair<string,string> > critical_links;
+	map<int32_t, RunStats>::iterator riter;
+	for(riter=run_stats.begin(); riter!=run_stats.end(); riter++){
+		vector<string> &path = critical_paths[riter->first];
+		int64_t ticks = FindCriticalPath(riter->second, path);
+		critical_path_ms[riter->first] = TicksToMs(ticks);
+		for(unsigned int i=1; i<path.size(); i++) critical_links.insert(pair<string,string>(path[i-1], path[i]));
+
+		jout<<"JANADOT critical path for run "<<riter->first<<" ("<<MakeTimeString(critical_path_ms[riter->first])<<"/event): ";
+		for(unsigned int i=0; i<path.size(); i++) jout<<(i==0 ? "":" -> ")<<path[i];
+		jout<<endl;
+	}
+	
 	// If the user specified a focus factory, find the decendents and ancestors
 	set<string> focus_relatives;
 	if(has_focus){
@@ -241,12 +315,13 @@ jerror_t JEventProcessorJANADOT::fini(void)
 		// Don't draw links when the caller is flagged to be ignored via the special name "<ignore>"
 		if(nametag1 == "<ignore>") continue;
 		
-		double my_ms = stats.from_factory_ms + stats.from_source_ms + stats.from_cache_ms;
+		double my_ms = TicksToMs(stats.from_factory_ticks + stats.from_source_ticks + stats.from_cache_ticks);
 		double percent = 100.0*my_ms/total_ms;
 		char percentstr[32];
 		sprintf(percentstr, "%5.1f%%", percent);
 		
-		string timestr=MakeTimeString(stats.from_factory_ms);
+		string timestr=MakeTimeString(TicksToMs(stats.from_factory_ticks));
+		bool is_critical = critical_links.find(pair<string,string>(nametag1, nametag2)) != critical_links.end();
 		
 		// If a focus factory was specified, check if either the 
 		if(has_focus){
@@ -259,6 +334,7 @@ jerror_t JEventProcessorJANADOT::fini(void)
 		file<<" -> ";
 		file<<"\""<<nametag2<<"\"";
 		file<<" [style=bold, fontsize=8";
+		if(is_critical) file<<", color=red, penwidth=3";
 		file<<", label=\""<<Ntotal<<" calls\\n"<<timestr<<"\\n"<<percentstr<<"\"";
 		//file<<", penwidth="<<(int)(percent/10.0);
 		file<<"];";
@@ -299,7 +375,7 @@ jerror_t JEventProcessorJANADOT::fini(void)
 		}
 		
 		// Get time spent in this factory proper
-		double time_spent_in_factory = fcall_stats.time_waited_on - fcall_stats.time_waiting;
+		double time_spent_in_factory = TicksToMs((int64_t)fcall_stats.time_waited_on - (int64_t)fcall_stats.time_waiting);
 		string timestr=MakeTimeString(time_spent_in_factory);
 
 		double percent = 100.0*time_spent_in_factory/total_ms;
@@ -366,10 +442,31 @@ jerror_t JEventProcessorJANADOT::fini(void)
 	file<<", margin=0";
 	file<<"];"<<endl;
 	
+	// Make node listing the critical path for each run
+	if(!critical_paths.empty()){
+		stringstream cp_html;
+		cp_html<<"<TABLE border=\"0\" cellspacing=\"0\" cellpadding=\"0\" cellborder=\"0\">";
+		cp_html<<"<TR><TD><font color=\"red\">Critical path (per event)</font></TD></TR>";
+		map<int32_t, vector<string> >::iterator cpiter;
+		for(cpiter=critical_paths.begin(); cpiter!=critical_paths.end(); cpiter++){
+			vector<string> &path = cpiter->second;
+			cp_html<<"<TR><TD><font point-size=\"8\">run "<<cpiter->first<<": ";
+			for(unsigned int i=0; i<path.size(); i++) cp_html<<(i==0 ? "":" &rarr; ")<<path[i];
+			cp_html<<" ("<<MakeTimeString(critical_path_ms[cpiter->first])<<")</font></TD></TR>";
+		}
+		cp_html<<"</TABLE>";
+		file<<"\t\"CriticalPath\"";
+		file<<" [shape=box,style=filled,color=white";
+		file<<", label=<"<<cp_html.str()<<">";
+		file<<", margin=0";
+		file<<"];"<<endl;
+	}
+
 
 	// Make all processor nodes appear at top of graph
 	file<<"\t{rank=source; ";
 	file << "\"CreationTime\";";
+	if(!critical_paths.empty()) file << "\"CriticalPath\";";
 	for(unsigned int i=0; i<processor_nodes.size(); i++)file<<"\""<<processor_nodes[i]<<"\"; ";
 	file<<"}"<<endl;
 	
@@ -422,6 +519,192 @@ jerror_t JEventProcessorJANADOT::fini(void)
 	return NOERROR;
 }
 
+//------------------------------------------------------------------
+// MergeThreadStats
+//------------------------------------------------------------------
+void JEventProcessorJANADOT::MergeThreadStats(void)
+{
+	/// Add the statistics accumulated by each of the processing threads
+	/// into the global maps. This is only called from fini when no
+	/// threads should be processing events, but the mutex is locked
+	/// anyway to guard against a thread registering itself late.
+
+	pthread_mutex_lock(&mutex);
+	for(unsigned int i=0; i<thread_stats.size(); i++){
+		ThreadStats *tstats = thread_stats[i];
+
+		map<CallLink, CallStats>::iterator iter;
+		for(iter=tstats->call_links.begin(); iter!=tstats->call_links.end(); iter++){
+			call_links[iter->first] += iter->second;
+		}
+
+		map<string, FactoryCallStats>::iterator fiter;
+		for(fiter=tstats->factory_stats.begin(); fiter!=tstats->factory_stats.end(); fiter++){
+			factory_stats[fiter->first] += fiter->second;
+		}
+
+		map<int32_t, RunStats>::iterator riter;
+		for(riter=tstats->run_stats.begin(); riter!=tstats->run_stats.end(); riter++){
+			run_stats[riter->first] += riter->second;
+		}
+
+		// Clear so a second call doesn't double count
+		tstats->call_links.clear();
+		tstats->factory_stats.clear();
+		tstats->run_stats.clear();
+		tstats->event_records.clear();
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+//------------------------------------------------------------------
+// WriteCallLog
+//------------------------------------------------------------------
+void JEventProcessorJANADOT::WriteCallLog(void)
+{
+	/// Write the call stack entries recorded for individual events
+	/// to the file specified by JANADOT:CALL_LOG. The format is a
+	/// simple tab separated text file with one line per event
+	/// (starting with "E") followed by one line per call (starting
+	/// with "C"). See janacritpath for a consumer of this.
+
+	ofstream ofs(call_log_filename.c_str());
+	if(!ofs.is_open()){
+		jerr<<"Unable to open JANADOT:CALL_LOG file \""<<call_log_filename<<"\"!"<<endl;
+		return;
+	}
+
+	ofs<<"# janadot call log"<<endl;
+	ofs<<"# E <run> <event>"<<endl;
+	ofs<<"# C <caller> <callee> <start_ns> <end_ns> <data_source>"<<endl;
+	ofs<<"# data_source: 1=not available 2=cache 3=source 4=factory"<<endl;
+
+	unsigned int Nevents = 0;
+	pthread_mutex_lock(&mutex);
+	for(unsigned int i=0; i<thread_stats.size(); i++){
+		vector<EventRecord> &erecs = thread_stats[i]->event_records;
+		for(unsigned int j=0; j<erecs.size(); j++, Nevents++){
+			EventRecord &erec = erecs[j];
+			ofs<<"E\t"<<erec.run_number<<"\t"<<erec.event_number<<"\n";
+			for(unsigned int k=0; k<erec.calls.size(); k++){
+				CallRecord &crec = erec.calls[k];
+				ofs<<"C\t"<<crec.caller<<"\t"<<crec.callee<<"\t"<<crec.start_ticks<<"\t"<<crec.end_ticks<<"\t"<<crec.data_source<<"\n";
+			}
+		}
+	}
+	pthread_mutex_unlock(&mutex);
+	ofs.close();
+
+	jout<<"JANADOT wrote call log for "<<Nevents<<" events to \""<<call_log_filename<<"\""<<endl;
+}
+
+//------------------------------------------------------------------
+// RunStats::operator+=
+//------------------------------------------------------------------
+void JEventProcessorJANADOT::RunStats::operator+=(const RunStats &s)
+{
+	Nevents += s.Nevents;
+
+	map<string, int64_t>::const_iterator iter;
+	for(iter=s.self_ticks.begin(); iter!=s.self_ticks.end(); iter++) self_ticks[iter->first] += iter->second;
+
+	map<string, set<string> >::const_iterator citer;
+	for(citer=s.callees.begin(); citer!=s.callees.end(); citer++){
+		callees[citer->first].insert(citer->second.begin(), citer->second.end());
+	}
+}
+
+//------------------------------------------------------------------
+// FindCriticalPath
+//------------------------------------------------------------------
+int64_t JEventProcessorJANADOT::FindCriticalPath(RunStats &rstats, vector<string> &path)
+{
+	/// Find the chain of dependencies from a top-level caller (i.e. one
+	/// that is never a callee) to a leaf that has the largest sum of
+	/// time spent in the nodes themselves. The nodes are filled into
+	/// path in calling order and the average time per event of the
+	/// path is returned in ticks.
+
+	path.clear();
+	if(rstats.Nevents == 0) return 0;
+
+	// Top-level callers are those that never appear as a callee
+	set<string> all_callees;
+	map<string, set<string> >::iterator iter;
+	for(iter=rstats.callees.begin(); iter!=rstats.callees.end(); iter++){
+		all_callees.insert(iter->second.begin(), iter->second.end());
+	}
+
+	map<string, int64_t> best;
+	map<string, string> next;
+	set<string> visiting;
+	int64_t max_ticks = -1;
+	string start;
+	for(iter=rstats.callees.begin(); iter!=rstats.callees.end(); iter++){
+		const string &node = iter->first;
+		if(node == "<ignore>") continue;
+		if(all_callees.find(node) != all_callees.end()) continue;
+		int64_t ticks = FindCriticalPath(rstats, node, best, next, visiting);
+
+		// For ties, prefer the caller that spent the most time waiting
+		bool tie = (ticks==max_ticks) && (rstats.self_ticks[node] < rstats.self_ticks[start]);
+		if(ticks > max_ticks || tie){
+			max_ticks = ticks;
+			start = node;
+		}
+	}
+	if(max_ticks < 0) return 0;
+
+	// Walk the path starting at the top-level caller
+	for(string node=start; !node.empty(); ){
+		path.push_back(node);
+		map<string, string>::iterator niter = next.find(node);
+		node = niter==next.end() ? "":niter->second;
+		if(path.size() > best.size()) break; // protect against cycles
+	}
+
+	return max_ticks/(int64_t)rstats.Nevents;
+}
+
+//------------------------------------------------------------------
+// FindCriticalPath
+//------------------------------------------------------------------
+int64_t JEventProcessorJANADOT::FindCriticalPath(RunStats &rstats, const string &node, map<string, int64_t> &best, map<string, string> &next, set<string> &visiting)
+{
+	/// This is reentrant and returns the longest path (in ticks) from the
+	/// given node down to any leaf. Results are cached in best so each
+	/// node is only evaluated once. The visiting set is used to break
+	/// any cycles in the graph.
+
+	map<string, int64_t>::iterator biter = best.find(node);
+	if(biter != best.end()) return biter->second;
+	if(visiting.find(node) != visiting.end()) return 0;
+	visiting.insert(node);
+
+	// Top-level callers will have negative self time since they only
+	// wait on others. Don't let that count against the path.
+	int64_t self = rstats.self_ticks[node];
+	if(self < 0) self = 0;
+
+	int64_t max_callee = 0;
+	map<string, set<string> >::iterator iter = rstats.callees.find(node);
+	if(iter != rstats.callees.end()){
+		set<string>::iterator it;
+		for(it=iter->second.begin(); it!=iter->second.end(); it++){
+			int64_t ticks = FindCriticalPath(rstats, *it, best, next, visiting);
+			if(ticks>max_callee || next.find(node)==next.end()){
+				max_callee = ticks;
+				next[node] = *it;
+			}
+		}
+	}
+
+	visiting.erase(node);
+	best[node] = self + max_callee;
+
+	return best[node];
+}
+
 //------------------------------------------------------------------
 // FindDecendents
 //------------------------------------------------------------------
@@ -7,7 +7,13 @@
 using namespace jana;
 
 #include <map>
+#include <set>
+#include <vector>
+#include <string>
 using std::map;
+using std::set;
+using std::vector;
+using std::string;
 
 class JEventProcessorJANADOT:public JEventProcessor
 {
@@ -65,13 +71,34 @@ class JEventProcessorJANADOT:public JEventProcessor
 	/// focus factory is drawn with a triple octagon shape to indicate it was used
 	/// as the focus.
 	///
+	/// JANADOT:CALL_LOG  - If set to a file name, the individual call stack
+	/// entries (with start/end ticks) of every event are also written to that
+	/// file in fini. This is what the janacritpath utility reads to do the
+	/// critical path and parallelism analysis. Events are buffered per thread
+	/// in memory so the number recorded by each thread is capped by
+	/// JANADOT:CALL_LOG_MAX_EVENTS (default 10000).
+	///
 	/// Because the configurations can become large for large projects, a script
 	/// called "janadot_groups.py" is provided as part of JANA. Just give it the
 	/// path of the top level directory structure where code you wish to document
 	/// it is.
+	///
+	/// Statistics are accumulated by each processing thread into its own
+	/// ThreadStats object (attached to the JEventLoop as a user reference) so
+	/// that no lock needs to be taken while processing events. These are merged
+	/// in fini. Times are recorded as integer ticks (nanoseconds) taken from
+	/// the call stack and only converted to ms when the dot file is written.
+	///
+	/// In addition to the call graph, the critical path for each run is
+	/// determined and drawn in red. This is the chain of dependencies from a
+	/// top-level caller down to a leaf with the largest sum of time spent in
+	/// the factories themselves (averaged per event). It is the shortest
+	/// the event could take if everything not on it were done in parallel.
 
 
 	public:
+		JEventProcessorJANADOT(){}
+		virtual ~JEventProcessorJANADOT();
 		const char* className(void){return "JEventProcessorJANADOT";}
 
 		jerror_t init(void);							///< Called once at program start.
@@ -105,45 +132,100 @@ class JEventProcessorJANADOT:public JEventProcessor
 		class CallStats{
 			public:
 				CallStats(void){
-					from_cache_ms = 0;
-					from_source_ms = 0;
-					from_factory_ms = 0;
-					data_not_available_ms = 0;
+					from_cache_ticks = 0;
+					from_source_ticks = 0;
+					from_factory_ticks = 0;
+					data_not_available_ticks = 0;
 					Nfrom_cache = 0;
 					Nfrom_source = 0;
 					Nfrom_factory = 0;
 					Ndata_not_available = 0;
 				}
-				double from_cache_ms;
-				double from_source_ms;
-				double from_factory_ms;
-				double data_not_available_ms;
+				uint64_t from_cache_ticks;
+				uint64_t from_source_ticks;
+				uint64_t from_factory_ticks;
+				uint64_t data_not_available_ticks;
 				unsigned int Nfrom_cache;
 				unsigned int Nfrom_source;
 				unsigned int Nfrom_factory;
 				unsigned int Ndata_not_available;
+
+				void operator+=(const CallStats &s){
+					from_cache_ticks         += s.from_cache_ticks;
+					from_source_ticks        += s.from_source_ticks;
+					from_factory_ticks       += s.from_factory_ticks;
+					data_not_available_ticks += s.data_not_available_ticks;
+					Nfrom_cache              += s.Nfrom_cache;
+					Nfrom_source             += s.Nfrom_source;
+					Nfrom_factory            += s.Nfrom_factory;
+					Ndata_not_available      += s.Ndata_not_available;
+				}
 		};
 		
 		class FactoryCallStats{
 			public:
 				FactoryCallStats(void){
 					type = kDefault;
-					time_waited_on = 0.0;
-					time_waiting = 0.0;
+					time_waited_on = 0;
+					time_waiting = 0;
 					Nfrom_factory = 0;
 					Nfrom_source = 0;
 					Nfrom_cache = 0;
 				}
 				node_type type;
-				double time_waited_on;	// time other factories spent waiting on this factory
-				double time_waiting;		// time this factory spent waiting on other factories
+				uint64_t time_waited_on;	// ticks other factories spent waiting on this factory
+				uint64_t time_waiting;		// ticks this factory spent waiting on other factories
 				unsigned int Nfrom_factory;
 				unsigned int Nfrom_source;
 				unsigned int Nfrom_cache;
+
+				void operator+=(const FactoryCallStats &s){
+					time_waited_on += s.time_waited_on;
+					time_waiting   += s.time_waiting;
+					Nfrom_factory  += s.Nfrom_factory;
+					Nfrom_source   += s.Nfrom_source;
+					Nfrom_cache    += s.Nfrom_cache;
+				}
+		};
+
+		class RunStats{
+			public:
+				RunStats(void):Nevents(0){}
+				map<string, int64_t> self_ticks;      // ticks spent in node itself (excluding callees)
+				map<string, set<string> > callees;    // dependencies of each node
+				uint64_t Nevents;
+
+				void operator+=(const RunStats &s);
+		};
+
+		class CallRecord{
+			public:
+				string caller;
+				string callee;
+				uint64_t start_ticks;
+				uint64_t end_ticks;
+				int data_source;
+		};
+
+		class EventRecord{
+			public:
+				int32_t run_number;
+				uint64_t event_number;
+				vector<CallRecord> calls;
+		};
+
+		class ThreadStats{
+			public:
+				map<CallLink, CallStats> call_links;
+				map<string, FactoryCallStats> factory_stats;
+				map<int32_t, RunStats> run_stats;
+				vector<EventRecord> event_records;
 		};
 
 		map<CallLink, CallStats> call_links;
 		map<string, FactoryCallStats> factory_stats;
+		map<int32_t, RunStats> run_stats;
+		vector<ThreadStats*> thread_stats;
 		pthread_mutex_t mutex;
 		bool force_all_factories_active;
 		bool suppress_unused_factories;
@@ -153,9 +235,16 @@ class JEventProcessorJANADOT:public JEventProcessor
 		set<string> no_subgraph_groups;
 		bool has_focus;
 		string focus_factory;
+		string call_log_filename;
+		unsigned int call_log_max_events;
 		
 		void FindDecendents(string caller, set<string> &decendents);
 		void FindAncestors(string callee, set<string> &ancestors);
+		void MergeThreadStats(void);
+		void WriteCallLog(void);
+		int64_t FindCriticalPath(RunStats &rstats, vector<string> &path);
+		int64_t FindCriticalPath(RunStats &rstats, const string &node, map<string, int64_t> &best, map<string, string> &next, set<string> &visiting);
+		double TicksToMs(int64_t ticks){ return (double)ticks/1.0E6; }
 		string MakeTimeString(double time_in_ms);
 		string MakeNametag(const string &name, const string &tag);
 };
@@ -72,6 +72,9 @@ jerror_t JEventSourceEVIO::GetEvent(JEvent &event)
 		return NO_MORE_EVENTS_IN_SOURCE;
 	}
 	++Nevents_read;
+
+	// First word of the event is its length in 32-bit words (exclusive)
+	AddBytesRead(4*((uint64_t)evioFile->getBuffer()[0] + 1));
 	
 	// Create a DOM tree of the event
 	evioDOMTree *tree = new evioDOMTree(*evioFile);
@@ -0,0 +1,47 @@
+// $Id$
+//
+//    File: JEVIOBank.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JEVIOBank_
+#define _JEVIOBank_
+
+#include <JANA/JObject.h>
+#include <JANA/JFactory.h>
+
+#include "JEVIOBankView.h"
+
+/// JEVIOBank is the object JEventSourceEVIOMap provides to factories.
+/// There is one for every bank, segment and tagsegment in the event,
+/// in depth first order so the first is always the top level event
+/// bank. It is only a view (see JEVIOBankView) so it points to data
+/// owned by the event source and is valid only while the event is
+/// being processed. It must not be kept beyond that.
+
+class JEVIOBank:public jana::JObject, public JEVIOBankView{
+	public:
+		JOBJECT_PUBLIC(JEVIOBank);
+
+		JEVIOBank(const JEVIOBankView &view, unsigned int depth, const JEVIOBank *parent):JEVIOBankView(view),depth(depth),parent(parent){}
+
+		// GetTag() returns the EVIO tag. Use JObject::GetTag() for the
+		// factory tag.
+		using JEVIOBankView::GetTag;
+
+		unsigned int depth;        ///< 0 for the event bank, 1 for its children, ...
+		const JEVIOBank *parent;   ///< NULL for the event bank
+
+		void toStrings(vector<pair<string,string> > &items)const{
+			AddString(items, "depth", "%d", depth);
+			AddString(items, "tag", "0x%04x", tag);
+			AddString(items, "num", "%d", num);
+			AddString(items, "type", "0x%02x", type);
+			AddString(items, "nwords", "%d", nwords);
+			AddString(items, "swapped", "%d", swapped ? 1:0);
+		}
+};
+
+#endif // _JEVIOBank_
+
@@ -0,0 +1,51 @@
+// $Id$
+//
+//    File: JEVIOBankView.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include "JEVIOBankView.h"
+
+//---------------------------------
+// GetChildren
+//---------------------------------
+void JEVIOBankView::GetChildren(vector<JEVIOBankView> &children) const
+{
+	/// Fill the given container with views of the immediate children
+	/// of this bank. If it is not a container, the vector will be
+	/// empty. Children that would extend past the end of this bank
+	/// (i.e. corrupt data) are not included.
+	children.clear();
+	if(!IsContainer()) return;
+
+	header_type_t child_type = GetChildHeaderType();
+	const uint32_t *data = GetRawData();
+	uint32_t pos = 0;
+	while(pos < nwords){
+		JEVIOBankView child(&data[pos], child_type, swapped, version);
+		uint32_t len = child.GetNwordsTotal();
+		if(pos+len > nwords || len<child.GetHeaderWords()) break;
+		children.push_back(child);
+		pos += len;
+	}
+}
+
+//---------------------------------
+// GetString
+//---------------------------------
+string JEVIOBankView::GetString(void) const
+{
+	/// Return the data of a string (kCharStar8) bank as a string. If
+	/// the bank contains multiple strings (version 4 string arrays)
+	/// only the first is returned. Characters are not affected by the
+	/// byte order so no swapping is needed.
+	if(type!=kCharStar8) return "";
+
+	const char *c = (const char*)GetRawData();
+	uint32_t N = GetNelements();
+	uint32_t len = 0;
+	while(len<N && c[len]!=0 && c[len]!=4) len++;
+
+	return string(c, len);
+}
@@ -0,0 +1,273 @@
+// $Id$
+//
+//    File: JEVIOBankView.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JEVIOBankView_
+#define _JEVIOBankView_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+#include <string>
+using std::vector;
+using std::string;
+
+/// JEVIOBankView is a non-owning view of a single EVIO bank, segment
+/// or tagsegment. It holds only a pointer to the header word(s) in
+/// the memory the event was read into (normally the memory mapped
+/// file) so creating one never copies any data. The memory must
+/// stay valid for as long as the view is used. For banks handed to
+/// factories by JEventSourceEVIOMap, that is until the event is
+/// freed.
+///
+/// If the file was written on a machine of the opposite byte order,
+/// IsSwapped() returns true. The header values are always returned
+/// in native order. The data can be obtained in native order with
+/// GetData() which copies (and swaps) it into a vector. For files
+/// in native order, GetDataPointer() can be used to access the data
+/// in place without any copy at all.
+
+class JEVIOBankView{
+	public:
+
+		enum header_type_t{
+			kBank = 0,      // 2 word header
+			kSegment,       // 1 word header, 8 bit tag
+			kTagSegment     // 1 word header, 12 bit tag
+		};
+
+		// EVIO content types
+		enum{
+			kUnknown32  = 0x0,
+			kUInt32     = 0x1,
+			kFloat32    = 0x2,
+			kCharStar8  = 0x3,
+			kShort16    = 0x4,
+			kUShort16   = 0x5,
+			kChar8      = 0x6,
+			kUChar8     = 0x7,
+			kDouble64   = 0x8,
+			kLong64     = 0x9,
+			kULong64    = 0xa,
+			kInt32      = 0xb,
+			kTagSegmentType = 0xc,
+			kSegmentType    = 0xd,
+			kBankType       = 0xe,
+			kComposite      = 0xf,
+			kAlsoBank       = 0x10,
+			kAlsoSegment    = 0x20,
+			kAlsoTagSegment = 0x40  // only in version 1-3 files
+		};
+
+		JEVIOBankView():header(NULL),header_type(kBank),swapped(false),tag(0),num(0),type(0),pad(0),nwords(0){}
+		JEVIOBankView(const uint32_t *header, header_type_t header_type, bool swapped, int version){Set(header, header_type, swapped, version);}
+
+		inline void Set(const uint32_t *header, header_type_t header_type, bool swapped, int version);
+
+		inline uint32_t GetTag(void) const {return tag;}
+		inline uint32_t GetNum(void) const {return num;}          ///< Only banks have a num. Zero for others.
+		inline uint32_t GetDataType(void) const {return type;}
+		inline uint32_t GetPadding(void) const {return pad;}      ///< Bytes of padding at end of 8 and 16 bit data (version 4 only)
+		inline uint32_t GetNwords(void) const {return nwords;}    ///< Number of 32-bit data words (not including header)
+		inline uint32_t GetNwordsTotal(void) const {return nwords + GetHeaderWords();}
+		inline uint32_t GetHeaderWords(void) const {return header_type==kBank ? 2:1;}
+		inline header_type_t GetHeaderType(void) const {return header_type;}
+		inline bool IsSwapped(void) const {return swapped;}
+		inline int GetVersion(void) const {return version;}
+		inline bool IsValid(void) const {return header!=NULL;}
+
+		inline bool IsContainer(void) const;
+		inline header_type_t GetChildHeaderType(void) const;
+		inline uint32_t GetElementSize(void) const;
+		inline uint32_t GetNelements(void) const;
+
+		inline const uint32_t* GetHeader(void) const {return header;}
+		inline const uint32_t* GetRawData(void) const {return header + GetHeaderWords();} ///< Data exactly as in file (may be in foreign byte order!)
+
+		template<class T> const T* GetDataPointer(uint32_t &N) const;
+		template<class T> void GetData(vector<T> &vals) const;
+		string GetString(void) const;
+
+		void GetChildren(vector<JEVIOBankView> &children) const;
+
+		static inline uint32_t Swap32(uint32_t w){return __builtin_bswap32(w);}
+		static inline uint16_t Swap16(uint16_t w){return (uint16_t)((w>>8) | (w<<8));}
+		static inline uint64_t Swap64(uint64_t w){return __builtin_bswap64(w);}
+
+	protected:
+		const uint32_t *header;
+		header_type_t header_type;
+		bool swapped;
+		int version;
+		uint32_t tag;
+		uint32_t num;
+		uint32_t type;
+		uint32_t pad;
+		uint32_t nwords;
+};
+
+//---------------------------------
+// Set
+//---------------------------------
+inline void JEVIOBankView::Set(const uint32_t *header, header_type_t header_type, bool swapped, int version)
+{
+	/// Decode the header at the given location. The header is not
+	/// copied, only the pointer to it is kept.
+	this->header = header;
+	this->header_type = header_type;
+	this->swapped = swapped;
+	this->version = version;
+
+	// Versions 1-3 use all 8 bits for the type. Version 4 uses the
+	// top 2 for padding.
+	uint32_t w0 = swapped ? Swap32(header[0]):header[0];
+	switch(header_type){
+		case kBank:{
+			uint32_t w1 = swapped ? Swap32(header[1]):header[1];
+			nwords = w0 - 1;
+			tag    = w1 >> 16;
+			type   = (w1 >> 8) & (version<4 ? 0xff:0x3f);
+			pad    = version<4 ? 0:((w1 >> 14) & 0x3);
+			num    = w1 & 0xff;
+			break;}
+		case kSegment:
+			nwords = w0 & 0xffff;
+			tag    = w0 >> 24;
+			type   = (w0 >> 16) & (version<4 ? 0xff:0x3f);
+			pad    = version<4 ? 0:((w0 >> 22) & 0x3);
+			num    = 0;
+			break;
+		case kTagSegment:
+			nwords = w0 & 0xffff;
+			tag    = w0 >> 20;
+			type   = (w0 >> 16) & 0xf;
+			pad    = 0;
+			num    = 0;
+			break;
+	}
+}
+
+//---------------------------------
+// IsContainer
+//---------------------------------
+inline bool JEVIOBankView::IsContainer(void) const
+{
+	switch(type){
+		case kBankType:
+		case kAlsoBank:
+		case kSegmentType:
+		case kAlsoSegment:
+		case kTagSegmentType:
+			return true;
+		case kAlsoTagSegment:
+			return version<4; // 0x40 does not fit in the 6 bit type of version 4
+		default:
+			return false;
+	}
+}
+
+//---------------------------------
+// GetChildHeaderType
+//---------------------------------
+inline JEVIOBankView::header_type_t JEVIOBankView::GetChildHeaderType(void) const
+{
+	switch(type){
+		case kSegmentType:
+		case kAlsoSegment:
+			return kSegment;
+		case kTagSegmentType:
+		case kAlsoTagSegment:
+			return kTagSegment;
+		default:
+			return kBank;
+	}
+}
+
+//---------------------------------
+// GetElementSize
+//---------------------------------
+inline uint32_t JEVIOBankView::GetElementSize(void) const
+{
+	/// Size in bytes of the individual data values in this bank.
+	/// This is what determines how the data is byte swapped.
+	switch(type){
+		case kCharStar8:
+		case kChar8:
+		case kUChar8:
+			return 1;
+		case kShort16:
+		case kUShort16:
+			return 2;
+		case kDouble64:
+		case kLong64:
+		case kULong64:
+			return 8;
+		default:
+			return 4;
+	}
+}
+
+//---------------------------------
+// GetNelements
+//---------------------------------
+inline uint32_t JEVIOBankView::GetNelements(void) const
+{
+	uint32_t Nbytes = 4*nwords;
+	if(pad<=Nbytes) Nbytes -= pad;
+	return Nbytes/GetElementSize();
+}
+
+//---------------------------------
+// GetDataPointer
+//---------------------------------
+template<class T>
+const T* JEVIOBankView::GetDataPointer(uint32_t &N) const
+{
+	/// Return a pointer directly to the data of this bank in the
+	/// mapped file. The number of elements of type T is returned in N.
+	/// No data is copied. If the file is not in native byte order,
+	/// then the data cannot be used in place so NULL is returned (and
+	/// N is set to zero). Use GetData() in that case.
+	if(swapped || sizeof(T)!=GetElementSize()){
+		N = 0;
+		return NULL;
+	}
+	N = GetNelements();
+	return (const T*)GetRawData();
+}
+
+//---------------------------------
+// GetData
+//---------------------------------
+template<class T>
+void JEVIOBankView::GetData(vector<T> &vals) const
+{
+	/// Copy the data of this bank into the given vector, converting
+	/// it to native byte order if needed. The size of T must match
+	/// the element size of the bank's data type (e.g. uint32_t, float
+	/// or int for 32-bit types). If it does not, the vector is left
+	/// empty.
+	vals.clear();
+	if(sizeof(T)!=GetElementSize()) return;
+
+	uint32_t N = GetNelements();
+	vals.resize(N);
+	if(N==0) return;
+	memcpy(&vals[0], GetRawData(), N*sizeof(T));
+	if(!swapped) return;
+
+	for(uint32_t i=0; i<N; i++){
+		switch(sizeof(T)){
+			case 2: {uint16_t v; memcpy(&v, &vals[i], 2); v = Swap16(v); memcpy(&vals[i], &v, 2);} break;
+			case 4: {uint32_t v; memcpy(&v, &vals[i], 4); v = Swap32(v); memcpy(&vals[i], &v, 4);} break;
+			case 8: {uint64_t v; memcpy(&v, &vals[i], 8); v = Swap64(v); memcpy(&vals[i], &v, 8);} break;
+		}
+	}
+}
+
+#endif // _JEVIOBankView_
+
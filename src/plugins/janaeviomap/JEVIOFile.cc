@@ -0,0 +1,321 @@
+// $Id$
+//
+//    File: JEVIOFile.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <sstream>
+using namespace std;
+
+#include "JEVIOFile.h"
+#include "JEVIOBankView.h"
+
+//---------------------------------
+// JEVIOFile    (Constructor)
+//---------------------------------
+JEVIOFile::JEVIOFile(const string &filename)
+{
+	this->filename = filename;
+	buff = NULL;
+	file_size = 0;
+	file_words = 0;
+	mapped = false;
+	swapped = false;
+	version = 0;
+
+	if(!Map()) return;
+	if(!IndexBlocks() || !IndexEvents()){
+		// Keep whatever events were successfully indexed. A truncated
+		// file should still give us all of its complete events.
+		if(events.empty()){
+			if(mapped){
+				munmap((void*)buff, file_size);
+			}else{
+				delete[] buff;
+			}
+			buff = NULL;
+		}
+	}
+}
+
+//---------------------------------
+// ~JEVIOFile    (Destructor)
+//---------------------------------
+JEVIOFile::~JEVIOFile()
+{
+	if(buff){
+		if(mapped){
+			munmap((void*)buff, file_size);
+		}else{
+			delete[] buff;
+		}
+	}
+}
+
+//---------------------------------
+// Word
+//---------------------------------
+inline uint32_t JEVIOFile::Word(uint64_t i) const
+{
+	/// Return word i of the file in native byte order
+	return swapped ? JEVIOBankView::Swap32(buff[i]):buff[i];
+}
+
+//---------------------------------
+// CheckMagic
+//---------------------------------
+bool JEVIOFile::CheckMagic(const string &filename)
+{
+	/// Returns true if the given file starts with an EVIO block
+	/// header (in either byte order).
+	int fd = open(filename.c_str(), O_RDONLY);
+	if(fd<0) return false;
+	uint32_t header[8];
+	ssize_t n = read(fd, header, sizeof(header));
+	close(fd);
+	if(n != sizeof(header)) return false;
+
+	return header[7]==kMagic || JEVIOBankView::Swap32(header[7])==kMagic;
+}
+
+//---------------------------------
+// Map
+//---------------------------------
+bool JEVIOFile::Map(void)
+{
+	/// Map the whole file into memory. If mmap is not possible (e.g.
+	/// some network file systems) fall back to reading the whole file
+	/// into a buffer.
+	int fd = open(filename.c_str(), O_RDONLY);
+	if(fd<0){
+		error = string("unable to open: ") + strerror(errno);
+		return false;
+	}
+
+	struct stat st;
+	if(fstat(fd, &st)!=0){
+		error = string("unable to stat: ") + strerror(errno);
+		close(fd);
+		return false;
+	}
+	file_size = st.st_size;
+	file_words = file_size/4;
+	if(file_words < 8){
+		error = "file too small to be EVIO";
+		close(fd);
+		return false;
+	}
+
+	void *addr = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(addr != MAP_FAILED){
+		buff = (const uint32_t*)addr;
+		mapped = true;
+	}else{
+		uint32_t *mybuff = new uint32_t[file_words];
+		uint64_t Nread = 0;
+		while(Nread < file_words*4){
+			ssize_t n = read(fd, (char*)mybuff + Nread, file_words*4 - Nread);
+			if(n<=0) break;
+			Nread += n;
+		}
+		if(Nread < file_words*4){
+			error = "short read";
+			delete[] mybuff;
+			close(fd);
+			return false;
+		}
+		buff = mybuff;
+	}
+	close(fd);
+
+	// Determine byte order from magic word in first block header
+	if(buff[7] == kMagic){
+		swapped = false;
+	}else if(JEVIOBankView::Swap32(buff[7]) == kMagic){
+		swapped = true;
+	}else{
+		error = "bad magic word in first block header (not an EVIO file?)";
+		if(mapped){
+			munmap((void*)buff, file_size);
+		}else{
+			delete[] buff;
+		}
+		buff = NULL;
+		return false;
+	}
+	version = Word(5) & 0xff;
+
+	return true;
+}
+
+//---------------------------------
+// IndexBlocks
+//---------------------------------
+bool JEVIOFile::IndexBlocks(void)
+{
+	/// Walk the block headers recording where the data words of each
+	/// block are. For version 4, the length is in the first header word
+	/// and every word after the header is data. For earlier versions,
+	/// blocks are fixed size and the fifth word tells how many words
+	/// (including the header) are actually used.
+	uint64_t pos = 0;
+	uint64_t logical = 0;
+	while(pos+8 <= file_words){
+		uint32_t block_len = Word(pos);
+		uint32_t header_len = Word(pos+2);
+		uint32_t magic = Word(pos+7);
+		if(magic!=kMagic || header_len<8 || block_len<header_len){
+			stringstream ss;
+			ss << "bad block header at word " << pos;
+			error = ss.str();
+			return false;
+		}
+
+		uint64_t used = block_len;
+		if(version<4){
+			used = Word(pos+4);
+			if(used<header_len || used>block_len) used = block_len;
+		}
+		if(pos+used > file_words) used = file_words - pos; // truncated file
+
+		block_t b;
+		b.offset = pos + header_len;
+		b.nwords = used - header_len;
+		b.logical = logical;
+		blocks.push_back(b);
+		logical += b.nwords;
+
+		pos += block_len;
+	}
+
+	return !blocks.empty();
+}
+
+//---------------------------------
+// IndexEvents
+//---------------------------------
+bool JEVIOFile::IndexEvents(void)
+{
+	/// Find the start and length of every event. Only the first word
+	/// of each event is read. Events are located in the stream of
+	/// all block data words concatenated. For version 4 files, every
+	/// event lies within a single block. For earlier versions, the
+	/// first event starts where the first block header says it does
+	/// and events may continue into the next block.
+	if(blocks.empty()) return false;
+
+	uint64_t total = blocks.back().logical + blocks.back().nwords;
+	uint64_t logical = 0;
+	if(version<4){
+		uint32_t start = Word(3);
+		uint32_t header_len = Word(2);
+		if(start>=header_len) logical = start - header_len;
+	}else{
+		// Skip the dictionary if there is one. It is the first
+		// event in the first block.
+		bool has_dictionary = (Word(5)>>8) & 0x1;
+		if(has_dictionary && blocks[0].nwords>0) logical = Word(blocks[0].offset) + 1;
+	}
+
+	uint32_t iblock = 0;
+	while(logical < total){
+
+		// Find block containing this position
+		while(iblock+1<blocks.size() && logical >= blocks[iblock].logical + blocks[iblock].nwords) iblock++;
+		const block_t &b = blocks[iblock];
+		uint64_t offset = b.offset + (logical - b.logical);
+
+		uint64_t nwords = (uint64_t)Word(offset) + 1;
+		if(logical + nwords > total){
+			stringstream ss;
+			ss << "truncated event at word " << offset << " (" << events.size() << " complete events)";
+			error = ss.str();
+			return false;
+		}
+
+		event_t e;
+		e.logical = logical;
+		e.nwords = nwords;
+		e.iblock = iblock;
+		e.spans = logical + nwords > b.logical + b.nwords;
+		events.push_back(e);
+
+		logical += nwords;
+	}
+
+	return true;
+}
+
+//---------------------------------
+// LogicalToOffset
+//---------------------------------
+uint64_t JEVIOFile::LogicalToOffset(uint64_t logical, uint32_t &iblock) const
+{
+	/// Convert a position in the stream of data words to a word offset
+	/// in the file. The iblock argument is used as the starting point
+	/// for the search and is updated to the block the position is in.
+	while(iblock+1<blocks.size() && logical >= blocks[iblock].logical + blocks[iblock].nwords) iblock++;
+
+	return blocks[iblock].offset + (logical - blocks[iblock].logical);
+}
+
+//---------------------------------
+// GetEventNwords
+//---------------------------------
+uint32_t JEVIOFile::GetEventNwords(uint64_t ievent) const
+{
+	if(ievent >= events.size()) return 0;
+	return events[ievent].nwords;
+}
+
+//---------------------------------
+// EventSpansBlocks
+//---------------------------------
+bool JEVIOFile::EventSpansBlocks(uint64_t ievent) const
+{
+	if(ievent >= events.size()) return false;
+	return events[ievent].spans;
+}
+
+//---------------------------------
+// GetEvent
+//---------------------------------
+const uint32_t* JEVIOFile::GetEvent(uint64_t ievent, vector<uint32_t> &buffer) const
+{
+	/// Return a pointer to the first word (the bank length) of the
+	/// given event (counting from 0). Normally, this points directly
+	/// into the mapped file and "buffer" is not touched. If the event
+	/// spans more than one block (only possible in version 1-3 files)
+	/// it is copied into "buffer" and a pointer to that is returned.
+	/// Returns NULL if ievent is out of range.
+	if(ievent >= events.size()) return NULL;
+	const event_t &e = events[ievent];
+	uint32_t iblock = e.iblock;
+
+	if(!e.spans) return &buff[LogicalToOffset(e.logical, iblock)];
+
+	buffer.resize(e.nwords);
+	uint64_t logical = e.logical;
+	uint32_t ncopied = 0;
+	while(ncopied < e.nwords){
+		uint64_t offset = LogicalToOffset(logical, iblock);
+		const block_t &b = blocks[iblock];
+		uint64_t navail = b.logical + b.nwords - logical;
+		uint64_t n = e.nwords - ncopied;
+		if(n > navail) n = navail;
+		memcpy(&buffer[ncopied], &buff[offset], n*sizeof(uint32_t));
+		ncopied += n;
+		logical += n;
+	}
+
+	return &buffer[0];
+}
+
@@ -0,0 +1,96 @@
+// $Id$
+//
+//    File: JEVIOFile.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JEVIOFile_
+#define _JEVIOFile_
+
+#include <stdint.h>
+
+#include <vector>
+#include <string>
+using std::vector;
+using std::string;
+
+/// JEVIOFile reads EVIO files without the evio library. The file is
+/// memory mapped (or, if that fails, read into memory in one go) and
+/// an index of the events is built by walking only the block headers
+/// and the first word of each event. Events are returned as pointers
+/// into the mapped file so no data is copied or allocated.
+///
+/// Both the version 4 format (variable sized blocks that always
+/// contain whole events) and the older version 1-3 format (fixed
+/// sized blocks where events may continue into the next block) are
+/// supported. Only in the latter case, an event that spans a block
+/// boundary must be copied into a contiguous buffer supplied by the
+/// caller.
+///
+/// Files written with the opposite byte order are detected from the
+/// magic word in the block header. The event data is then left in
+/// its original order and IsSwapped() returns true. JEVIOBankView
+/// takes care of converting values to native byte order as they are
+/// accessed.
+
+class JEVIOFile{
+	public:
+		JEVIOFile(const string &filename);
+		virtual ~JEVIOFile();
+
+		bool IsOpen(void) const {return buff!=NULL;}
+		const string& GetError(void) const {return error;}
+		const string& GetFilename(void) const {return filename;}
+		int GetVersion(void) const {return version;}
+		bool IsSwapped(void) const {return swapped;}
+		bool IsMapped(void) const {return mapped;}
+		uint64_t GetFileSize(void) const {return file_size;}
+		uint64_t GetNevents(void) const {return events.size();}
+		uint64_t GetNblocks(void) const {return blocks.size();}
+		const uint32_t* GetBuffer(void) const {return buff;} ///< Start of mapped file
+
+		uint32_t GetEventNwords(uint64_t ievent) const; ///< Total length of event in words (including bank header)
+		bool EventSpansBlocks(uint64_t ievent) const;
+		const uint32_t* GetEvent(uint64_t ievent, vector<uint32_t> &buffer) const;
+
+		static const uint32_t kMagic = 0xc0da0100;
+		static bool CheckMagic(const string &filename);
+
+	protected:
+
+		class block_t{
+			public:
+				uint64_t offset;       // word offset in file of first data word (after header)
+				uint64_t nwords;       // number of data words (not including header)
+				uint64_t logical;      // position of first data word in stream of all data words
+		};
+
+		class event_t{
+			public:
+				uint64_t logical;      // position of event's first word in stream of all data words
+				uint32_t nwords;       // total length including length word
+				uint32_t iblock;       // index of block event starts in
+				bool spans;            // true if event continues into next block(s)
+		};
+
+		string filename;
+		string error;
+		const uint32_t *buff;
+		uint64_t file_size;
+		uint64_t file_words;
+		bool mapped;
+		bool swapped;
+		int version;
+		vector<block_t> blocks;
+		vector<event_t> events;
+
+		inline uint32_t Word(uint64_t i) const;
+		bool Map(void);
+		bool IndexBlocks(void);
+		bool IndexEvents(void);
+		uint64_t LogicalToOffset(uint64_t logical, uint32_t &iblock) const;
+};
+
+#endif // _JEVIOFile_
+
@@ -0,0 +1,246 @@
+// $Id$
+//
+//    File: JEventSourceEVIOMap.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <iostream>
+#include <iomanip>
+using namespace std;
+
+#include <JANA/JApplication.h>
+#include <JANA/JFactory_base.h>
+#include <JANA/JFactory.h>
+#include <JANA/JEventLoop.h>
+#include <JANA/JEvent.h>
+
+#include "JEventSourceEVIOMap.h"
+#include "JEventSourceEVIOMapGenerator.h"
+#include "JFactoryGeneratorEVIOMap.h"
+
+// Routine used to allow us to register our JEventSourceGenerator
+extern "C"{
+void InitPlugin(JApplication *app){
+	InitJANAPlugin(app);
+	app->AddEventSourceGenerator(new JEventSourceEVIOMapGenerator());
+	app->AddFactoryGenerator(new JFactoryGeneratorEVIOMap());
+}
+} // "C"
+
+//----------------
+// Constructor
+//----------------
+JEventSourceEVIOMap::JEventSourceEVIOMap(const char* source_name):JEventSource(source_name)
+{
+	next_event = 0;
+	file = new JEVIOFile(source_name);
+	if(!file->IsOpen()){
+		jerr<<"Unable to open EVIO file \""<<source_name<<"\": "<<file->GetError()<<endl;
+		return;
+	}
+	if(file->GetError()!="") jerr<<"Problem indexing EVIO file \""<<source_name<<"\": "<<file->GetError()<<endl;
+
+	jout<<"Opened EVIO file \""<<source_name<<"\" (version "<<file->GetVersion();
+	jout<<(file->IsSwapped() ? ", byte swapped":"")<<(file->IsMapped() ? ", mapped":", read");
+	jout<<") "<<file->GetNevents()<<" events in "<<file->GetNblocks()<<" blocks"<<endl;
+}
+
+//----------------
+// Destructor
+//----------------
+JEventSourceEVIOMap::~JEventSourceEVIOMap()
+{
+	delete file;
+}
+
+//----------------
+// GetEvent
+//----------------
+jerror_t JEventSourceEVIOMap::GetEvent(JEvent &event)
+{
+	/// Implementation of JEventSource::GetEvent function
+	if(!file->IsOpen()) return EVENT_SOURCE_NOT_OPEN;
+	if(next_event >= file->GetNevents()) return NO_MORE_EVENTS_IN_SOURCE;
+
+	return ReadEvent(next_event++, event);
+}
+
+//----------------
+// GetEvent
+//----------------
+jerror_t JEventSourceEVIOMap::GetEvent(uint64_t eventNumber, JEvent &event)
+{
+	/// Random access to event by its position in the file (the first
+	/// event is 1). Sequential reading continues from the event after it.
+	if(!file->IsOpen()) return EVENT_SOURCE_NOT_OPEN;
+	if(eventNumber<1 || eventNumber > file->GetNevents()) return NO_MORE_EVENTS_IN_SOURCE;
+
+	next_event = eventNumber;
+	return ReadEvent(eventNumber-1, event);
+}
+
+//----------------
+// SkipEvents
+//----------------
+jerror_t JEventSourceEVIOMap::SkipEvents(uint64_t Nevents, uint64_t &Nskipped)
+{
+	/// The file is indexed when it is opened so this just moves
+	/// the next event to read. Nothing in the skipped events is touched.
+	Nskipped = 0;
+	if(!file->IsOpen()) return EVENT_SOURCE_NOT_OPEN;
+
+	uint64_t Nleft = file->GetNevents() - next_event;
+	Nskipped = Nevents<Nleft ? Nevents:Nleft;
+	next_event += Nskipped;
+
+	return Nskipped==Nevents ? NOERROR:NO_MORE_EVENTS_IN_SOURCE;
+}
+
+//----------------
+// SeekToEvent
+//----------------
+jerror_t JEventSourceEVIOMap::SeekToEvent(uint64_t eventNumber, uint64_t &Nskipped)
+{
+	/// Event numbers are positions in the file (see ReadEvent)
+	Nskipped = 0;
+	if(!file->IsOpen()) return EVENT_SOURCE_NOT_OPEN;
+
+	uint64_t Nevents = eventNumber>next_event ? eventNumber-1-next_event:~(uint64_t)0;
+	return SkipEvents(Nevents, Nskipped);
+}
+
+//----------------
+// ReadEvent
+//----------------
+jerror_t JEventSourceEVIOMap::ReadEvent(uint64_t ievent, JEvent &event)
+{
+	EventRef *ref = new EventRef;
+	ref->ievent = ievent;
+	ref->words = file->GetEvent(ievent, ref->buffer);
+	AddBytesRead(4*(uint64_t)file->GetEventNwords(ievent));
+	Nevents_read++;
+
+	event.SetJEventSource(this);
+	event.SetEventNumber(ievent+1);
+	event.SetRunNumber(-1);
+	event.SetRef(ref);
+
+	return NOERROR;
+}
+
+//----------------
+// FreeEvent
+//----------------
+void JEventSourceEVIOMap::FreeEvent(JEvent &event)
+{
+	delete (EventRef*)event.GetRef();
+}
+
+//----------------
+// GetRawEvent
+//----------------
+bool JEventSourceEVIOMap::GetRawEvent(JEvent &event, const void* &data, uint64_t &size)
+{
+	/// The event bank exactly as it is in the file (still in the
+	/// file's byte order).
+	EventRef *ref = (EventRef*)event.GetRef();
+	if(!ref || !ref->words) return false;
+	data = ref->words;
+	size = 4*(uint64_t)file->GetEventNwords(ref->ievent);
+	return true;
+}
+
+//----------------
+// GetRawEventHeader
+//----------------
+void JEventSourceEVIOMap::GetRawEventHeader(JEvent &event, uint64_t size, vector<char> &header)
+{
+	/// Raw events are written as a version 4 file with one event per
+	/// block. This works regardless of the input's version since only
+	/// the block headers differ between versions, not the banks.
+	MakeBlockHeader(8 + size/4, (uint32_t)event.GetEventNumber(), 1, false, header);
+}
+
+//----------------
+// GetRawFileTrailer
+//----------------
+void JEventSourceEVIOMap::GetRawFileTrailer(vector<char> &trailer)
+{
+	/// An empty block marked as the last one
+	MakeBlockHeader(8, 0, 0, true, trailer);
+}
+
+//----------------
+// MakeBlockHeader
+//----------------
+void JEventSourceEVIOMap::MakeBlockHeader(uint32_t Nwords, uint32_t block_number, uint32_t Nevents, bool last, vector<char> &header)
+{
+	/// Append a version 4 block header in the byte order of the input
+	/// file so it matches the raw event data.
+	uint32_t words[8];
+	words[0] = Nwords;
+	words[1] = block_number;
+	words[2] = 8;                    // header length
+	words[3] = Nevents;
+	words[4] = 0;
+	words[5] = 4 | (last ? 0x200:0); // version and last block bit
+	words[6] = 0;
+	words[7] = JEVIOFile::kMagic;
+	if(file->IsSwapped()){
+		for(unsigned int i=0; i<8; i++) words[i] = JEVIOBankView::Swap32(words[i]);
+	}
+	header.insert(header.end(), (const char*)words, (const char*)&words[8]);
+}
+
+//----------------
+// GetObjects
+//----------------
+jerror_t JEventSourceEVIOMap::GetObjects(JEvent &event, JFactory_base *factory)
+{
+	/// Provide JEVIOBank objects for all banks in the event. These
+	/// are views into the mapped file so no event data is copied.
+
+	// We must have a factory to hold the data
+	if(!factory)throw RESOURCE_UNAVAILABLE;
+
+	// Tagged factories are not supported
+	if(strcmp(factory->Tag(), ""))return OBJECT_NOT_AVAILABLE;
+
+	if(strcmp(factory->GetDataClassName(), "JEVIOBank")) return OBJECT_NOT_AVAILABLE;
+
+	JFactory<JEVIOBank> *fac = dynamic_cast<JFactory<JEVIOBank>*>(factory);
+	if(!fac){
+		jerr<<__FILE__<<":"<<__LINE__<<" Hmmm... factory passed does not seem to be a JFactory<JEVIOBank>"<<endl;
+		return UNKNOWN_ERROR;
+	}
+
+	EventRef *ref = (EventRef*)event.GetRef();
+	if(!ref || !ref->words) throw RESOURCE_UNAVAILABLE;
+
+	vector<JEVIOBank*> banks;
+	vector<JEVIOBankView> children;
+	JEVIOBankView top(ref->words, JEVIOBankView::kBank, file->IsSwapped(), file->GetVersion());
+	AddBanks(top, 0, NULL, banks, children);
+	fac->CopyTo(banks);
+
+	return NOERROR;
+}
+
+//----------------
+// AddBanks
+//----------------
+void JEventSourceEVIOMap::AddBanks(const JEVIOBankView &view, unsigned int depth, const JEVIOBank *parent, vector<JEVIOBank*> &banks, vector<JEVIOBankView> &children)
+{
+	/// Add a JEVIOBank for the given view and then recursively for
+	/// all of its children. The "children" vector is only scratch
+	/// space passed in to avoid reallocating it at every level.
+	JEVIOBank *bank = new JEVIOBank(view, depth, parent);
+	banks.push_back(bank);
+	if(!view.IsContainer()) return;
+
+	view.GetChildren(children);
+	vector<JEVIOBankView> mychildren(children);
+	for(unsigned int i=0; i<mychildren.size(); i++) AddBanks(mychildren[i], depth+1, bank, banks, children);
+}
+
@@ -0,0 +1,74 @@
+// $Id$
+//
+//    File: JEventSourceEVIOMap.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JEventSourceEVIOMap_
+#define _JEventSourceEVIOMap_
+
+#include <vector>
+#include <string>
+using namespace std;
+
+#include <JANA/JEventSource.h>
+#include <JANA/jerror.h>
+using namespace jana;
+
+#include "JEVIOFile.h"
+#include "JEVIOBank.h"
+
+/// JEventSourceEVIOMap reads EVIO files natively (no evio library)
+/// using JEVIOFile. Unlike JEventSourceEVIO, it does not build an
+/// evioDOMTree for each event. Instead, the banks are provided to
+/// factories as JEVIOBank objects which point directly into the
+/// memory mapped file. The only per-event allocations are the small
+/// JEVIOBank view objects themselves and then only if they are
+/// actually requested.
+///
+/// Random access by event number is supported since the whole file
+/// is indexed when it is opened.
+
+class JEventSourceEVIOMap:public JEventSource
+{
+	public:
+		JEventSourceEVIOMap(const char* source_name);
+		virtual ~JEventSourceEVIOMap();
+		virtual const char* className(void){return static_className();}
+		static const char* static_className(void){return "JEventSourceEVIOMap";}
+
+		jerror_t GetEvent(JEvent &event);
+		void FreeEvent(JEvent &event);
+		jerror_t GetObjects(JEvent &event, JFactory_base *factory);
+
+		bool GetRawEvent(JEvent &event, const void* &data, uint64_t &size);
+		void GetRawEventHeader(JEvent &event, uint64_t size, vector<char> &header);
+		void GetRawFileTrailer(vector<char> &trailer);
+
+		bool HasRandomAccess(void){return true;}
+		jerror_t GetEvent(uint64_t eventNumber, JEvent &event);
+		jerror_t SkipEvents(uint64_t Nevents, uint64_t &Nskipped);
+		jerror_t SeekToEvent(uint64_t eventNumber, uint64_t &Nskipped);
+
+		const JEVIOFile* GetFile(void) const {return file;}
+
+		/// What the JEvent's ref points to
+		class EventRef{
+			public:
+				uint64_t ievent;
+				const uint32_t *words;
+				vector<uint32_t> buffer; // only used if event spans blocks
+		};
+
+	protected:
+		JEVIOFile *file;
+		uint64_t next_event;
+
+		jerror_t ReadEvent(uint64_t ievent, JEvent &event);
+		void MakeBlockHeader(uint32_t Nwords, uint32_t block_number, uint32_t Nevents, bool last, vector<char> &header);
+		void AddBanks(const JEVIOBankView &view, unsigned int depth, const JEVIOBank *parent, vector<JEVIOBank*> &banks, vector<JEVIOBankView> &children);
+};
+
+#endif // _JEventSourceEVIOMap_
+
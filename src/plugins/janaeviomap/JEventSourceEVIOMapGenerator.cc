@@ -0,0 +1,42 @@
+// $Id$
+//
+//    File: JEventSourceEVIOMapGenerator.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <string>
+using std::string;
+
+#include "JEventSourceEVIOMapGenerator.h"
+#include "JEventSourceEVIOMap.h"
+
+//---------------------------------
+// Description
+//---------------------------------
+const char* JEventSourceEVIOMapGenerator::Description(void)
+{
+	return "EVIO (native, memory mapped)";
+}
+
+//---------------------------------
+// CheckOpenable
+//---------------------------------
+double JEventSourceEVIOMapGenerator::CheckOpenable(string source)
+{
+	/// Check for the EVIO magic word in the first block header. This
+	/// returns slightly less than 1 so that if the janaevio plugin
+	/// (which uses the evio library) is also attached, it is used.
+	/// Use -PEVENT_SOURCE_TYPE=JEventSourceEVIOMapGenerator to force
+	/// this one in that case.
+	return JEVIOFile::CheckMagic(source) ? 0.75:0.0;
+}
+
+//---------------------------------
+// MakeJEventSource
+//---------------------------------
+JEventSource* JEventSourceEVIOMapGenerator::MakeJEventSource(string source)
+{
+	return new JEventSourceEVIOMap(source.c_str());
+}
+
@@ -0,0 +1,28 @@
+// $Id$
+//
+//    File: JEventSourceEVIOMapGenerator.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JEventSourceEVIOMapGenerator_
+#define _JEventSourceEVIOMapGenerator_
+
+#include <JANA/JEventSourceGenerator.h>
+using namespace jana;
+
+class JEventSourceEVIOMapGenerator:public JEventSourceGenerator{
+	public:
+		JEventSourceEVIOMapGenerator(){}
+		~JEventSourceEVIOMapGenerator(){}
+		const char* className(void){return static_className();}
+		static const char* static_className(void){return "JEventSourceEVIOMapGenerator";}
+
+		const char* Description(void);
+		double CheckOpenable(string source);
+		JEventSource* MakeJEventSource(string source);
+
+};
+
+#endif // _JEventSourceEVIOMapGenerator_
+
@@ -0,0 +1,35 @@
+// $Id$
+//
+//    File: JFactoryGeneratorEVIOMap.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JFactoryGeneratorEVIOMap_
+#define _JFactoryGeneratorEVIOMap_
+
+#include <JANA/jerror.h>
+#include <JANA/JFactoryGenerator.h>
+#include <JANA/JEventLoop.h>
+using namespace jana;
+
+#include "JEVIOBank.h"
+
+/// Adds the (empty) JFactory<JEVIOBank> that JEventSourceEVIOMap
+/// fills so consumers can simply do loop->Get(banks).
+
+class JFactoryGeneratorEVIOMap: public JFactoryGenerator{
+	public:
+		JFactoryGeneratorEVIOMap(){}
+		virtual ~JFactoryGeneratorEVIOMap(){}
+		virtual const char* className(void){return static_className();}
+		static const char* static_className(void){return "JFactoryGeneratorEVIOMap";}
+
+		jerror_t GenerateFactories(JEventLoop *loop){
+			loop->AddFactory(new JFactory<JEVIOBank>());
+			return NOERROR;
+		}
+};
+
+#endif // _JFactoryGeneratorEVIOMap_
+
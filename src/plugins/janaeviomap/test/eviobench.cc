@@ -0,0 +1,326 @@
+// Author: David Lawrence   Oct. 18, 2026
+//
+//
+// eviobench.cc
+//
+// Compare the time needed to read every bank of every event in an
+// EVIO file using the native reader of the janaeviomap plugin
+// (JEVIOFile + JEVIOBankView) with the evioDOMTree path used by the
+// janaevio plugin. The latter is only included if compiled with
+// -DHAVE_EVIO and linked against the evio libraries. See the README
+// in the parent directory for how to build it.
+//
+// This can also write a byte swapped copy of a file (-w) which is
+// useful for checking that foreign byte order files are read correctly:
+// the checksum printed for the copy should match that of the original.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+using namespace std;
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "../JEVIOFile.h"
+#include "../JEVIOBankView.h"
+
+#ifdef HAVE_EVIO
+#include <evioUtil.hxx>
+#include <evioFileChannel.hxx>
+using namespace evio;
+#endif
+
+void ParseCommandLineArguments(int narg, char *argv[]);
+void Usage(void);
+double GetTime(void);
+bool BenchNative(double &t, uint64_t &Nevents, uint64_t &Nbanks, uint64_t &checksum);
+bool BenchDOM(double &t, uint64_t &Nevents, uint64_t &Nbanks);
+bool WriteSwapped(void);
+
+string FILENAME = "";
+string SWAPPED_FILENAME = "";
+int NPASSES = 100;
+
+//-----------
+// main
+//-----------
+int main(int narg, char *argv[])
+{
+	ParseCommandLineArguments(narg, argv);
+
+	if(SWAPPED_FILENAME != "") return WriteSwapped() ? 0:-1;
+
+	double t;
+	uint64_t Nevents, Nbanks, checksum;
+	if(!BenchNative(t, Nevents, Nbanks, checksum)) return -1;
+	cout<<"  native: "<<setw(10)<<Nevents<<" events "<<setw(12)<<Nbanks<<" banks ";
+	cout<<fixed<<setprecision(3)<<setw(10)<<1.0E6*t/(double)Nevents<<" us/event  checksum=0x"<<hex<<checksum<<dec<<endl;
+
+#ifdef HAVE_EVIO
+	double t_native = t;
+	if(!BenchDOM(t, Nevents, Nbanks)) return -1;
+	cout<<"     DOM: "<<setw(10)<<Nevents<<" events "<<setw(12)<<Nbanks<<" banks ";
+	cout<<fixed<<setprecision(3)<<setw(10)<<1.0E6*t/(double)Nevents<<" us/event"<<endl;
+	cout<<" speedup: "<<setprecision(1)<<t/t_native<<endl;
+#else
+	cout<<"(compiled without HAVE_EVIO so the evioDOMTree path is not timed)"<<endl;
+#endif
+
+	return 0;
+}
+
+//-----------
+// GetTime
+//-----------
+double GetTime(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + 1.0E-9*(double)ts.tv_nsec;
+}
+
+//-----------
+// BenchNative
+//-----------
+bool BenchNative(double &t, uint64_t &Nevents, uint64_t &Nbanks, uint64_t &checksum)
+{
+	/// Walk every bank of every event, touching all of the data the
+	/// way a consumer would. For native byte order files, the data
+	/// is used in place. Otherwise, it is copied and swapped.
+	double start = GetTime();
+
+	Nevents = Nbanks = checksum = 0;
+	vector<uint32_t> buffer;
+	vector<JEVIOBankView> stack;
+	vector<JEVIOBankView> children;
+	vector<uint8_t> v8;
+	vector<uint16_t> v16;
+	vector<uint32_t> v32;
+	vector<uint64_t> v64;
+	for(int ipass=0; ipass<NPASSES; ipass++){
+
+		// Open (and index) the file on every pass, same as the DOM path
+		JEVIOFile file(FILENAME);
+		if(!file.IsOpen()){
+			cerr<<"Unable to open "<<FILENAME<<": "<<file.GetError()<<endl;
+			return false;
+		}
+		if(ipass==0){
+			cout<<FILENAME<<": version "<<file.GetVersion()<<(file.IsSwapped() ? " (byte swapped)":"");
+			cout<<"  "<<file.GetNevents()<<" events  "<<file.GetNblocks()<<" blocks"<<endl;
+		}
+
+		for(uint64_t ievent=0; ievent<file.GetNevents(); ievent++){
+			const uint32_t *words = file.GetEvent(ievent, buffer);
+			stack.clear();
+			stack.push_back(JEVIOBankView(words, JEVIOBankView::kBank, file.IsSwapped(), file.GetVersion()));
+			while(!stack.empty()){
+				JEVIOBankView bank = stack.back();
+				stack.pop_back();
+				Nbanks++;
+				checksum += bank.GetTag() + bank.GetNum();
+				if(bank.IsContainer()){
+					bank.GetChildren(children);
+					stack.insert(stack.end(), children.rbegin(), children.rend());
+					continue;
+				}
+				uint32_t N;
+				switch(bank.GetElementSize()){
+					case 1:
+						bank.GetData(v8);
+						for(uint32_t i=0; i<v8.size(); i++) checksum += v8[i];
+						break;
+					case 2:
+						bank.GetData(v16);
+						for(uint32_t i=0; i<v16.size(); i++) checksum += v16[i];
+						break;
+					case 8:
+						bank.GetData(v64);
+						for(uint32_t i=0; i<v64.size(); i++) checksum += v64[i];
+						break;
+					default:
+						if(const uint32_t *p = bank.GetDataPointer<uint32_t>(N)){
+							for(uint32_t i=0; i<N; i++) checksum += p[i];
+						}else{
+							bank.GetData(v32);
+							for(uint32_t i=0; i<v32.size(); i++) checksum += v32[i];
+						}
+				}
+			}
+			Nevents++;
+		}
+	}
+
+	t = GetTime() - start;
+	return true;
+}
+
+#ifdef HAVE_EVIO
+//-----------
+// BenchDOM
+//-----------
+bool BenchDOM(double &t, uint64_t &Nevents, uint64_t &Nbanks)
+{
+	/// Read the file the way JEventSourceEVIO does: create an
+	/// evioDOMTree for every event and get the list of all nodes.
+	double start = GetTime();
+
+	Nevents = Nbanks = 0;
+	for(int ipass=0; ipass<NPASSES; ipass++){
+		try{
+			evioFileChannel chan(FILENAME, "r");
+			chan.open();
+			while(chan.read()){
+				evioDOMTree *tree = new evioDOMTree(chan);
+				evioDOMNodeListP nodes = tree->getNodeList();
+				Nbanks += nodes->size();
+				delete tree;
+				Nevents++;
+			}
+			chan.close();
+		}catch(evioException &e){
+			cerr<<e.toString()<<endl;
+			return false;
+		}
+	}
+
+	t = GetTime() - start;
+	return true;
+}
+#endif // HAVE_EVIO
+
+//-----------
+// WriteSwapped
+//-----------
+bool WriteSwapped(void)
+{
+	/// Write a copy of FILENAME with the opposite byte order. Every
+	/// header word and 32-bit value is swapped as a whole. 16 and 64-bit
+	/// values are swapped individually and 8-bit data is left alone,
+	/// just as the evio library does. This works in either direction.
+	/// Events that span blocks are not supported.
+	JEVIOFile file(FILENAME);
+	if(!file.IsOpen()){
+		cerr<<"Unable to open "<<FILENAME<<": "<<file.GetError()<<endl;
+		return false;
+	}
+	// Element size to swap each word with. Default is to swap the
+	// entire word which is right for block headers and 32-bit data.
+	uint64_t Nwords = file.GetFileSize()/4;
+	const uint32_t *buff = file.GetBuffer();
+	vector<uint8_t> mode(Nwords, 4);
+
+	vector<uint32_t> buffer;
+	vector<JEVIOBankView> stack;
+	vector<JEVIOBankView> children;
+	for(uint64_t ievent=0; ievent<file.GetNevents(); ievent++){
+		if(file.EventSpansBlocks(ievent)){
+			cerr<<"Event "<<ievent<<" spans blocks. Can't swap this file."<<endl;
+			return false;
+		}
+		const uint32_t *words = file.GetEvent(ievent, buffer);
+		stack.clear();
+		stack.push_back(JEVIOBankView(words, JEVIOBankView::kBank, file.IsSwapped(), file.GetVersion()));
+		while(!stack.empty()){
+			JEVIOBankView bank = stack.back();
+			stack.pop_back();
+			if(bank.IsContainer()){
+				bank.GetChildren(children);
+				stack.insert(stack.end(), children.begin(), children.end());
+				continue;
+			}
+			uint64_t offset = bank.GetRawData() - buff;
+			for(uint32_t i=0; i<bank.GetNwords(); i++) mode[offset+i] = bank.GetElementSize();
+		}
+	}
+
+	vector<uint32_t> out(buff, buff+Nwords);
+	for(uint64_t i=0; i<Nwords; i++){
+		uint32_t w = out[i];
+		switch(mode[i]){
+			case 1: break;
+			case 2: out[i] = ((w & 0x00ff00ff)<<8) | ((w & 0xff00ff00)>>8); break;
+			case 8:
+				if(i+1<Nwords){
+					out[i]   = JEVIOBankView::Swap32(out[i+1]);
+					out[i+1] = JEVIOBankView::Swap32(w);
+					i++;
+				}
+				break;
+			default: out[i] = JEVIOBankView::Swap32(w);
+		}
+	}
+
+	ofstream ofs(SWAPPED_FILENAME.c_str(), ios::binary);
+	ofs.write((const char*)&out[0], out.size()*sizeof(uint32_t));
+	if(!ofs.good()){
+		cerr<<"Error writing "<<SWAPPED_FILENAME<<endl;
+		return false;
+	}
+	cout<<"Wrote byte swapped copy of "<<FILENAME<<" to "<<SWAPPED_FILENAME<<endl;
+
+	return true;
+}
+
+//-----------
+// ParseCommandLineArguments
+//-----------
+void ParseCommandLineArguments(int narg, char *argv[])
+{
+	if(narg==1)Usage();
+
+	for(int i=1;i<narg;i++){
+		if(argv[i][0] == '-'){
+			string arg = "";
+			if(i+1 < narg) arg  = argv[i+1];
+			switch(argv[i][1]){
+				case 'h':
+					Usage();
+					break;
+				case 'n':
+					if(arg==""){cout<<"'"<<argv[i][1]<<"' requires an argument!"<<endl; exit(0);}
+					NPASSES = atoi(arg.c_str());
+					i++;
+					break;
+				case 'w':
+					if(arg==""){cout<<"'"<<argv[i][1]<<"' requires an argument!"<<endl; exit(0);}
+					SWAPPED_FILENAME = arg;
+					i++;
+					break;
+			}
+		}else{
+			FILENAME = argv[i];
+		}
+	}
+
+	if(FILENAME==""){
+		cout<<"You must specify an EVIO file!"<<endl;
+		exit(-1);
+	}
+}
+
+//-----------
+// Usage
+//-----------
+void Usage(void)
+{
+	cout<<"Usage:"<<endl;
+	cout<<"       eviobench [options] file.evio"<<endl;
+	cout<<endl;
+	cout<<"Time reading all banks of all events using the native"<<endl;
+	cout<<"EVIO reader and (if available) the evioDOMTree."<<endl;
+	cout<<endl;
+	cout<<"Options:"<<endl;
+	cout<<endl;
+	cout<<"   -h              Print this message"<<endl;
+	cout<<"   -n passes       Number of times to read the file (def. 100)"<<endl;
+	cout<<"   -w outfile      Write byte swapped copy of file and exit"<<endl;
+	cout<<endl;
+
+	exit(0);
+}
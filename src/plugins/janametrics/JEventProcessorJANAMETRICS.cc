@@ -0,0 +1,302 @@
+// Author: David Lawrence  Oct. 18, 2026
+//
+//
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+using namespace std;
+
+#include <JANA/JApplication.h>
+#include "JEventProcessorJANAMETRICS.h"
+#include "JMetricsFormat.h"
+using namespace jana;
+
+
+// Routine used to allow us to register our JEventSourceGenerator
+extern "C"{
+void InitPlugin(JApplication *app){
+	InitJANAPlugin(app);
+	app->AddProcessor(new JEventProcessorJANAMETRICS());
+}
+} // "C"
+
+//------------------------------------------------------------------
+// LaunchMetricsThread
+//------------------------------------------------------------------
+void* LaunchMetricsThread(void *arg)
+{
+	// Leave process-wide signals (e.g. SIGINT) to the other threads
+	sigset_t set;
+	sigfillset(&set);
+	pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+	((JEventProcessorJANAMETRICS*)arg)->ServiceLoop();
+
+	return NULL;
+}
+
+//------------------------------------------------------------------
+// JEventProcessorJANAMETRICS
+//------------------------------------------------------------------
+JEventProcessorJANAMETRICS::JEventProcessorJANAMETRICS()
+{
+	listen_fd = -1;
+	thread_started = false;
+	stop = false;
+}
+
+//------------------------------------------------------------------
+// ~JEventProcessorJANAMETRICS
+//------------------------------------------------------------------
+JEventProcessorJANAMETRICS::~JEventProcessorJANAMETRICS()
+{
+	if(thread_started){
+		stop = true;
+		pthread_join(thr, NULL);
+	}
+	if(listen_fd >= 0) close(listen_fd);
+}
+
+//------------------------------------------------------------------
+// init
+//------------------------------------------------------------------
+jerror_t JEventProcessorJANAMETRICS::init(void)
+{
+	port = 9099;
+	filename = "";
+	file_format = "prometheus";
+	interval = 5.0;
+
+	JParameterManager *parms = app->GetJParameterManager();
+	parms->SetDefaultParameter("JANAMETRICS:PORT", port, "TCP port on the loopback interface to serve metrics on over HTTP (/metrics for Prometheus format, /metrics.json for JSON). Set to 0 to disable.");
+	parms->SetDefaultParameter("JANAMETRICS:FILE", filename, "If set, write metrics to this file every JANAMETRICS:INTERVAL seconds.");
+	parms->SetDefaultParameter("JANAMETRICS:FILE_FORMAT", file_format, "Format of JANAMETRICS:FILE. Either \"prometheus\" or \"json\".");
+	parms->SetDefaultParameter("JANAMETRICS:INTERVAL", interval, "Seconds between updates of JANAMETRICS:FILE.");
+	if(interval < 0.1) interval = 0.1;
+
+	// Everything is read from the statistics segment published by JApplication
+	bool STATS_SHM = true;
+	parms->SetDefaultParameter("JANA:STATS_SHM", STATS_SHM);
+	if(!STATS_SHM){
+		jerr<<"janametrics: JANA:STATS_SHM is turned off so no metrics will be available!"<<endl;
+		return NOERROR;
+	}
+
+	if(port>0 && !OpenPort()) return NOERROR;
+	if(listen_fd<0 && filename=="") return NOERROR;
+
+	stop = false;
+	if(pthread_create(&thr, NULL, LaunchMetricsThread, this) == 0){
+		thread_started = true;
+	}else{
+		jerr<<"janametrics: unable to launch thread!"<<endl;
+	}
+
+	return NOERROR;
+}
+
+//------------------------------------------------------------------
+// fini
+//------------------------------------------------------------------
+jerror_t JEventProcessorJANAMETRICS::fini(void)
+{
+	// Stop the thread here since the statistics segment
+	// is deleted shortly after this is called.
+	if(thread_started){
+		stop = true;
+		pthread_join(thr, NULL);
+		thread_started = false;
+	}
+	if(listen_fd >= 0) close(listen_fd);
+	listen_fd = -1;
+
+	// Leave the final numbers in the file
+	if(filename != "") WriteFile();
+
+	return NOERROR;
+}
+
+//------------------------------------------------------------------
+// OpenPort
+//------------------------------------------------------------------
+bool JEventProcessorJANAMETRICS::OpenPort(void)
+{
+	/// Open a listening socket on the loopback interface only. Exposing
+	/// the metrics more widely should be done with a proper proxy.
+	listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+	if(listen_fd < 0){
+		jerr<<"janametrics: socket: "<<strerror(errno)<<endl;
+		return false;
+	}
+	int one = 1;
+	setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(port);
+	if(bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr))!=0 || listen(listen_fd, 8)!=0){
+		jerr<<"janametrics: unable to listen on 127.0.0.1:"<<port<<" : "<<strerror(errno)<<endl;
+		close(listen_fd);
+		listen_fd = -1;
+		return false;
+	}
+	fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL) | O_NONBLOCK);
+
+	jout<<"janametrics: serving metrics at http://127.0.0.1:"<<port<<"/metrics"<<endl;
+
+	return true;
+}
+
+//------------------------------------------------------------------
+// ServiceLoop
+//------------------------------------------------------------------
+void JEventProcessorJANAMETRICS::ServiceLoop(void)
+{
+	double last_write = 0.0;
+	while(!stop){
+		if(listen_fd >= 0){
+			struct pollfd pfd;
+			pfd.fd = listen_fd;
+			pfd.events = POLLIN;
+			pfd.revents = 0;
+			if(poll(&pfd, 1, 250)>0 && (pfd.revents & POLLIN)){
+				int fd = accept(listen_fd, NULL, NULL);
+				if(fd >= 0){
+					HandleHTTP(fd);
+					close(fd);
+				}
+			}
+		}else{
+			usleep(250000);
+		}
+
+		if(filename!="" && (JMetricsFormat::GetTime()-last_write)>=interval){
+			WriteFile();
+			last_write = JMetricsFormat::GetTime();
+		}
+	}
+}
+
+//------------------------------------------------------------------
+// Format
+//------------------------------------------------------------------
+string JEventProcessorJANAMETRICS::Format(const string &format, bool &ok)
+{
+	/// Return the current metrics in the given format. The statistics
+	/// segment is only created once event processing starts so this
+	/// may not be able to return anything if called very early.
+	ok = false;
+	JStatsSegment *seg = app->GetStatsSegment();
+	if(!seg || !seg->Get()) return "statistics not available yet\n";
+
+	ok = true;
+	if(format == "json") return JMetricsFormat::JSON(seg->Get());
+	return JMetricsFormat::Prometheus(seg->Get());
+}
+
+//------------------------------------------------------------------
+// HandleHTTP
+//------------------------------------------------------------------
+void JEventProcessorJANAMETRICS::HandleHTTP(int fd)
+{
+	/// Read a single HTTP request from the socket and respond to it.
+	/// Only GET of /metrics (Prometheus) and /metrics.json (JSON) are
+	/// supported. Clients get at most 1 second to send the request.
+	string request;
+	char buff[1024];
+	for(int i=0; i<10 && request.find("\r\n\r\n")==string::npos && request.size()<8192; i++){
+		struct pollfd pfd;
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if(poll(&pfd, 1, 100) <= 0) continue;
+		ssize_t n = read(fd, buff, sizeof(buff));
+		if(n <= 0) break;
+		request.append(buff, n);
+	}
+
+	string method, path;
+	stringstream ss(request);
+	ss >> method >> path;
+	size_t pos = path.find('?');
+	if(pos != string::npos) path.erase(pos);
+
+	string status = "200 OK";
+	string content_type = "text/plain; version=0.0.4; charset=utf-8";
+	string body;
+	bool ok = true;
+	if(method != "GET"){
+		status = "405 Method Not Allowed";
+		body = "only GET is supported\n";
+	}else if(path=="/metrics" || path=="/"){
+		body = Format("prometheus", ok);
+	}else if(path=="/metrics.json" || path=="/json"){
+		content_type = "application/json";
+		body = Format("json", ok);
+	}else{
+		status = "404 Not Found";
+		body = "try /metrics or /metrics.json\n";
+	}
+	if(!ok){
+		status = "503 Service Unavailable";
+		content_type = "text/plain; charset=utf-8";
+	}
+
+	stringstream response;
+	response << "HTTP/1.0 " << status << "\r\n";
+	response << "Content-Type: " << content_type << "\r\n";
+	response << "Content-Length: " << body.size() << "\r\n";
+	response << "Connection: close\r\n";
+	response << "\r\n";
+	response << body;
+
+	string str = response.str();
+	const char *ptr = str.c_str();
+	size_t left = str.size();
+	while(left > 0){
+		ssize_t n = write(fd, ptr, left);
+		if(n < 0 && errno==EINTR) continue;
+		if(n <= 0) break;
+		ptr += n;
+		left -= n;
+	}
+}
+
+//------------------------------------------------------------------
+// WriteFile
+//------------------------------------------------------------------
+void JEventProcessorJANAMETRICS::WriteFile(void)
+{
+	/// Write the metrics to a temporary file and then rename it so
+	/// readers never see a partially written file.
+	bool ok;
+	string body = Format(file_format, ok);
+	if(!ok) return;
+
+	string tmpname = filename + ".tmp";
+	ofstream ofs(tmpname.c_str());
+	if(!ofs.is_open()){
+		jerr<<"janametrics: unable to open "<<tmpname<<" for writing"<<endl;
+		return;
+	}
+	ofs << body;
+	ofs.close();
+	if(rename(tmpname.c_str(), filename.c_str()) != 0){
+		jerr<<"janametrics: unable to rename "<<tmpname<<" to "<<filename<<" : "<<strerror(errno)<<endl;
+	}
+}
+
@@ -0,0 +1,51 @@
+// Author: David Lawrence  Oct. 18, 2026
+//
+//
+
+// This plugin exports the JANA processing statistics (event counts,
+// rates, per-thread and per-factory counters, memory usage) for use
+// by monitoring systems. They can be pulled over HTTP from a port on
+// the loopback interface and/or written periodically to a file. Both
+// Prometheus text format and JSON are supported. See README for details.
+
+#include <pthread.h>
+
+#include <string>
+using std::string;
+
+#include <JANA/JEventProcessor.h>
+#include <JANA/JEventLoop.h>
+using namespace jana;
+
+class JEventProcessorJANAMETRICS:public JEventProcessor
+{
+	public:
+		JEventProcessorJANAMETRICS();
+		virtual ~JEventProcessorJANAMETRICS();
+		const char* className(void){return "JEventProcessorJANAMETRICS";}
+
+		jerror_t init(void);							///< Called once at program start.
+		jerror_t brun(JEventLoop *loop, int32_t runnumber){return NOERROR;}	///< Called everytime a new run number is detected.
+		jerror_t evnt(JEventLoop *loop, uint64_t eventnumber){return NOERROR;}	///< Called every event.
+		jerror_t erun(void){return NOERROR;};	///< Called everytime run number changes, provided brun has been called.
+		jerror_t fini(void);							///< Called after last event of last event source has been processed.
+
+		void ServiceLoop(void);
+
+	protected:
+		int port;
+		string filename;
+		string file_format;
+		double interval;
+
+		int listen_fd;
+		pthread_t thr;
+		bool thread_started;
+		volatile bool stop;
+
+		bool OpenPort(void);
+		void HandleHTTP(int fd);
+		void WriteFile(void);
+		string Format(const string &format, bool &ok);
+};
+
@@ -0,0 +1,264 @@
+// $Id$
+//
+//    File: JMetricsFormat.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <unistd.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include <sstream>
+#include <vector>
+#include <iomanip>
+using namespace std;
+
+#include "JMetricsFormat.h"
+
+//---------------------------------
+// GetTime
+//---------------------------------
+double JMetricsFormat::GetTime(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + 1.0E-6*(double)tv.tv_usec;
+}
+
+//---------------------------------
+// GetRSS
+//---------------------------------
+double JMetricsFormat::GetRSS(void)
+{
+	/// Return the resident set size of this process in bytes. On
+	/// systems without /proc, the peak RSS is returned instead.
+	FILE *f = fopen("/proc/self/statm", "r");
+	if(f){
+		unsigned long size=0, resident=0;
+		int n = fscanf(f, "%lu %lu", &size, &resident);
+		fclose(f);
+		if(n == 2) return (double)resident*(double)sysconf(_SC_PAGESIZE);
+	}
+
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return (double)usage.ru_maxrss;        // bytes on Mac OS X
+#else
+	return (double)usage.ru_maxrss*1024.0; // kB elsewhere
+#endif
+}
+
+//---------------------------------
+// SplitNameTag
+//---------------------------------
+void JMetricsFormat::SplitNameTag(const string &nametag, string &name, string &tag)
+{
+	size_t pos = nametag.find(':');
+	name = nametag.substr(0, pos);
+	tag = pos==string::npos ? "":nametag.substr(pos+1);
+}
+
+//---------------------------------
+// EscapeLabel
+//---------------------------------
+string JMetricsFormat::EscapeLabel(const string &s)
+{
+	string ret;
+	for(unsigned int i=0; i<s.size(); i++){
+		switch(s[i]){
+			case '\\': ret += "\\\\"; break;
+			case '"' : ret += "\\\""; break;
+			case '\n': ret += "\\n";  break;
+			default  : ret += s[i];
+		}
+	}
+	return ret;
+}
+
+//---------------------------------
+// EscapeJSON
+//---------------------------------
+string JMetricsFormat::EscapeJSON(const string &s)
+{
+	string ret;
+	for(unsigned int i=0; i<s.size(); i++){
+		unsigned char c = s[i];
+		switch(c){
+			case '\\': ret += "\\\\"; break;
+			case '"' : ret += "\\\""; break;
+			case '\n': ret += "\\n";  break;
+			case '\t': ret += "\\t";  break;
+			default:
+				if(c < 0x20){
+					char buff[8];
+					sprintf(buff, "\\u%04x", c);
+					ret += buff;
+				}else{
+					ret += c;
+				}
+		}
+	}
+	return ret;
+}
+
+//---------------------------------
+// Prometheus
+//---------------------------------
+string JMetricsFormat::Prometheus(const jstats_t *stats)
+{
+	/// Format the statistics in the Prometheus text exposition format
+	/// (version 0.0.4).
+	stringstream ss;
+	ss << setprecision(12);
+
+	double now = GetTime();
+
+	ss << "# HELP jana_events_processed_total Events processed." << endl;
+	ss << "# TYPE jana_events_processed_total counter" << endl;
+	ss << "jana_events_processed_total " << stats->NEvents << endl;
+	ss << "# HELP jana_events_read_total Events read from event sources." << endl;
+	ss << "# TYPE jana_events_read_total counter" << endl;
+	ss << "jana_events_read_total " << stats->NEvents_read << endl;
+	ss << "# HELP jana_events_lost_total Events lost due to stalled threads." << endl;
+	ss << "# TYPE jana_events_lost_total counter" << endl;
+	ss << "jana_events_lost_total " << stats->Nlost_events << endl;
+	ss << "# HELP jana_event_rate_hz Instantaneous event processing rate." << endl;
+	ss << "# TYPE jana_event_rate_hz gauge" << endl;
+	ss << "jana_event_rate_hz " << stats->rate_instantaneous << endl;
+	ss << "# HELP jana_event_rate_average_hz Average event processing rate." << endl;
+	ss << "# TYPE jana_event_rate_average_hz gauge" << endl;
+	ss << "jana_event_rate_average_hz " << stats->rate_average << endl;
+	ss << "# HELP jana_threads Processing threads currently running." << endl;
+	ss << "# TYPE jana_threads gauge" << endl;
+	ss << "jana_threads " << stats->Nthreads_running << endl;
+	ss << "# HELP jana_threads_requested Processing threads requested." << endl;
+	ss << "# TYPE jana_threads_requested gauge" << endl;
+	ss << "jana_threads_requested " << stats->Nthreads << endl;
+	ss << "# HELP jana_event_buffer_events Events waiting in the event buffer." << endl;
+	ss << "# TYPE jana_event_buffer_events gauge" << endl;
+	ss << "jana_event_buffer_events " << stats->event_buffer_size << endl;
+	ss << "# HELP jana_event_buffer_max_events Maximum events allowed in the event buffer." << endl;
+	ss << "# TYPE jana_event_buffer_max_events gauge" << endl;
+	ss << "jana_event_buffer_max_events " << stats->event_buffer_max << endl;
+	ss << "# HELP jana_resident_memory_bytes Resident set size of process." << endl;
+	ss << "# TYPE jana_resident_memory_bytes gauge" << endl;
+	ss << "jana_resident_memory_bytes " << GetRSS() << endl;
+	ss << "# HELP jana_uptime_seconds Time since event processing started." << endl;
+	ss << "# TYPE jana_uptime_seconds gauge" << endl;
+	ss << "jana_uptime_seconds " << now - stats->start_time << endl;
+	ss << "# HELP jana_stats_age_seconds Time since global statistics were last updated." << endl;
+	ss << "# TYPE jana_stats_age_seconds gauge" << endl;
+	ss << "jana_stats_age_seconds " << now - stats->update_time << endl;
+
+	// Per-thread
+	ss << "# HELP jana_thread_events_processed_total Events processed by thread." << endl;
+	ss << "# TYPE jana_thread_events_processed_total counter" << endl;
+	for(unsigned int i=0; i<JSTATS_MAX_THREADS; i++){
+		const jstats_thread_t &t = stats->threads[i];
+		if(t.in_use) ss << "jana_thread_events_processed_total{thread=\"" << t.thread_index << "\"} " << t.Nevents << endl;
+	}
+	ss << "# HELP jana_thread_event_rate_hz Instantaneous event processing rate of thread." << endl;
+	ss << "# TYPE jana_thread_event_rate_hz gauge" << endl;
+	for(unsigned int i=0; i<JSTATS_MAX_THREADS; i++){
+		const jstats_thread_t &t = stats->threads[i];
+		if(t.in_use) ss << "jana_thread_event_rate_hz{thread=\"" << t.thread_index << "\"} " << t.rate_instantaneous << endl;
+	}
+	ss << "# HELP jana_thread_heartbeat_seconds Time since thread last finished an event." << endl;
+	ss << "# TYPE jana_thread_heartbeat_seconds gauge" << endl;
+	for(unsigned int i=0; i<JSTATS_MAX_THREADS; i++){
+		const jstats_thread_t &t = stats->threads[i];
+		if(t.in_use) ss << "jana_thread_heartbeat_seconds{thread=\"" << t.thread_index << "\"} " << t.heartbeat << endl;
+	}
+
+	// Per-factory
+	unsigned int Nfactories = stats->Nfactories;
+	if(Nfactories > JSTATS_MAX_FACTORIES) Nfactories = JSTATS_MAX_FACTORIES;
+	vector<string> labels;
+	for(unsigned int i=0; i<Nfactories; i++){
+		string name, tag;
+		SplitNameTag(stats->factories[i].name, name, tag);
+		labels.push_back("{factory=\"" + EscapeLabel(name) + "\",tag=\"" + EscapeLabel(tag) + "\"}");
+	}
+	ss << "# HELP jana_factory_calls_total Requests for factory data." << endl;
+	ss << "# TYPE jana_factory_calls_total counter" << endl;
+	for(unsigned int i=0; i<Nfactories; i++) ss << "jana_factory_calls_total" << labels[i] << " " << stats->factories[i].Ncalls << endl;
+	ss << "# HELP jana_factory_evnt_calls_total Calls to factory evnt method." << endl;
+	ss << "# TYPE jana_factory_evnt_calls_total counter" << endl;
+	for(unsigned int i=0; i<Nfactories; i++) ss << "jana_factory_evnt_calls_total" << labels[i] << " " << stats->factories[i].Ngencalls << endl;
+	ss << "# HELP jana_factory_evnt_seconds_total Time spent in factory evnt method (including nested factories)." << endl;
+	ss << "# TYPE jana_factory_evnt_seconds_total counter" << endl;
+	for(unsigned int i=0; i<Nfactories; i++) ss << "jana_factory_evnt_seconds_total" << labels[i] << " " << 1.0E-9*(double)stats->factories[i].evnt_ns << endl;
+
+	return ss.str();
+}
+
+//---------------------------------
+// JSON
+//---------------------------------
+string JMetricsFormat::JSON(const jstats_t *stats)
+{
+	/// Format the statistics as a single JSON object.
+	stringstream ss;
+	ss << setprecision(12);
+
+	double now = GetTime();
+
+	ss << "{" << endl;
+	ss << "  \"pid\": " << stats->pid << "," << endl;
+	ss << "  \"command\": \"" << EscapeJSON(stats->command) << "\"," << endl;
+	ss << "  \"source\": \"" << EscapeJSON(stats->source_name) << "\"," << endl;
+	ss << "  \"time\": " << now << "," << endl;
+	ss << "  \"uptime_seconds\": " << now - stats->start_time << "," << endl;
+	ss << "  \"events_processed\": " << stats->NEvents << "," << endl;
+	ss << "  \"events_read\": " << stats->NEvents_read << "," << endl;
+	ss << "  \"events_lost\": " << stats->Nlost_events << "," << endl;
+	ss << "  \"rate_hz\": " << stats->rate_instantaneous << "," << endl;
+	ss << "  \"rate_average_hz\": " << stats->rate_average << "," << endl;
+	ss << "  \"threads\": " << stats->Nthreads_running << "," << endl;
+	ss << "  \"threads_requested\": " << stats->Nthreads << "," << endl;
+	ss << "  \"event_buffer_events\": " << stats->event_buffer_size << "," << endl;
+	ss << "  \"event_buffer_max_events\": " << stats->event_buffer_max << "," << endl;
+	ss << "  \"resident_memory_bytes\": " << GetRSS() << "," << endl;
+	ss << "  \"finished\": " << (stats->finished ? "true":"false") << "," << endl;
+
+	ss << "  \"thread_stats\": [";
+	bool first = true;
+	for(unsigned int i=0; i<JSTATS_MAX_THREADS; i++){
+		const jstats_thread_t &t = stats->threads[i];
+		if(!t.in_use) continue;
+		ss << (first ? "":",") << endl;
+		ss << "    {\"thread\": " << t.thread_index;
+		ss << ", \"events_processed\": " << t.Nevents;
+		ss << ", \"rate_hz\": " << t.rate_instantaneous;
+		ss << ", \"rate_average_hz\": " << t.rate_integrated;
+		ss << ", \"last_event_seconds\": " << t.last_event_time;
+		ss << ", \"heartbeat_seconds\": " << t.heartbeat;
+		ss << ", \"run\": " << t.run_number;
+		ss << ", \"event\": " << t.event_number << "}";
+		first = false;
+	}
+	ss << endl << "  ]," << endl;
+
+	ss << "  \"factories\": [";
+	unsigned int Nfactories = stats->Nfactories;
+	if(Nfactories > JSTATS_MAX_FACTORIES) Nfactories = JSTATS_MAX_FACTORIES;
+	for(unsigned int i=0; i<Nfactories; i++){
+		const jstats_factory_t &f = stats->factories[i];
+		string name, tag;
+		SplitNameTag(f.name, name, tag);
+		ss << (i==0 ? "":",") << endl;
+		ss << "    {\"factory\": \"" << EscapeJSON(name) << "\"";
+		ss << ", \"tag\": \"" << EscapeJSON(tag) << "\"";
+		ss << ", \"calls\": " << f.Ncalls;
+		ss << ", \"evnt_calls\": " << f.Ngencalls;
+		ss << ", \"evnt_seconds\": " << 1.0E-9*(double)f.evnt_ns << "}";
+	}
+	ss << endl << "  ]" << endl;
+	ss << "}" << endl;
+
+	return ss.str();
+}
+
@@ -0,0 +1,37 @@
+// $Id$
+//
+//    File: JMetricsFormat.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JMetricsFormat_
+#define _JMetricsFormat_
+
+#include <string>
+using std::string;
+
+#include <JANA/JStatsSegment.h>
+using namespace jana;
+
+/// Routines to format a snapshot of the JANA statistics segment (see
+/// JStatsSegment) as either Prometheus text exposition format or JSON.
+/// Only the shared memory block is read so formatting never waits on
+/// any lock held by the processing threads.
+
+class JMetricsFormat{
+	public:
+		static string Prometheus(const jstats_t *stats);
+		static string JSON(const jstats_t *stats);
+
+		static double GetRSS(void);
+		static double GetTime(void);
+
+	protected:
+		static string EscapeLabel(const string &s);
+		static string EscapeJSON(const string &s);
+		static void SplitNameTag(const string &nametag, string &name, string &tag);
+};
+
+#endif // _JMetricsFormat_
+
@@ -7,12 +7,10 @@
 
 #include <iostream>
 #include <iomanip>
-#include <fstream>
 using namespace std;
 
 #include <JANA/JApplication.h>
 #include "JEventProcessorJANAPFM.h"
-#include "JFactoryGenerator_JPMUCounts.h"
 using namespace jana;
 
 
@@ -21,64 +19,61 @@ extern "C"{
 void InitPlugin(JApplication *app){
 	InitJANAPlugin(app);
 
-	// Initialize PFM system
-	int err = pfm_initialize();
-	switch(err){
-		case PFM_SUCCESS:
-			cout<<"--->Initialized PMU"<<endl;
-			break;
-		case PFM_ERR_NOTSUPP:
-			cout<<"--->PMU support unavailable"<<endl;
-			return;
-		default:
-			cout<<"--->Unknown PMU response: "<<err<<endl;
-			return ;
-	}
-	
-	// Add processor and factory generator
+	// The counters are reported in the factory report so make sure it is on
+	app->SetPrintFactoryReport(true);
+
 	app->AddProcessor(new JEventProcessorJANAPFM());
-	app->AddFactoryGenerator(new JFactoryGenerator_JPMUCounts());
 }
 } // "C"
 
 //------------------------------------------------------------------
-// init 
+// ~JEventProcessorJANAPFM
+//------------------------------------------------------------------
+JEventProcessorJANAPFM::~JEventProcessorJANAPFM()
+{
+	for(unsigned int i=0; i<monitors.size(); i++) delete monitors[i];
+}
+
+//------------------------------------------------------------------
+// init
 //------------------------------------------------------------------
 jerror_t JEventProcessorJANAPFM::init(void)
 {
+	allow_hardware = true;
+	app->GetJParameterManager()->SetDefaultParameter("JANAPFM:HARDWARE", allow_hardware, "Set to 0 to only use software counters (task-clock, page-faults, context-switches) even if the hardware PMU is available");
+
 	// Initialize our mutex
 	pthread_mutex_init(&mutex, NULL);
-	
+
 	return NOERROR;
 }
 
 //------------------------------------------------------------------
 // brun
 //------------------------------------------------------------------
-jerror_t JEventProcessorJANAPFM::brun(JEventLoop *loop, int runnumber)
-{	
+jerror_t JEventProcessorJANAPFM::brun(JEventLoop *loop, int32_t runnumber)
+{
 	return NOERROR;
 }
 
 //------------------------------------------------------------------
 // evnt
 //------------------------------------------------------------------
-jerror_t JEventProcessorJANAPFM::evnt(JEventLoop *loop, int eventnumber)
+jerror_t JEventProcessorJANAPFM::evnt(JEventLoop *loop, uint64_t eventnumber)
 {
-	vector<const JPMUCounts*> jpmucounts;
-	loop->Get(jpmucounts);
-
-	// Loop over JPMUCounts objects
-	for(unsigned int i=0; i<jpmucounts.size(); i++){
-		const JPMUCounts *jpmucount = jpmucounts[i];
-	
-		// Look for an entry for this event in pmu_counts
-		pair<string,pthread_t> key(jpmucount->name, pthread_self());
-		pmu_counts_t &pc = pmu_counts[key];
-		pc.counts += jpmucount->counts;
-		pc.time_enabled += jpmucount->time_enabled;
-		pc.time_running += jpmucount->time_running;
-		pc.N++;
+	// Attach a monitor to this thread's JEventLoop the first time we see
+	// it. The counters themselves are opened by the monitor from within
+	// this thread on the next factory call. Note that this means the first
+	// event in each thread is not counted. This is actually desirable since
+	// the first event often involves many initializations which will have
+	// a different footprint than the rest of the events that follow.
+	if(loop->GetFactoryMonitor() == NULL){
+		JFactoryMonitorPFM *monitor = new JFactoryMonitorPFM(allow_hardware);
+		loop->SetFactoryMonitor(monitor);
+
+		pthread_mutex_lock(&mutex);
+		monitors.push_back(monitor);
+		pthread_mutex_unlock(&mutex);
 	}
 
 	return NOERROR;
@@ -89,38 +84,22 @@ jerror_t JEventProcessorJANAPFM::evnt(JEventLoop *loop, int eventnumber)
 //------------------------------------------------------------------
 jerror_t JEventProcessorJANAPFM::fini(void)
 {
-
-	// We want the output file to use thread numbers 0,1,2,... instead
-	// of the opaque values returned by pthread_self. Make a map of
-	// these here.
-	map<pthread_t,int> thr_map;
-	map<pair<string,pthread_t>, pmu_counts_t>::iterator iter;
-	for(iter=pmu_counts.begin(); iter!=pmu_counts.end(); iter++){
-		pthread_t thr = iter->first.second;
-		
-		map<pthread_t,int>::iterator iter = thr_map.find(thr);
-		if(iter==thr_map.end()){
-			thr_map[thr] = thr_map.size();
+	// Let the user know which type of counters were actually used
+	unsigned int Nhardware = 0;
+	unsigned int Nsoftware = 0;
+	pthread_mutex_lock(&mutex);
+	for(unsigned int i=0; i<monitors.size(); i++){
+		if(!monitors[i]->IsActive()) continue;
+		if(monitors[i]->GetCounters().IsHardware()){
+			Nhardware++;
+		}else{
+			Nsoftware++;
 		}
 	}
+	pthread_mutex_unlock(&mutex);
 
-	// Open output file
-	string ofname = "janapfm.out";
-	cout<<endl;
-	cout<<"Writing Perfomance Monitor info. to \""<<ofname<<"\""<<endl;
-	ofstream of(ofname.c_str());
-
-	of<<"# thread Nevents counts time_enabled  time_running  name"<<endl;
-
-	// Write results
-	for(iter=pmu_counts.begin(); iter!=pmu_counts.end(); iter++){
-		pmu_counts_t &pc = iter->second;
-		string name = iter->first.first;
-		pthread_t thr = iter->first.second;
-		of<<thr_map[thr]<<" "<<pc.N<<" "<<pc.counts<<" "<<pc.time_enabled<<" "<<pc.time_running<<" "<<name<<endl;
-	}
-	
-	of.close();
+	jout<<"janapfm: performance counters recorded for "<<Nhardware<<" thread(s) using hardware counters and ";
+	jout<<Nsoftware<<" thread(s) using software counters. See factory report for results."<<endl;
 
 	return NOERROR;
 }
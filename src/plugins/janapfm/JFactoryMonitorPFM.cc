@@ -0,0 +1,71 @@
+// $Id$
+//
+//    File: JFactoryMonitorPFM.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <iostream>
+using namespace std;
+
+#include <JANA/JStreamLog.h>
+
+#include "JFactoryMonitorPFM.h"
+
+//---------------------------------
+// JFactoryMonitorPFM    (Constructor)
+//---------------------------------
+JFactoryMonitorPFM::JFactoryMonitorPFM(bool allow_hardware):counters(allow_hardware)
+{
+	tried_open = false;
+	depth = 0;
+}
+
+//---------------------------------
+// EvntStart
+//---------------------------------
+void JFactoryMonitorPFM::EvntStart(JFactory_base *factory)
+{
+	// The counters must be opened from the thread they will count so
+	// this is deferred until the first factory call in that thread.
+	if(!tried_open){
+		tried_open = true;
+		if(!counters.Open()) jerr<<"janapfm: unable to open performance counters: "<<counters.GetError()<<endl;
+	}
+	if(!counters.IsOpen()) return;
+
+	if(depth >= stack.size()) stack.resize(depth+1);
+	frame_t &frame = stack[depth++];
+	frame.factory = factory;
+	frame.children.assign(counters.GetNames().size(), 0);
+
+	// Read last so as little of our own overhead is counted as possible
+	counters.Read(frame.start);
+}
+
+//---------------------------------
+// EvntEnd
+//---------------------------------
+void JFactoryMonitorPFM::EvntEnd(JFactory_base *factory)
+{
+	if(!counters.IsOpen()) return;
+	if(!counters.Read(now)) return;
+
+	// Find the matching frame. This should always be the top one,
+	// but be forgiving in case something was skipped.
+	int idx = (int)depth - 1;
+	while(idx>=0 && stack[idx].factory!=factory) idx--;
+	if(idx < 0) return;
+	depth = idx;
+
+	frame_t &frame = stack[idx];
+	frame_t *parent = idx>0 ? &stack[idx-1]:NULL;
+	const vector<string> &names = counters.GetNames();
+	for(unsigned int i=0; i<names.size(); i++){
+		uint64_t delta = now[i] - frame.start[i];
+		uint64_t self = delta>frame.children[i] ? delta-frame.children[i]:0;
+		factory->AddPerfCount(names[i], self);
+		if(parent) parent->children[i] += delta;
+	}
+}
+
@@ -0,0 +1,51 @@
+// $Id$
+//
+//    File: JFactoryMonitorPFM.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JFactoryMonitorPFM_
+#define _JFactoryMonitorPFM_
+
+#include <JANA/JFactoryMonitor.h>
+#include <JANA/JFactory_base.h>
+using namespace jana;
+
+#include "JPerfCounterGroup.h"
+
+/// Reads a JPerfCounterGroup before and after every factory evnt call
+/// for a single JEventLoop (thread) and adds the difference to the
+/// factory's performance counters (see JFactory_base::AddPerfCount).
+/// When factories are nested, the counts accumulated while in the inner
+/// factory are subtracted from the outer one so that each factory is only
+/// charged for its own work.
+
+class JFactoryMonitorPFM:public JFactoryMonitor{
+	public:
+		JFactoryMonitorPFM(bool allow_hardware=true);
+		virtual ~JFactoryMonitorPFM(){}
+
+		void EvntStart(JFactory_base *factory);
+		void EvntEnd(JFactory_base *factory);
+
+		bool IsActive(void) const {return counters.IsOpen();}
+		const JPerfCounterGroup& GetCounters(void) const {return counters;}
+
+	protected:
+		class frame_t{
+			public:
+				JFactory_base *factory;
+				vector<uint64_t> start;
+				vector<uint64_t> children;
+		};
+
+		JPerfCounterGroup counters;
+		bool tried_open;
+		vector<frame_t> stack;
+		unsigned int depth;      // stack entries in use (stack is never shrunk to avoid reallocating)
+		vector<uint64_t> now;
+};
+
+#endif // _JFactoryMonitorPFM_
+
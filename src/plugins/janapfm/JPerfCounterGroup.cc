@@ -0,0 +1,177 @@
+// $Id$
+//
+//    File: JPerfCounterGroup.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif // __linux__
+
+#include "JPerfCounterGroup.h"
+
+#ifdef __linux__
+// glibc does not provide a wrapper for this
+static long perf_event_open(struct perf_event_attr *attr, pid_t pid, int cpu, int group_fd, unsigned long flags)
+{
+	return syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+typedef struct{
+	uint32_t type;
+	uint64_t config;
+	const char *name;
+}counter_def_t;
+
+static counter_def_t hardware_counters[] = {
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,   "cycles"},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"},
+	{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "cache-misses"},
+	{0, 0, NULL}
+};
+
+static counter_def_t software_counters[] = {
+	{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK,       "task-clock"},
+	{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS,      "page-faults"},
+	{PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "context-switches"},
+	{0, 0, NULL}
+};
+#endif // __linux__
+
+//---------------------------------
+// JPerfCounterGroup    (Constructor)
+//---------------------------------
+JPerfCounterGroup::JPerfCounterGroup(bool allow_hardware)
+{
+	this->allow_hardware = allow_hardware;
+	hardware = false;
+}
+
+//---------------------------------
+// ~JPerfCounterGroup    (Destructor)
+//---------------------------------
+JPerfCounterGroup::~JPerfCounterGroup()
+{
+	Close();
+}
+
+//---------------------------------
+// Open
+//---------------------------------
+bool JPerfCounterGroup::Open(void)
+{
+	/// Open the counters for the calling thread. Hardware counters
+	/// are tried first (if allowed) and if that fails, software
+	/// counters are used. Returns true if any counters were opened.
+	Close();
+	if(allow_hardware && OpenGroup(true)) return true;
+
+	return OpenGroup(false);
+}
+
+//---------------------------------
+// OpenGroup
+//---------------------------------
+bool JPerfCounterGroup::OpenGroup(bool use_hardware)
+{
+#ifdef __linux__
+	counter_def_t *defs = use_hardware ? hardware_counters:software_counters;
+
+	for(int i=0; defs[i].name!=NULL; i++){
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size           = sizeof(attr);
+		attr.type           = defs[i].type;
+		attr.config         = defs[i].config;
+		attr.disabled       = fds.empty() ? 1:0; // leader starts disabled so all start together
+		attr.exclude_kernel = use_hardware ? 1:0; // software events (e.g. context switches) happen in the kernel
+		attr.exclude_hv     = 1;
+		attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		int group_fd = fds.empty() ? -1:fds[0];
+		int fd = (int)perf_event_open(&attr, 0, -1, group_fd, 0);
+		if(fd<0 && !attr.exclude_kernel && (errno==EACCES || errno==EPERM)){
+			// Counting in the kernel is not allowed (perf_event_paranoid).
+			// Context switches would then always be 0 so leave them out.
+			if(defs[i].config == PERF_COUNT_SW_CONTEXT_SWITCHES) continue;
+			attr.exclude_kernel = 1;
+			fd = (int)perf_event_open(&attr, 0, -1, group_fd, 0);
+		}
+		if(fd < 0){
+			// If the leader could not be opened then give up on this set
+			if(fds.empty()){
+				error = string("perf_event_open(") + defs[i].name + "): " + strerror(errno);
+				return false;
+			}
+			continue;
+		}
+		fds.push_back(fd);
+		names.push_back(defs[i].name);
+	}
+
+	if(fds.empty()) return false;
+
+	// Read format is: nr, time_enabled, time_running, value[nr]
+	buff.resize(3 + fds.size());
+	hardware = use_hardware;
+
+	ioctl(fds[0], PERF_EVENT_IOC_RESET,  PERF_IOC_FLAG_GROUP);
+	ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+	return true;
+#else
+	error = "perf_event_open is only available on Linux";
+	return false;
+#endif // __linux__
+}
+
+//---------------------------------
+// Close
+//---------------------------------
+void JPerfCounterGroup::Close(void)
+{
+	// Close members before the leader
+	for(int i=(int)fds.size()-1; i>=0; i--) close(fds[i]);
+	fds.clear();
+	names.clear();
+	hardware = false;
+}
+
+//---------------------------------
+// Read
+//---------------------------------
+bool JPerfCounterGroup::Read(vector<uint64_t> &values)
+{
+	/// Read the current values of all counters in the group. If the
+	/// kernel had to multiplex the PMU so the group was only counting
+	/// for part of the time, the values are scaled up to estimate the
+	/// full count. The values are in the same order as GetNames().
+	if(fds.empty()) return false;
+
+	ssize_t bytes = read(fds[0], &buff[0], buff.size()*sizeof(uint64_t));
+	if(bytes < (ssize_t)(3*sizeof(uint64_t))) return false;
+
+	uint64_t nr           = buff[0];
+	uint64_t time_enabled = buff[1];
+	uint64_t time_running = buff[2];
+	if(nr > fds.size()) nr = fds.size();
+
+	values.resize(fds.size());
+	for(uint64_t i=0; i<nr; i++){
+		uint64_t v = buff[3+i];
+		if(time_running>0 && time_running<time_enabled){
+			v = (uint64_t)((double)v*(double)time_enabled/(double)time_running);
+		}
+		values[i] = v;
+	}
+
+	return true;
+}
+
@@ -0,0 +1,58 @@
+// $Id$
+//
+//    File: JPerfCounterGroup.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JPerfCounterGroup_
+#define _JPerfCounterGroup_
+
+#include <stdint.h>
+
+#include <vector>
+#include <string>
+using std::vector;
+using std::string;
+
+/// A small group of performance counters for the calling thread
+/// opened directly via the perf_event_open system call. The counters
+/// are opened as a single group so they are scheduled on the PMU
+/// together and can be read with a single read() call.
+///
+/// The hardware counters cycles, instructions and cache-misses are
+/// tried first. If the PMU is not accessible (e.g. in a VM or when
+/// /proc/sys/kernel/perf_event_paranoid forbids it) then the software
+/// counters task-clock, page-faults and context-switches are used
+/// instead. Individual group members that cannot be opened are
+/// simply dropped.
+///
+/// This is only functional on Linux. On other platforms Open() always
+/// returns false.
+
+class JPerfCounterGroup{
+	public:
+		JPerfCounterGroup(bool allow_hardware=true);
+		virtual ~JPerfCounterGroup();
+
+		bool Open(void);   ///< Open counters for the calling thread
+		void Close(void);
+		bool IsOpen(void) const {return !fds.empty();}
+		bool IsHardware(void) const {return hardware;}
+		const vector<string>& GetNames(void) const {return names;}
+		bool Read(vector<uint64_t> &values); ///< Read current (scaled) values of all counters
+		const string& GetError(void) const {return error;}
+
+	protected:
+		bool OpenGroup(bool use_hardware);
+
+		bool allow_hardware;
+		bool hardware;
+		vector<int> fds;    // fds[0] is the group leader
+		vector<string> names;
+		vector<uint64_t> buff;
+		string error;
+};
+
+#endif // _JPerfCounterGroup_
+
@@ -403,6 +403,18 @@ TreeInfo* JEventProcessor_janaroot::GetTreeInfo(JFactory_base *fac)
 		tinfo->branches.push_back(branch);
 	}
 	
+	// If the class describes its members with JOBJECT_FIELDS then FillTree
+	// can copy the values straight out of the objects instead of parsing
+	// them from strings. This is only done if every field made it into
+	// the tree so that the fields line up with the branches.
+	tinfo->fields = NULL;
+	vector<const JObject*> objs;
+	fac->GetExistingObjects(objs);
+	if(!objs.empty()){
+		const vector<JField> *fields = objs[0]->GetFields();
+		if(fields!=NULL && fields->size()==tinfo->types.size()) tinfo->fields = fields;
+	}
+
 	// Inform user if nothing useful in the object is found
 	if(tinfo->item_sizes.size()<1){
 		_DBG_<<"No usable data members in \""<<tname<<"\"!"<<endl;
@@ -435,6 +447,12 @@ TreeInfo* JEventProcessor_janaroot::GetTreeInfo(JFactory_base *fac)
 void JEventProcessor_janaroot::FillTree(JFactory_base *fac, TreeInfo *tinfo)
 {
 	// n.b. This gets called while inside the ROOT mutex so it is not locked again here
+
+	// Use the binary values if the class has them
+	if(tinfo->fields){
+		FillTreeFromFields(fac, tinfo);
+		return;
+	}
 	
 	// Get data in form of strings from factory
 	vector<vector<pair<string,string> > > items;
@@ -524,3 +542,75 @@ void JEventProcessor_janaroot::FillTree(JFactory_base *fac, TreeInfo *tinfo)
 	tinfo->branches[0]->SetAddress((void*)tinfo->Nptr);
 }
 
+//------------------
+// FillTreeFromFields
+//------------------
+void JEventProcessor_janaroot::FillTreeFromFields(JFactory_base *fac, TreeInfo *tinfo)
+{
+	// This does the same as FillTree, but gets the values from the
+	// objects' JField descriptions rather than from toStrings.
+	// n.b. This gets called while inside the ROOT mutex so it is not locked again here
+
+	vector<const JObject*> objs;
+	fac->GetExistingObjects(objs);
+
+	// Set number of objects in event
+	*tinfo->Nptr = (int)objs.size()<tinfo->Nmax ? (int)objs.size():tinfo->Nmax;
+
+	// Loop over items in class
+	const vector<JField> &fields = *tinfo->fields;
+	unsigned long ptr =  tinfo->Bptr;
+	for(unsigned int j=0; j<tinfo->types.size(); j++){
+		
+		if(tinfo->branches[j+1] == NULL)continue;
+		const JField &field = fields[j];
+	
+		// Set the branch address
+		if(tinfo->types[j] == type_string){
+			tinfo->StringMap[j].clear();
+		}else{
+			tinfo->branches[j+1]->SetAddress((void*)ptr);
+		}
+
+		// Loop over objects
+		for(unsigned int i=0; i<(unsigned int)*tinfo->Nptr; i++){
+			switch(tinfo->types[j]){
+				case type_short:
+					*(short*)ptr = field.GetAs<short>(objs[i]);
+					break;
+				case type_ushort:
+					*(unsigned short*)ptr = field.GetAs<unsigned short>(objs[i]);
+					break;
+				case type_int:
+					*(int*)ptr = field.GetAs<int>(objs[i]);
+					break;
+				case type_uint:
+					*(unsigned int*)ptr = field.GetAs<unsigned int>(objs[i]);
+					break;
+				case type_long:
+					*(long*)ptr = field.GetAs<long>(objs[i]);
+					break;
+				case type_ulong:
+					*(unsigned long*)ptr = field.GetAs<unsigned long>(objs[i]);
+					break;
+				case type_float:
+					*(float*)ptr = field.GetAs<float>(objs[i]);
+					break;
+				case type_double:
+					*(double*)ptr = field.GetAs<double>(objs[i]);
+					break;
+				case type_string:
+					tinfo->StringMap[j].push_back(string());
+					field.GetValue(objs[i], &tinfo->StringMap[j].back());
+					break;
+				default:
+					break;
+			}
+			ptr += tinfo->item_sizes[j];
+		}
+	}
+
+	// Copy in number of objects
+	tinfo->branches[0]->SetAddress((void*)tinfo->Nptr);
+}
+
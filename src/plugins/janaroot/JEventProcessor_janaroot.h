@@ -49,6 +49,7 @@ class JEventProcessor_janaroot:public jana::JEventProcessor{
 				int *Nptr;
 				unsigned long Bptr;
 			map<int, vector<std::string> > StringMap;
+				const vector<jana::JField> *fields; // non-NULL if class has JOBJECT_FIELDS
 				
 				void Print(void){
 					cout<<"    tree name:"<<tree->GetName()<<endl;
@@ -88,6 +89,7 @@ class JEventProcessor_janaroot:public jana::JEventProcessor{
 		
 		TreeInfo* GetTreeInfo(jana::JFactory_base *fac);
 		void FillTree(jana::JFactory_base *fac, TreeInfo *binfo);
+		void FillTreeFromFields(jana::JFactory_base *fac, TreeInfo *binfo);
 };
 
 #endif // _JEventProcessor_janaroot_
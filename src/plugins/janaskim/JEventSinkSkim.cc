@@ -0,0 +1,354 @@
+// $Id$
+//
+//    File: JEventSinkSkim.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+using namespace std;
+
+#include <JANA/JApplication.h>
+#include <JANA/JEvent.h>
+
+#include "JEventSinkSkim.h"
+
+// Routine used to create our JEventProcessor
+extern "C"{
+void InitPlugin(JApplication *app){
+	InitJANAPlugin(app);
+	app->AddProcessor(new JEventSinkSkim(), true);
+}
+} // "C"
+
+//---------------------------------
+// LaunchWriterThread
+//---------------------------------
+static void* LaunchWriterThread(void *arg)
+{
+	((JEventSinkSkim*)arg)->WriterLoop();
+	return NULL;
+}
+
+//---------------------------------
+// JEventSinkSkim    (Constructor)
+//---------------------------------
+JEventSinkSkim::JEventSinkSkim()
+{
+	mask = 0;
+	writer_started = false;
+	stop_writer = false;
+	Nbytes_queued = 0;
+	wait_time = 0.0;
+	pthread_mutex_init(&queue_mutex, NULL);
+	pthread_cond_init(&queue_cond, NULL);
+	pthread_cond_init(&space_cond, NULL);
+	pthread_key_create(&buffers_key, NULL);
+}
+
+//---------------------------------
+// ~JEventSinkSkim    (Destructor)
+//---------------------------------
+JEventSinkSkim::~JEventSinkSkim()
+{
+	for(unsigned int i=0; i<outputs.size(); i++){
+		if(outputs[i]->file) fclose(outputs[i]->file);
+		delete outputs[i];
+	}
+	for(unsigned int i=0; i<all_buffers.size(); i++){
+		for(unsigned int j=0; j<all_buffers[i]->buffers.size(); j++) delete all_buffers[i]->buffers[j];
+		delete all_buffers[i];
+	}
+	for(unsigned int i=0; i<queue.size(); i++) delete queue[i];
+	for(unsigned int i=0; i<free_buffers.size(); i++) delete free_buffers[i];
+	pthread_key_delete(buffers_key);
+	pthread_cond_destroy(&space_cond);
+	pthread_cond_destroy(&queue_cond);
+	pthread_mutex_destroy(&queue_mutex);
+}
+
+//---------------------------------
+// init
+//---------------------------------
+jerror_t JEventSinkSkim::init(void)
+{
+	OUTPUT = "";
+	BUFFER_MB = 4;
+	MAX_QUEUED_MB = 256;
+
+	JParameterManager *parms = app->GetJParameterManager();
+	parms->SetDefaultParameter("SKIM:OUTPUT", OUTPUT, "Comma separated list of bit:filename. Events with the status bit set are copied to the file");
+	parms->SetDefaultParameter("SKIM:BUFFER_MB", BUFFER_MB, "Size in MB of each thread's staging buffer for each skim file");
+	parms->SetDefaultParameter("SKIM:MAX_QUEUED_MB", MAX_QUEUED_MB, "Max. MB of skimmed events waiting to be written before processing threads wait");
+	if(BUFFER_MB<1) BUFFER_MB = 1;
+
+	// Parse output list
+	stringstream ss(OUTPUT);
+	string item;
+	while(getline(ss, item, ',')){
+		stringstream ss2(item);
+		ss2 >> item; // strip white space
+		if(item == "") continue;
+		size_t pos = item.find(':');
+		char *end = NULL;
+		unsigned long bit = pos==string::npos ? 64:strtoul(item.substr(0, pos).c_str(), &end, 0);
+		if(pos==string::npos || pos==0 || *end!=0 || bit>=64 || pos+1==item.size()){
+			jerr<<"Bad SKIM:OUTPUT entry \""<<item<<"\" (should be bit:filename with bit 0-63)"<<endl;
+			continue;
+		}
+
+		Output *out = new Output;
+		out->bit = bit;
+		out->filename = item.substr(pos+1);
+		out->have_framing = false;
+		out->header_written = false;
+		out->Nevents = 0;
+		out->Nbytes = 0;
+		out->file = fopen(out->filename.c_str(), "wb");
+		if(!out->file){
+			jerr<<"Unable to open skim file \""<<out->filename<<"\" for writing!"<<endl;
+			delete out;
+			continue;
+		}
+		outputs.push_back(out);
+		mask |= (uint64_t)1<<bit;
+	}
+	if(outputs.empty()) return NOERROR;
+
+	jout<<"Skimming events to:"<<endl;
+	for(unsigned int i=0; i<outputs.size(); i++){
+		jout<<"   status bit "<<outputs[i]->bit<<" -> \""<<outputs[i]->filename<<"\""<<endl;
+	}
+
+	if(pthread_create(&writer_thread, NULL, LaunchWriterThread, this) != 0){
+		jerr<<"Unable to start skim writer thread! No events will be skimmed."<<endl;
+		for(unsigned int i=0; i<outputs.size(); i++){
+			fclose(outputs[i]->file);
+			delete outputs[i];
+		}
+		outputs.clear();
+		mask = 0;
+		return RESOURCE_UNAVAILABLE;
+	}
+	writer_started = true;
+
+	return NOERROR;
+}
+
+//---------------------------------
+// evnt
+//---------------------------------
+jerror_t JEventSinkSkim::evnt(JEventLoop *loop, uint64_t eventnumber)
+{
+	/// Copy the event's raw bytes into this thread's staging buffer
+	/// of every output whose bit is set for the event. Since sinks
+	/// are called after all other processors, any of them could have
+	/// set the bits.
+	JEvent &event = loop->GetJEvent();
+	uint64_t status = event.GetStatus();
+	if((status & mask) == 0) return NOERROR;
+
+	JEventSource *source = event.GetJEventSource();
+	const void *data = NULL;
+	uint64_t size = 0;
+	if(!source || !source->GetRawEvent(event, data, size)){
+		pthread_mutex_lock(&queue_mutex);
+		if(unsupported.insert(source).second){
+			jerr<<"Source \""<<(source ? source->GetSourceName():"")<<"\" can not provide raw events. Its events will not be skimmed!"<<endl;
+		}
+		pthread_mutex_unlock(&queue_mutex);
+		return NOERROR;
+	}
+
+	ThreadBuffers *tb = (ThreadBuffers*)pthread_getspecific(buffers_key);
+	if(!tb){
+		tb = new ThreadBuffers;
+		tb->buffers.resize(outputs.size(), NULL);
+		tb->have_framing.resize(outputs.size(), false);
+		pthread_setspecific(buffers_key, tb);
+		pthread_mutex_lock(&queue_mutex);
+		all_buffers.push_back(tb);
+		pthread_mutex_unlock(&queue_mutex);
+	}
+
+	for(unsigned int i=0; i<outputs.size(); i++){
+		Output *out = outputs[i];
+		if(((status>>out->bit) & 0x1) == 0) continue;
+		if(!tb->have_framing[i]){
+			GetFraming(out, source);
+			tb->have_framing[i] = true;
+		}
+
+		Buffer* &buffer = tb->buffers[i];
+		if(!buffer) buffer = GetFreeBuffer(i);
+
+		tb->header.clear();
+		source->GetRawEventHeader(event, size, tb->header);
+		buffer->data.insert(buffer->data.end(), tb->header.begin(), tb->header.end());
+		buffer->data.insert(buffer->data.end(), (const char*)data, (const char*)data + size);
+		buffer->Nevents++;
+
+		if(buffer->data.size() >= (uint64_t)BUFFER_MB*1024*1024){
+			Queue(buffer);
+			buffer = NULL;
+		}
+	}
+
+	return NOERROR;
+}
+
+//---------------------------------
+// fini
+//---------------------------------
+jerror_t JEventSinkSkim::fini(void)
+{
+	if(outputs.empty()) return NOERROR;
+
+	// Queue what is left in each thread's buffers. All processing
+	// threads are finished by now.
+	for(unsigned int i=0; i<all_buffers.size(); i++){
+		vector<Buffer*> &buffers = all_buffers[i]->buffers;
+		for(unsigned int j=0; j<buffers.size(); j++){
+			if(buffers[j]) Queue(buffers[j]);
+			buffers[j] = NULL;
+		}
+	}
+
+	// Let writer thread finish the queue
+	if(writer_started){
+		pthread_mutex_lock(&queue_mutex);
+		stop_writer = true;
+		pthread_cond_signal(&queue_cond);
+		pthread_mutex_unlock(&queue_mutex);
+		pthread_join(writer_thread, NULL);
+		writer_started = false;
+	}
+
+	for(unsigned int i=0; i<outputs.size(); i++){
+		Output *out = outputs[i];
+		if(out->header_written && !out->file_trailer.empty()){
+			fwrite(&out->file_trailer[0], 1, out->file_trailer.size(), out->file);
+			out->Nbytes += out->file_trailer.size();
+		}
+		if(fclose(out->file) != 0) jerr<<"Error closing skim file \""<<out->filename<<"\"!"<<endl;
+		out->file = NULL;
+
+		jout<<"Skimmed "<<out->Nevents<<" events (status bit "<<out->bit<<") to \""<<out->filename<<"\" (";
+		jout<<fixed<<setprecision(2)<<(double)out->Nbytes/1024.0/1024.0<<" MB)"<<endl;
+	}
+	if(wait_time > 0.1) jout<<"Processing threads waited "<<fixed<<setprecision(1)<<wait_time<<" s for the skim writer"<<endl;
+
+	return NOERROR;
+}
+
+//---------------------------------
+// GetFraming
+//---------------------------------
+void JEventSinkSkim::GetFraming(Output *output, JEventSource *source)
+{
+	/// Get the bytes the source says go at the start and end of a
+	/// file of its raw events. This is done with the first event
+	/// skimmed to the output since the source (file) may be closed
+	/// by the time the output is closed. Each processing thread calls
+	/// this once per output (see evnt) and have_framing is only read
+	/// or written here, under the lock.
+	pthread_mutex_lock(&queue_mutex);
+	if(!output->have_framing){
+		source->GetRawFileHeader(output->file_header);
+		source->GetRawFileTrailer(output->file_trailer);
+		output->have_framing = true;
+	}
+	pthread_mutex_unlock(&queue_mutex);
+}
+
+//---------------------------------
+// GetFreeBuffer
+//---------------------------------
+JEventSinkSkim::Buffer* JEventSinkSkim::GetFreeBuffer(unsigned int ioutput)
+{
+	/// Get an empty buffer for the given output. Buffers are reused
+	/// once the writer is done with them so their memory stays allocated.
+	Buffer *buffer = NULL;
+	pthread_mutex_lock(&queue_mutex);
+	if(!free_buffers.empty()){
+		buffer = free_buffers.back();
+		free_buffers.pop_back();
+	}
+	pthread_mutex_unlock(&queue_mutex);
+
+	if(!buffer){
+		buffer = new Buffer;
+		buffer->data.reserve((uint64_t)BUFFER_MB*1024*1024 + 65536);
+	}
+	buffer->ioutput = ioutput;
+	buffer->Nevents = 0;
+	buffer->data.clear();
+
+	return buffer;
+}
+
+//---------------------------------
+// Queue
+//---------------------------------
+void JEventSinkSkim::Queue(Buffer *buffer)
+{
+	/// Hand a buffer to the writer thread. If too much is already
+	/// waiting to be written, wait for the writer to catch up first.
+	uint64_t max_bytes = (uint64_t)MAX_QUEUED_MB*1024*1024;
+	pthread_mutex_lock(&queue_mutex);
+	if(!queue.empty() && Nbytes_queued+buffer->data.size() > max_bytes){
+		uint64_t start = JEventLoop::GetTicks();
+		while(!queue.empty() && Nbytes_queued+buffer->data.size() > max_bytes) pthread_cond_wait(&space_cond, &queue_mutex);
+		wait_time += (double)(JEventLoop::GetTicks() - start)/1.0E9;
+	}
+	queue.push_back(buffer);
+	Nbytes_queued += buffer->data.size();
+	pthread_cond_signal(&queue_cond);
+	pthread_mutex_unlock(&queue_mutex);
+}
+
+//---------------------------------
+// WriterLoop
+//---------------------------------
+void JEventSinkSkim::WriterLoop(void)
+{
+	/// Write queued buffers to their files until told to stop and
+	/// the queue is empty.
+	pthread_mutex_lock(&queue_mutex);
+	while(true){
+		while(queue.empty() && !stop_writer) pthread_cond_wait(&queue_cond, &queue_mutex);
+		if(queue.empty()) break;
+
+		Buffer *buffer = queue.front();
+		queue.pop_front();
+		pthread_mutex_unlock(&queue_mutex);
+
+		Output *out = outputs[buffer->ioutput];
+		if(!out->header_written){
+			if(!out->file_header.empty()){
+				fwrite(&out->file_header[0], 1, out->file_header.size(), out->file);
+				out->Nbytes += out->file_header.size();
+			}
+			out->header_written = true;
+		}
+		if(!buffer->data.empty()){
+			if(fwrite(&buffer->data[0], 1, buffer->data.size(), out->file) != buffer->data.size()){
+				jerr<<"Error writing to skim file \""<<out->filename<<"\"!"<<endl;
+			}
+		}
+		out->Nevents += buffer->Nevents;
+		out->Nbytes += buffer->data.size();
+
+		pthread_mutex_lock(&queue_mutex);
+		Nbytes_queued -= buffer->data.size();
+		free_buffers.push_back(buffer);
+		pthread_cond_broadcast(&space_cond);
+	}
+	pthread_mutex_unlock(&queue_mutex);
+}
+
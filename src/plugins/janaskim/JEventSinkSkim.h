@@ -0,0 +1,114 @@
+// $Id$
+//
+//    File: JEventSinkSkim.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _JEventSinkSkim_
+#define _JEventSinkSkim_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include <deque>
+#include <set>
+using std::deque;
+using std::set;
+
+#include <JANA/JEventSink.h>
+using namespace jana;
+
+/// JEventSinkSkim copies selected events to one or more output files
+/// exactly as they were read (no decoding and re-encoding of the
+/// event). Events are selected by status bits of their JEvent which
+/// event processors set, e.g.
+///
+///   loop->GetJEvent().SetStatusBit(5);
+///
+/// Each output file is given a status bit with -PSKIM:OUTPUT=bit:file,...
+/// and gets every event that has that bit set. The raw bytes come from
+/// the source's JEventSource::GetRawEvent() so only sources that
+/// implement it can be skimmed.
+///
+/// Each processing thread appends the events it selects to its own
+/// staging buffer (one per output). Full buffers are handed to a
+/// writer thread which does all of the file writes. Processing threads
+/// only wait if the writer falls behind by more than SKIM:MAX_QUEUED_MB.
+
+class JEventSinkSkim:public JEventSink{
+	public:
+		JEventSinkSkim();
+		virtual ~JEventSinkSkim();
+		virtual const char* className(void){return static_className();}
+		static const char* static_className(void){return "JEventSinkSkim";}
+
+		/// One output file
+		class Output{
+			public:
+				uint32_t bit;
+				string filename;
+				FILE *file;
+				bool have_framing;        ///< file_header and file_trailer are set (guarded by queue_mutex)
+				bool header_written;
+				vector<char> file_header;
+				vector<char> file_trailer;
+				uint64_t Nevents;
+				uint64_t Nbytes;
+		};
+
+		/// Events staged by one thread for one output
+		class Buffer{
+			public:
+				unsigned int ioutput;
+				uint64_t Nevents;
+				vector<char> data;
+		};
+
+		/// Per-thread staging buffers
+		class ThreadBuffers{
+			public:
+				vector<Buffer*> buffers;  ///< one per output (NULL if none in use)
+				vector<bool> have_framing;///< one per output. This thread has seen the output's framing set
+				vector<char> header;      ///< used to get event headers from source
+		};
+
+		void WriterLoop(void); ///< Used internally by writer thread
+
+	protected:
+		jerror_t init(void);
+		jerror_t brun_sink(JEventLoop *loop, int32_t runnumber){return NOERROR;}
+		jerror_t evnt(JEventLoop *loop, uint64_t eventnumber);
+		jerror_t fini(void);
+
+		Buffer* GetFreeBuffer(unsigned int ioutput);
+		void Queue(Buffer *buffer);
+		void GetFraming(Output *output, JEventSource *source);
+
+	private:
+		string OUTPUT;
+		uint32_t BUFFER_MB;
+		uint32_t MAX_QUEUED_MB;
+
+		vector<Output*> outputs;
+		uint64_t mask;                    // all bits used by outputs
+
+		pthread_key_t buffers_key;
+		vector<ThreadBuffers*> all_buffers;
+		set<JEventSource*> unsupported;   // sources already warned about
+
+		pthread_t writer_thread;
+		bool writer_started;
+		bool stop_writer;
+		pthread_mutex_t queue_mutex;
+		pthread_cond_t queue_cond;        // signaled when buffers are queued
+		pthread_cond_t space_cond;        // signaled when the writer has written a buffer
+		deque<Buffer*> queue;
+		vector<Buffer*> free_buffers;
+		uint64_t Nbytes_queued;
+		double wait_time;                 // time processing threads waited for writer (s)
+};
+
+#endif // _JEventSinkSkim_
+
@@ -0,0 +1,340 @@
+// $Id$
+//
+//    File: JField_test.cc
+// Created: Mon Oct 19 2026
+// Creator: davidl
+//
+
+//=============================================================================
+// This unit test checks the binary form of JField values written by
+// JField::Serialize and read back by JField::Deserialize. This is what
+// the columnar files (janacolumnar) and the factory cache (JFactoryCache)
+// store so values of every type must come back exactly as they were.
+// It also checks that input that is cut short is rejected and that
+// JFIELD_METHOD fields are written but not set when reading back.
+//=============================================================================
+
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+#include <set>
+#include <limits>
+using namespace std;
+
+#include <JANA/JObject.h>
+#include <JANA/JField.h>
+using namespace jana;
+
+#define CATCH_CONFIG_RUNNER
+#include "../catch.hpp"
+
+enum Color{kRed, kGreen, kBlue=1000000};
+enum class Plane:int8_t{kU=-1, kV=0, kX=1};
+enum class Big:uint64_t{kSmall=1, kLarge=0xFFFFFFFFFFFFFFF0ULL};
+
+class FieldTest:public JObject{
+	public:
+		JOBJECT_PUBLIC(FieldTest);
+
+		FieldTest():i8(0),u8(0),i16(0),u16(0),i32(0),u32(0),i64(0),u64(0),f(0.0),d(0.0),b(false),color(kRed),plane(Plane::kV),big(Big::kSmall){}
+
+		int8_t   i8;
+		uint8_t  u8;
+		int16_t  i16;
+		uint16_t u16;
+		int32_t  i32;
+		uint32_t u32;
+		int64_t  i64;
+		uint64_t u64;
+		float    f;
+		double   d;
+		bool     b;
+		string   s;
+		Color    color;
+		Plane    plane;
+		Big      big;
+		string   s2;
+
+		JOBJECT_FIELDS(FieldTest,
+			JFIELD(i8,    "%d"),
+			JFIELD(u8,    "%d"),
+			JFIELD(i16,   "%d"),
+			JFIELD(u16,   "%d"),
+			JFIELD(i32,   "%d"),
+			JFIELD(u32,   "%u"),
+			JFIELD(i64,   "%ld"),
+			JFIELD(u64,   "%lu"),
+			JFIELD(f,     "%f"),
+			JFIELD(d,     "%f"),
+			JFIELD(b,     "%d"),
+			JFIELD(s,     NULL),
+			JFIELD(color, "%d"),
+			JFIELD(plane, "%d"),
+			JFIELD(big,   "%lu"),
+			JFIELD_METHOD(sum, GetSum, "%f"),
+			JFIELD_METHOD(label, GetLabel, NULL),
+			JFIELD(s2,    NULL));
+
+		double GetSum(void) const {return (double)i32 + d;}
+		string GetLabel(void) const {return s + "/" + s2;}
+};
+
+FieldTest MakeTestObject(int which);
+bool SameMembers(const FieldTest &a, const FieldTest &b);
+
+//------------------
+// main
+//------------------
+int main(int narg, char *argv[])
+{
+	cout<<endl;
+	cout<<"----- starting JField unit test ------"<<endl;
+
+	int result = Catch::Main( narg, argv );
+
+	return result;
+}
+
+//------------------
+// TEST_CASE
+//------------------
+TEST_CASE("jfield/types", "Checks that the test class has a field of every type")
+{
+	const vector<JField> &fields = FieldTest::static_fields();
+	set<int> types;
+	for(unsigned int i=0; i<fields.size(); i++) types.insert(fields[i].type);
+	for(int t=JField::kInt8; t<=JField::kString; t++){
+		INFO( "type " << JField::GetTypeName((JField::type_t)t) );
+		REQUIRE( types.count(t) == 1 );
+	}
+
+	// Enums are stored as integers of the same size and signedness
+	REQUIRE( fields[12].type == JField::kUInt32 );
+	REQUIRE( fields[13].type == JField::kInt8 );
+	REQUIRE( fields[14].type == JField::kUInt64 );
+
+	// Method fields are not data members
+	REQUIRE( !fields[15].IsMember() );
+	REQUIRE( !fields[16].IsMember() );
+	REQUIRE( fields[17].IsMember() );
+}
+
+//------------------
+// TEST_CASE
+//------------------
+TEST_CASE("jfield/round trip", "Serializes objects and reads them back")
+{
+	const vector<JField> &fields = FieldTest::static_fields();
+
+	for(int which=0; which<3; which++){
+		FieldTest in = MakeTestObject(which);
+		vector<char> buff;
+		JField::Serialize(&in, fields, buff);
+
+		FieldTest out;
+		const char *ptr = buff.data();
+		const char *end = buff.data() + buff.size();
+		REQUIRE( JField::Deserialize(&out, fields, ptr, end) );
+		ptrdiff_t Nleft = end - ptr;
+		REQUIRE( Nleft == 0 );
+		REQUIRE( SameMembers(in, out) );
+
+		// Method fields come from the members so must agree too
+		REQUIRE( out.GetSum() == in.GetSum() );
+		REQUIRE( out.GetLabel() == in.GetLabel() );
+	}
+}
+
+//------------------
+// TEST_CASE
+//------------------
+TEST_CASE("jfield/many objects", "Reads several objects back from one buffer")
+{
+	const vector<JField> &fields = FieldTest::static_fields();
+
+	vector<char> buff;
+	FieldTest in[3];
+	for(int i=0; i<3; i++){
+		in[i] = MakeTestObject(i);
+		JField::Serialize(&in[i], fields, buff);
+	}
+
+	const char *ptr = buff.data();
+	const char *end = buff.data() + buff.size();
+	for(int i=0; i<3; i++){
+		FieldTest out;
+		REQUIRE( JField::Deserialize(&out, fields, ptr, end) );
+		REQUIRE( SameMembers(in[i], out) );
+	}
+	ptrdiff_t Nleft = end - ptr;
+	REQUIRE( Nleft == 0 );
+}
+
+//------------------
+// TEST_CASE
+//------------------
+TEST_CASE("jfield/method fields", "Checks JFIELD_METHOD values are written but not set")
+{
+	const vector<JField> &fields = FieldTest::static_fields();
+	FieldTest in = MakeTestObject(1);
+
+	// The bytes for the method fields are there
+	vector<char> buff;
+	JField::Serialize(&in, fields, buff);
+	string label = in.GetLabel();
+	size_t Nexpected = 0;
+	for(unsigned int i=0; i<fields.size(); i++) Nexpected += fields[i].GetSize();
+	Nexpected += 3*sizeof(uint32_t) + in.s.size() + label.size() + in.s2.size();
+	REQUIRE( buff.size() == Nexpected );
+
+	// Changing the written values of the method fields changes nothing
+	// when reading back. The sum (a double) follows the 14 fixed size
+	// members before it and the string s.
+	size_t sum_offset = 0;
+	for(unsigned int i=0; i<15; i++) sum_offset += fields[i].GetSize();
+	sum_offset += sizeof(uint32_t) + in.s.size();
+	double bogus = -1.0;
+	memcpy(&buff[sum_offset], &bogus, sizeof(bogus));
+
+	FieldTest out;
+	const char *ptr = buff.data();
+	const char *end = buff.data() + buff.size();
+	REQUIRE( JField::Deserialize(&out, fields, ptr, end) );
+	ptrdiff_t Nleft = end - ptr;
+	REQUIRE( Nleft == 0 );
+	REQUIRE( SameMembers(in, out) );
+	REQUIRE( out.GetSum() == in.GetSum() );
+}
+
+//------------------
+// TEST_CASE
+//------------------
+TEST_CASE("jfield/truncated", "Checks input that is cut short is rejected")
+{
+	const vector<JField> &fields = FieldTest::static_fields();
+	FieldTest in = MakeTestObject(2);
+	vector<char> buff;
+	JField::Serialize(&in, fields, buff);
+
+	// Every length short of the whole thing must fail without reading
+	// past the end. Copying into a buffer of exactly that size lets
+	// tools like valgrind catch reads past it.
+	for(size_t N=0; N<buff.size(); N++){
+		vector<char> part(buff.begin(), buff.begin()+N);
+		FieldTest out;
+		const char *ptr = part.data();
+		const char *end = part.data() + part.size();
+		INFO( "length " << N << " of " << buff.size() );
+		REQUIRE( !JField::Deserialize(&out, fields, ptr, end) );
+		ptrdiff_t Nleft = end - ptr;
+		REQUIRE( Nleft >= 0 );
+	}
+}
+
+//------------------
+// TEST_CASE
+//------------------
+TEST_CASE("jfield/bad string length", "Checks a string length past the end is rejected")
+{
+	// Only a string field so the length is at the start
+	vector<JField> fields;
+	fields.push_back(FieldTest::static_fields()[11]);
+	REQUIRE( fields[0].type == JField::kString );
+
+	FieldTest in = MakeTestObject(1);
+	vector<char> buff;
+	JField::Serialize(&in, fields, buff);
+	REQUIRE( buff.size() == sizeof(uint32_t) + in.s.size() );
+
+	uint32_t lengths[] = {(uint32_t)in.s.size()+1, 0x7FFFFFFF, 0xFFFFFFFF};
+	for(unsigned int i=0; i<3; i++){
+		memcpy(&buff[0], &lengths[i], sizeof(uint32_t));
+		FieldTest out;
+		const char *ptr = buff.data();
+		const char *end = buff.data() + buff.size();
+		INFO( "length " << lengths[i] );
+		REQUIRE( !JField::Deserialize(&out, fields, ptr, end) );
+	}
+}
+
+//------------------
+// MakeTestObject
+//------------------
+FieldTest MakeTestObject(int which)
+{
+	/// Make objects with the smallest values (0), the largest values
+	/// (1) and some ordinary values (2) of each type.
+	FieldTest t;
+	switch(which){
+		case 0:
+			t.i8  = numeric_limits<int8_t>::min();
+			t.u8  = 0;
+			t.i16 = numeric_limits<int16_t>::min();
+			t.u16 = 0;
+			t.i32 = numeric_limits<int32_t>::min();
+			t.u32 = 0;
+			t.i64 = numeric_limits<int64_t>::min();
+			t.u64 = 0;
+			t.f   = -numeric_limits<float>::max();
+			t.d   = -numeric_limits<double>::denorm_min();
+			t.b   = false;
+			t.s   = "";
+			t.color = kRed;
+			t.plane = Plane::kU;
+			t.big   = Big::kSmall;
+			t.s2  = "";
+			break;
+		case 1:
+			t.i8  = numeric_limits<int8_t>::max();
+			t.u8  = numeric_limits<uint8_t>::max();
+			t.i16 = numeric_limits<int16_t>::max();
+			t.u16 = numeric_limits<uint16_t>::max();
+			t.i32 = numeric_limits<int32_t>::max();
+			t.u32 = numeric_limits<uint32_t>::max();
+			t.i64 = numeric_limits<int64_t>::max();
+			t.u64 = numeric_limits<uint64_t>::max();
+			t.f   = numeric_limits<float>::max();
+			t.d   = numeric_limits<double>::max();
+			t.b   = true;
+			t.s   = string("with\0NUL and\nnewline", 20);
+			t.color = kBlue;
+			t.plane = Plane::kX;
+			t.big   = Big::kLarge;
+			t.s2  = string(100000, 'x');
+			break;
+		default:
+			t.i8  = -7;
+			t.u8  = 200;
+			t.i16 = -1234;
+			t.u16 = 54321;
+			t.i32 = -123456789;
+			t.u32 = 3000000000U;
+			t.i64 = -1234567890123LL;
+			t.u64 = 12345678901234567890ULL;
+			t.f   = 3.14159f;
+			t.d   = 2.718281828459045;
+			t.b   = true;
+			t.s   = "hit";
+			t.color = kGreen;
+			t.plane = Plane::kV;
+			t.big   = Big::kSmall;
+			t.s2  = "CDC";
+			break;
+	}
+	return t;
+}
+
+//------------------
+// SameMembers
+//------------------
+bool SameMembers(const FieldTest &a, const FieldTest &b)
+{
+	/// Compare all data members. Floating point values are compared
+	/// bit for bit since they must come back exactly.
+	return a.i8==b.i8 && a.u8==b.u8 && a.i16==b.i16 && a.u16==b.u16
+		&& a.i32==b.i32 && a.u32==b.u32 && a.i64==b.i64 && a.u64==b.u64
+		&& memcmp(&a.f, &b.f, sizeof(a.f))==0 && memcmp(&a.d, &b.d, sizeof(a.d))==0
+		&& a.b==b.b && a.s==b.s && a.color==b.color && a.plane==b.plane
+		&& a.big==b.big && a.s2==b.s2;
+}
@@ -0,0 +1,424 @@
+// Author: David Lawrence   Oct. 19, 2026
+//
+//
+// janabroker.cc
+//
+// Read events from one or more source files and hand them out to any
+// number of jana processes connected over Unix domain or TCP sockets.
+// The processes read from the broker by giving its address as the
+// source name (e.g. jana -PPLUGINS=jana_iotest tcp:farm01:5555). See
+// JEventSourceSocket and JEventSocket for the protocol. Each file is
+// read only once no matter how many processes there are and events go
+// to whichever processes have room for them (credit based flow control)
+// so slow ones do not hold up the others. Any source type that
+// implements JEventSource::GetRawEvent can be used. Plugins providing
+// the source types are given with -PPLUGINS=... just like for jana.
+//
+// Events already sent to a process that dies are not sent again. At
+// most JANA:SOCKET_CREDITS of them (as set in that process) are lost.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+using namespace std;
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include <JANA/JApplication.h>
+#include <JANA/JEventSocket.h>
+#include <JANA/JEventSourceGenerator.h>
+#include <JANA/JEventLoop.h>
+#include <JANA/JEvent.h>
+using namespace jana;
+
+void ParseCommandLineArguments(int &narg, char *argv[]);
+void Usage(void);
+JEventSource* OpenSource(JApplication *app, const string &filename);
+bool NextEvent(JApplication *app, vector<char> &buff, jsocket_event_t &rec);
+void FillBatch(JApplication *app, class Client &c);
+void StopReading(int x);
+
+vector<string> FILENAMES;
+string ADDRESS = "unix:/tmp/janabroker.sock";
+uint32_t MAX_BATCH = 16;
+uint64_t MAX_EVENTS = 0;
+volatile bool quit = false;
+
+// State of reading the input files
+unsigned int ifile = 0;
+JEventSource *source = NULL;
+bool done_reading = false;
+uint64_t Nevents = 0;
+uint64_t Nbytes = 0;
+unsigned int Nfailed = 0;
+
+// One connected process
+class Client{
+	public:
+		int fd;
+		unsigned int id;        // 1 for first to connect, 2 for second, ...
+		uint32_t credit;        // events it has room for
+		vector<char> out;       // message being sent
+		size_t Nsent_bytes;     // bytes of out already sent
+		vector<char> in;        // partial message received
+		bool ended;             // sent kEnd
+		uint64_t Nevents;
+		uint64_t Nbatches;
+};
+
+//-----------
+// main
+//-----------
+int main(int narg, char *argv[])
+{
+	// Parse the command line
+	ParseCommandLineArguments(narg, argv);
+
+	// The JApplication is only used to attach the plugins that
+	// provide the source types.
+	JApplication *app = new JApplication(narg, argv);
+	app->create_event_buffer_thread = false;
+	app->Init();
+
+	string error;
+	int listen_fd = JEventSocket::Listen(ADDRESS, error);
+	if(listen_fd < 0){
+		cerr<<"Unable to listen for clients: "<<error<<endl;
+		delete app;
+		return -1;
+	}
+	fcntl(listen_fd, F_SETFL, O_NONBLOCK);
+	cout<<"Listening for clients at "<<ADDRESS<<endl;
+
+	signal(SIGINT, StopReading);
+	signal(SIGTERM, StopReading);
+	signal(SIGPIPE, SIG_IGN);
+
+	vector<Client*> clients;
+	vector<Client*> finished;
+	unsigned int first = 0;  // rotates so no client is always served first
+	uint64_t start = 0;
+	while(true){
+		if(quit) done_reading = true;
+
+		// Exit once all events are out and every client has been told
+		if(done_reading && clients.empty()) break;
+
+		// Build the list of descriptors to watch. Clients are always
+		// watched for reading (for credit or the connection closing)
+		// and for writing while they have something waiting to be sent.
+		vector<struct pollfd> fds(1 + clients.size());
+		fds[0].fd = listen_fd;
+		fds[0].events = done_reading ? 0:POLLIN;
+		for(unsigned int i=0; i<clients.size(); i++){
+			fds[1+i].fd = clients[i]->fd;
+			fds[1+i].events = POLLIN | (clients[i]->out.empty() ? 0:POLLOUT);
+		}
+		int rc = poll(&fds[0], fds.size(), 500);
+		if(rc<0 && errno!=EINTR){
+			cerr<<"poll: "<<strerror(errno)<<endl;
+			break;
+		}
+
+		// New clients
+		if(fds[0].revents & POLLIN){
+			int fd;
+			while((fd = accept(listen_fd, NULL, NULL)) >= 0){
+				fcntl(fd, F_SETFL, O_NONBLOCK);
+				int one = 1;
+				setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // fails harmlessly for unix sockets
+				Client *c = new Client;
+				c->fd = fd;
+				c->id = clients.size() + finished.size() + 1;
+				c->credit = 0;
+				c->Nsent_bytes = 0;
+				c->ended = false;
+				c->Nevents = 0;
+				c->Nbatches = 0;
+				clients.push_back(c);
+				if(start==0) start = JEventLoop::GetTicks();
+				cout<<"Client "<<c->id<<" connected"<<endl;
+			}
+		}
+
+		// Existing clients
+		for(unsigned int i=0; i<clients.size(); i++){
+			Client *c = clients[i];
+			short revents = fds[1+i].revents;
+			bool closed = (revents & (POLLERR | POLLNVAL))!=0;
+
+			if(revents & (POLLIN | POLLHUP)){
+				char buff[1024];
+				ssize_t n = read(c->fd, buff, sizeof(buff));
+				if(n > 0){
+					c->in.insert(c->in.end(), buff, buff+n);
+					while(c->in.size() >= sizeof(jsocket_header_t)){
+						jsocket_header_t hdr;
+						memcpy(&hdr, &c->in[0], sizeof(hdr));
+						c->in.erase(c->in.begin(), c->in.begin()+sizeof(hdr));
+						if(!JEventSocket::CheckHeader(hdr) || hdr.type!=JEventSocket::kCredit){
+							cerr<<"Bad message from client (wrong version of JANA?)"<<endl;
+							closed = true;
+							break;
+						}
+						c->credit += hdr.count;
+					}
+				}else if(n==0 || (errno!=EAGAIN && errno!=EINTR)){
+					closed = true;
+				}
+			}
+
+			if(!closed && !c->out.empty() && (revents & POLLOUT)){
+				ssize_t n = send(c->fd, &c->out[c->Nsent_bytes], c->out.size()-c->Nsent_bytes, MSG_NOSIGNAL);
+				if(n > 0){
+					c->Nsent_bytes += n;
+					if(c->Nsent_bytes == c->out.size()){
+						c->out.clear();
+						c->Nsent_bytes = 0;
+					}
+				}else if(n<0 && errno!=EAGAIN && errno!=EINTR){
+					closed = true;
+				}
+			}
+
+			if(closed){
+				if(!c->ended) cerr<<"Client "<<c->id<<" disconnected before end of input!"<<endl;
+				close(c->fd);
+				finished.push_back(c);
+				clients.erase(clients.begin()+i);
+				fds.erase(fds.begin()+1+i);
+				i--;
+			}
+		}
+
+		// Give clients with room for more events their next batch
+		for(unsigned int j=0; j<clients.size(); j++){
+			Client *c = clients[(first + j)%clients.size()];
+			if(c->out.empty() && c->credit>0 && !c->ended) FillBatch(app, *c);
+		}
+		if(!clients.empty()) first = (first + 1)%clients.size();
+	}
+	close(listen_fd);
+	JEventSocket::Unlink(ADDRESS);
+	if(source) delete source;
+	double time = start==0 ? 0.0:(double)(JEventLoop::GetTicks() - start)/1.0E9;
+
+	// Report
+	cout<<"Sent "<<Nevents<<" events ("<<fixed<<setprecision(1)<<(double)Nbytes/1.0E6<<" MB) in "<<setprecision(2)<<time<<" s";
+	if(time>0.0) cout<<" ("<<setprecision(1)<<(double)Nevents/time<<" Hz, "<<(double)Nbytes/1.0E6/time<<" MB/s)";
+	cout<<endl;
+	cout<<"   client      events   batches"<<endl;
+	for(unsigned int i=0; i<finished.size(); i++){
+		cout<<"   "<<setw(6)<<finished[i]->id<<" "<<setw(11)<<finished[i]->Nevents<<" "<<setw(9)<<finished[i]->Nbatches<<endl;
+		delete finished[i];
+	}
+
+	delete app;
+
+	return Nfailed>0 ? -1:0;
+}
+
+//-----------
+// FillBatch
+//-----------
+void FillBatch(JApplication *app, Client &c)
+{
+	/// Read up to MAX_BATCH events (but no more than the client has
+	/// credit for) into the client's output buffer. If there are no more
+	/// events, tell the client so instead.
+	uint32_t Nmax = c.credit<MAX_BATCH ? c.credit:MAX_BATCH;
+	vector<jsocket_event_t> records;
+	vector<char> data;
+	while(records.size() < Nmax){
+		jsocket_event_t rec;
+		if(!NextEvent(app, data, rec)) break;
+		records.push_back(rec);
+	}
+
+	jsocket_header_t hdr;
+	if(records.empty()){
+		JEventSocket::MakeHeader(hdr, JEventSocket::kEnd, 0, 0);
+		c.out.assign((char*)&hdr, (char*)&hdr + sizeof(hdr));
+		c.ended = true;
+		return;
+	}
+
+	uint64_t Nrecord_bytes = records.size()*sizeof(jsocket_event_t);
+	JEventSocket::MakeHeader(hdr, JEventSocket::kEvents, records.size(), Nrecord_bytes + data.size());
+	c.out.reserve(sizeof(hdr) + Nrecord_bytes + data.size());
+	c.out.assign((char*)&hdr, (char*)&hdr + sizeof(hdr));
+	c.out.insert(c.out.end(), (char*)&records[0], (char*)&records[0] + Nrecord_bytes);
+	c.out.insert(c.out.end(), data.begin(), data.end());
+	c.credit -= records.size();
+	c.Nevents += records.size();
+	c.Nbatches++;
+}
+
+//-----------
+// NextEvent
+//-----------
+bool NextEvent(JApplication *app, vector<char> &buff, jsocket_event_t &rec)
+{
+	/// Append the bytes of the next event from the input files to buff
+	/// and fill in rec for it. Returns false once there are no more.
+	while(!done_reading){
+		if(MAX_EVENTS>0 && Nevents>=MAX_EVENTS){
+			done_reading = true;
+			break;
+		}
+
+		if(!source){
+			if(ifile >= FILENAMES.size()){
+				done_reading = true;
+				break;
+			}
+			const string &filename = FILENAMES[ifile++];
+			source = OpenSource(app, filename);
+			if(!source){
+				cerr<<filename<<": no source type can read this file!"<<endl;
+				Nfailed++;
+				continue;
+			}
+		}
+
+		JEvent event;
+		if(source->JEventSource::GetEvent(event) != NOERROR){
+			delete source;
+			source = NULL;
+			continue;
+		}
+
+		const void *data = NULL;
+		uint64_t size = 0;
+		if(!source->GetRawEvent(event, data, size)){
+			cerr<<source->GetSourceName()<<": source type "<<source->className()<<" can not give raw events!"<<endl;
+			event.FreeEvent();
+			delete source;
+			source = NULL;
+			Nfailed++;
+			continue;
+		}
+
+		rec.run_number = event.GetRunNumber();
+		rec.pad = 0;
+		rec.event_number = event.GetEventNumber();
+		rec.size = size;
+		buff.insert(buff.end(), (const char*)data, (const char*)data + size);
+		event.FreeEvent();
+		Nevents++;
+		Nbytes += size;
+		return true;
+	}
+
+	return false;
+}
+
+//-----------
+// StopReading
+//-----------
+void StopReading(int x)
+{
+	// Stop reading. Clients are told there are no more events.
+	quit = true;
+}
+
+//-----------
+// OpenSource
+//-----------
+JEventSource* OpenSource(JApplication *app, const string &filename)
+{
+	/// Make a source for the file using whichever generator says it
+	/// is most likely to be able to read it (same as JApplication does).
+	vector<JEventSourceGenerator*> generators = app->GetEventSourceGenerators();
+	JEventSourceGenerator *gen = NULL;
+	double liklihood = 0.0;
+	for(unsigned int i=0; i<generators.size(); i++){
+		double my_liklihood = generators[i]->CheckOpenable(filename);
+		if(my_liklihood > liklihood){
+			liklihood = my_liklihood;
+			gen = generators[i];
+		}
+	}
+
+	return gen ? gen->MakeJEventSource(filename):NULL;
+}
+
+//-----------
+// ParseCommandLineArguments
+//-----------
+void ParseCommandLineArguments(int &narg, char *argv[])
+{
+	if(narg==1)Usage();
+
+	for(int i=1;i<narg;i++){
+		if(argv[i][0] == '-'){
+			string arg = "";
+			if(i+1 < narg) arg  = argv[i+1];
+			switch(argv[i][1]){
+				case 'h':
+					Usage();
+					break;
+				case 'a':
+				case 'b':
+				case 'N':
+					if(arg==""){cout<<"'"<<argv[i][1]<<"' requires an argument!"<<endl; exit(0);}
+					if(argv[i][1]=='a') ADDRESS = arg;
+					if(argv[i][1]=='b') MAX_BATCH = atoi(arg.c_str());
+					if(argv[i][1]=='N') MAX_EVENTS = strtoull(arg.c_str(), NULL, 0);
+					i++;
+					break;
+			}
+		}else{
+			FILENAMES.push_back(argv[i]);
+		}
+	}
+
+	if(FILENAMES.empty()){
+		cout<<"You must specify at least one file to read!"<<endl;
+		exit(-1);
+	}
+	if(!JEventSocket::IsSocketAddress(ADDRESS.c_str())){
+		cout<<"Bad address \""<<ADDRESS<<"\" (use unix:PATH or tcp:HOST:PORT)"<<endl;
+		exit(-1);
+	}
+	if(MAX_BATCH<1) MAX_BATCH = 1;
+}
+
+//-----------
+// Usage
+//-----------
+void Usage(void)
+{
+	cout<<"Usage:"<<endl;
+	cout<<"       janabroker [options] file [file2 ...]"<<endl;
+	cout<<endl;
+	cout<<"Read events from the files and hand them out to jana processes"<<endl;
+	cout<<"that connect using the broker's address as their source name."<<endl;
+	cout<<"Each process is sent no more events than it has asked for so"<<endl;
+	cout<<"events go to whichever have room. Once all events have been"<<endl;
+	cout<<"sent, janabroker exits when the last process disconnects."<<endl;
+	cout<<endl;
+	cout<<"Options:"<<endl;
+	cout<<endl;
+	cout<<"   -h              Print this message"<<endl;
+	cout<<"   -a address      Where to listen: unix:PATH or tcp:HOST:PORT"<<endl;
+	cout<<"                   (def. unix:/tmp/janabroker.sock, HOST may be *)"<<endl;
+	cout<<"   -b Nevents      Most events to send a process at once (def. 16)"<<endl;
+	cout<<"   -N Nevents      Stop after sending this many events"<<endl;
+	cout<<"   -Pkey=value     Set config. parameter (e.g. -PPLUGINS=janaeviomap)"<<endl;
+	cout<<endl;
+
+	exit(0);
+}
@@ -0,0 +1,378 @@
+// Author: David Lawrence   Oct. 18, 2026
+//
+//
+// janacritpath.cc
+//
+// Read the per-event factory call timings written by the janadot
+// plugin (see JANADOT:CALL_LOG) and determine how much of the time
+// spent on each event is on the critical path of the factory
+// dependency graph. From this, estimate how much could be gained
+// by adding threads, either by processing more events in parallel
+// (inter-event) or by running independent factories of the same
+// event in parallel (intra-event).
+//
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <set>
+using namespace std;
+
+#include <stdlib.h>
+#include <stdint.h>
+
+void ParseCommandLineArguments(int &narg, char *argv[]);
+void Usage(void);
+void ProcessEvent(void);
+int64_t LongestPath(const string &node, map<string, int64_t> &best, map<string, string> &next, set<string> &visiting);
+string JoinPath(const vector<string> &path);
+
+vector<string> FILENAMES;
+unsigned int MAX_THREADS = 64;
+double SERIAL_FRACTION = -1.0;
+bool VERBOSE = false;
+
+// Info for event currently being read in
+int32_t run_number = 0;
+uint64_t event_number = 0;
+bool have_event = false;
+map<string, int64_t> self_ticks;
+map<string, set<string> > callees;
+set<string> source_nodes;
+
+// Totals over all events
+uint64_t Nevents = 0;
+double sum_work_ms = 0.0;
+double sum_critical_ms = 0.0;
+double sum_source_ms = 0.0;
+double sum_parallelism = 0.0;
+map<string, unsigned int> path_counts;
+
+enum{
+	DATA_NOT_AVAILABLE = 1,
+	DATA_FROM_CACHE,
+	DATA_FROM_SOURCE,
+	DATA_FROM_FACTORY
+};
+
+//-----------
+// main
+//-----------
+int main(int narg, char *argv[])
+{
+	// Parse the command line
+	ParseCommandLineArguments(narg, argv);
+
+	if(VERBOSE){
+		cout<<endl;
+		cout<<"     run        event   work(ms)   crit(ms)  parallelism  critical path"<<endl;
+		cout<<"---------------------------------------------------------------------------"<<endl;
+	}
+
+	for(unsigned int i=0; i<FILENAMES.size(); i++){
+		ifstream ifs(FILENAMES[i].c_str());
+		if(!ifs.is_open()){
+			cerr<<"Unable to open file \""<<FILENAMES[i]<<"\"!"<<endl;
+			return -1;
+		}
+
+		string line;
+		while(getline(ifs, line)){
+			if(line.empty() || line[0]=='#') continue;
+
+			// Split at tabs
+			vector<string> fields;
+			stringstream ss(line);
+			string field;
+			while(getline(ss, field, '\t')) fields.push_back(field);
+
+			if(fields[0] == "E"){
+				if(fields.size() < 3) continue;
+				ProcessEvent();
+				run_number = atoi(fields[1].c_str());
+				event_number = strtoull(fields[2].c_str(), NULL, 10);
+				have_event = true;
+			}else if(fields[0] == "C"){
+				if(fields.size() < 6) continue;
+				const string &caller = fields[1];
+				const string &callee = fields[2];
+				if(caller == "<ignore>") continue;
+				uint64_t start_ticks = strtoull(fields[3].c_str(), NULL, 10);
+				uint64_t end_ticks   = strtoull(fields[4].c_str(), NULL, 10);
+				int data_source = atoi(fields[5].c_str());
+
+				int64_t delta_t = (int64_t)(end_ticks - start_ticks);
+				self_ticks[callee] += delta_t;
+				self_ticks[caller] -= delta_t;
+				callees[caller].insert(callee);
+				if(data_source == DATA_FROM_SOURCE) source_nodes.insert(callee);
+			}
+		}
+		ProcessEvent();
+	}
+
+	if(Nevents == 0){
+		cout<<"No events found!"<<endl;
+		return 0;
+	}
+
+	// Averages per event
+	double work_ms     = sum_work_ms/(double)Nevents;
+	double critical_ms = sum_critical_ms/(double)Nevents;
+	double source_ms   = sum_source_ms/(double)Nevents;
+	double parallelism = critical_ms>0.0 ? work_ms/critical_ms:1.0;
+
+	// Fraction of each event that is inherently serial. For intra-event
+	// parallelism this is the critical path. For inter-event parallelism
+	// this is the time spent getting objects from the source (unless
+	// overridden on the command line).
+	double f_intra = work_ms>0.0 ? critical_ms/work_ms:1.0;
+	double f_inter = SERIAL_FRACTION>=0.0 ? SERIAL_FRACTION:(work_ms>0.0 ? source_ms/work_ms:0.0);
+
+	cout<<endl;
+	cout<<"Events analyzed: "<<Nevents<<endl;
+	cout<<fixed<<setprecision(3);
+	cout<<"     Average work per event: "<<setw(10)<<work_ms<<" ms"<<endl;
+	cout<<"    Average critical path  : "<<setw(10)<<critical_ms<<" ms  ("<<setprecision(1)<<100.0*f_intra<<"% of work)"<<endl;
+	cout<<setprecision(3);
+	cout<<" Average time from source  : "<<setw(10)<<source_ms<<" ms"<<endl;
+	cout<<"Average available parallelism (work/critical path): "<<setprecision(2)<<parallelism;
+	cout<<"  (mean of per-event ratios: "<<sum_parallelism/(double)Nevents<<")"<<endl;
+	cout<<endl;
+
+	// Most common critical paths
+	multimap<unsigned int, string> sorted_paths;
+	map<string, unsigned int>::iterator piter;
+	for(piter=path_counts.begin(); piter!=path_counts.end(); piter++) sorted_paths.insert(pair<unsigned int, string>(piter->second, piter->first));
+	cout<<"Most frequent critical paths:"<<endl;
+	unsigned int Nprinted = 0;
+	multimap<unsigned int, string>::reverse_iterator siter;
+	for(siter=sorted_paths.rbegin(); siter!=sorted_paths.rend() && Nprinted<5; siter++, Nprinted++){
+		cout<<"  "<<setw(5)<<setprecision(1)<<100.0*(double)siter->first/(double)Nevents<<"%  "<<siter->second<<endl;
+	}
+	cout<<endl;
+
+	// Amdahl-style projections. Inter-event: the serial fraction is
+	// f_inter and everything else scales with N. Intra-event: the critical
+	// path can't be shortened, but everything off of it can be spread
+	// over N threads.
+	cout<<"Projected speedup (Amdahl):"<<endl;
+	cout<<"  Serial fraction  inter-event: "<<setprecision(3)<<f_inter<<(SERIAL_FRACTION>=0.0 ? " (user specified)":" (source)")<<endl;
+	cout<<"  Serial fraction  intra-event: "<<f_intra<<" (critical path)"<<endl;
+	cout<<endl;
+	cout<<"  Nthreads   inter-event   intra-event"<<endl;
+	cout<<"  --------------------------------------"<<endl;
+	vector<unsigned int> Nthreads;
+	for(unsigned int N=1; N<=MAX_THREADS; N*=2) Nthreads.push_back(N);
+	if(Nthreads.back() != MAX_THREADS) Nthreads.push_back(MAX_THREADS);
+	for(unsigned int i=0; i<Nthreads.size(); i++){
+		double N = (double)Nthreads[i];
+		double s_inter = 1.0/(f_inter + (1.0-f_inter)/N);
+		double s_intra = 1.0/(f_intra + (1.0-f_intra)/N);
+		cout<<"  "<<setw(8)<<Nthreads[i]<<"  "<<setw(12)<<setprecision(2)<<s_inter<<"  "<<setw(12)<<s_intra<<endl;
+	}
+	cout<<"  "<<setw(8)<<"limit"<<"  "<<setw(12)<<(f_inter>0.0 ? 1.0/f_inter:0.0)<<"  "<<setw(12)<<(f_intra>0.0 ? 1.0/f_intra:0.0);
+	if(f_inter<=0.0) cout<<"   (inter-event: unbounded)";
+	cout<<endl<<endl;
+
+	return 0;
+}
+
+//-----------
+// ProcessEvent
+//-----------
+void ProcessEvent(void)
+{
+	/// Called when all calls for an event have been read in. Finds
+	/// the critical path and adds the event to the totals.
+
+	if(!have_event) return;
+	have_event = false;
+
+	// Total work is the sum of the time spent in each node itself.
+	// Top-level callers (event processors) will have negative values
+	// since only the time waiting on others is recorded for them.
+	int64_t work_ticks = 0;
+	int64_t source_ticks = 0;
+	map<string, int64_t>::iterator iter;
+	for(iter=self_ticks.begin(); iter!=self_ticks.end(); iter++){
+		if(iter->second <= 0) continue;
+		work_ticks += iter->second;
+		if(source_nodes.find(iter->first) != source_nodes.end()) source_ticks += iter->second;
+	}
+
+	// Top-level callers are those that never appear as a callee
+	set<string> all_callees;
+	map<string, set<string> >::iterator citer;
+	for(citer=callees.begin(); citer!=callees.end(); citer++) all_callees.insert(citer->second.begin(), citer->second.end());
+
+	map<string, int64_t> best;
+	map<string, string> next;
+	set<string> visiting;
+	int64_t critical_ticks = 0;
+	string start;
+	for(citer=callees.begin(); citer!=callees.end(); citer++){
+		if(all_callees.find(citer->first) != all_callees.end()) continue;
+		int64_t ticks = LongestPath(citer->first, best, next, visiting);
+		if(start.empty() || ticks>critical_ticks){
+			critical_ticks = ticks;
+			start = citer->first;
+		}
+	}
+
+	vector<string> path;
+	for(string node=start; !node.empty(); ){
+		path.push_back(node);
+		map<string, string>::iterator niter = next.find(node);
+		node = niter==next.end() ? "":niter->second;
+		if(path.size() > best.size()) break; // protect against cycles
+	}
+	string pathstr = JoinPath(path);
+
+	double work_ms = (double)work_ticks/1.0E6;
+	double critical_ms = (double)critical_ticks/1.0E6;
+	double parallelism = critical_ticks>0 ? (double)work_ticks/(double)critical_ticks:1.0;
+
+	Nevents++;
+	sum_work_ms += work_ms;
+	sum_critical_ms += critical_ms;
+	sum_source_ms += (double)source_ticks/1.0E6;
+	sum_parallelism += parallelism;
+	path_counts[pathstr]++;
+
+	if(VERBOSE){
+		cout<<setw(8)<<run_number<<" "<<setw(12)<<event_number<<" ";
+		cout<<fixed<<setprecision(3)<<setw(10)<<work_ms<<" "<<setw(10)<<critical_ms<<" ";
+		cout<<setprecision(2)<<setw(12)<<parallelism<<"  "<<pathstr<<endl;
+	}
+
+	self_ticks.clear();
+	callees.clear();
+	source_nodes.clear();
+}
+
+//-----------
+// LongestPath
+//-----------
+int64_t LongestPath(const string &node, map<string, int64_t> &best, map<string, string> &next, set<string> &visiting)
+{
+	/// Returns the largest sum of self times (in ticks) over all paths
+	/// from the given node down to a leaf. Results are cached in best
+	/// and the next node along the path is recorded in next.
+
+	map<string, int64_t>::iterator biter = best.find(node);
+	if(biter != best.end()) return biter->second;
+	if(visiting.find(node) != visiting.end()) return 0;
+	visiting.insert(node);
+
+	int64_t self = self_ticks[node];
+	if(self < 0) self = 0;
+
+	int64_t max_callee = 0;
+	map<string, set<string> >::iterator iter = callees.find(node);
+	if(iter != callees.end()){
+		set<string>::iterator it;
+		for(it=iter->second.begin(); it!=iter->second.end(); it++){
+			int64_t ticks = LongestPath(*it, best, next, visiting);
+			if(ticks>max_callee || next.find(node)==next.end()){
+				max_callee = ticks;
+				next[node] = *it;
+			}
+		}
+	}
+
+	visiting.erase(node);
+	best[node] = self + max_callee;
+
+	return best[node];
+}
+
+//-----------
+// JoinPath
+//-----------
+string JoinPath(const vector<string> &path)
+{
+	string str;
+	for(unsigned int i=0; i<path.size(); i++){
+		if(i>0) str += " -> ";
+		str += path[i];
+	}
+
+	return str;
+}
+
+//-----------
+// ParseCommandLineArguments
+//-----------
+void ParseCommandLineArguments(int &narg, char *argv[])
+{
+	if(narg==1)Usage();
+
+	for(int i=1;i<narg;i++){
+		if(argv[i][0] == '-'){
+			string arg = "";
+			if(i+1 < narg) arg  = argv[i+1];
+			switch(argv[i][1]){
+				case 'h':
+					Usage();
+					break;
+				case 'n':
+					if(arg==""){cout<<"'"<<argv[i][1]<<"' requires an argument!"<<endl; exit(0);}
+					MAX_THREADS = atoi(arg.c_str());
+					if(MAX_THREADS<1) MAX_THREADS = 1;
+					i++;
+					break;
+				case 's':
+					if(arg==""){cout<<"'"<<argv[i][1]<<"' requires an argument!"<<endl; exit(0);}
+					SERIAL_FRACTION = atof(arg.c_str());
+					i++;
+					break;
+				case 'v':
+					VERBOSE = true;
+					break;
+			}
+		}else{
+			FILENAMES.push_back(argv[i]);
+		}
+	}
+
+	if(FILENAMES.empty()){
+		cout<<"You must specify at least one call log file!"<<endl;
+		exit(-1);
+	}
+}
+
+//-----------
+// Usage
+//-----------
+void Usage(void)
+{
+	cout<<"Usage:"<<endl;
+	cout<<"       janacritpath [options] calllog [calllog2 ...]"<<endl;
+	cout<<endl;
+	cout<<"Analyze factory call timings recorded by the janadot plugin"<<endl;
+	cout<<"to find the critical path of each event and estimate how much"<<endl;
+	cout<<"could be gained by running on more threads."<<endl;
+	cout<<endl;
+	cout<<"Options:"<<endl;
+	cout<<endl;
+	cout<<"   -h              Print this message"<<endl;
+	cout<<"   -n Nthreads     Max. number of threads to project to (def. 64)"<<endl;
+	cout<<"   -s fraction     Serial fraction to use for inter-event projection"<<endl;
+	cout<<"                   (default is fraction of time spent in source)"<<endl;
+	cout<<"   -v              Print critical path of every event"<<endl;
+	cout<<endl;
+	cout<<"To record the call log, run with the janadot plugin and set the"<<endl;
+	cout<<"JANADOT:CALL_LOG config. parameter. e.g."<<endl;
+	cout<<endl;
+	cout<<"   jana -PPLUGINS=janadot -PJANADOT:CALL_LOG=calls.log file.evio"<<endl;
+	cout<<"   janacritpath calls.log"<<endl;
+	cout<<endl;
+
+	exit(0);
+}
+
@@ -7,19 +7,25 @@
 #include <sys/time.h>
 
 #include <iostream>
+#include <iomanip>
 using namespace std;
 
 #include <JANA/JApplication.h>
 #include "jc_cmsg.h"
+#include "jc_socket.h"
 
 string ParseCommandLineArguments(int narg, char *argv[]);
 void Usage(void);
+int SocketCommand(string cmd);
+string TranslateCommand(string cmd);
 
 string UDL = "cMsg://localhost/cMsg/janactl";
 string NAME = "janactl";
 string DESCRIPTION = "Access JANA processes remotely";
 string SUBJECT = "janactl";
 double TIMEOUT = 0.75; // seconds
+bool USE_CMSG = false;
+string SOCKET_PATH = "";
 
 //-----------
 // main
@@ -41,6 +47,9 @@ int main(int narg, char *argv[])
 	// Parse the command line
 	string cmd = ParseCommandLineArguments(narg, argv);
 
+	// The control socket is used unless cMsg was explicitly asked for
+	if(!USE_CMSG) return SocketCommand(cmd);
+
 #if HAVE_CMSG
 	// Create jc_cmsg object
 	jc_cmsg jc(UDL, NAME, DESCRIPTION);
@@ -91,6 +100,74 @@ int main(int narg, char *argv[])
 	return 0;
 }
 
+//-----------
+// TranslateCommand
+//-----------
+string TranslateCommand(string cmd)
+{
+	/// Convert the commands janactl has always accepted into their
+	/// equivalents in the control socket protocol. Anything not
+	/// recognized is passed through unchanged.
+	if(cmd=="thinfo") return "threads";
+	if(cmd.find("set nthreads ")==0) return "nthreads " + cmd.substr(13);
+	if(cmd=="list parms" || cmd=="list params" || cmd.find("list conf")==0) return "params";
+	if(cmd=="list sources") return "sources";
+	if(cmd=="command line") return "command";
+	if(cmd=="dump stacks") return "stacks";
+	return cmd;
+}
+
+//-----------
+// SocketCommand
+//-----------
+int SocketCommand(string cmd)
+{
+	/// Send the command to the process(es) through their control
+	/// socket(s). If no specific process was given, the command
+	/// is sent to all JANA processes found on this node.
+	vector<string> paths;
+	if(SOCKET_PATH != ""){
+		paths.push_back(SOCKET_PATH);
+	}else{
+		paths = jc_socket::FindSockets();
+	}
+	if(paths.empty()){
+		jerr<<"No JANA processes with control sockets found."<<endl;
+		return -1;
+	}
+
+	// "list" just prints the processes we can talk to
+	bool list_only = (cmd=="list");
+	if(list_only) cmd = "command";
+	cmd = TranslateCommand(cmd);
+
+	int ret = 0;
+	for(unsigned int i=0; i<paths.size(); i++){
+		jc_socket jc(paths[i], TIMEOUT>2.0 ? TIMEOUT:2.0);
+		if(!jc.IsConnected()){
+			jerr<<jc.GetError()<<endl;
+			ret = -1;
+			continue;
+		}
+
+		string response;
+		bool ok = jc.SendCommand(cmd, response);
+		if(list_only){
+			cout<<setw(8)<<jc_socket::PathToPID(paths[i])<<"  "<<paths[i]<<"  "<<response;
+			continue;
+		}
+		if(paths.size()>1) cout<<"--- "<<paths[i]<<" ---"<<endl;
+		if(ok){
+			cout<<response;
+		}else{
+			jerr<<"Error: "<<response;
+			ret = -1;
+		}
+	}
+
+	return ret;
+}
+
 //-----------
 // ParseCommandLineArguments
 //-----------
@@ -110,7 +187,10 @@ string ParseCommandLineArguments(int narg, char *argv[])
 			string arg_next((i+1)<narg ? argv[i+1]:"");
 			if(arg=="h" || arg=="help" || arg=="-help")Usage();
 			if(arg=="t" || arg=="-timeout"){TIMEOUT = atof(arg_next.c_str()); i++; continue;}
-			if(arg=="u" || arg=="-udl"){UDL = arg_next; udl_specified=true; i++; continue;}
+			if(arg=="p" || arg=="-pid"){SOCKET_PATH = jana::JControlServer::GetDefaultPath(atoi(arg_next.c_str())); i++; continue;}
+			if(arg=="S" || arg=="-socket"){SOCKET_PATH = arg_next; i++; continue;}
+			if(arg=="-cmsg"){USE_CMSG = true; continue;}
+			if(arg=="u" || arg=="-udl"){UDL = arg_next; udl_specified=true; USE_CMSG = true; i++; continue;}
 			if(arg=="n" || arg=="-name"){NAME = arg_next; i++; continue;}
 			if(arg=="d" || arg=="-description"){DESCRIPTION = arg_next; i++; continue;}
 			if(arg=="s" || arg=="-subject"){SUBJECT = arg_next; i++; continue;}
@@ -140,20 +220,29 @@ void Usage(void)
 	cout<<"Usage:"<<endl;
 	cout<<"       janactl [options] cmd"<<endl;
 	cout<<endl;
-	cout<<"Communicate with remote or local processes that have the janactl"<<endl;
-	cout<<"plugin attached."<<endl;
+	cout<<"Communicate with JANA processes running on this node through their"<<endl;
+	cout<<"control sockets (see the JANA:CONTROL_SOCKET config. parameter). If no"<<endl;
+	cout<<"process is specified, the command is sent to all of them."<<endl;
+	cout<<endl;
+	cout<<"Remote processes that have the janactl plugin attached can still be"<<endl;
+	cout<<"reached through cMsg using the -u or --cmsg options."<<endl;
 	cout<<endl;
 	cout<<"Options:"<<endl;
 	cout<<endl;
 	cout<<"   -h, --help  Print this message"<<endl;
+	cout<<"   -p pid      Send command only to the process with this PID"<<endl;
+	cout<<"   -S path     Send command only to the process using this control socket"<<endl;
+	cout<<"   --cmsg      Use cMsg instead of the control socket"<<endl;
 	cout<<"   -t timeout  Set the timeout of commands while waiting for a response."<<endl;
-	cout<<"   -u udl      Set UDL of cMsg server. If not given, the JANACTL_UDL environment"<<endl;
+	cout<<"   -u udl      Set UDL of cMsg server (implies --cmsg). If not given, the JANACTL_UDL environment"<<endl;
 	cout<<"               variable is used. If that's not set, the localhost is used."<<endl;
 	cout<<"   -n name     Set name of this program for use by cMsg server."<<endl;
 	cout<<"   -d descr.   Set description text of this program for use by cMsg server."<<endl;
 	cout<<"   -s subject  Send command to subject (default is all \"janactl\" which is"<<endl;
 	cout<<"               all processes.)"<<endl;
 	cout<<endl;
+	cout<<"   --pid pid              Same as -p"<<endl;
+	cout<<"   --socket path          Same as -S"<<endl;
 	cout<<"   --timeout timeout      Same as -t"<<endl;
 	cout<<"   --udl udl              Same as -u"<<endl;
 	cout<<"   --name name            Same as -n"<<endl;
@@ -192,6 +281,17 @@ void Usage(void)
 	cout<<"   command line        Print command line used to start remote process(es)"<<endl;
 	cout<<"   host info           Print host info (CPU, RAM, ...) for remote process(es)"<<endl;
 	cout<<endl;
+	cout<<" additional commands (control socket only):"<<endl;
+	cout<<"   help                List all commands the process understands"<<endl;
+	cout<<"   stats               Print global processing statistics"<<endl;
+	cout<<"   nthreads            Print number of processing threads"<<endl;
+	cout<<"   get param           Print value of a configuration parameter"<<endl;
+	cout<<"   set param value     Set value of a configuration parameter"<<endl;
+	cout<<"   stacks              Print stack trace of every processing thread"<<endl;
+	cout<<endl;
+	cout<<" (list source types, list factories, list plugins, attach plugin and host info"<<endl;
+	cout<<"  are only supported via cMsg.)"<<endl;
+	cout<<endl;
 
 	exit(0);
 }
@@ -0,0 +1,172 @@
+// $Id$
+//
+//    File: jc_socket.cc
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <algorithm>
+using namespace std;
+
+#include "jc_socket.h"
+
+//---------------------------------
+// jc_socket    (Constructor)
+//---------------------------------
+jc_socket::jc_socket(string path, double timeout)
+{
+	this->path = path;
+	this->timeout = timeout;
+
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path)-1);
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd < 0){
+		error = string("socket: ") + strerror(errno);
+		return;
+	}
+	if(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0){
+		error = string("connect(") + path + "): " + strerror(errno);
+		close(fd);
+		fd = -1;
+	}
+}
+
+//---------------------------------
+// ~jc_socket    (Destructor)
+//---------------------------------
+jc_socket::~jc_socket()
+{
+	if(fd >= 0) close(fd);
+}
+
+//---------------------------------
+// SendCommand
+//---------------------------------
+bool jc_socket::SendCommand(string cmd, string &response)
+{
+	/// Send a single command and wait for the complete response. On
+	/// return, "response" holds the body of the response (or the error
+	/// message if the command failed). Returns true if the remote
+	/// process replied "OK".
+	response = "";
+	if(fd < 0) return false;
+
+	cmd += "\n";
+	const char *ptr = cmd.c_str();
+	size_t left = cmd.size();
+	while(left > 0){
+		ssize_t n = write(fd, ptr, left);
+		if(n < 0){
+			if(errno == EINTR) continue;
+			error = string("write: ") + strerror(errno);
+			response = error;
+			return false;
+		}
+		ptr += n;
+		left -= n;
+	}
+
+	string status;
+	if(!ReadLine(status)){
+		response = error;
+		return false;
+	}
+	bool ok = status.find("OK")==0;
+	if(!ok && status.find("ERROR ")==0) response = status.substr(6) + "\n";
+
+	string line;
+	while(ReadLine(line)){
+		if(line == ".") return ok;
+		if(line.find("..")==0) line.erase(0, 1);
+		response += line + "\n";
+	}
+
+	response += error + "\n";
+	return false;
+}
+
+//---------------------------------
+// ReadLine
+//---------------------------------
+bool jc_socket::ReadLine(string &line)
+{
+	size_t pos;
+	while((pos=buff.find('\n')) == string::npos){
+		struct pollfd pfd;
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		int n = poll(&pfd, 1, (int)(timeout*1000.0));
+		if(n == 0){
+			error = "timeout waiting for response";
+			return false;
+		}
+		if(n < 0){
+			if(errno == EINTR) continue;
+			error = string("poll: ") + strerror(errno);
+			return false;
+		}
+		char tmp[4096];
+		ssize_t nread = read(fd, tmp, sizeof(tmp));
+		if(nread <= 0){
+			error = "connection closed by remote process";
+			return false;
+		}
+		buff.append(tmp, nread);
+	}
+
+	line = buff.substr(0, pos);
+	buff.erase(0, pos+1);
+	return true;
+}
+
+//---------------------------------
+// PathToPID
+//---------------------------------
+int jc_socket::PathToPID(const string &path)
+{
+	/// Extract the PID from a default socket path (/tmp/jana_ctl.<pid>).
+	/// Returns 0 if the path is not of that form.
+	size_t pos = path.rfind("jana_ctl.");
+	if(pos == string::npos) return 0;
+	return atoi(path.substr(pos+9).c_str());
+}
+
+//---------------------------------
+// FindSockets
+//---------------------------------
+vector<string> jc_socket::FindSockets(void)
+{
+	/// Return paths of all control sockets at their default location
+	/// whose process is still alive. Stale sockets left over from
+	/// processes that crashed are ignored.
+	vector<string> paths;
+	DIR *dir = opendir("/tmp");
+	if(!dir) return paths;
+	struct dirent *ent;
+	while((ent=readdir(dir)) != NULL){
+		string name = ent->d_name;
+		if(name.find("jana_ctl.") != 0) continue;
+		int pid = PathToPID(name);
+		if(pid<=0 || (kill(pid, 0)!=0 && errno==ESRCH)) continue;
+		paths.push_back("/tmp/" + name);
+	}
+	closedir(dir);
+	sort(paths.begin(), paths.end());
+
+	return paths;
+}
+
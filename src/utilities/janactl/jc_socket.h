@@ -0,0 +1,45 @@
+// $Id$
+//
+//    File: jc_socket.h
+// Created: Sun Oct 18 2026
+// Creator: davidl
+//
+
+#ifndef _jc_socket_
+#define _jc_socket_
+
+#include <string>
+#include <vector>
+using std::string;
+using std::vector;
+
+/// Client side of the JANA control socket (see JControlServer).
+/// One of these is used for each process being talked to.
+
+class jc_socket{
+	public:
+		jc_socket(string path, double timeout=2.0);
+		virtual ~jc_socket();
+
+		bool IsConnected(void){return fd>=0;}
+		const string& GetPath(void){return path;}
+		const string& GetError(void){return error;}
+		void SetTimeout(double timeout){this->timeout = timeout;}
+
+		bool SendCommand(string cmd, string &response);
+
+		static vector<string> FindSockets(void);
+		static int PathToPID(const string &path);
+
+	protected:
+		int fd;
+		string path;
+		string error;
+		double timeout;
+		string buff;
+
+		bool ReadLine(string &line);
+};
+
+#endif // _jc_socket_
+
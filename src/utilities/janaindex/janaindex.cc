@@ -0,0 +1,229 @@
+// Author: David Lawrence   Oct. 18, 2026
+//
+//
+// janaindex.cc
+//
+// Make event index sidecar files (see JEventIndex) for a list of
+// source files so that jobs reading them can access events by event
+// number without reading through the file. The files are scanned in
+// parallel, one file per thread. Any source type based on
+// JEventSourceMMap can be indexed. Plugins providing the source types
+// are given with -PPLUGINS=... just like for jana.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+using namespace std;
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <JANA/JApplication.h>
+#include <JANA/JEventSourceMMap.h>
+#include <JANA/JEventSourceGenerator.h>
+#include <JANA/JEventLoop.h>
+using namespace jana;
+
+void ParseCommandLineArguments(int &narg, char *argv[]);
+void Usage(void);
+JEventSource* OpenSource(JApplication *app, const string &filename);
+void* IndexThread(void *arg);
+
+vector<string> FILENAMES;
+unsigned int NTHREADS = 0;
+bool FORCE = false;
+
+// One file to index
+class Job{
+	public:
+		string filename;
+		JEventSourceMMap *source;
+		JEventIndex index;
+		bool ok;
+		double time;
+};
+vector<Job*> jobs;
+unsigned int next_job = 0;
+pthread_mutex_t jobs_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//-----------
+// main
+//-----------
+int main(int narg, char *argv[])
+{
+	// Parse the command line
+	ParseCommandLineArguments(narg, argv);
+
+	// The JApplication is only used to attach the plugins that
+	// provide the source types.
+	JApplication *app = new JApplication(narg, argv);
+	app->create_event_buffer_thread = false;
+	app->Init();
+
+	// Open the sources here, one at a time, since their constructors
+	// may set config. parameters.
+	unsigned int Nskipped = 0;
+	for(unsigned int i=0; i<FILENAMES.size(); i++){
+		const string &filename = FILENAMES[i];
+		if(!FORCE){
+			JEventIndex index;
+			if(index.Read(JEventIndex::GetIndexFilename(filename), filename)){
+				cout<<filename<<": index is up to date ("<<index.GetNevents()<<" events)"<<endl;
+				Nskipped++;
+				continue;
+			}
+		}
+
+		JEventSource *source = OpenSource(app, filename);
+		if(!source){
+			cerr<<filename<<": no source type can read this file!"<<endl;
+			continue;
+		}
+		JEventSourceMMap *mmap_source = dynamic_cast<JEventSourceMMap*>(source);
+		if(!mmap_source || !mmap_source->IsMapped()){
+			cerr<<filename<<": source type "<<source->className()<<" can not be indexed!"<<endl;
+			delete source;
+			continue;
+		}
+
+		Job *job = new Job;
+		job->filename = filename;
+		job->source = mmap_source;
+		job->ok = false;
+		job->time = 0.0;
+		jobs.push_back(job);
+	}
+
+	// Scan the files
+	if(NTHREADS==0) NTHREADS = sysconf(_SC_NPROCESSORS_ONLN);
+	if(NTHREADS>jobs.size()) NTHREADS = jobs.size();
+	vector<pthread_t> threads(NTHREADS);
+	for(unsigned int i=0; i<NTHREADS; i++) pthread_create(&threads[i], NULL, IndexThread, NULL);
+	for(unsigned int i=0; i<NTHREADS; i++) pthread_join(threads[i], NULL);
+
+	// Report
+	unsigned int Nfailed = 0;
+	for(unsigned int i=0; i<jobs.size(); i++){
+		Job *job = jobs[i];
+		if(job->ok){
+			cout<<job->filename<<": indexed "<<job->index.GetNevents()<<" events in "<<fixed<<setprecision(2)<<job->time<<" s"<<endl;
+		}else{
+			cerr<<job->filename<<": unable to write \""<<JEventIndex::GetIndexFilename(job->filename)<<"\"!"<<endl;
+			Nfailed++;
+		}
+		delete job->source;
+		delete job;
+	}
+	if(Nskipped>0) cout<<Nskipped<<" file(s) already had an up to date index (use -f to remake)"<<endl;
+
+	delete app;
+
+	return (Nfailed>0 || jobs.size()+Nskipped<FILENAMES.size()) ? -1:0;
+}
+
+//-----------
+// OpenSource
+//-----------
+JEventSource* OpenSource(JApplication *app, const string &filename)
+{
+	/// Make a source for the file using whichever generator says it
+	/// is most likely to be able to read it (same as JApplication does).
+	vector<JEventSourceGenerator*> generators = app->GetEventSourceGenerators();
+	JEventSourceGenerator *gen = NULL;
+	double liklihood = 0.0;
+	for(unsigned int i=0; i<generators.size(); i++){
+		double my_liklihood = generators[i]->CheckOpenable(filename);
+		if(my_liklihood > liklihood){
+			liklihood = my_liklihood;
+			gen = generators[i];
+		}
+	}
+
+	return gen ? gen->MakeJEventSource(filename):NULL;
+}
+
+//-----------
+// IndexThread
+//-----------
+void* IndexThread(void *arg)
+{
+	/// Take files from the job list until there are none left
+	while(true){
+		pthread_mutex_lock(&jobs_mutex);
+		Job *job = next_job<jobs.size() ? jobs[next_job++]:NULL;
+		pthread_mutex_unlock(&jobs_mutex);
+		if(!job) break;
+
+		uint64_t start = JEventLoop::GetTicks();
+		job->ok = job->source->BuildEventIndex(job->index);
+		job->ok = job->ok && job->index.Write(JEventIndex::GetIndexFilename(job->filename), job->filename);
+		job->time = (double)(JEventLoop::GetTicks() - start)/1.0E9;
+	}
+
+	return NULL;
+}
+
+//-----------
+// ParseCommandLineArguments
+//-----------
+void ParseCommandLineArguments(int &narg, char *argv[])
+{
+	if(narg==1)Usage();
+
+	for(int i=1;i<narg;i++){
+		if(argv[i][0] == '-'){
+			string arg = "";
+			if(i+1 < narg) arg  = argv[i+1];
+			switch(argv[i][1]){
+				case 'h':
+					Usage();
+					break;
+				case 'j':
+					if(arg==""){cout<<"'"<<argv[i][1]<<"' requires an argument!"<<endl; exit(0);}
+					NTHREADS = atoi(arg.c_str());
+					i++;
+					break;
+				case 'f':
+					FORCE = true;
+					break;
+			}
+		}else{
+			FILENAMES.push_back(argv[i]);
+		}
+	}
+
+	if(FILENAMES.empty()){
+		cout<<"You must specify at least one file to index!"<<endl;
+		exit(-1);
+	}
+}
+
+//-----------
+// Usage
+//-----------
+void Usage(void)
+{
+	cout<<"Usage:"<<endl;
+	cout<<"       janaindex [options] file [file2 ...]"<<endl;
+	cout<<endl;
+	cout<<"Make an event index for each file so events can be read"<<endl;
+	cout<<"by event number without reading through the file. The index"<<endl;
+	cout<<"for file.dat is written to file.dat.jidx. Memory mapped"<<endl;
+	cout<<"sources use it automatically (see JANA:EVENT_INDEX)."<<endl;
+	cout<<"Only sources that can report event offsets can be indexed."<<endl;
+	cout<<"e.g. janaindex -PPLUGINS=jana_iotest -PREAD_MODE=mmap file.dat"<<endl;
+	cout<<endl;
+	cout<<"Options:"<<endl;
+	cout<<endl;
+	cout<<"   -h              Print this message"<<endl;
+	cout<<"   -j Nthreads     Number of files to scan at once (def. number of cores)"<<endl;
+	cout<<"   -f              Remake index even if an up to date one exists"<<endl;
+	cout<<"   -Pkey=value     Set config. parameter (e.g. -PPLUGINS=jana_iotest)"<<endl;
+	cout<<endl;
+
+	exit(0);
+}
@@ -0,0 +1,223 @@
+// Author: David Lawrence   Oct. 19, 2026
+//
+//
+// janaring.cc
+//
+// Read events from one or more source files and put their raw bytes in
+// a shared memory event ring (see JEventRing) for other processes to
+// take them from. Worker processes read the ring through sources
+// based on JEventSourceRing by giving a source name of ring:NAME (e.g.
+// jana -PPLUGINS=jana_iotest ring:NAME). Any source type that implements
+// JEventSource::GetRawEvent can be used. Plugins providing the source
+// types are given with -PPLUGINS=... just like for jana.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+using namespace std;
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <JANA/JApplication.h>
+#include <JANA/JEventRing.h>
+#include <JANA/JEventSourceGenerator.h>
+#include <JANA/JEventLoop.h>
+#include <JANA/JEvent.h>
+using namespace jana;
+
+void ParseCommandLineArguments(int &narg, char *argv[]);
+void Usage(void);
+JEventSource* OpenSource(JApplication *app, const string &filename);
+void StopReading(int x);
+
+vector<string> FILENAMES;
+string RING_NAME = "jana";
+uint32_t NSLOTS = 64;
+uint64_t SLOT_SIZE = 4*1024*1024;
+uint64_t MAX_EVENTS = 0;
+double WAIT_TIMEOUT = 0.0;
+volatile bool quit = false;
+
+//-----------
+// main
+//-----------
+int main(int narg, char *argv[])
+{
+	// Parse the command line
+	ParseCommandLineArguments(narg, argv);
+
+	// The JApplication is only used to attach the plugins that
+	// provide the source types.
+	JApplication *app = new JApplication(narg, argv);
+	app->create_event_buffer_thread = false;
+	app->Init();
+
+	JEventRing ring;
+	if(!ring.Create(RING_NAME, NSLOTS, SLOT_SIZE)){
+		cerr<<"Unable to create event ring: "<<ring.GetError()<<endl;
+		delete app;
+		return -1;
+	}
+	cout<<"Created event ring \""<<RING_NAME<<"\" ("<<NSLOTS<<" slots x "<<ring.GetSlotSize()<<" bytes)"<<endl;
+	cout<<"Consumers should use the source name ring:"<<RING_NAME<<endl;
+
+	signal(SIGINT, StopReading);
+	signal(SIGTERM, StopReading);
+
+	uint64_t Nevents = 0;
+	uint64_t Ntoo_big = 0;
+	uint64_t Nbytes = 0;
+	unsigned int Nfailed = 0;
+	uint64_t start = JEventLoop::GetTicks();
+	for(unsigned int i=0; i<FILENAMES.size() && !quit; i++){
+		const string &filename = FILENAMES[i];
+		JEventSource *source = OpenSource(app, filename);
+		if(!source){
+			cerr<<filename<<": no source type can read this file!"<<endl;
+			Nfailed++;
+			continue;
+		}
+
+		while(!quit && (MAX_EVENTS==0 || Nevents<MAX_EVENTS)){
+			JEvent event;
+			jerror_t err = source->JEventSource::GetEvent(event);
+			if(err != NOERROR) break;
+
+			const void *data = NULL;
+			uint64_t size = 0;
+			if(!source->GetRawEvent(event, data, size)){
+				cerr<<filename<<": source type "<<source->className()<<" can not give raw events!"<<endl;
+				event.FreeEvent();
+				Nfailed++;
+				break;
+			}
+			if(ring.Put(data, size, event.GetRunNumber(), event.GetEventNumber())){
+				Nevents++;
+				Nbytes += size;
+			}else{
+				if(Ntoo_big++ < 10) cerr<<filename<<": event "<<event.GetEventNumber()<<": "<<ring.GetError()<<" (skipped)"<<endl;
+			}
+			event.FreeEvent();
+		}
+		delete source;
+	}
+	ring.Finish();
+
+	cout<<"Waiting for consumers to finish ..."<<endl;
+	if(!ring.WaitForConsumers(WAIT_TIMEOUT)) cerr<<"Timed out waiting for consumers!"<<endl;
+	double time = (double)(JEventLoop::GetTicks() - start)/1.0E9;
+
+	cout<<"Put "<<Nevents<<" events ("<<fixed<<setprecision(1)<<(double)Nbytes/1.0E6<<" MB) in ring in "<<setprecision(2)<<time<<" s";
+	if(time>0.0) cout<<" ("<<setprecision(1)<<(double)Nevents/time<<" Hz, "<<(double)Nbytes/1.0E6/time<<" MB/s)";
+	cout<<endl;
+	if(Ntoo_big>0) cerr<<Ntoo_big<<" events were larger than the slot size and were skipped (see -s)"<<endl;
+	ring.PrintStats();
+	ring.Detach();
+
+	delete app;
+
+	return (Nfailed>0 || Ntoo_big>0) ? -1:0;
+}
+
+//-----------
+// StopReading
+//-----------
+void StopReading(int x)
+{
+	// Stop reading. Events already in the ring are still given out.
+	quit = true;
+}
+
+//-----------
+// OpenSource
+//-----------
+JEventSource* OpenSource(JApplication *app, const string &filename)
+{
+	/// Make a source for the file using whichever generator says it
+	/// is most likely to be able to read it (same as JApplication does).
+	vector<JEventSourceGenerator*> generators = app->GetEventSourceGenerators();
+	JEventSourceGenerator *gen = NULL;
+	double liklihood = 0.0;
+	for(unsigned int i=0; i<generators.size(); i++){
+		double my_liklihood = generators[i]->CheckOpenable(filename);
+		if(my_liklihood > liklihood){
+			liklihood = my_liklihood;
+			gen = generators[i];
+		}
+	}
+
+	return gen ? gen->MakeJEventSource(filename):NULL;
+}
+
+//-----------
+// ParseCommandLineArguments
+//-----------
+void ParseCommandLineArguments(int &narg, char *argv[])
+{
+	if(narg==1)Usage();
+
+	for(int i=1;i<narg;i++){
+		if(argv[i][0] == '-'){
+			string arg = "";
+			if(i+1 < narg) arg  = argv[i+1];
+			switch(argv[i][1]){
+				case 'h':
+					Usage();
+					break;
+				case 'r':
+				case 'n':
+				case 's':
+				case 'N':
+				case 't':
+					if(arg==""){cout<<"'"<<argv[i][1]<<"' requires an argument!"<<endl; exit(0);}
+					if(argv[i][1]=='r') RING_NAME = arg;
+					if(argv[i][1]=='n') NSLOTS = atoi(arg.c_str());
+					if(argv[i][1]=='s') SLOT_SIZE = strtoull(arg.c_str(), NULL, 0);
+					if(argv[i][1]=='N') MAX_EVENTS = strtoull(arg.c_str(), NULL, 0);
+					if(argv[i][1]=='t') WAIT_TIMEOUT = atof(arg.c_str());
+					i++;
+					break;
+			}
+		}else{
+			FILENAMES.push_back(argv[i]);
+		}
+	}
+
+	if(FILENAMES.empty()){
+		cout<<"You must specify at least one file to read!"<<endl;
+		exit(-1);
+	}
+}
+
+//-----------
+// Usage
+//-----------
+void Usage(void)
+{
+	cout<<"Usage:"<<endl;
+	cout<<"       janaring [options] file [file2 ...]"<<endl;
+	cout<<endl;
+	cout<<"Read events from the files and put them in a shared memory"<<endl;
+	cout<<"event ring that other jana processes take them from by using"<<endl;
+	cout<<"a source name of ring:NAME. Events are not copied out of the"<<endl;
+	cout<<"ring by the consumers. Once all events have been put in the"<<endl;
+	cout<<"ring, janaring waits for the consumers to finish with them."<<endl;
+	cout<<endl;
+	cout<<"Options:"<<endl;
+	cout<<endl;
+	cout<<"   -h              Print this message"<<endl;
+	cout<<"   -r name         Name of ring (def. jana)"<<endl;
+	cout<<"   -n Nslots       Number of events the ring holds (def. 64)"<<endl;
+	cout<<"   -s bytes        Largest event the ring can hold (def. 4194304)"<<endl;
+	cout<<"   -N Nevents      Stop after putting this many events in ring"<<endl;
+	cout<<"   -t seconds      Longest to wait for consumers at end (def. forever)"<<endl;
+	cout<<"   -Pkey=value     Set config. parameter (e.g. -PPLUGINS=janaeviomap)"<<endl;
+	cout<<endl;
+
+	exit(0);
+}
@@ -0,0 +1,251 @@
+// Author: David Lawrence   Oct. 18, 2026
+//
+//
+// janatop.cc
+//
+// Display the processing statistics of a running JANA program by
+// attaching to the shared memory segment it publishes them in (see
+// JStatsSegment and the JANA:STATS_SHM config. parameter). The
+// monitored program is not affected in any way by this.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+using namespace std;
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <JANA/JStatsSegment.h>
+using namespace jana;
+
+void ParseCommandLineArguments(int &narg, char *argv[]);
+void Usage(void);
+void PrintStats(jstats_t *stats);
+string Val2StringWithPrefix(double val);
+
+pid_t PID = 0;
+double INTERVAL = 2.0;
+int NITERATIONS = -1;
+unsigned int NFACTORIES = 15;
+bool CLEAR_SCREEN = true;
+
+// Factory call counts from the last update so rates can be calculated
+vector<uint64_t> last_Ngencalls;
+double last_update_time = 0.0;
+
+//-----------
+// main
+//-----------
+int main(int narg, char *argv[])
+{
+	// Parse the command line
+	ParseCommandLineArguments(narg, argv);
+
+	JStatsSegment seg;
+	if(!seg.Attach(PID)){
+		cerr<<"Unable to attach to JANA process "<<PID<<": "<<seg.GetError()<<endl;
+		cerr<<"(Is it running with -PJANA:STATS_SHM=1 ?)"<<endl;
+		return -1;
+	}
+	jstats_t *stats = seg.Get();
+
+	for(int i=0; NITERATIONS<0 || i<NITERATIONS; i++){
+
+		// Sleep between updates, but not before the first
+		if(i>0) usleep((useconds_t)(INTERVAL*1.0E6));
+
+		PrintStats(stats);
+
+		if(stats->finished){
+			cout<<endl<<"Process "<<PID<<" has finished event processing."<<endl;
+			break;
+		}
+		if(kill(PID, 0)!=0){
+			cout<<endl<<"Process "<<PID<<" is no longer running."<<endl;
+			break;
+		}
+	}
+
+	return 0;
+}
+
+//-----------
+// PrintStats
+//-----------
+void PrintStats(jstats_t *stats)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	double now = (double)tv.tv_sec + 1.0E-6*(double)tv.tv_usec;
+
+	if(CLEAR_SCREEN) cout<<"\033[2J\033[H";
+
+	cout<<"PID: "<<stats->pid<<"   up: "<<fixed<<setprecision(0)<<now-stats->start_time<<"s";
+	cout<<"   last update: "<<setprecision(1)<<now-stats->update_time<<"s ago"<<endl;
+	cout<<"command: "<<stats->command<<endl;
+	cout<<"source: "<<stats->source_name<<endl;
+	cout<<endl;
+	cout<<"events: "<<stats->NEvents<<" processed  "<<stats->NEvents_read<<" read  "<<stats->Nlost_events<<" lost"<<endl;
+	cout<<"  rate: "<<Val2StringWithPrefix(stats->rate_instantaneous)<<"Hz (avg. "<<Val2StringWithPrefix(stats->rate_average)<<"Hz)"<<endl;
+	cout<<"threads: "<<stats->Nthreads_running<<" running ("<<stats->Nthreads<<" requested)";
+	cout<<"   event buffer: "<<stats->event_buffer_size<<"/"<<stats->event_buffer_max<<endl;
+	cout<<endl;
+
+	// Per-thread table
+	cout<<"  thread        Nevents    rate(Hz)  avg(Hz)  last(ms)  heartbeat(s)       run         event"<<endl;
+	cout<<"  --------------------------------------------------------------------------------------------"<<endl;
+	for(unsigned int i=0; i<JSTATS_MAX_THREADS; i++){
+		jstats_thread_t &t = stats->threads[i];
+		if(!t.in_use) continue;
+		cout<<"  "<<setw(6)<<t.thread_index;
+		cout<<" "<<setw(14)<<t.Nevents;
+		cout<<" "<<setw(11)<<setprecision(1)<<t.rate_instantaneous;
+		cout<<" "<<setw(8)<<setprecision(1)<<t.rate_integrated;
+		cout<<" "<<setw(9)<<setprecision(2)<<t.last_event_time*1000.0;
+		cout<<" "<<setw(13)<<setprecision(1)<<t.heartbeat;
+		cout<<" "<<setw(9)<<t.run_number;
+		cout<<" "<<setw(13)<<t.event_number;
+		cout<<endl;
+	}
+	cout<<endl;
+
+	// Factories sorted by number of evnt calls since the last update
+	unsigned int Nfactories = stats->Nfactories;
+	if(Nfactories > JSTATS_MAX_FACTORIES) Nfactories = JSTATS_MAX_FACTORIES;
+	last_Ngencalls.resize(Nfactories, 0);
+	double dt = last_update_time>0.0 ? now-last_update_time:0.0;
+	vector<pair<uint64_t, unsigned int> > order;
+	for(unsigned int i=0; i<Nfactories; i++){
+		uint64_t Ngencalls = stats->factories[i].Ngencalls;
+		uint64_t delta = Ngencalls>=last_Ngencalls[i] ? Ngencalls-last_Ngencalls[i]:0;
+		order.push_back(pair<uint64_t, unsigned int>(delta, i));
+	}
+	sort(order.rbegin(), order.rend());
+
+	cout<<"  factory                                              calls     gencalls  gencalls/s"<<endl;
+	cout<<"  ---------------------------------------------------------------------------------"<<endl;
+	for(unsigned int j=0; j<order.size() && j<NFACTORIES; j++){
+		jstats_factory_t &f = stats->factories[order[j].second];
+		string name(f.name, 0, 48);
+		cout<<"  "<<setw(48)<<left<<name<<right;
+		cout<<" "<<setw(10)<<f.Ncalls;
+		cout<<" "<<setw(12)<<f.Ngencalls;
+		cout<<" "<<setw(11)<<setprecision(1)<<(dt>0.0 ? (double)order[j].first/dt:0.0);
+		cout<<endl;
+	}
+	if(order.size() > NFACTORIES) cout<<"  ("<<order.size()-NFACTORIES<<" more factories not shown)"<<endl;
+	cout.flush();
+
+	for(unsigned int i=0; i<Nfactories; i++) last_Ngencalls[i] = stats->factories[i].Ngencalls;
+	last_update_time = now;
+}
+
+//-----------
+// Val2StringWithPrefix
+//-----------
+string Val2StringWithPrefix(double val)
+{
+	/// Same as JApplication::Val2StringWithPrefix
+	const char *units = "";
+	if(val>1.5E9){
+		val/=1.0E9;
+		units = "G";
+	}else if(val>1.5E6){
+		val/=1.0E6;
+		units = "M";
+	}else if(val>1.5E3){
+		val/=1.0E3;
+		units = "k";
+	}
+
+	stringstream ss;
+	ss<<fixed<<setprecision(2)<<val<<" "<<units;
+	return ss.str();
+}
+
+//-----------
+// ParseCommandLineArguments
+//-----------
+void ParseCommandLineArguments(int &narg, char *argv[])
+{
+	if(narg==1)Usage();
+
+	for(int i=1;i<narg;i++){
+		if(argv[i][0] == '-'){
+			string arg = "";
+			if(i+1 < narg) arg  = argv[i+1];
+			switch(argv[i][1]){
+				case 'h':
+					Usage();
+					break;
+				case 'i':
+					if(arg==""){cout<<"'"<<argv[i][1]<<"' requires an argument!"<<endl; exit(0);}
+					INTERVAL = atof(arg.c_str());
+					if(INTERVAL<0.1) INTERVAL = 0.1;
+					i++;
+					break;
+				case 'n':
+					if(arg==""){cout<<"'"<<argv[i][1]<<"' requires an argument!"<<endl; exit(0);}
+					NITERATIONS = atoi(arg.c_str());
+					i++;
+					break;
+				case 'f':
+					if(arg==""){cout<<"'"<<argv[i][1]<<"' requires an argument!"<<endl; exit(0);}
+					NFACTORIES = atoi(arg.c_str());
+					i++;
+					break;
+				case '1':
+					NITERATIONS = 1;
+					CLEAR_SCREEN = false;
+					break;
+				case 'b':
+					CLEAR_SCREEN = false;
+					break;
+			}
+		}else{
+			PID = (pid_t)atoi(argv[i]);
+		}
+	}
+
+	if(PID<=0){
+		cout<<"You must specify the PID of the JANA process to monitor!"<<endl;
+		exit(-1);
+	}
+}
+
+//-----------
+// Usage
+//-----------
+void Usage(void)
+{
+	cout<<"Usage:"<<endl;
+	cout<<"       janatop [options] PID"<<endl;
+	cout<<endl;
+	cout<<"Display processing statistics of a running JANA program."<<endl;
+	cout<<"The statistics are read from the shared memory segment"<<endl;
+	cout<<"/dev/shm/jana_stats.PID that the program publishes them in."<<endl;
+	cout<<endl;
+	cout<<"Options:"<<endl;
+	cout<<endl;
+	cout<<"   -h              Print this message"<<endl;
+	cout<<"   -i seconds      Update interval (def. 2)"<<endl;
+	cout<<"   -n iterations   Number of updates before exiting (def. until program ends)"<<endl;
+	cout<<"   -f Nfactories   Number of factories to display (def. 15)"<<endl;
+	cout<<"   -1              Print once and exit (implies -b)"<<endl;
+	cout<<"   -b              Batch mode: don't clear the screen between updates"<<endl;
+	cout<<endl;
+	cout<<"Publishing is on by default. It can be turned off in the program"<<endl;
+	cout<<"being monitored with -PJANA:STATS_SHM=0"<<endl;
+	cout<<endl;
+
+	exit(0);
+}
+